@@ -0,0 +1,153 @@
+/*
+ * STARTREK ULTRA - 3D LOGIC ENGINE
+ * Authors: Nicola Taibi, Supported by Google Gemini
+ * Copyright (C) 2026 Nicola Taibi
+ * License: GNU General Public License v3.0
+ */
+
+/* Authentication overhead: galaxy signature (from scratch vs. resumed after the cube) and sealed PacketUpdate
+   frames (cached session vs. per-frame context setup).
+   Usage: bench_auth [seconds_per_case] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <time.h>
+#include <openssl/hmac.h>
+#include <openssl/core_names.h>
+#include <openssl/rand.h>
+#include "crypto_session.h"
+#define BENCH_BATCH 16  /* Sealing a small frame takes under a microsecond */
+#include "bench_util.h"
+
+#define TICK_HZ 30
+#define CAPTAINS MAX_CLIENTS
+
+/* --- Galaxy Signature --- */
+
+static StarTrekGame galaxy;
+static uint8_t hmac_key[32];
+
+static void sign_struct(void *arg) {
+    unsigned int len = 32;
+    HMAC(EVP_sha256(), hmac_key, 32, (uint8_t *)&galaxy, offsetof(StarTrekGame, server_signature), galaxy.server_signature, &len);
+}
+
+/* The server's way: the HMAC state after the cube is kept while the galaxy is unchanged */
+static EVP_MAC_CTX *cube_mac;
+
+static void sign_resumed(void *arg) {
+    EVP_MAC_CTX *ctx = EVP_MAC_CTX_dup(cube_mac);
+    size_t len = 0;
+    EVP_MAC_update(ctx, (uint8_t *)&galaxy + sizeof(galaxy.g), offsetof(StarTrekGame, server_signature) - sizeof(galaxy.g));
+    EVP_MAC_final(ctx, galaxy.server_signature, &len, 32);
+    EVP_MAC_CTX_free(ctx);
+}
+
+/* --- Sealed Updates --- */
+
+typedef struct {
+    CryptoSession session;
+    const uint8_t *frame;
+    int len;
+    int64_t frame_id;
+    uint8_t *out;
+    uint8_t iv[12], tag[16];
+} SealCase;
+
+static void seal_session(void *arg) {
+    SealCase *c = arg;
+    crypto_session_encrypt(&c->session, CRYPTO_AES, CRYPTO_CHANNEL_UPDATES, c->frame_id++, c->frame, c->len, c->out, c->iv, c->tag);
+}
+
+/* What a sealed stream costs without a cached context: key schedule on every frame */
+static void seal_fresh(void *arg) {
+    SealCase *c = arg;
+    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+    int outlen = 0, final_len = 0;
+    EVP_EncryptInit_ex(ctx, EVP_aes_256_gcm(), NULL, c->session.key, c->iv);
+    EVP_EncryptUpdate(ctx, c->out, &outlen, c->frame, c->len);
+    EVP_EncryptFinal_ex(ctx, c->out + outlen, &final_len);
+    EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG, 16, c->tag);
+    EVP_CIPHER_CTX_free(ctx);
+}
+
+int main(int argc, char **argv) {
+    double budget = (argc > 1) ? atof(argv[1]) : 0.25;
+    if (budget <= 0) budget = 0.25;
+
+    RAND_bytes(hmac_key, sizeof(hmac_key));
+    RAND_bytes((uint8_t *)&galaxy, sizeof(galaxy));
+
+    EVP_MAC *mac = EVP_MAC_fetch(NULL, "HMAC", NULL);
+    cube_mac = mac ? EVP_MAC_CTX_new(mac) : NULL;
+    EVP_MAC_free(mac);
+    if (!cube_mac) { fprintf(stderr, "HMAC-SHA256 unavailable\n"); return 1; }
+    char digest[] = "SHA256";
+    OSSL_PARAM params[] = { OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, digest, 0), OSSL_PARAM_construct_end() };
+    EVP_MAC_init(cube_mac, hmac_key, 32, params);
+    EVP_MAC_update(cube_mac, (uint8_t *)galaxy.g, sizeof(galaxy.g));
+
+    /* Both ways must sign the same bytes to the same MAC */
+    uint8_t whole[32];
+    sign_struct(NULL);
+    memcpy(whole, galaxy.server_signature, 32);
+    sign_resumed(NULL);
+    if (memcmp(whole, galaxy.server_signature, 32) != 0) { printf("galaxy signature mismatch\n"); return 1; }
+
+    printf("--- Galaxy Signature (HMAC-SHA256) ---\n");
+    printf("%-28s %10s %12s %12s\n", "HASHED PER LOGIN", "BYTES", "SIGNS/S", "US/SIGN");
+    double r_struct = rate(budget, sign_struct, NULL);
+    double r_resumed = rate(budget, sign_resumed, NULL);
+    printf("%-28s %10zu %12.0f %12.1f\n", "StarTrekGame from scratch", offsetof(StarTrekGame, server_signature), r_struct, 1e6 / r_struct);
+    printf("%-28s %10zu %12.0f %12.1f\n", "Resumed after the cube", offsetof(StarTrekGame, server_signature) - sizeof(galaxy.g),
+           r_resumed, 1e6 / r_resumed);
+    printf("The cube (%zu bytes) is hashed again only when the galaxy changes.\n\n", sizeof(galaxy.g));
+
+    /* Frame sizes as Phase 3 builds them: header, objects, then the quadrant FX */
+    static const struct { int objects, fx; const char *name; } frames[] = {
+        {1, 0, "Empty quadrant"}, {24, 4, "Typical quadrant"}, {64, 16, "Busy quadrant"},
+        {MAX_NET_OBJECTS, MAX_FX_EVENTS, "Full frame"},
+    };
+    size_t max_len = sizeof(PacketUpdate) + MAX_FX_EVENTS * sizeof(NetFxEvent);
+    uint8_t *frame = malloc(max_len), *out = malloc(max_len + 16), *back = malloc(max_len + 16);
+    if (!frame || !out || !back) { perror("malloc"); return 1; }
+    RAND_bytes(frame, (int)max_len);
+
+    printf("--- Sealed PacketUpdate (AES-256-GCM) ---\n");
+    printf("%-18s %7s %12s %10s %12s %8s %13s\n", "FRAME", "BYTES", "SESSION F/S", "US/FRAME", "FRESH F/S", "SPEEDUP", "TICK SHARE");
+    for (size_t f = 0; f < sizeof(frames) / sizeof(frames[0]); f++) {
+        int len = (int)(offsetof(PacketUpdate, objects) + frames[f].objects * sizeof(NetObject) + frames[f].fx * sizeof(NetFxEvent));
+        SealCase c = {0};
+        uint8_t key[32];
+        RAND_bytes(key, sizeof(key));
+        crypto_session_bind(&c.session, key);
+        c.frame = frame; c.len = len; c.out = out; c.frame_id = 1;
+
+        /* Round trip check before timing anything */
+        CryptoSession rx = {0};
+        crypto_session_bind(&rx, key);
+        int clen = crypto_session_encrypt(&c.session, CRYPTO_AES, CRYPTO_CHANNEL_UPDATES, 1, frame, len, out, c.iv, c.tag);
+        int plen = crypto_session_decrypt(&rx, CRYPTO_AES, c.iv, c.tag, out, clen, back);
+        bool intact = (clen == len && plen == len && memcmp(frame, back, len) == 0);
+        out[0] ^= 1;
+        int forged = crypto_session_decrypt(&rx, CRYPTO_AES, c.iv, c.tag, out, clen, back);
+        crypto_session_free(&rx);
+        if (!intact || forged >= 0) {
+            printf("%-18s %7d   %s\n", frames[f].name, len, (forged >= 0) ? "FORGERY ACCEPTED" : "ROUND TRIP FAILED");
+            crypto_session_free(&c.session);
+            continue;
+        }
+
+        double r_sess = rate(budget, seal_session, &c);
+        double r_fresh = rate(budget, seal_fresh, &c);
+        /* Share of the 33ms tick spent sealing one frame for every captain */
+        double share = (CAPTAINS * TICK_HZ) / r_sess * 100.0;
+        printf("%-18s %7d %12.0f %10.2f %12.0f %7.2fx %12.3f%%\n", frames[f].name, len, r_sess, 1e6 / r_sess,
+               r_fresh, r_sess / r_fresh, share);
+        crypto_session_free(&c.session);
+    }
+    free(frame); free(out); free(back);
+    return 0;
+}
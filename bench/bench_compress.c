@@ -0,0 +1,97 @@
+/*
+ * STARTREK ULTRA - 3D LOGIC ENGINE
+ * Authors: Nicola Taibi, Supported by Google Gemini
+ * Copyright (C) 2026 Nicola Taibi
+ * License: GNU General Public License v3.0
+ */
+
+/* Subspace text compression: ratio and CPU cost on captured server reports, with the
+   shared dictionary and with plain deflate for reference.
+   Usage: bench_compress [-t seconds_per_case] [report files...]  (default: bench/samples) */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "subspace_codec.h"
+#include "bench_util.h"
+
+static const char *default_samples[] = {
+    "bench/samples/help.txt", "bench/samples/sta.txt", "bench/samples/dam.txt", "bench/samples/inv.txt",
+    "bench/samples/who.txt", "bench/samples/cal.txt", "bench/samples/ical.txt", "bench/samples/aux.txt",
+};
+
+static int load_file(const char *path, uint8_t *buf, int cap) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return -1;
+    int n = (int)fread(buf, 1, cap, f);
+    fclose(f);
+    return n;
+}
+
+/* Raw deflate without the dictionary, same level and window as the codec */
+static int plain_deflate(const uint8_t *in, int len, uint8_t *out, int cap) {
+    z_stream z;
+    memset(&z, 0, sizeof(z));
+    if (deflateInit2(&z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) return -1;
+    z.next_in = (Bytef *)in; z.avail_in = len;
+    z.next_out = out; z.avail_out = cap;
+    int r = deflate(&z, Z_FINISH);
+    int n = (int)z.total_out;
+    deflateEnd(&z);
+    return (r == Z_STREAM_END) ? n : -1;
+}
+
+int main(int argc, char **argv) {
+    double budget = 0.25;
+    int first = 1;
+    if (argc > 2 && strcmp(argv[1], "-t") == 0) { budget = atof(argv[2]); first = 3; }
+    if (budget <= 0) budget = 0.25;
+
+    const char **files = default_samples;
+    int nfiles = sizeof(default_samples) / sizeof(default_samples[0]);
+    if (argc > first) { files = (const char **)&argv[first]; nfiles = argc - first; }
+
+    static uint8_t in[65536], out[65536], back[65536];
+    SubspaceCodec tx = {0}, rx = {0};
+    long total_raw = 0, total_dict = 0, total_plain = 0;
+
+    printf("Dictionary: %d bytes\n", SUBSPACE_DICT_LEN);
+    printf("%-28s %6s %8s %7s %8s %7s %10s %10s\n", "REPORT", "BYTES", "DICT", "RATIO", "PLAIN", "RATIO", "DEFL US", "INFL US");
+    for (int f = 0; f < nfiles; f++) {
+        int len = load_file(files[f], in, sizeof(in) - 1);
+        if (len <= 0) { printf("%-28s unreadable\n", files[f]); continue; }
+
+        int plain = plain_deflate(in, len, out, sizeof(out));
+        int clen = subspace_compress(&tx, in, len, out, sizeof(out));
+        if (clen < 0) {
+            printf("%-28s %6d %8s %7s %8d %6.2fx %10s %10s\n", files[f], len, "raw", "-", plain, (double)len / plain, "-", "-");
+            total_raw += len; total_dict += len; total_plain += plain;
+            continue;
+        }
+        if (subspace_decompress(&rx, out, clen, back, sizeof(back)) != len || memcmp(in, back, len) != 0) {
+            printf("%-28s ROUND TRIP FAILED\n", files[f]);
+            return 1;
+        }
+
+        long n = 0;
+        double t0 = now_sec(), t1;
+        do { for (int k = 0; k < 64; k++) subspace_compress(&tx, in, len, out, sizeof(out)); n += 64; } while ((t1 = now_sec()) - t0 < budget);
+        double defl_us = (t1 - t0) * 1e6 / n;
+
+        n = 0; t0 = now_sec();
+        do { for (int k = 0; k < 64; k++) subspace_decompress(&rx, out, clen, back, sizeof(back)); n += 64; } while ((t1 = now_sec()) - t0 < budget);
+        double infl_us = (t1 - t0) * 1e6 / n;
+
+        printf("%-28s %6d %8d %6.2fx %8d %6.2fx %10.2f %10.2f\n", files[f], len, clen, (double)len / clen,
+               plain, (double)len / plain, defl_us, infl_us);
+        total_raw += len; total_dict += clen; total_plain += plain;
+    }
+    if (total_dict > 0 && total_plain > 0)
+        printf("%-28s %6ld %8ld %6.2fx %8ld %6.2fx\n", "TOTAL", total_raw, total_dict, (double)total_raw / total_dict,
+               total_plain, (double)total_raw / total_plain);
+
+    subspace_codec_free(&tx);
+    subspace_codec_free(&rx);
+    return 0;
+}
@@ -0,0 +1,204 @@
+/*
+ * STARTREK ULTRA - 3D LOGIC ENGINE
+ * Authors: Nicola Taibi, Supported by Google Gemini
+ * Copyright (C) 2026 Nicola Taibi
+ * License: GNU General Public License v3.0
+ */
+
+/* Phase 2 hazard sensing: the former per-kind quadrant loops, each measuring every body with
+   sqrt(pow(...)) and the nebula and pulsar loops twice, against the tick's contact pairs read
+   by the same handlers. Both sides find the same contacts; the effects are left out so only
+   the sensing is timed. The pairs side consults each quadrant's hazard field first, so a
+   ship out of reach of every static hazard measures none. MOVING: every ship has moved a
+   hair before the collision checks, so the pairs side shifts its solid bodies.
+   Usage: bench_contacts [seconds_per_case] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "server_internal.h"
+#include "bench_util.h"
+
+/* The server's entity arrays; entity.c reserves and pools them, spatial.c indexes them */
+NPCStar *stars_data;
+NPCBlackHole *black_holes;
+NPCNebula *nebulas;
+NPCPulsar *pulsars;
+NPCComet *comets;
+NPCAsteroid *asteroids;
+NPCDerelict *derelicts;
+NPCMine *mines;
+NPCBuoy *buoys;
+NPCPlatform *platforms;
+NPCRift *rifts;
+NPCMonster *monsters;
+NPCPlanet *planets;
+NPCBase *bases;
+NPCShip *npcs;
+NPCHotData npc_hot;
+ConnectedPlayer players[MAX_CLIENTS];
+StarTrekGame galaxy_master;
+int galaxy_q = GALAXY_Q_DEFAULT;
+int64_t *galaxy_map;
+int64_t *galaxy_cell_frame;
+int g_debug = 0;
+int global_tick = 0;
+
+/* --- Galaxy Population --- */
+
+#define SCATTER(arr, max) for (int i = 0; i < (max); i++) place(&(arr)[i].active, &(arr)[i].q1, &(arr)[i].q2, &(arr)[i].q3, \
+                                                                &(arr)[i].x, &(arr)[i].y, &(arr)[i].z, crowd)
+
+/* Crowded: a quarter of every kind, captains included, converges on one quadrant */
+static void place(int *active, int *q1, int *q2, int *q3, double *x, double *y, double *z, bool crowd) {
+    *active = 1;
+    if (crowd && rand() % 4 == 0) { *q1 = 5; *q2 = 5; *q3 = 5; }
+    else { *q1 = rand() % 10 + 1; *q2 = rand() % 10 + 1; *q3 = rand() % 10 + 1; }
+    *x = rand() % 1000 / 100.0; *y = rand() % 1000 / 100.0; *z = rand() % 1000 / 100.0;
+}
+
+static void populate(bool crowd) {
+    srand(1701);
+    SCATTER(planets, MAX_PLANETS); SCATTER(stars_data, MAX_STARS); SCATTER(black_holes, MAX_BH);
+    SCATTER(nebulas, MAX_NEBULAS); SCATTER(pulsars, MAX_PULSARS); SCATTER(comets, MAX_COMETS);
+    SCATTER(asteroids, MAX_ASTEROIDS); SCATTER(mines, MAX_MINES); SCATTER(rifts, MAX_RIFTS);
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        int active;
+        double x, y, z;
+        StarTrekGame *s = &players[i].state;
+        place(&active, &s->q1, &s->q2, &s->q3, &x, &y, &z, crowd);
+        s->s1 = (float)x; s->s2 = (float)y; s->s3 = (float)z;
+        players[i].active = active;
+        snprintf(players[i].name, sizeof(players[i].name), "Captain %d", i);
+    }
+}
+
+/* --- Hazard Sensing --- */
+
+static volatile long sink;
+static long found;  /* Contacts the handlers acted on, the same for both sides */
+
+#define FORMER_DIST(arr, q, list, k) sqrt(pow(s->s1 - (arr)[(q)->list[k]].x, 2) + pow(s->s2 - (arr)[(q)->list[k]].y, 2) + pow(s->s3 - (arr)[(q)->list[k]].z, 2))
+
+/* Ships that move shift by a hair between the hazards and the collision checks */
+static void nudge(StarTrekGame *s, bool moving, float by) {
+    if (moving) s->s1 += by;
+}
+
+static void sense_former(bool moving) {
+    long hits = 0;
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (!players[i].active) continue;
+        StarTrekGame *s = &players[i].state;
+        QuadrantIndex qv = spatial_quadrant(s->q1, s->q2, s->q3), *q = &qv;
+        for (int k = 0; k < q->nebula_count; k++) if (FORMER_DIST(nebulas, q, nebulas, k) < 2.0) hits++;
+        for (int k = 0; k < q->pulsar_count; k++) if (FORMER_DIST(pulsars, q, pulsars, k) < 2.5) hits++;
+        for (int k = 0; k < q->comet_count; k++) if (FORMER_DIST(comets, q, comets, k) < 0.6) hits++;
+        for (int k = 0; k < q->asteroid_count; k++) if (FORMER_DIST(asteroids, q, asteroids, k) < 0.8) hits++;
+        for (int k = 0; k < q->nebula_count; k++) if (FORMER_DIST(nebulas, q, nebulas, k) < 2.0) { hits++; break; }
+        for (int k = 0; k < q->pulsar_count; k++) if (FORMER_DIST(pulsars, q, pulsars, k) < 2.0) hits++;
+        for (int k = 0; k < q->bh_count; k++) {
+            double dx = black_holes[q->black_holes[k]].x - s->s1, dy = black_holes[q->black_holes[k]].y - s->s2;
+            double dz = black_holes[q->black_holes[k]].z - s->s3, d = sqrt(dx * dx + dy * dy + dz * dz);
+            if (d < 3.0 && d > 0.1) hits++;
+        }
+        double gx, gy, gz;
+        const SpatialHit *mine_hits;
+        if (spatial_position(SI_PLAYER, i, &gx, &gy, &gz)) hits += spatial_query_all(gx, gy, gz, 0.4, SI_MASK(SI_MINE), &mine_hits);
+        for (int k = 0; k < q->rift_count; k++) if (FORMER_DIST(rifts, q, rifts, k) < 0.5) hits++;
+
+        nudge(s, moving, 0.001f);
+        QuadrantIndex cv = spatial_quadrant(s->q1, s->q2, s->q3), *c = &cv;
+        for (int k = 0; k < c->bh_count; k++) {
+            double dx = black_holes[c->black_holes[k]].x - s->s1, dy = black_holes[c->black_holes[k]].y - s->s2;
+            double dz = black_holes[c->black_holes[k]].z - s->s3;
+            if (sqrt(dx * dx + dy * dy + dz * dz) < DIST_GRAVITY_WELL) hits++;
+        }
+        for (int k = 0; k < c->star_count; k++) if (FORMER_DIST(stars_data, c, stars, k) < 0.8) hits++;
+        for (int k = 0; k < c->planet_count; k++) if (FORMER_DIST(planets, c, planets, k) < 0.8) hits++;
+        nudge(s, moving, -0.001f);
+    }
+    found = hits;
+    sink = hits;
+}
+
+static void sense_pairs(bool moving) {
+    long hits = 0;
+    contacts_build();
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (!players[i].active) continue;
+        StarTrekGame *s = &players[i].state;
+        ContactList h = contacts_of(i);
+        for (int k = 0; k < h.count; k++) if (h.pairs[k].kind == SI_NEBULA && h.pairs[k].d2 < 2.0 * 2.0) hits++;
+        for (int k = 0; k < h.count; k++) if (h.pairs[k].kind == SI_PULSAR && h.pairs[k].d2 < 2.5 * 2.5) hits++;
+        for (int k = 0; k < h.count; k++) if (h.pairs[k].kind == SI_COMET && h.pairs[k].d2 < 0.6 * 0.6) hits++;
+        for (int k = 0; k < h.count; k++) if (h.pairs[k].kind == SI_ASTEROID && h.pairs[k].d2 < 0.8 * 0.8) hits++;
+        for (int k = 0; k < h.count; k++) if (h.pairs[k].kind == SI_NEBULA && h.pairs[k].d2 < 2.0 * 2.0) { hits++; break; }
+        for (int k = 0; k < h.count; k++) if (h.pairs[k].kind == SI_PULSAR && h.pairs[k].d2 < 2.0 * 2.0) hits++;
+        for (int k = 0; k < h.count; k++) {
+            if (h.pairs[k].kind != SI_BH) continue;
+            double d = sqrt(h.pairs[k].d2);
+            if (d < 3.0 && d > 0.1) hits++;
+        }
+        for (int k = 0; k < h.count; k++) if (h.pairs[k].kind == SI_MINE) hits++;
+        for (int k = 0; k < h.count; k++) if (h.pairs[k].kind == SI_RIFT && h.pairs[k].d2 < 0.5 * 0.5) hits++;
+
+        nudge(s, moving, 0.001f);
+        ContactList c = contacts_moved(i);
+        for (int k = 0; k < c.count; k++) if (c.pairs[k].kind == SI_BH && sqrt(c.pairs[k].d2) < DIST_GRAVITY_WELL) hits++;
+        for (int k = 0; k < c.count; k++) if (c.pairs[k].kind == SI_STAR && c.pairs[k].d2 < 0.8 * 0.8) hits++;
+        for (int k = 0; k < c.count; k++) if (c.pairs[k].kind == SI_PLANET && c.pairs[k].d2 < 0.8 * 0.8) hits++;
+        nudge(s, moving, -0.001f);
+    }
+    found = hits;
+    sink = hits;
+}
+
+typedef struct { void (*sense)(bool); bool moving; } SenseCase;
+
+static void run_sense(void *arg) {
+    const SenseCase *c = arg;
+    c->sense(c->moving);
+}
+
+/* Microseconds per call of one sensing side */
+static double per_call_us(double budget, void (*sense)(bool), bool moving) {
+    SenseCase c = {sense, moving};
+    return 1e6 / rate(budget, run_sense, &c);
+}
+
+int main(int argc, char **argv) {
+    double budget = (argc > 1) ? atof(argv[1]) : 0.25;
+    if (budget <= 0) budget = 0.25;
+
+    entity_init();
+    /* populate() fills every slot up to the default limits */
+    for (int kind = 0; kind < SI_PLAYER; kind++) entity_reserve(kind, entity_limit(kind));
+    galaxy_map = calloc(GALAXY_CELLS, sizeof(int64_t));
+    galaxy_cell_frame = calloc(GALAXY_CELLS, sizeof(int64_t));
+    if (!galaxy_map || !galaxy_cell_frame) { perror("calloc"); return 1; }
+
+    printf("%-9s %-7s %8s %9s %9s %9s %9s %9s\n", "GALAXY", "SHIPS", "CONTACTS", "PAIRS",
+           "FORMER", "PER SHIP", "CONTACT", "PER SHIP");
+    for (int crowd = 0; crowd <= 1; crowd++) {
+        populate(crowd);
+        entity_rebuild_pools();
+        rebuild_spatial_index();
+        for (int moving = 0; moving <= 1; moving++) {
+            sense_former(moving);
+            long former_found = found;
+            sense_pairs(moving);
+            if (found != former_found) { printf("contact mismatch: %ld vs %ld\n", former_found, found); return 1; }
+            int pairs = 0, ships = 0;
+            for (int i = 0; i < MAX_CLIENTS; i++) if (players[i].active) { ships++; pairs += contacts_of(i).count; }
+            double former = per_call_us(budget, sense_former, moving), contact = per_call_us(budget, sense_pairs, moving);
+            printf("%-9s %-7s %8ld %9d %9.2f %9.3f %9.2f %9.3f\n", crowd ? "Crowded" : "Spread", moving ? "moving" : "still",
+                   found, pairs, former, former / ships, contact, contact / ships);
+        }
+    }
+    printf("FORMER and CONTACT in microseconds per tick for all ships, PER SHIP divided by the ships in play.\n");
+    printf("CONTACTS: hazard and collision tests that hit. PAIRS: what the broadphase kept for the handlers.\n");
+    return 0;
+}
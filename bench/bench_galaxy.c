@@ -0,0 +1,129 @@
+/*
+ * STARTREK ULTRA - 3D LOGIC ENGINE
+ * Authors: Nicola Taibi, Supported by Google Gemini
+ * Copyright (C) 2026 Nicola Taibi
+ * License: GNU General Public License v3.0
+ */
+
+/* Galaxy size scaling: generates galaxies of 10x10x10, 20x20x20 and 40x40x40 quadrants
+   with the server's own code and runs its tick on them, no captains connected. The last
+   case raises the NPC and mine pool limits as an event server would (-l npc=30000
+   -l mine=30000). Each case runs in a child process, since quadrant-keyed storage and pool
+   limits are set once per server. After timing, every case checks that each slot up to
+   every kind's limit has an id that decodes back to it, and exits nonzero if one does not.
+   Usage: bench_galaxy [seconds_per_case] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "server_internal.h"
+#include "bench_util.h"
+
+/* What trek_server.c provides to the modules */
+pthread_mutex_t game_mutex = PTHREAD_MUTEX_INITIALIZER;
+int g_debug = 0;
+int global_tick = 0;
+void sign_galaxy_data() {}
+
+/* generate_galaxy() prints its astrometrics report: keep it out of the table */
+static void quiet_generate(void) {
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO), null = open("/dev/null", O_WRONLY);
+    if (saved < 0 || null < 0) { perror("dup"); exit(1); }
+    dup2(null, STDOUT_FILENO);
+    generate_galaxy();
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(null); close(saved);
+}
+
+typedef struct { int q; int event_limit; } GalaxyCase;
+
+/* Raised limits push kinds into the overflow id blocks: no two slots may share an id */
+static bool ids_round_trip(void) {
+    for (int kind = 0; kind < ENT_KINDS; kind++) {
+        int limit = entity_limit(kind);
+        entity_reserve(kind, limit);
+        for (int slot = 0; slot < limit; slot++) {
+            int id = entity_id(kind, slot), k, s;
+            if (!entity_decode(id, &k, &s) || k != kind || s != slot) {
+                printf("id %d of kind %d slot %d decodes wrong\n", id, kind, slot);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool run_case(const GalaxyCase *c, double budget) {
+    galaxy_q = c->q;
+    if (c->event_limit) { entity_set_limit("npc", c->event_limit); entity_set_limit("mine", c->event_limit); }
+    entity_init();
+    srand(1701);
+    double t0 = now_sec();
+    quiet_generate();
+    double gen = now_sec() - t0;
+
+    t0 = now_sec();
+    init_static_spatial_index();
+    double index = now_sec() - t0;
+    mempool_init();
+    snapshot_publish();
+
+    int bodies = 0;
+    size_t pool_bytes = 0;
+    for (int kind = 0; kind < SI_PLAYER; kind++) {
+        const uint16_t *live;
+        bodies += entity_live(kind, &live);
+        pool_bytes += entity_pool_bytes(kind);
+    }
+
+    /* The tick saves the galaxy every 1800 ticks; stay well short of that */
+    int ticks = 0;
+    t0 = now_sec();
+    double t1;
+    do {
+        update_game_logic();
+        ticks++;
+        t1 = now_sec();
+    } while (t1 - t0 < budget && ticks < 1700);
+
+    char name[24];
+    snprintf(name, sizeof(name), "%dx%dx%d%s", c->q, c->q, c->q, c->event_limit ? " event" : "");
+    printf("%-15s %9d %10zu %10zu %10zu %7d %9.2f %9.2f %9.1f\n", name, GALAXY_CELLS, GALAXY_CELLS * sizeof(int64_t),
+           spatial_index_bytes(), pool_bytes, bodies, gen * 1e3, index * 1e3, (t1 - t0) / ticks * 1e6);
+    return ids_round_trip();
+}
+
+int main(int argc, char **argv) {
+    double budget = (argc > 1) ? atof(argv[1]) : 1.0;
+    if (budget <= 0) budget = 1.0;
+
+    static const GalaxyCase cases[] = {{10, 0}, {20, 0}, {40, 0}, {40, 30000}};
+    printf("%-15s %9s %10s %10s %10s %7s %9s %9s %9s\n", "GALAXY", "CELLS", "MAP BYTES", "IDX BYTES", "POOL BYTES",
+           "BODIES", "GENERATE", "INDEX", "TICK");
+    int failed = 0;
+    for (size_t s = 0; s < sizeof(cases) / sizeof(cases[0]); s++) {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid < 0) { perror("fork"); return 1; }
+        if (pid == 0) {
+            bool ok = run_case(&cases[s], budget);
+            fflush(stdout);
+            _exit(ok ? 0 : 1);
+        }
+        int status;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            printf("%dx%dx%d failed\n", cases[s].q, cases[s].q, cases[s].q);
+            failed++;
+        }
+    }
+    printf("GENERATE and INDEX in milliseconds, TICK in microseconds per tick (30 Hz budget: 33333).\n");
+    printf("BODIES: live bodies after generation, capped by each pool's soft limit. POOL BYTES: entity storage committed.\n");
+    return failed ? 1 : 0;
+}
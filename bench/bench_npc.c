@@ -0,0 +1,151 @@
+/*
+ * STARTREK ULTRA - 3D LOGIC ENGINE
+ * Authors: Nicola Taibi, Supported by Google Gemini
+ * Copyright (C) 2026 Nicola Taibi
+ * License: GNU General Public License v3.0
+ */
+
+/* NPC movement: the former NPCShip records, which carried position, energy, liveness and AI
+   state inline, against the npc_hot arrays the server now moves with npc_integrate. Both
+   sides run the same tick: patrol displacement for every live ship, the move, the clamp to
+   the galaxy and the quadrant/sector split. A fifth of the ships are wrecks.
+   Usage: bench_npc [seconds_per_case] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "server_internal.h"
+#include "bench_util.h"
+
+int galaxy_q = GALAXY_Q_DEFAULT;  /* get_q_from_g clamps to it */
+
+/* --- Former Layout --- */
+
+typedef struct {
+    int id, faction, q1, q2, q3;
+    double x, y, z, h, m;
+    double gx, gy, gz;
+    int energy, active;
+    float engine_health;
+    int fire_cooldown;
+    AIState ai_state;
+    int target_player_idx;
+    int nav_timer;
+    double dx, dy, dz;
+    double tx, ty, tz;
+    uint8_t is_cloaked;
+} LegacyNPC;
+
+/* --- Populations --- */
+
+typedef struct {
+    int count;
+    LegacyNPC *legacy;
+    NPCShip *cold;
+    double *gx, *gy, *gz, *vx, *vy, *vz, *x, *y, *z;
+    int32_t *q1, *q2, *q3, *energy;
+    uint8_t *active, *ai_state;
+} Fleet;
+
+static void *alloc(size_t n, size_t size) {
+    void *p = calloc(n, size);
+    if (!p) { perror("calloc"); exit(1); }
+    return p;
+}
+
+static void fleet_init(Fleet *f, int count) {
+    f->count = count;
+    f->legacy = alloc(count, sizeof(LegacyNPC));
+    f->cold = alloc(count, sizeof(NPCShip));
+    f->gx = alloc(count, sizeof(double)); f->gy = alloc(count, sizeof(double)); f->gz = alloc(count, sizeof(double));
+    f->vx = alloc(count, sizeof(double)); f->vy = alloc(count, sizeof(double)); f->vz = alloc(count, sizeof(double));
+    f->x = alloc(count, sizeof(double)); f->y = alloc(count, sizeof(double)); f->z = alloc(count, sizeof(double));
+    f->q1 = alloc(count, sizeof(int32_t)); f->q2 = alloc(count, sizeof(int32_t)); f->q3 = alloc(count, sizeof(int32_t));
+    f->energy = alloc(count, sizeof(int32_t));
+    f->active = alloc(count, 1); f->ai_state = alloc(count, 1);
+
+    srand(1701);
+    for (int n = 0; n < count; n++) {
+        double gx = rand() % 10000 / 100.0, gy = rand() % 10000 / 100.0, gz = rand() % 10000 / 100.0;
+        double dx = (rand() % 100 - 50) / 50.0, dy = (rand() % 100 - 50) / 50.0, dz = (rand() % 100 - 50) / 50.0;
+        int active = rand() % 5 != 0;
+        f->legacy[n] = (LegacyNPC){.id = n, .faction = 10 + n % 5, .gx = gx, .gy = gy, .gz = gz, .energy = 10000,
+                                   .active = active, .engine_health = 100.0f, .dx = dx, .dy = dy, .dz = dz};
+        f->cold[n] = (NPCShip){.id = n, .faction = 10 + n % 5, .engine_health = 100.0f, .dx = dx, .dy = dy, .dz = dz};
+        f->gx[n] = gx; f->gy[n] = gy; f->gz[n] = gz;
+        f->energy[n] = 10000; f->active[n] = (uint8_t)active; f->ai_state[n] = AI_STATE_PATROL;
+    }
+}
+
+static void fleet_free(Fleet *f) {
+    free(f->legacy); free(f->cold);
+    free(f->gx); free(f->gy); free(f->gz); free(f->vx); free(f->vy); free(f->vz);
+    free(f->x); free(f->y); free(f->z); free(f->q1); free(f->q2); free(f->q3);
+    free(f->energy); free(f->active); free(f->ai_state);
+}
+
+/* --- Ticks --- */
+
+static double patrol_speed(float engine_health) {
+    return engine_health < 10.0f ? 0.0 : 0.03 * (engine_health / 100.0f);
+}
+
+/* The former Phase 1 movement, record by record */
+static void tick_legacy(void *arg) {
+    Fleet *f = arg;
+    for (int n = 0; n < f->count; n++) {
+        LegacyNPC *npc = &f->legacy[n];
+        if (!npc->active) continue;
+        double speed = patrol_speed(npc->engine_health);
+        npc->gx += npc->dx * speed; npc->gy += npc->dy * speed; npc->gz += npc->dz * speed;
+        if (npc->gx < 0.05) { npc->gx = 0.05; }
+        if (npc->gx > 99.95) { npc->gx = 99.95; }
+        if (npc->gy < 0.05) { npc->gy = 0.05; }
+        if (npc->gy > 99.95) { npc->gy = 99.95; }
+        if (npc->gz < 0.05) { npc->gz = 0.05; }
+        if (npc->gz > 99.95) { npc->gz = 99.95; }
+        npc->q1 = get_q_from_g(npc->gx); npc->q2 = get_q_from_g(npc->gy); npc->q3 = get_q_from_g(npc->gz);
+        npc->x = npc->gx - (npc->q1 - 1) * 10.0; npc->y = npc->gy - (npc->q2 - 1) * 10.0; npc->z = npc->gz - (npc->q3 - 1) * 10.0;
+    }
+}
+
+/* The move alone, as the server runs it after the AI */
+static void tick_integrate(void *arg) {
+    Fleet *f = arg;
+    npc_integrate(f->gx, f->vx, f->x, f->q1, f->count, 0.05, 99.95, 10);
+    npc_integrate(f->gy, f->vy, f->y, f->q2, f->count, 0.05, 99.95, 10);
+    npc_integrate(f->gz, f->vz, f->z, f->q3, f->count, 0.05, 99.95, 10);
+}
+
+/* Displacement for the live ships, as the AI leaves it, then the move */
+static void tick_soa(void *arg) {
+    Fleet *f = arg;
+    for (int n = 0; n < f->count; n++) {
+        if (!f->active[n]) continue;
+        double speed = patrol_speed(f->cold[n].engine_health);
+        f->vx[n] = f->cold[n].dx * speed; f->vy[n] = f->cold[n].dy * speed; f->vz[n] = f->cold[n].dz * speed;
+    }
+    tick_integrate(f);
+}
+
+int main(int argc, char **argv) {
+    double budget = (argc > 1) ? atof(argv[1]) : 0.25;
+    if (budget <= 0) budget = 0.25;
+
+    static const int sizes[] = {1000, 10000, 100000};
+    printf("%-7s %10s %10s %9s %9s %9s %8s\n", "NPCS", "AOS BYTES", "SOA BYTES", "AOS TICK", "SOA TICK", "INTEGRATE", "SPEEDUP");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        Fleet f;
+        fleet_init(&f, sizes[s]);
+        size_t hot = (size_t)f.count * (9 * sizeof(double) + 4 * sizeof(int32_t) + 2);
+        double aos = 1e9 / rate(budget, tick_legacy, &f) / f.count;
+        double soa = 1e9 / rate(budget, tick_soa, &f) / f.count;
+        double integ = 1e9 / rate(budget, tick_integrate, &f) / f.count;
+        printf("%-7d %10zu %10zu %9.2f %9.2f %9.2f %7.2fx\n", f.count, f.count * sizeof(LegacyNPC), hot, aos, soa, integ, aos / soa);
+        fleet_free(&f);
+    }
+    printf("Times in nanoseconds per NPC per tick. SOA BYTES: the hot arrays only.\n");
+    printf("INTEGRATE: the three npc_integrate passes alone; build with OPT_CFLAGS=\"-O2 -march=native\" for AVX lanes.\n");
+    return 0;
+}
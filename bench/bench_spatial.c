@@ -0,0 +1,348 @@
+/*
+ * STARTREK ULTRA - 3D LOGIC ENGINE
+ * Authors: Nicola Taibi, Supported by Google Gemini
+ * Copyright (C) 2026 Nicola Taibi
+ * License: GNU General Public License v3.0
+ */
+
+/* Spatial index layout: the compressed per-quadrant runs of 16-bit slot indices against the
+   former fixed pointer arrays (MAX_Q_* caps), on memory, lost bodies and the quadrant walks
+   of Phase 1 (NPC AI) and Phase 3 (update frames). The grid row senses through radius queries
+   on the proximity grid instead, reaching across quadrant borders.
+   Usage: bench_spatial [seconds_per_case] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "server_internal.h"
+#include "bench_util.h"
+
+/* The server's entity arrays; entity.c reserves and pools them, spatial.c indexes them */
+NPCStar *stars_data;
+NPCBlackHole *black_holes;
+NPCNebula *nebulas;
+NPCPulsar *pulsars;
+NPCComet *comets;
+NPCAsteroid *asteroids;
+NPCDerelict *derelicts;
+NPCMine *mines;
+NPCBuoy *buoys;
+NPCPlatform *platforms;
+NPCRift *rifts;
+NPCMonster *monsters;
+NPCPlanet *planets;
+NPCBase *bases;
+NPCShip *npcs;
+NPCHotData npc_hot;
+ConnectedPlayer players[MAX_CLIENTS];
+StarTrekGame galaxy_master;
+int galaxy_q = GALAXY_Q_DEFAULT;
+int64_t *galaxy_map;
+int64_t *galaxy_cell_frame;
+int g_debug = 0;
+int global_tick = 0;
+
+/* --- Former Layout --- */
+
+typedef struct {
+    NPCShip *npcs[32];           int npc_count;
+    NPCPlanet *planets[32];      int planet_count;   int static_planet_count;
+    NPCBase *bases[16];          int base_count;     int static_base_count;
+    NPCStar *stars[64];          int star_count;     int static_star_count;
+    NPCBlackHole *black_holes[8]; int bh_count;      int static_bh_count;
+    NPCNebula *nebulas[16];      int nebula_count;   int static_nebula_count;
+    NPCPulsar *pulsars[8];       int pulsar_count;   int static_pulsar_count;
+    NPCComet *comets[8];         int comet_count;
+    NPCAsteroid *asteroids[40];  int asteroid_count;
+    NPCDerelict *derelicts[8];   int derelict_count;
+    NPCMine *mines[32];          int mine_count;
+    NPCBuoy *buoys[8];           int buoy_count;
+    NPCPlatform *platforms[16];  int platform_count;
+    NPCRift *rifts[4];           int rift_count;
+    NPCMonster *monsters[4];     int monster_count;
+    ConnectedPlayer *players[32]; int player_count;
+} LegacyQuadrant;
+
+static LegacyQuadrant (*legacy)[11][11];
+static long legacy_dropped;
+
+#define LEGACY_ADD(list, count, ent) do { \
+    if ((count) < (int)(sizeof(list) / sizeof(list[0]))) list[(count)++] = (ent); else legacy_dropped++; } while (0)
+#define LEGACY_KIND(arr, max, list, count) \
+    for (int i = 0; i < (max); i++) if ((arr)[i].active && IS_Q_VALID((arr)[i].q1, (arr)[i].q2, (arr)[i].q3)) { \
+        LegacyQuadrant *q = &legacy[(arr)[i].q1][(arr)[i].q2][(arr)[i].q3]; LEGACY_ADD(q->list, q->count, &(arr)[i]); }
+
+static void legacy_build(void) {
+    memset(legacy, 0, 11 * 11 * 11 * sizeof(LegacyQuadrant));
+    legacy_dropped = 0;
+    for (int i = 0; i < MAX_NPC; i++) if (npc_hot.active[i] && IS_Q_VALID(npc_hot.q1[i], npc_hot.q2[i], npc_hot.q3[i])) {
+        LegacyQuadrant *q = &legacy[npc_hot.q1[i]][npc_hot.q2[i]][npc_hot.q3[i]]; LEGACY_ADD(q->npcs, q->npc_count, &npcs[i]); }
+    LEGACY_KIND(planets, MAX_PLANETS, planets, planet_count);
+    LEGACY_KIND(bases, MAX_BASES, bases, base_count);
+    LEGACY_KIND(stars_data, MAX_STARS, stars, star_count);
+    LEGACY_KIND(black_holes, MAX_BH, black_holes, bh_count);
+    LEGACY_KIND(nebulas, MAX_NEBULAS, nebulas, nebula_count);
+    LEGACY_KIND(pulsars, MAX_PULSARS, pulsars, pulsar_count);
+    LEGACY_KIND(comets, MAX_COMETS, comets, comet_count);
+    LEGACY_KIND(asteroids, MAX_ASTEROIDS, asteroids, asteroid_count);
+    LEGACY_KIND(derelicts, MAX_DERELICTS, derelicts, derelict_count);
+    LEGACY_KIND(mines, MAX_MINES, mines, mine_count);
+    LEGACY_KIND(buoys, MAX_BUOYS, buoys, buoy_count);
+    LEGACY_KIND(platforms, MAX_PLATFORMS, platforms, platform_count);
+    LEGACY_KIND(rifts, MAX_RIFTS, rifts, rift_count);
+    LEGACY_KIND(monsters, MAX_MONSTERS, monsters, monster_count);
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        StarTrekGame *s = &players[i].state;
+        if (!players[i].active || !IS_Q_VALID(s->q1, s->q2, s->q3)) continue;
+        LegacyQuadrant *q = &legacy[s->q1][s->q2][s->q3];
+        LEGACY_ADD(q->players, q->player_count, &players[i]);
+    }
+}
+
+/* --- Galaxy Population --- */
+
+#define SCATTER(arr, max) for (int i = 0; i < (max); i++) place(&(arr)[i].active, &(arr)[i].q1, &(arr)[i].q2, &(arr)[i].q3, \
+                                                                &(arr)[i].x, &(arr)[i].y, &(arr)[i].z, crowd)
+
+/* Crowded: a quarter of every kind converges on one quadrant, as a fleet battle near a
+   starbase inside an asteroid field would */
+static void place(int *active, int *q1, int *q2, int *q3, double *x, double *y, double *z, bool crowd) {
+    *active = 1;
+    if (crowd && rand() % 4 == 0) { *q1 = 5; *q2 = 5; *q3 = 5; }
+    else { *q1 = rand() % 10 + 1; *q2 = rand() % 10 + 1; *q3 = rand() % 10 + 1; }
+    *x = rand() % 1000 / 100.0; *y = rand() % 1000 / 100.0; *z = rand() % 1000 / 100.0;
+}
+
+static void populate(bool crowd) {
+    srand(1701);
+    for (int i = 0; i < MAX_NPC; i++) {
+        int active;
+        place(&active, &npc_hot.q1[i], &npc_hot.q2[i], &npc_hot.q3[i], &npc_hot.x[i], &npc_hot.y[i], &npc_hot.z[i], crowd);
+        npc_hot.active[i] = (uint8_t)active;
+        npc_hot.gx[i] = (npc_hot.q1[i] - 1) * 10.0 + npc_hot.x[i];
+        npc_hot.gy[i] = (npc_hot.q2[i] - 1) * 10.0 + npc_hot.y[i];
+        npc_hot.gz[i] = (npc_hot.q3[i] - 1) * 10.0 + npc_hot.z[i];
+    }
+    SCATTER(planets, MAX_PLANETS); SCATTER(bases, MAX_BASES);
+    SCATTER(stars_data, MAX_STARS); SCATTER(black_holes, MAX_BH); SCATTER(nebulas, MAX_NEBULAS);
+    SCATTER(pulsars, MAX_PULSARS); SCATTER(comets, MAX_COMETS); SCATTER(asteroids, MAX_ASTEROIDS);
+    SCATTER(derelicts, MAX_DERELICTS); SCATTER(mines, MAX_MINES); SCATTER(buoys, MAX_BUOYS);
+    SCATTER(platforms, MAX_PLATFORMS); SCATTER(rifts, MAX_RIFTS); SCATTER(monsters, MAX_MONSTERS);
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        int active;
+        double x, y, z;
+        StarTrekGame *s = &players[i].state;
+        place(&active, &s->q1, &s->q2, &s->q3, &x, &y, &z, crowd);
+        s->s1 = (float)x; s->s2 = (float)y; s->s3 = (float)z;
+        players[i].active = active;
+        snprintf(players[i].name, sizeof(players[i].name), "Captain %d", i);
+        players[i].faction = i % 3;
+    }
+    for (int i = 0; i < MAX_NPC; i++) { npcs[i].id = i; npcs[i].faction = 10 + i % 5; }
+}
+
+/* --- Quadrant Walks --- */
+
+static volatile double sink;
+static long walked;  /* Bodies visited, so a layout that loses bodies does not look faster */
+
+/* Phase 1: every NPC looks for hostile captains and black holes in its quadrant */
+static void phase1_legacy(void *arg) {
+    double acc = 0;
+    for (int n = 0; n < MAX_NPC; n++) {
+        NPCShip *npc = &npcs[n];
+        LegacyQuadrant *q = &legacy[npc_hot.q1[n]][npc_hot.q2[n]][npc_hot.q3[n]];
+        walked += q->player_count + q->bh_count;
+        for (int j = 0; j < q->player_count; j++) {
+            ConnectedPlayer *p = q->players[j];
+            if (p->faction != npc->faction) acc += p->state.s1 - npc_hot.x[n];
+        }
+        for (int h = 0; h < q->bh_count; h++) acc += q->black_holes[h]->x - npc_hot.x[n];
+    }
+    sink = acc;
+}
+
+static void phase1_csr(void *arg) {
+    double acc = 0;
+    for (int n = 0; n < MAX_NPC; n++) {
+        NPCShip *npc = &npcs[n];
+        QuadrantIndex qv = spatial_quadrant(npc_hot.q1[n], npc_hot.q2[n], npc_hot.q3[n]), *q = &qv;
+        walked += q->player_count + q->bh_count;
+        for (int j = 0; j < q->player_count; j++) {
+            ConnectedPlayer *p = &players[q->players[j]];
+            if (p->faction != npc->faction) acc += p->state.s1 - npc_hot.x[n];
+        }
+        for (int h = 0; h < q->bh_count; h++) acc += black_holes[q->black_holes[h]].x - npc_hot.x[n];
+    }
+    sink = acc;
+}
+
+/* Phase 1 as the server runs it: captains within sensor range and black holes within reach,
+   whichever quadrant they are in */
+static void phase1_grid(void *arg) {
+    double acc = 0;
+    const SpatialHit *near;
+    for (int n = 0; n < MAX_NPC; n++) {
+        NPCShip *npc = &npcs[n];
+        double gx = npc_hot.gx[n], gy = npc_hot.gy[n], gz = npc_hot.gz[n];
+        int count = spatial_query_all(gx, gy, gz, 10.0, SI_MASK(SI_PLAYER), &near);
+        walked += count;
+        for (int j = 0; j < count; j++) {
+            ConnectedPlayer *p = &players[near[j].idx];
+            if (p->faction != npc->faction) acc += near[j].d2;
+        }
+        count = spatial_query_all(gx, gy, gz, 1.0, SI_MASK(SI_BH), &near);
+        walked += count;
+        for (int h = 0; h < count; h++) acc += near[h].d2;
+    }
+    sink = acc;
+}
+
+/* Phase 3: every captain's frame lists all bodies in its quadrant, up to the wire limit */
+#define FRAME_ADD(ent) do { frame[o][0] = (float)(ent).x; frame[o][1] = (float)(ent).y; frame[o][2] = (float)(ent).z; o++; } while (0)
+#define FRAME_NPC(n) do { frame[o][0] = (float)npc_hot.x[n]; frame[o][1] = (float)npc_hot.y[n]; frame[o][2] = (float)npc_hot.z[n]; o++; } while (0)
+
+static float frame[MAX_NET_OBJECTS][3];
+
+static void phase3_legacy(void *arg) {
+    int total = 0;
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        StarTrekGame *s = &players[i].state;
+        LegacyQuadrant *q = &legacy[s->q1][s->q2][s->q3];
+        int o = 0;
+        for (int k = 0; k < q->npc_count && o < MAX_NET_OBJECTS; k++) FRAME_NPC(q->npcs[k]->id);
+        for (int k = 0; k < q->planet_count && o < MAX_NET_OBJECTS; k++) FRAME_ADD(*q->planets[k]);
+        for (int k = 0; k < q->star_count && o < MAX_NET_OBJECTS; k++) FRAME_ADD(*q->stars[k]);
+        for (int k = 0; k < q->bh_count && o < MAX_NET_OBJECTS; k++) FRAME_ADD(*q->black_holes[k]);
+        for (int k = 0; k < q->base_count && o < MAX_NET_OBJECTS; k++) FRAME_ADD(*q->bases[k]);
+        for (int k = 0; k < q->nebula_count && o < MAX_NET_OBJECTS; k++) FRAME_ADD(*q->nebulas[k]);
+        for (int k = 0; k < q->pulsar_count && o < MAX_NET_OBJECTS; k++) FRAME_ADD(*q->pulsars[k]);
+        for (int k = 0; k < q->comet_count && o < MAX_NET_OBJECTS; k++) FRAME_ADD(*q->comets[k]);
+        for (int k = 0; k < q->asteroid_count && o < MAX_NET_OBJECTS; k++) FRAME_ADD(*q->asteroids[k]);
+        for (int k = 0; k < q->derelict_count && o < MAX_NET_OBJECTS; k++) FRAME_ADD(*q->derelicts[k]);
+        for (int k = 0; k < q->platform_count && o < MAX_NET_OBJECTS; k++) FRAME_ADD(*q->platforms[k]);
+        for (int k = 0; k < q->monster_count && o < MAX_NET_OBJECTS; k++) FRAME_ADD(*q->monsters[k]);
+        total += o;
+    }
+    walked += total;
+    sink = total + frame[0][0];
+}
+
+static void phase3_csr(void *arg) {
+    int total = 0;
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        StarTrekGame *s = &players[i].state;
+        QuadrantIndex qv = spatial_quadrant(s->q1, s->q2, s->q3), *q = &qv;
+        int o = 0;
+        for (int k = 0; k < q->npc_count && o < MAX_NET_OBJECTS; k++) FRAME_NPC(q->npcs[k]);
+        for (int k = 0; k < q->planet_count && o < MAX_NET_OBJECTS; k++) FRAME_ADD(planets[q->planets[k]]);
+        for (int k = 0; k < q->star_count && o < MAX_NET_OBJECTS; k++) FRAME_ADD(stars_data[q->stars[k]]);
+        for (int k = 0; k < q->bh_count && o < MAX_NET_OBJECTS; k++) FRAME_ADD(black_holes[q->black_holes[k]]);
+        for (int k = 0; k < q->base_count && o < MAX_NET_OBJECTS; k++) FRAME_ADD(bases[q->bases[k]]);
+        for (int k = 0; k < q->nebula_count && o < MAX_NET_OBJECTS; k++) FRAME_ADD(nebulas[q->nebulas[k]]);
+        for (int k = 0; k < q->pulsar_count && o < MAX_NET_OBJECTS; k++) FRAME_ADD(pulsars[q->pulsars[k]]);
+        for (int k = 0; k < q->comet_count && o < MAX_NET_OBJECTS; k++) FRAME_ADD(comets[q->comets[k]]);
+        for (int k = 0; k < q->asteroid_count && o < MAX_NET_OBJECTS; k++) FRAME_ADD(asteroids[q->asteroids[k]]);
+        for (int k = 0; k < q->derelict_count && o < MAX_NET_OBJECTS; k++) FRAME_ADD(derelicts[q->derelicts[k]]);
+        for (int k = 0; k < q->platform_count && o < MAX_NET_OBJECTS; k++) FRAME_ADD(platforms[q->platforms[k]]);
+        for (int k = 0; k < q->monster_count && o < MAX_NET_OBJECTS; k++) FRAME_ADD(monsters[q->monsters[k]]);
+        total += o;
+    }
+    walked += total;
+    sink = total + frame[0][0];
+}
+
+/* A tick's index maintenance with a few ships crossing a quadrant border */
+static void tick_update(void *arg) {
+    int *next = arg;
+    for (int k = 0; k < 8; k++) {
+        npc_hot.q1[*next] = npc_hot.q1[*next] % 10 + 1;
+        npc_hot.gx[*next] = (npc_hot.q1[*next] - 1) * 10.0 + npc_hot.x[*next];
+        *next = (*next + 37) % MAX_NPC;
+    }
+    global_tick++;
+    update_spatial_index();
+}
+
+/* Cold variants: the rest of a tick (every NPC, the network, crypto) has pushed the index out
+   of cache before the walk runs, as it does in the server */
+#define EVICT_BYTES (16 << 20)
+static uint8_t *evict_buf;
+
+static void evict(void) {
+    for (size_t b = 0; b < EVICT_BYTES; b += 64) evict_buf[b]++;
+}
+
+/* Microseconds one walk takes from a cold cache; only the walk is timed */
+static double cold_us(double budget, void (*fn)(void *)) {
+    double spent = 0, end = now_sec() + budget;
+    long n = 0;
+    do {
+        evict();
+        double t0 = now_sec();
+        fn(NULL);
+        spent += now_sec() - t0;
+        n++;
+    } while (now_sec() < end);
+    return spent / n * 1e6;
+}
+
+typedef struct {
+    const char *name;
+    void (*phase1)(void *), (*phase3)(void *);
+} Layout;
+
+static void run_layout(double budget, const char *galaxy, const Layout *l, size_t bytes, long lost, bool update) {
+    long w1, w3;
+    walked = 0; l->phase1(NULL); w1 = walked;
+    walked = 0; l->phase3(NULL); w3 = walked;
+    double p1 = 1e6 / rate(budget, l->phase1, NULL), p3 = 1e6 / rate(budget, l->phase3, NULL);
+    double c1 = cold_us(budget, l->phase1), c3 = cold_us(budget, l->phase3);
+    printf("%-9s %-8s %9zu %6ld %9ld %8.2f %8.2f %9ld %8.2f %8.2f", galaxy, l->name, bytes, lost, w1, p1, c1, w3, p3, c3);
+    if (update) {
+        int next = 0;
+        printf(" %8.2f\n", 1e6 / rate(budget, tick_update, &next));
+    } else {
+        printf(" %8s\n", "-");
+    }
+}
+
+int main(int argc, char **argv) {
+    double budget = (argc > 1) ? atof(argv[1]) : 0.25;
+    if (budget <= 0) budget = 0.25;
+
+    entity_init();
+    /* populate() fills every slot up to the default limits */
+    for (int kind = 0; kind < SI_PLAYER; kind++) entity_reserve(kind, entity_limit(kind));
+    galaxy_map = calloc(GALAXY_CELLS, sizeof(int64_t));
+    galaxy_cell_frame = calloc(GALAXY_CELLS, sizeof(int64_t));
+    legacy = calloc(11 * 11 * 11, sizeof(LegacyQuadrant));
+    if (!galaxy_map || !galaxy_cell_frame) { perror("calloc"); return 1; }
+    if (!legacy) { perror("calloc"); return 1; }
+
+    evict_buf = calloc(EVICT_BYTES, 1);
+    if (!evict_buf) { perror("calloc"); return 1; }
+
+    static const Layout pointer = {"pointer", phase1_legacy, phase3_legacy}, csr = {"csr", phase1_csr, phase3_csr},
+                        grid = {"grid", phase1_grid, phase3_csr};
+    printf("%-9s %-8s %9s %6s %9s %8s %8s %9s %8s %8s %8s\n", "GALAXY", "LAYOUT", "BYTES", "LOST",
+           "P1 BODIES", "P1 WARM", "P1 COLD", "P3 BODIES", "P3 WARM", "P3 COLD", "UPDATE");
+    for (int crowd = 0; crowd <= 1; crowd++) {
+        const char *name = crowd ? "Crowded" : "Spread";
+        populate(crowd);
+        entity_rebuild_pools();
+        legacy_build();
+        rebuild_spatial_index();
+        run_layout(budget, name, &pointer, 11 * 11 * 11 * sizeof(LegacyQuadrant), legacy_dropped, false);
+        run_layout(budget, name, &csr, spatial_index_bytes(), 0, true);
+        run_layout(budget, name, &grid, spatial_index_bytes(), 0, false);
+    }
+    printf("Times in microseconds per pass. COLD: the walk right after 16 MB of other work.\n");
+    printf("LOST: bodies the fixed arrays could not hold; they were invisible to AI, sensors and frames.\n");
+    printf("P1 BODIES (grid): captains within 10 units and black holes within 1, borders included.\n");
+    printf("UPDATE: per-tick index maintenance with 8 ships changing quadrant.\n");
+    free(legacy);
+    free(evict_buf);
+    return 0;
+}
@@ -0,0 +1,37 @@
+/*
+ * STARTREK ULTRA - 3D LOGIC ENGINE
+ * Authors: Nicola Taibi, Supported by Google Gemini
+ * Copyright (C) 2026 Nicola Taibi
+ * License: GNU General Public License v3.0
+ */
+
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include <time.h>
+
+/* Calls between two clock reads in rate(); a bench of sub-microsecond cases raises it
+   before including this header */
+#ifndef BENCH_BATCH
+#define BENCH_BATCH 4
+#endif
+
+static inline double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Runs fn until the budget is spent and returns calls per second */
+static inline double rate(double budget, void (*fn)(void *), void *arg) {
+    long n = 0;
+    double t0 = now_sec(), t1;
+    do {
+        for (int k = 0; k < BENCH_BATCH; k++) fn(arg);
+        n += BENCH_BATCH;
+        t1 = now_sec();
+    } while (t1 - t0 < budget);
+    return n / (t1 - t0);
+}
+
+#endif
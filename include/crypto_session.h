@@ -0,0 +1,51 @@
+/*
+ * STARTREK ULTRA - 3D LOGIC ENGINE
+ * Authors: Nicola Taibi, Supported by Google Gemini
+ * Copyright (C) 2026 Nicola Taibi
+ * License: GNU General Public License v3.0
+ */
+
+#ifndef CRYPTO_SESSION_H
+#define CRYPTO_SESSION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <openssl/evp.h>
+#include "network.h"
+
+#define CRYPTO_ALGO_SLOTS (CRYPTO_PQC + 1)
+
+/* Nonce domains. Chat and sealed updates are encrypted under the same session key by
+   separate sessions, each with its own counter: the channel keeps their nonces apart. */
+#define CRYPTO_CHANNEL_MESSAGES 0
+#define CRYPTO_CHANNEL_UPDATES  1
+
+/* Per-connection cipher state: one keyed context per algorithm and direction, created on
+   first use and reused for every later frame. Only the IV is reset per message. */
+typedef struct {
+    uint8_t key[32];
+    bool keyed;
+    uint32_t nonce_seq;  /* Per-message counter, random start on every rekey */
+    EVP_CIPHER_CTX *enc[CRYPTO_ALGO_SLOTS];
+    EVP_CIPHER_CTX *dec[CRYPTO_ALGO_SLOTS];
+    EVP_CIPHER_CTX *ivgen[CRYPTO_ALGO_SLOTS];  /* CBC modes: enciphers the nonce into the IV */
+} CryptoSession;
+
+const EVP_CIPHER *crypto_cipher(int algo, bool *is_aead);
+
+/* Binds the session to key; a no-op when the key is unchanged */
+void crypto_session_bind(CryptoSession *cs, const uint8_t *key);
+/* Runs the key schedule for algo ahead of the first frame */
+void crypto_session_prepare(CryptoSession *cs, int algo);
+void crypto_session_free(CryptoSession *cs);
+
+/* Nonce is frame_id (low 7 bytes LE), the channel (1 byte) and the session counter (4 bytes).
+   CBC modes do not use it as the IV directly but its encryption under the session key.
+   Returns the ciphertext length, -1 on failure. */
+int crypto_session_encrypt(CryptoSession *cs, int algo, int channel, int64_t frame_id, const uint8_t *in, int len,
+                           uint8_t *out, uint8_t iv[12], uint8_t tag[16]);
+/* Returns the plaintext length, -1 on failure or authentication mismatch */
+int crypto_session_decrypt(CryptoSession *cs, int algo, const uint8_t iv[12], const uint8_t tag[16],
+                           const uint8_t *in, int len, uint8_t *out);
+
+#endif
@@ -39,6 +39,66 @@
 #define TIMER_SUPERNOVA         1800    /* 60 Seconds */
 #define TIMER_WORMHOLE_SEQ      450     /* 15 Seconds */
 
+/* --- Alerts --- */
+#define ALERT_COALESCE_TICKS    300     /* 10 Seconds: repeated hazard alerts are folded */
+
+/* --- Session Resume --- */
+#define RESUME_MAX_FRAME_GAP    900     /* 30 Seconds: older sessions get a full resync */
+
+/* --- Command Batches --- */
+#define MAX_BATCH_TICK_DELAY    300     /* 10 Seconds between batch steps at most */
+
+/* --- Command Ingestion --- */
+#define CMD_QUEUE_MAX_RECORDS   4096    /* Parsed commands awaiting the next tick, all captains */
+#define CMD_RATE_PER_SEC        20      /* Sustained commands per captain */
+#define CMD_RATE_BURST          40      /* Bucket size: short bursts above the rate */
+
+/* --- Lag Compensation --- */
+#define LAG_HISTORY_TICKS       32      /* ~1 Second of positions per player and NPC */
+#define LAG_REWIND_MAX_MS       250     /* Shots are never judged further back than this */
+#define LAG_VIEW_DELAY_MS       33      /* Client interpolation: one update behind the server */
+#define LAG_RTT_SAMPLE_TICKS    30      /* 1 Second between RTT readings */
+
+/* --- Crypto Offload --- */
+#define CRYPTO_WORKERS          4       /* Threads encrypting and writing every frame to captains */
+#define CRYPTO_QUEUE_MAX_JOBS   4096    /* Per worker; frames beyond this are dropped */
+#define CRYPTO_FLUSH_MS         20      /* Retry of a link's unsent bytes when no frame follows */
+#define OUTBOX_MAX_BYTES        (1024 * 1024) /* Unsent bytes a link may owe before it is closed */
+
+/* --- Combat FX --- */
+#define FX_BYTE_BUDGET          2048    /* Per quadrant and tick; later events are dropped */
+#define FX_TICK_EVENTS          4096    /* All quadrants, one tick */
+
+/* --- Spatial Index --- */
+#define SPATIAL_TOUCH_MAX       1024    /* Spawns and deaths per tick before a full rebuild */
+#define SPATIAL_CHECK_TICKS     300     /* Debug (-d): compare with a full rebuild every 10 seconds */
+#define SPATIAL_GRID_CELL       2.0     /* Proximity grid cell edge, in galactic units */
+#define SPATIAL_GRID_BUCKETS    4096    /* Hash buckets per kind (power of two) */
+#define SPATIAL_GRID_SLACK      0.5     /* Extra reach covering movement since the grid was built */
+#define SPATIAL_QUERY_MAX       128     /* Initial room of the shared query buffer, grown on demand */
+#define SPATIAL_REWIND_REACH    2.0     /* Torpedoes: how far a rewound ship may be from where it is now */
+#define SPATIAL_BORDER_VIEW     3.0     /* Captains see ships across a quadrant border up to this far */
+#define CONTACT_SLACK           0.5     /* Phase 2: extra reach on solid bodies covering a ship's move in the tick */
+#define HAZARD_FIELD_RES        10      /* Hazard field cells per quadrant edge */
+#define HAZARD_FIELD_CACHE      128     /* Quadrant fields kept at once (power of two) */
+
+/* --- World Snapshot --- */
+#define SNAPSHOT_BUFFERS        3       /* Published, being read, being built */
+#define SNAPSHOT_MAX_QUADS      1024    /* Captain quadrants plus border neighbours */
+#define SNAPSHOT_MAX_ENTRIES    8192    /* Sensor contacts across all of them */
+
+/* --- Memory Pools --- */
+#define ARENA_BYTES             (256 * 1024) /* Per-thread scratch, reset every tick and command */
+#define MAX_ARENAS              16      /* Threads that may own an arena */
+#define SLAB_SMALL_SIZE         512     /* Short replies and alerts */
+#define SLAB_SMALL_COUNT        4096
+#define SLAB_MEDIUM_SIZE        4096    /* Status reports */
+#define SLAB_MEDIUM_COUNT       1024
+#define SLAB_FRAME_SIZE         (16 * 1024 + 512) /* A full PacketUpdate queued for its link */
+#define SLAB_FRAME_COUNT        256
+#define SLAB_LARGE_SIZE         (65536 + 512) /* Largest PacketMessage text plus header */
+#define SLAB_LARGE_COUNT        32
+
 /* --- Buffer Sizes --- */
 #define LARGE_DATA_BUFFER       65536   /* For SRS/LRS scans */
 
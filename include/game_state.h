@@ -14,13 +14,14 @@
 #pragma pack(push, 1)
 
 #define MAX_NET_OBJECTS 128
-#define MAX_NET_BEAMS 8
 
-typedef struct {
-    float net_sx, net_sy, net_sz; /* Source coordinates */
-    float net_tx, net_ty, net_tz; /* Target coordinates */
-    int32_t active;
-} NetBeam;
+/* Galaxy Chart. The galaxy is a cube of up to GALAXY_Q_MAX quadrants per axis; the Galaxy
+   Master charts its first CHART_Q (g/z below) and the PacketChart that follows it the rest. */
+#define GALAXY_Q_MAX 64      /* Quadrant coordinates travel as 8-bit values on the wire */
+#define CHART_Q 10
+#define CHART_SIDE_MAX (GALAXY_Q_MAX + 1)
+/* Index of quadrant q1-q3 in a 1-based chart of q quadrants per axis, zero pad included */
+#define CHART_CELL(q, q1, q2, q3) ((((q1) * ((q) + 1)) + (q2)) * ((q) + 1) + (q3))
 
 typedef struct {
     float net_x, net_y, net_z;
@@ -43,12 +44,6 @@ typedef struct {
     int32_t active;
 } NetPoint;
 
-typedef struct {
-    float net_x, net_y, net_z;
-    int32_t species;
-    int32_t active;
-} NetDismantle;
-
 typedef struct {
     int32_t active;
     int32_t q1, q2, q3;
@@ -119,13 +114,8 @@ typedef struct {
     /* Multi-user sync (Objects in current sector) */
     int32_t object_count;
     NetObject objects[MAX_NET_OBJECTS];
-    int32_t beam_count;
-    NetBeam beams[MAX_NET_BEAMS];
-    NetPoint torp;
-    NetPoint boom;
     NetPoint wormhole;
     NetPoint jump_arrival;
-    NetDismantle dismantle;
     NetPoint recovery_fx;
     NetProbe probes[3];
 } StarTrekGame;
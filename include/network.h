@@ -20,6 +20,13 @@
 #define PKT_MESSAGE 4
 #define PKT_QUERY 5
 #define PKT_HANDSHAKE 6
+#define PKT_RESUME 7
+#define PKT_SPECTATE 8
+#define PKT_BATCH 9
+#define PKT_ALERT 10
+#define PKT_SENSOR 11
+#define PKT_UPDATE_SEALED 12
+#define PKT_CHART 13
 
 /* Magic Signature for Key Verification (32 bytes) */
 #define HANDSHAKE_MAGIC_STRING "TREK-ULTRA-KEY-VERIFICATION-SIG"
@@ -38,6 +45,56 @@
 #define CRYPTO_DES      11
 #define CRYPTO_PQC      12
 
+/* Session Resume Outcome (PacketResumeAck.status) */
+#define RESUME_REJECTED 0   /* Unknown token: client must perform a full login */
+#define RESUME_DELTA    1   /* cell_count NetGalaxyCell records follow */
+#define RESUME_FULL     2   /* A full StarTrekGame and its PacketChart follow (gap too large) */
+#define RESUME_MAX_DELTA_CELLS 256 /* Above this a full StarTrekGame is cheaper */
+
+#define MAX_BATCH_COMMANDS 8
+
+/* Spectator Subscription (PacketSpectate.mode) */
+#define SPECTATE_QUADRANT 1 /* Fixed camera on quadrant q1,q2,q3 */
+#define SPECTATE_CAPTAIN  2 /* Mirrors the view of captain target_id (1-based) */
+
+/* Sensor Reports (PacketSensor.report) */
+#define SENSOR_SRS  1   /* count NetSensorContact records */
+#define SENSOR_LRS  2   /* count NetLrsCell records (3x3x3 neighbourhood) */
+#define SENSOR_SCAN 3   /* one NetScanReport */
+#define MAX_SENSOR_CONTACTS 256
+#define LRS_CELLS 27
+
+/* NetSensorContact.kind */
+#define CONTACT_PLAYER    1
+#define CONTACT_NPC       2
+#define CONTACT_BASE      3
+#define CONTACT_PLANET    4
+#define CONTACT_STAR      5
+#define CONTACT_BLACKHOLE 6
+#define CONTACT_NEBULA    7
+#define CONTACT_PULSAR    8
+#define CONTACT_COMET     9
+#define CONTACT_ASTEROID  10
+#define CONTACT_MONSTER   11
+#define CONTACT_PROBE     12
+#define CONTACT_DERELICT  13
+#define CONTACT_PLATFORM  14
+#define CONTACT_RIFT      15
+#define CONTACT_BUOY      16
+#define CONTACT_MINE      17
+
+/* NetSensorContact.flags */
+#define CONTACT_F_LOCKED   0x01
+#define CONTACT_F_CHASE    0x02
+#define CONTACT_F_NEIGHBOR 0x04 /* Adjacent quadrant: q1,q2,q3 are meaningful, x,y,z are not */
+#define CONTACT_F_DERELICT 0x08 /* Probe has gone derelict */
+
+/* NetLrsCell.flags */
+#define LRS_F_VALID      0x01
+#define LRS_F_CURRENT    0x02
+#define LRS_F_NAV_LOST   0x04 /* Sensor damage: bearing unknown */
+#define LRS_F_ICONS_LOST 0x08 /* Sensor damage: object counts unknown */
+
 #define SCOPE_GLOBAL 0
 #define SCOPE_FACTION 1
 #define SCOPE_PRIVATE 2
@@ -74,6 +131,34 @@ typedef enum {
     SHIP_CLASS_GENERIC_ALIEN
 } ShipClass;
 
+/* Compact Alert Channel: rendered to text by the client */
+typedef enum {
+    ALERT_NONE = 0,
+    ALERT_GRAVITY_SHEAR,
+    ALERT_NEBULA_DRAIN,
+    ALERT_PULSAR_RADIATION,       /* p1: damage */
+    ALERT_SICKBAY_RADIATION,
+    ALERT_ASTEROID_COLLISION,
+    ALERT_COMET_GAS,
+    ALERT_AMOEBA_DRAIN,
+    ALERT_CRYSTALLINE_RESONANCE,
+    ALERT_LIFE_SUPPORT_CASUALTIES,
+    ALERT_HULL_SYSTEM_HIT,        /* p1: system index */
+    ALERT_PLATFORM_ATTACK,
+    ALERT_PLATFORM_SYSTEM_HIT,
+    ALERT_TORPEDO_HIT,
+    ALERT_TORPEDO_SYSTEM_HIT,     /* p1: system index */
+    ALERT_WARP_ENGAGED,           /* p1: warp factor x10, p2: ETA ticks */
+    ALERT_IMPULSE_ENGAGED,        /* p1: percent */
+    ALERT_SHIP_ALIGNED,
+    ALERT_WORMHOLE_EXOTIC_MATTER,
+    ALERT_WORMHOLE_BRIDGE,
+    ALERT_WORMHOLE_ENTRY,
+    ALERT_WORMHOLE_STABILIZED,
+    ALERT_WORMHOLE_ARRIVAL,
+    ALERT_COUNT
+} AlertCode;
+
 typedef struct {
     int32_t type;
     char name[64];
@@ -86,12 +171,73 @@ typedef struct {
     char cmd[256];
 } PacketCommand;
 
+/* Command Batch: variable length, only the first count entries of cmds are transmitted.
+   tick_delay 0 runs every command in one lock scope, otherwise one command every tick_delay ticks. */
+typedef struct {
+    int32_t type;
+    int32_t count;
+    int32_t tick_delay;
+    char cmds[MAX_BATCH_COMMANDS][256];
+} PacketBatch;
+
+/* Link capabilities requested in PacketHandshake.caps */
+#define LINK_CAP_COMPRESS 0x1  /* PacketMessage text may be deflated with the shared dictionary */
+#define LINK_CAP_SEALED_UPDATES 0x2 /* PacketUpdate arrives as PKT_UPDATE_SEALED */
+
 typedef struct {
     int32_t type;
     int32_t pubkey_len;
-    uint8_t pubkey[256]; /* Standard EC Public Key */
+    uint8_t pubkey[252]; /* Standard EC Public Key */
+    uint32_t caps;       /* LINK_CAP_*; zero from older clients, which get the bare int ACK */
 } PacketHandshake;
 
+/* Handshake ACK for a client that requested capabilities: caps holds the granted subset */
+typedef struct {
+    int32_t type;
+    uint32_t caps;
+} PacketHandshakeAck;
+
+/* Reconnect request: presents the token issued at login and the last seen frame */
+typedef struct {
+    int32_t type;
+    char name[64];
+    uint64_t token;
+    int64_t last_frame;
+} PacketResume;
+
+/* Sent after the Galaxy Master and its PacketChart at login (status RESUME_FULL, no payload)
+   and as reply to PacketResume */
+typedef struct {
+    int32_t type;
+    int32_t status;
+    uint64_t token;      /* Fresh token, rotated on every successful resume */
+    int64_t frame_id;    /* Server frame the client is synchronized to */
+    int32_t cell_count;
+} PacketResumeAck;
+
+typedef struct {
+    uint8_t q1, q2, q3;
+    int64_t val;
+} NetGalaxyCell;
+
+/* Follows every Galaxy Master: the size of the galaxy and its non-empty quadrants outside
+   the CHART_Q corner the Master charts. Quadrants it does not list are empty. */
+typedef struct {
+    int32_t type;
+    int32_t galaxy_q;
+    int32_t count;          /* At most galaxy_q^3 */
+    NetGalaxyCell cells[];
+} PacketChart;
+
+/* Read-only subscription: answered with the Galaxy Master, then a PKT_UPDATE stream.
+   Sending it again on a live spectator link switches the subscription. */
+typedef struct {
+    int32_t type;
+    int32_t mode;
+    int32_t q1, q2, q3;
+    int32_t target_id;
+} PacketSpectate;
+
 typedef struct {
     int32_t type;
     char from[64];
@@ -101,6 +247,7 @@ typedef struct {
     int32_t length;
     int64_t origin_frame; /* Server frame used for frequency scrambling */
     uint8_t is_encrypted;
+    uint8_t is_compressed; /* Text deflated with the shared dictionary, then encrypted */
     uint8_t crypto_algo; /* 1:AES... 11:DES, 12:PQC (ML-KEM/Kyber) */
     uint8_t iv[12];      /* GCM/Poly/CTR/CBC IV */
     uint8_t tag[16];     /* Auth Tag */
@@ -110,6 +257,98 @@ typedef struct {
     char text[65536];
 } PacketMessage;
 
+typedef struct {
+    uint16_t code;
+    uint16_t repeat;   /* Occurrences coalesced into this alert */
+    int32_t p1, p2;
+} NetAlert;
+
+/* Variable length: at most one entry per code per tick */
+typedef struct {
+    int32_t type;
+    int32_t count;
+    NetAlert alerts[ALERT_COUNT];
+} PacketAlert;
+
+/* --- Sensor Reports --- */
+
+/* Positions and bearings already carry the server-side sensor noise */
+typedef struct {
+    int32_t id;
+    uint8_t kind;
+    uint8_t flags;
+    uint8_t q1, q2, q3;
+    float x, y, z;
+    float dist, heading, mark;
+    int32_t energy;
+    int16_t faction;
+    int16_t detail;    /* NPC engine %, monster type */
+    int16_t owner;     /* Player slot for players and probes, -1 otherwise */
+} NetSensorContact;
+
+typedef struct {
+    int16_t slot;
+    char name[64];
+} NetSensorName;
+
+typedef struct {
+    uint8_t q1, q2, q3;
+    uint8_t flags;
+    float heading, mark, dist;
+    int64_t val;       /* Galaxy encoding, scrambled when sensors are damaged */
+} NetLrsCell;
+
+typedef struct {
+    int32_t target_id;
+    uint8_t kind;
+    int16_t faction;
+    int16_t detail;    /* NPC behaviour (0 patrol, 1 aggressive, 2 retreating), planet resource, monster type */
+    int32_t energy;
+    int32_t crew;
+    int32_t torpedoes;
+    int32_t amount;    /* Planet reserves, platform cooldown */
+    float engine;
+    float system_health[10];
+    char name[64];
+} NetScanReport;
+
+/* --- Combat FX --- */
+
+/* Visual events of one quadrant for one tick. Built once per quadrant and appended to the
+   PacketUpdate of everyone there, after objects[object_count]. */
+#define MAX_FX_EVENTS 64
+
+#define FX_BEAM      1  /* x,y,z origin, tx,ty,tz target */
+#define FX_BOOM      2
+#define FX_TORPEDO   3  /* Position this tick while in flight */
+#define FX_DISMANTLE 4  /* detail: species of the wreck */
+
+typedef struct {
+    uint8_t kind;
+    int32_t source;       /* Universal ID of the emitter, 0 if none */
+    float x, y, z;
+    float tx, ty, tz;
+    int32_t detail;
+} NetFxEvent;
+
+#define SENSOR_DATA_MAX (MAX_CLIENTS * sizeof(NetSensorName) + MAX_SENSOR_CONTACTS * sizeof(NetSensorContact))
+
+/* Variable length: name_count NetSensorName entries, then count records of the report type */
+typedef struct {
+    int32_t type;
+    int32_t report;
+    int32_t q1, q2, q3;
+    float s1, s2, s3;
+    float heading, mark;
+    int32_t energy;
+    int32_t torpedoes;
+    uint8_t cloaked;
+    int32_t name_count;
+    int32_t count;
+    int32_t omitted;      /* Contacts in range that did not fit the report */
+    uint8_t data[SENSOR_DATA_MAX];
+} PacketSensor;
+
 /* Update Packet: Optimized for variable length transmission */
 typedef struct {
     int32_t type;
@@ -136,23 +375,29 @@ typedef struct {
     float phaser_charge;
     uint8_t is_cloaked;
     uint8_t encryption_enabled;
-    NetPoint torp;
-    NetPoint boom;
     NetPoint wormhole;
     NetPoint jump_arrival;
-    NetDismantle dismantle;
     NetPoint recovery_fx;
     NetProbe probes[3];
     NetPoint supernova_pos; 
     int32_t supernova_q[3];
-    int32_t beam_count;
-    NetBeam beams[MAX_NET_BEAMS];
     int64_t map_update_val;
     int32_t map_update_q[3];
+    int32_t fx_count;     /* NetFxEvent records following the objects on the wire */
     int32_t object_count;
     NetObject objects[MAX_NET_OBJECTS];
 } PacketUpdate;
 
+/* A PacketUpdate frame (FX included) sealed with AES-256-GCM under the session key.
+   Nonce: frame_id (8 bytes LE) followed by a per-session counter (4 bytes). */
+typedef struct {
+    int32_t type;
+    int32_t length;      /* Ciphertext bytes following the header */
+    uint8_t iv[12];
+    uint8_t tag[16];
+    uint8_t data[];
+} PacketSealedUpdate;
+
 #pragma pack(pop)
 
 #endif
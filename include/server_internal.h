@@ -8,10 +8,13 @@
 #ifndef SERVER_INTERNAL_H
 #define SERVER_INTERNAL_H
 
+#include <stdio.h>
 #include <stdbool.h>
 #include <pthread.h>
 #include "network.h"
 #include "game_config.h"
+#include "crypto_session.h"
+#include "subspace_codec.h"
 
 typedef enum { 
     NAV_STATE_IDLE, 
@@ -33,6 +36,9 @@ typedef struct {
     int active;
     int crypto_algo; /* 0:None, 1-11:Legacy, 12:PQC (Quantum Secure) */
     uint8_t session_key[32]; /* Derived via ECDH/ML-KEM */
+    CryptoSession crypto;    /* Cached cipher contexts, owned by this slot's crypto worker */
+    uint64_t resume_token;   /* Issued at login, presented by PKT_RESUME on reconnect */
+    uint32_t link_caps;      /* LINK_CAP_* granted at handshake */
     
     /* Navigation & Physics State */
     double gx, gy, gz;      /* Absolute Galactic Coordinates */
@@ -44,6 +50,7 @@ typedef struct {
     int nav_timer;
     double warp_speed;
     double approach_dist;
+    uint16_t lock_gen;      /* Handle generation of state.lock_target */
     
     /* Torpedo State */
     bool torp_active;
@@ -52,6 +59,7 @@ typedef struct {
     double tx, ty, tz;      /* Torpedo Current Position */
     double tdx, tdy, tdz;   /* Torpedo Vector */
     int torp_target;        /* ID of target */
+    uint16_t torp_gen;      /* Its handle generation at launch */
     
     /* Jump Visuals */
     double wx, wy, wz;      /* Wormhole entrance coords */
@@ -60,6 +68,7 @@ typedef struct {
     
     /* Boarding Interaction State */
     int pending_bor_target; /* ID of target player */
+    uint16_t pending_bor_gen;
     int pending_bor_type;   /* 1: Ally, 2: Enemy */
 
     StarTrekGame state;
@@ -88,14 +97,12 @@ typedef struct { int id, faction, q1, q2, q3; double x, y, z; int health, energy
 typedef struct { int id, q1, q2, q3; double x, y, z; int active; } NPCRift;
 typedef struct { int id, type, q1, q2, q3; double x, y, z; int health, energy, active; int behavior_timer; } NPCMonster;
 
+/* Position, energy, liveness and AI state are per-tick data and live in npc_hot (below) */
 typedef struct { 
-    int id, faction, q1, q2, q3; 
-    double x, y, z, h, m; 
-    double gx, gy, gz; /* Absolute Galactic Coordinates 0-100 */
-    int energy, active; 
+    int id, faction; 
+    double h, m; 
     float engine_health; 
     int fire_cooldown; 
-    AIState ai_state; 
     int target_player_idx; 
     int nav_timer; 
     double dx, dy, dz;
@@ -108,6 +115,8 @@ typedef struct { int id, faction, q1, q2, q3; double x, y, z; int health, active
 
 /* --- Limits --- */
 
+/* Default soft limits of the entity pools, overridden with trek_server -l kind=N. Pools start
+   empty and grow in chunks up to their limit; ENT_POOL_MAX is the ceiling for any kind. */
 #define MAX_NPC 1000
 #define MAX_PLANETS 1000
 #define MAX_BASES 200
@@ -124,41 +133,51 @@ typedef struct { int id, faction, q1, q2, q3; double x, y, z; int health, active
 #define MAX_RIFTS 50
 #define MAX_MONSTERS 30
 
-/* Local Quadrant Limits for Spatial Index (Optimization) */
-#define MAX_Q_NPC 32
-#define MAX_Q_PLANETS 32
-#define MAX_Q_BASES 16
-#define MAX_Q_STARS 64
-#define MAX_Q_BH 8
-#define MAX_Q_NEBULAS 16
-#define MAX_Q_PULSARS 8
-#define MAX_Q_COMETS 8
-#define MAX_Q_ASTEROIDS 40
-#define MAX_Q_DERELICTS 8
-#define MAX_Q_MINES 32
-#define MAX_Q_BUOYS 8
-#define MAX_Q_PLATFORMS 16
-#define MAX_Q_RIFTS 4
-#define MAX_Q_MONSTERS 4
-#define MAX_Q_PLAYERS 32
-
-/* Global Data accessed by modules */
-extern NPCStar stars_data[MAX_STARS];
-extern NPCBlackHole black_holes[MAX_BH];
-extern NPCNebula nebulas[MAX_NEBULAS];
-extern NPCPulsar pulsars[MAX_PULSARS];
-extern NPCComet comets[MAX_COMETS];
-extern NPCAsteroid asteroids[MAX_ASTEROIDS];
-extern NPCDerelict derelicts[MAX_DERELICTS];
-extern NPCMine mines[MAX_MINES];
-extern NPCBuoy buoys[MAX_BUOYS];
-extern NPCPlatform platforms[MAX_PLATFORMS];
-extern NPCRift rifts[MAX_RIFTS];
-extern NPCMonster monsters[MAX_MONSTERS];
-extern NPCPlanet planets[MAX_PLANETS];
-extern NPCBase bases[MAX_BASES];
-extern NPCShip npcs[MAX_NPC];
+/* Per-tick NPC state, one array per field so the AI and movement passes stream through it
+   instead of striding across NPCShip records. Indexed like npcs[]; every array is part of
+   the NPC pool and grows with it. */
+typedef struct {
+    double *gx, *gy, *gz;     /* Absolute Galactic Coordinates */
+    double *vx, *vy, *vz;     /* Displacement chosen by the AI, applied and cleared by the move */
+    double *x, *y, *z;        /* Sector position, derived by the move */
+    int32_t *q1, *q2, *q3;    /* Quadrant, derived by the move */
+    int32_t *energy;
+    uint8_t *active;
+    uint8_t *ai_state;        /* AIState */
+} NPCHotData;
+
+/* Read-only spectator links (not bound to player slots) */
+#define MAX_SPECTATORS 256
+
+typedef struct {
+    int socket;
+    int mode;          /* SPECTATE_*, 0 = dropped for lagging */
+    int ready;         /* Galaxy Master delivered, stream may start */
+    int q1, q2, q3;    /* SPECTATE_QUADRANT */
+    int target;        /* SPECTATE_CAPTAIN: player index */
+    int64_t sent_frame;
+} Spectator;
+
+/* Global Data accessed by modules. Entity arrays are pool storage (entity.c): slots up to
+   entity_capacity() of their kind are addressable, and the arrays never move. */
+extern NPCStar *stars_data;
+extern NPCBlackHole *black_holes;
+extern NPCNebula *nebulas;
+extern NPCPulsar *pulsars;
+extern NPCComet *comets;
+extern NPCAsteroid *asteroids;
+extern NPCDerelict *derelicts;
+extern NPCMine *mines;
+extern NPCBuoy *buoys;
+extern NPCPlatform *platforms;
+extern NPCRift *rifts;
+extern NPCMonster *monsters;
+extern NPCPlanet *planets;
+extern NPCBase *bases;
+extern NPCShip *npcs;
+extern NPCHotData npc_hot;
 extern ConnectedPlayer players[MAX_CLIENTS];
+extern Spectator spectators[MAX_SPECTATORS];
 extern StarTrekGame galaxy_master;
 extern pthread_mutex_t game_mutex;
 extern int g_debug;
@@ -177,64 +196,371 @@ extern SupernovaState supernova_event;
 
 #define LOG_DEBUG(...) do { if (g_debug) { printf("DEBUG: " __VA_ARGS__); fflush(stdout); } } while (0)
 
-#define GALAXY_VERSION 20260210
+#define GALAXY_VERSION 20261024
+
+/* --- Galaxy Dimensions --- */
 
-/* Spatial Partitioning Index */
+/* The galaxy is a cube of galaxy_q quadrants per axis, each 10 units across, chosen at
+   startup (trek_server -g) or by the save being loaded. Quadrant-keyed storage is laid out
+   1-based with a zero pad on every axis, so cell 0 is never a quadrant. */
+#define GALAXY_Q_DEFAULT 10
+extern int galaxy_q;
+extern int64_t *galaxy_map;  /* BPNBS code of every quadrant, GALAXY_CELLS entries */
+#define GALAXY_SIDE (galaxy_q + 1)
+#define GALAXY_CELLS (GALAXY_SIDE * GALAXY_SIDE * GALAXY_SIDE)
+#define GALAXY_UNITS (galaxy_q * 10.0)
+#define GALAXY_CELL(q1,q2,q3) CHART_CELL(galaxy_q, q1, q2, q3)
+#define GALAXY_MAP(q1,q2,q3) galaxy_map[GALAXY_CELL(q1, q2, q3)]
+#define IS_CHART_Q(q1,q2,q3) ((q1)>=1 && (q1)<=CHART_Q && (q2)>=1 && (q2)<=CHART_Q && (q3)>=1 && (q3)<=CHART_Q)
+/* Once at startup, before anything keyed by quadrant is built: sizes the galaxy map */
+void galaxy_set_dimensions(int q);
+
+/* Entity kinds in the spatial index */
+enum {
+    SI_NPC, SI_PLANET, SI_BASE, SI_STAR, SI_BH, SI_NEBULA, SI_PULSAR, SI_COMET,
+    SI_ASTEROID, SI_DERELICT, SI_MINE, SI_BUOY, SI_PLATFORM, SI_RIFT, SI_MONSTER, SI_PLAYER,
+    SI_KINDS
+};
+
+/* Spatial Partitioning Index, compressed: spatial_slots[kind] holds the slot index of every
+   indexed body of the kind, grouped by quadrant, and spatial_runs[cell][kind] says where
+   that quadrant's run starts and how long it is. No quadrant has a cap. A cell's runs for
+   all kinds share one 64-byte line; each kind's slots grow with its pool. */
+typedef struct { uint16_t start, count; } SpatialRun;
+extern SpatialRun (*spatial_runs)[SI_KINDS];  /* GALAXY_CELLS rows */
+extern uint16_t *spatial_slots[SI_KINDS];
+
+/* One quadrant's view. Each list holds slot indices into the matching global array (npcs[],
+   stars_data[], players[]...) and points into the index storage, so it is only valid until
+   the next update_spatial_index(). */
 typedef struct {
-    NPCShip *npcs[MAX_Q_NPC];
-    int npc_count;
-    NPCPlanet *planets[MAX_Q_PLANETS];
-    int planet_count;
-    int static_planet_count; 
-    NPCBase *bases[MAX_Q_BASES];
-    int base_count;
-    int static_base_count;   
-    NPCStar *stars[MAX_Q_STARS];
-    int star_count;
-    int static_star_count;   
-    NPCBlackHole *black_holes[MAX_Q_BH];
-    int bh_count;
-    int static_bh_count;     
-    NPCNebula *nebulas[MAX_Q_NEBULAS];
-    int nebula_count;
-    int static_nebula_count; 
-    NPCPulsar *pulsars[MAX_Q_PULSARS];
-    int pulsar_count;
-    int static_pulsar_count; 
-    NPCComet *comets[MAX_Q_COMETS];
-    int comet_count;
-    NPCAsteroid *asteroids[MAX_Q_ASTEROIDS];
-    int asteroid_count;
-    NPCDerelict *derelicts[MAX_Q_DERELICTS];
-    int derelict_count;
-    NPCMine *mines[MAX_Q_MINES];
-    int mine_count;
-    NPCBuoy *buoys[MAX_Q_BUOYS];
-    int buoy_count;
-    NPCPlatform *platforms[MAX_Q_PLATFORMS];
-    int platform_count;
-    NPCRift *rifts[MAX_Q_RIFTS];
-    int rift_count;
-    NPCMonster *monsters[MAX_Q_MONSTERS];
-    int monster_count;
-    ConnectedPlayer *players[MAX_Q_PLAYERS];
-    int player_count;
+    const uint16_t *npcs;        int npc_count;
+    const uint16_t *planets;     int planet_count;
+    const uint16_t *bases;       int base_count;
+    const uint16_t *stars;       int star_count;
+    const uint16_t *black_holes; int bh_count;
+    const uint16_t *nebulas;     int nebula_count;
+    const uint16_t *pulsars;     int pulsar_count;
+    const uint16_t *comets;      int comet_count;
+    const uint16_t *asteroids;   int asteroid_count;
+    const uint16_t *derelicts;   int derelict_count;
+    const uint16_t *mines;       int mine_count;
+    const uint16_t *buoys;       int buoy_count;
+    const uint16_t *platforms;   int platform_count;
+    const uint16_t *rifts;       int rift_count;
+    const uint16_t *monsters;    int monster_count;
+    const uint16_t *players;     int player_count;
 } QuadrantIndex;
 
-extern QuadrantIndex (*spatial_index)[11][11];
+size_t spatial_index_bytes(void);
+
+/* Proximity grid: every indexed body is also hashed into uniform cells of absolute galactic
+   coordinates, so a radius query looks at the bodies near a point whatever quadrant they are
+   in. Cells follow the index and are one tick stale at most; distances are measured live. */
+#define SI_MASK(kind) (1u << (kind))
+typedef struct { uint16_t kind, idx; float d2; } SpatialHit;
+/* Absolute position of a body, false when it is not indexed */
+bool spatial_position(int kind, int idx, double *gx, double *gy, double *gz);
+/* Bodies of the kinds in kind_mask within radius of (gx,gy,gz), grouped by kind in enum order.
+   Returns how many matched; only the first max are written, so a result above max means
+   hits was too small. */
+int spatial_query(double gx, double gy, double gz, double radius, uint32_t kind_mask, SpatialHit *hits, int max);
+/* Tick only: every match, in a shared buffer valid until the next call */
+int spatial_query_all(double gx, double gy, double gz, double radius, uint32_t kind_mask, const SpatialHit **hits);
+
 void rebuild_spatial_index();
 void init_static_spatial_index();
+/* Tick only: moves bodies whose quadrant or active flag changed since the last call */
+void update_spatial_index();
+/* Reports a body that does not move on its own (asteroid, mine, platform...) as spawned or
+   destroyed; it is reindexed by the next update_spatial_index() */
+void spatial_index_touch(int kind, int idx);
+/* Bumped whenever a kind's runs are rebuilt: anything derived from where its bodies are is
+   stale once this changes */
+uint64_t spatial_kind_version(int kind);
+void log_spatial_stats(void);
+
+/* --- Entity Handles (entity.c) --- */
+
+/* Public ids keep the documented numbering (captains 1+, NPCs 1000+, bases 2000+ ... probes
+   19000+) but are decoded through a block table, not range tests. Every slot carries a
+   generation bumped when the slot is reused, so a handle taken earlier can tell whether its
+   id still names the same body. Probe slots are owner * 3 + probe. */
+#define ENT_PROBE SI_KINDS
+#define ENT_KINDS (SI_KINDS + 1)
 
-#define IS_Q_VALID(q1,q2,q3) ((q1)>=1 && (q1)<=10 && (q2)>=1 && (q2)<=10 && (q3)>=1 && (q3)<=10)
+#define ENT_ROAMS      0x01  /* Moves between quadrants: reached by galactic position */
+#define ENT_LOCK_HOLDS 0x02  /* A lock survives the body leaving the captain's quadrant */
+#define ENT_LOCKABLE   0x04
 
-/* Helper to safely calculate quadrant from absolute coordinate (0-100) */
+/* Typed view of one live body; the pointer is valid while game_mutex is held */
+typedef struct {
+    int kind, slot;
+    uint16_t gen;
+    uint8_t flags;
+    int q1, q2, q3;
+    double x, y, z;    /* Sector coordinates in its quadrant */
+    double gx, gy, gz; /* Absolute galactic coordinates */
+    union {
+        void *any;
+        ConnectedPlayer *player;
+        NPCShip *npc;
+        NPCPlanet *planet;
+        NPCBase *base;
+        NPCStar *star;
+        NPCBlackHole *black_hole;
+        NPCNebula *nebula;
+        NPCPulsar *pulsar;
+        NPCComet *comet;
+        NPCAsteroid *asteroid;
+        NPCDerelict *derelict;
+        NPCMine *mine;
+        NPCBuoy *buoy;
+        NPCPlatform *platform;
+        NPCRift *rift;
+        NPCMonster *monster;
+        NetProbe *probe;
+    };
+} EntityRef;
+
+void entity_init(void);
+/* Public id of a slot */
+int entity_id(int kind, int slot);
+/* Kind and slot named by an id, whether or not the body is alive; lock-free */
+bool entity_decode(int id, int *kind, int *slot);
+uint16_t entity_generation(int kind, int slot);
+/* A slot now holds a new body: handles taken on the previous one go stale */
+void entity_spawned(int kind, int slot);
+/* The live body an id names now (ids typed by a captain), game_mutex held */
+bool entity_lookup(int id, EntityRef *ref);
+/* As entity_lookup, but false once the id has been reused since gen was taken */
+bool entity_resolve(int id, uint16_t gen, EntityRef *ref);
+
+/* Pools: every kind below SI_PLAYER keeps a dense list of its live slots and a free list.
+   Its storage is committed ENT_POOL_CHUNK slots at a time as spawns need them, up to the
+   kind's soft limit. Captains and probes stay bound to their connection. */
+#define ENT_POOL_MAX   65535  /* Slot indices are 16-bit (live lists, quadrant runs, hits) */
+#define ENT_POOL_CHUNK 1024
+/* Before entity_init(): soft limit of the kind named as in trek_server -l (npc, mine...) */
+bool entity_set_limit(const char *name, int slots);
+/* Rebuilds the lists from the active flags, after a galaxy is generated or loaded */
+void entity_rebuild_pools(void);
+/* A free slot, its generation bumped and the spatial index told; the pool grows by a chunk
+   when it has none, and -1 comes back only at the limit. The caller fills the record,
+   active flag included. */
+int entity_alloc(int kind);
+/* Clears the active flag and frees the slot. Loops walking entity_live() backwards may
+   despawn the slot they are on. */
+void entity_despawn(int kind, int slot);
+/* Live slots of a kind, in no particular order */
+int entity_live(int kind, const uint16_t **slots);
+/* One past the highest live slot, for passes that stream slot-indexed arrays */
+int entity_span(int kind);
+/* Slots committed so far: every index below is addressable */
+int entity_capacity(int kind);
+int entity_limit(int kind);
+/* Commits slots [0, slots) for code filling them directly (generation); false past the limit */
+bool entity_reserve(int kind, int slots);
+/* Zeroes every committed body and empties the lists */
+void entity_clear_pools(void);
+/* Bytes committed for a kind: its records plus pool bookkeeping */
+size_t entity_pool_bytes(int kind);
+/* Galaxy file section holding the pooled kinds; loading raises limits a save exceeds */
+void entity_save_pools(FILE *f);
+bool entity_load_pools(FILE *f);
+void log_entity_stats(void);
+
+static inline bool entity_in_quadrant(const EntityRef *r, int q1, int q2, int q3) {
+    return r->q1 == q1 && r->q2 == q2 && r->q3 == q3;
+}
+
+/* --- NPC Motion (motion.c) --- */
+
+/* Moves count NPCs along one axis: applies and clears the displacement v, clamps the galactic
+   coordinate g to [lo, hi] and derives quadrant q (1 to qmax) and sector coordinate s from
+   it, as get_q_from_g would. Arrays must not overlap; written to auto-vectorize. */
+void npc_integrate(double *restrict g, double *restrict v, double *restrict s, int32_t *restrict q,
+                   int count, double lo, double hi, int qmax);
+
+/* Galaxy Map Change Tracking (Session Resume). galaxy_master.g mirrors the CHART_Q corner
+   of galaxy_map and is what gets signed; the rest reaches clients as PacketChart cells. */
+extern int64_t *galaxy_cell_frame;  /* Per GALAXY_CELL: frame of its last change */
+extern uint64_t galaxy_version;  /* Bumped whenever a corner cell changes; keys the cached signature */
+void track_galaxy_changes();
+
+/* Every galaxy_map write goes through here, so resume deltas see the cell move */
+static inline void galaxy_map_set(int cell, int64_t val) {
+    if (galaxy_map[cell] == val) return;
+    galaxy_map[cell] = val;
+    galaxy_cell_frame[cell] = galaxy_master.frame_id;
+}
+
+#define IS_Q_VALID(q1,q2,q3) ((q1)>=1 && (q1)<=galaxy_q && (q2)>=1 && (q2)<=galaxy_q && (q3)>=1 && (q3)<=galaxy_q)
+
+/* Helper to safely calculate quadrant from absolute coordinate (0 to GALAXY_UNITS) */
 static inline int get_q_from_g(double g) {
     int q = (int)(g / 10.0) + 1;
     if (q < 1) q = 1;
-    if (q > 10) q = 10;
+    if (q > galaxy_q) q = galaxy_q;
     return q;
 }
 
+static inline int spatial_run(int cell, int kind, const uint16_t **list) {
+    SpatialRun r = spatial_runs[cell][kind];
+    *list = &spatial_slots[kind][r.start];
+    return r.count;
+}
+
+/* Forced inline so a caller reading two kinds only pays for two runs: built out of line, the
+   view costs more than the walk in Phase 1. Cell 0 is never populated and stands in for an
+   invalid quadrant. */
+__attribute__((always_inline)) static inline QuadrantIndex spatial_quadrant(int q1, int q2, int q3) {
+    QuadrantIndex q;
+    int cell = IS_Q_VALID(q1, q2, q3) ? GALAXY_CELL(q1, q2, q3) : 0;
+    q.npc_count      = spatial_run(cell, SI_NPC,      &q.npcs);
+    q.planet_count   = spatial_run(cell, SI_PLANET,   &q.planets);
+    q.base_count     = spatial_run(cell, SI_BASE,     &q.bases);
+    q.star_count     = spatial_run(cell, SI_STAR,     &q.stars);
+    q.bh_count       = spatial_run(cell, SI_BH,       &q.black_holes);
+    q.nebula_count   = spatial_run(cell, SI_NEBULA,   &q.nebulas);
+    q.pulsar_count   = spatial_run(cell, SI_PULSAR,   &q.pulsars);
+    q.comet_count    = spatial_run(cell, SI_COMET,    &q.comets);
+    q.asteroid_count = spatial_run(cell, SI_ASTEROID, &q.asteroids);
+    q.derelict_count = spatial_run(cell, SI_DERELICT, &q.derelicts);
+    q.mine_count     = spatial_run(cell, SI_MINE,     &q.mines);
+    q.buoy_count     = spatial_run(cell, SI_BUOY,     &q.buoys);
+    q.platform_count = spatial_run(cell, SI_PLATFORM, &q.platforms);
+    q.rift_count     = spatial_run(cell, SI_RIFT,     &q.rifts);
+    q.monster_count  = spatial_run(cell, SI_MONSTER,  &q.monsters);
+    q.player_count   = spatial_run(cell, SI_PLAYER,   &q.players);
+    return q;
+}
+
+/* --- Combat FX (fx.c) --- */
+
+/* Effects are recorded in the quadrant they happen in and shipped to everyone there.
+   Tick only, with game_mutex held. */
+void fx_begin_tick(void);
+void fx_beam(int q1, int q2, int q3, int source, double sx, double sy, double sz, double tx, double ty, double tz);
+void fx_point(int q1, int q2, int q3, int kind, int source, double x, double y, double z, int detail);
+/* Serialized events of a quadrant, built on first request each tick */
+const NetFxEvent *fx_quadrant(int q1, int q2, int q3, int *count);
+void log_fx_stats(void);
+
+/* --- Contact Pairs (contacts.c) --- */
+
+/* Phase 2 broadphase: once per tick every captain's hazards are gathered from the spatial
+   index into one list of (captain, body) pairs with squared distances, and the hazard,
+   collision and trigger handlers read their captain's pairs instead of each walking the
+   quadrant and measuring every body again. Tick only, with game_mutex held. */
+typedef struct { uint16_t kind, idx; float d2, dx, dy, dz; } Contact;  /* dx..: body minus captain */
+typedef struct { const Contact *pairs; int count; } ContactList;
+void contacts_build(void);
+/* A captain's pairs, grouped by kind in enum order; valid until the next contacts_build() */
+ContactList contacts_of(int player);
+/* Planets, stars and black holes measured again once the ship has moved this tick, valid
+   until the next call. Solid bodies are gathered CONTACT_SLACK further out, so a short move
+   only shifts the pairs; a longer one or a new quadrant walks the index again. */
+ContactList contacts_moved(int player);
+void log_contact_stats(void);
+
+/* --- Lag Compensation (lagcomp.c) --- */
+
+/* One recorded position. Entity ids follow the sensor numbering: 1-32 captains, 1000+ NPCs. */
+typedef struct {
+    float x, y, z;
+    int8_t q1, q2, q3;
+    bool valid;
+    uint16_t gen;   /* NPCs: slot generation when recorded */
+} LagSample;
+
+/* Tick only, with game_mutex held: stores the end-of-tick positions and refreshes link RTTs */
+void lag_record(void);
+/* Ticks a captain's shots are rewound by: measured RTT plus client interpolation, capped */
+int lag_rewind_ticks(int p_idx);
+/* The recorded tick that lies `behind` ticks before the newest one */
+int lag_view_tick(int behind);
+/* Position of id at a past tick; false when not recorded or not in the given quadrant */
+bool lag_position(int id, int tick, int q1, int q2, int q3, double *x, double *y, double *z);
+/* Raw history for replay and debugging; false once the tick has left the ring */
+bool lag_sample(int id, int tick, LagSample *out);
+int lag_rtt_ms(int p_idx);
+
+/* --- World Snapshot (snapshot.c) --- */
+
+/* Read-only commands are served from an immutable copy of the world published by the
+   tick, so they never take game_mutex. Only what those reports read is copied. */
+typedef struct {
+    bool active;
+    char name[64];
+    int32_t faction;
+    int ship_class;
+    int nav_state;
+    double gx, gy, gz;
+    int32_t q1, q2, q3;
+    float s1, s2, s3;
+    float ent_h, ent_m;
+    int32_t energy, torpedoes;
+    int32_t cargo_energy, cargo_torpedoes;
+    int32_t crew_count, prison_unit, duranium_plating;
+    int32_t inventory[10];
+    int32_t shields[6];
+    float power_dist[3];
+    float system_health[10];
+    int32_t lock_target;
+    uint8_t is_cloaked;
+    int64_t lrs[3][3][3];        /* BPNBS codes around q1-q3, [dq1+1][dq2+1][dq3+1]; 0 outside */
+} PlayerView;
+
+/* One sensor contact with its true position; observer-specific noise is applied later */
+typedef struct {
+    double x, y, z;
+    int32_t id;
+    int32_t energy;
+    int32_t amount;      /* Planet reserves, platform fire cooldown */
+    float engine;        /* NPC engine health */
+    int16_t faction, detail, owner;
+    int16_t scan_detail; /* NPC behaviour, planet resource, monster type */
+    uint8_t kind, flags;
+    bool noisy;          /* Subject to ion noise and damaged-sensor misses */
+    bool active;
+} SensorEntry;
+
+typedef struct {
+    int first, count;
+    int dropped;         /* Bodies that did not fit the view */
+    int cell;            /* GALAXY_CELL of the quadrant, to reset quad_view on reuse */
+    bool full;           /* false: neighbour view, mobile contacts only */
+} QuadrantView;
+
+typedef struct {
+    int readers;         /* Atomic: threads currently reading this buffer */
+    int64_t version;     /* frame_id at publication */
+    PlayerView players[MAX_CLIENTS];
+    int16_t *quad_view;  /* Per GALAXY_CELL: index in views[], -1 if not captured */
+    QuadrantView views[SNAPSHOT_MAX_QUADS];
+    int view_count;
+    SensorEntry entries[SNAPSHOT_MAX_ENTRIES];
+    int entry_count;
+} WorldSnapshot;
+
+void snapshot_publish(void);  /* Tick only, with game_mutex held */
+const WorldSnapshot *snapshot_acquire(void);
+void snapshot_release(const WorldSnapshot *w);
+
+/* Scratch and packet memory (mempool.c). Arena memory lives until the enclosing
+   arena_release()/arena_reset() of the calling thread; slab blocks until slab_free(). */
+typedef struct ArenaSpill ArenaSpill;
+typedef struct { size_t used; ArenaSpill *spill; } ArenaMark;
+void *arena_alloc(size_t size);
+ArenaMark arena_mark(void);
+void arena_release(ArenaMark mark);
+void arena_reset(void);
+void *slab_alloc(size_t size);
+void slab_free(void *ptr);
+void mempool_init(void);
+void log_memory_stats(void);
+
 /* Function Prototypes */
 void normalize_upright(double *h, double *m);
 void generate_galaxy();
@@ -244,8 +570,38 @@ const char* get_species_name(int s);
 
 void broadcast_message(PacketMessage *msg);
 void send_server_msg(int p_idx, const char *from, const char *text);
+void crypto_pool_init(void);
+void crypto_pool_send(int p_idx, const PacketMessage *head, const char *text, int algo);
+void crypto_pool_frame(int p_idx, const void *pkt, size_t len);
+void crypto_pool_prepare(int p_idx);
+void crypto_pool_hold(void);     /* Network thread, without game_mutex: keep replies back */
+void crypto_pool_release(void);  /* Takes game_mutex to queue them */
+void crypto_pool_close(int p_idx, int fd);
+void log_outbox_stats(void);
+void send_alert(int p_idx, int code, int p1, int p2);
+void flush_alerts(int p_idx);
+void reset_alerts(int p_idx);
+void send_sensor_report(int p_idx, const PlayerView *me, PacketSensor *pkt, size_t data_len);
+void send_update(int p_idx, const PacketUpdate *upd, size_t len);
+void log_update_stats(void);
+void sign_galaxy_data();
+size_t signed_galaxy_sync(const void **out);
+void send_session_token(int slot);
+void adopt_handshake_link(int slot, int fd);
+bool link_has_session_key(int fd);
+void handle_resume(int fd, const PacketResume *pkt);
+void handle_spectate(int fd, const PacketSpectate *pkt);
+void remove_spectator(int fd);
+void spectator_send(Spectator *sp, const void *buf, size_t len);
+void spectator_fanout_captain(int p_idx, const void *buf, size_t len);
 
+/* Network thread: parse, rate limit and queue; reports are answered on the spot */
 void process_command(int p_idx, const char *cmd);
+void process_batch(int p_idx, const PacketBatch *pkt);
+/* Tick only, with game_mutex held */
+void run_queued_commands();
+void run_pending_batches();
+void log_command_stats(void);
 void update_game_logic();
 
 int read_all(int fd, void *buf, size_t len);
@@ -11,6 +11,7 @@
 #include <pthread.h>
 #include <semaphore.h>
 #include <stdint.h>
+#include "game_state.h"
 
 #pragma pack(push, 1)
 
@@ -100,7 +101,8 @@ typedef struct {
     uint8_t shm_server_pubkey[32];
     int shm_q[3];
     float shm_s[3];
-    int64_t shm_galaxy[11][11][11];
+    int shm_galaxy_q;
+    int64_t shm_galaxy[CHART_SIDE_MAX * CHART_SIDE_MAX * CHART_SIDE_MAX]; /* CHART_CELL(shm_galaxy_q, ...) */
     
     /* Subspace Telemetry Metrics */
     float net_kbps;
@@ -0,0 +1,33 @@
+/*
+ * STARTREK ULTRA - 3D LOGIC ENGINE
+ * Authors: Nicola Taibi, Supported by Google Gemini
+ * Copyright (C) 2026 Nicola Taibi
+ * License: GNU General Public License v3.0
+ */
+
+#ifndef SUBSPACE_CODEC_H
+#define SUBSPACE_CODEC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zlib.h>
+
+/* Texts shorter than this are sent as they are: the deflate block overhead eats the gain */
+#define SUBSPACE_COMPRESS_MIN 64
+
+/* Raw deflate primed with a dictionary of typical server reports. Both streams are
+   reset per message, so one codec serves a whole connection (or a whole worker). */
+typedef struct {
+    z_stream def, inf;
+    bool def_ready, inf_ready;
+} SubspaceCodec;
+
+extern const int SUBSPACE_DICT_LEN;
+
+/* Returns the compressed length, -1 if the text is too short or would not shrink */
+int subspace_compress(SubspaceCodec *sc, const uint8_t *in, int len, uint8_t *out, int cap);
+/* Returns the expanded length, -1 on a corrupt stream or if cap is exceeded */
+int subspace_decompress(SubspaceCodec *sc, const uint8_t *in, int len, uint8_t *out, int cap);
+void subspace_codec_free(SubspaceCodec *sc);
+
+#endif
@@ -0,0 +1,150 @@
+/*
+ * STARTREK ULTRA - 3D LOGIC ENGINE
+ * Authors: Nicola Taibi, Supported by Google Gemini
+ * Copyright (C) 2026 Nicola Taibi
+ * License: GNU General Public License v3.0
+ */
+
+#include <string.h>
+#include <openssl/rand.h>
+#include "crypto_session.h"
+
+const EVP_CIPHER *crypto_cipher(int algo, bool *is_aead) {
+    bool aead = false;
+    const EVP_CIPHER *cipher;
+    switch (algo) {
+        case CRYPTO_CHACHA:   cipher = EVP_chacha20_poly1305(); aead = true; break;
+        case CRYPTO_ARIA:     cipher = EVP_aria_256_gcm(); aead = true; break;
+        case CRYPTO_CAMELLIA: cipher = EVP_camellia_256_ctr(); break;
+        case CRYPTO_SEED:     cipher = EVP_seed_cbc(); break;
+        case CRYPTO_CAST5:    cipher = EVP_cast5_cbc(); break;
+        case CRYPTO_IDEA:     cipher = EVP_idea_cbc(); break;
+        case CRYPTO_3DES:     cipher = EVP_des_ede3_cbc(); break;
+        case CRYPTO_BLOWFISH: cipher = EVP_bf_cbc(); break;
+        case CRYPTO_RC4:      cipher = EVP_rc4(); break;
+        case CRYPTO_DES:      cipher = EVP_des_cbc(); break;
+        default:              cipher = EVP_aes_256_gcm(); aead = true; break; /* AES and PQC */
+    }
+    if (is_aead) *is_aead = aead;
+    return cipher;
+}
+
+static void free_contexts(CryptoSession *cs) {
+    for (int a = 0; a < CRYPTO_ALGO_SLOTS; a++) {
+        if (cs->enc[a]) EVP_CIPHER_CTX_free(cs->enc[a]);
+        if (cs->dec[a]) EVP_CIPHER_CTX_free(cs->dec[a]);
+        if (cs->ivgen[a]) EVP_CIPHER_CTX_free(cs->ivgen[a]);
+        cs->enc[a] = cs->dec[a] = cs->ivgen[a] = NULL;
+    }
+}
+
+void crypto_session_bind(CryptoSession *cs, const uint8_t *key) {
+    if (cs->keyed && memcmp(cs->key, key, 32) == 0) return;
+    free_contexts(cs);
+    memcpy(cs->key, key, 32);
+    RAND_bytes((uint8_t *)&cs->nonce_seq, sizeof(cs->nonce_seq));
+    cs->keyed = true;
+}
+
+void crypto_session_free(CryptoSession *cs) {
+    free_contexts(cs);
+    memset(cs->key, 0, 32);
+    cs->keyed = false;
+}
+
+/* Key schedule runs here, once per algorithm and direction */
+static EVP_CIPHER_CTX *session_ctx(CryptoSession *cs, int algo, int enc) {
+    if (algo < 0 || algo >= CRYPTO_ALGO_SLOTS) algo = CRYPTO_AES;
+    EVP_CIPHER_CTX **slot = enc ? &cs->enc[algo] : &cs->dec[algo];
+    if (*slot) return *slot;
+
+    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+    if (!ctx) return NULL;
+    if (EVP_CipherInit_ex(ctx, crypto_cipher(algo, NULL), NULL, cs->key, NULL, enc) <= 0) {
+        EVP_CIPHER_CTX_free(ctx);
+        return NULL;
+    }
+    *slot = ctx;
+    return ctx;
+}
+
+void crypto_session_prepare(CryptoSession *cs, int algo) {
+    if (cs->keyed && algo != CRYPTO_NONE) session_ctx(cs, algo, 1);
+}
+
+/* CBC wants an IV the sender's peers cannot predict, and the nonce is public: frame_id is
+   the same for every message of a tick, and the only part an 8-byte-block cipher would
+   read. The IV is instead one block of the nonce enciphered under the session key (NIST
+   SP 800-38A, appendix C); 8-byte blocks take the low half of frame_id and the counter.
+   Only chat uses CBC modes, so the channel byte is not needed here. */
+static int cbc_iv(CryptoSession *cs, int algo, const uint8_t iv[12], uint8_t out[16]) {
+    static const uint8_t zero[16] = {0};
+    EVP_CIPHER_CTX **slot = &cs->ivgen[algo];
+    if (!*slot) {
+        EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+        if (!ctx) return -1;
+        if (EVP_EncryptInit_ex(ctx, crypto_cipher(algo, NULL), NULL, cs->key, zero) <= 0) {
+            EVP_CIPHER_CTX_free(ctx);
+            return -1;
+        }
+        EVP_CIPHER_CTX_set_padding(ctx, 0);
+        *slot = ctx;
+    }
+    int bs = EVP_CIPHER_CTX_block_size(*slot), n = 0;
+    uint8_t block[16] = {0};
+    if (bs == 8) { memcpy(block, iv, 4); memcpy(block + 4, iv + 8, 4); }
+    else memcpy(block, iv, 12);
+    /* One block under a zero IV is the bare block cipher */
+    if (EVP_EncryptInit_ex(*slot, NULL, NULL, NULL, zero) <= 0) return -1;
+    return EVP_EncryptUpdate(*slot, out, &n, block, bs) > 0 && n == bs ? 1 : -1;
+}
+
+/* Resets a cached context for a new message. RC4 has no IV, so its keystream restarts from the key. */
+static int session_rearm(CryptoSession *cs, EVP_CIPHER_CTX *ctx, int algo, const uint8_t iv[12]) {
+    uint8_t iv_block[16] = {0}; /* 16-byte block ciphers read past the 12 transmitted bytes */
+    if (EVP_CIPHER_CTX_mode(ctx) == EVP_CIPH_CBC_MODE) {
+        if (cbc_iv(cs, algo, iv, iv_block) <= 0) return -1;
+    } else {
+        memcpy(iv_block, iv, 12);
+    }
+    return EVP_CipherInit_ex(ctx, NULL, NULL, (algo == CRYPTO_RC4) ? cs->key : NULL, iv_block, -1);
+}
+
+int crypto_session_encrypt(CryptoSession *cs, int algo, int channel, int64_t frame_id, const uint8_t *in, int len,
+                           uint8_t *out, uint8_t iv[12], uint8_t tag[16]) {
+    EVP_CIPHER_CTX *ctx = session_ctx(cs, algo, 1);
+    if (!ctx) return -1;
+
+    /* 56 bits of frame_id outlast any server at 30Hz; the top byte names the channel */
+    for (int i = 0; i < 7; i++) iv[i] = (uint8_t)((uint64_t)frame_id >> (i * 8));
+    iv[7] = (uint8_t)channel;
+    uint32_t seq = cs->nonce_seq++;
+    memcpy(iv + 8, &seq, 4);
+    if (session_rearm(cs, ctx, algo, iv) <= 0) return -1;
+
+    int outlen = 0, final_len = 0;
+    if (EVP_EncryptUpdate(ctx, out, &outlen, in, len) <= 0) return -1;
+    if (EVP_EncryptFinal_ex(ctx, out + outlen, &final_len) <= 0) return -1;
+
+    bool aead;
+    crypto_cipher(algo, &aead);
+    if (aead) EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG, 16, tag);
+    else memset(tag, 0, 16);
+    return outlen + final_len;
+}
+
+int crypto_session_decrypt(CryptoSession *cs, int algo, const uint8_t iv[12], const uint8_t tag[16],
+                           const uint8_t *in, int len, uint8_t *out) {
+    EVP_CIPHER_CTX *ctx = session_ctx(cs, algo, 0);
+    if (!ctx) return -1;
+    if (session_rearm(cs, ctx, algo, iv) <= 0) return -1;
+
+    int outlen = 0, final_len = 0;
+    if (EVP_DecryptUpdate(ctx, out, &outlen, in, len) <= 0) return -1;
+
+    bool aead;
+    crypto_cipher(algo, &aead);
+    if (aead) EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_TAG, 16, (void *)tag);
+    if (EVP_DecryptFinal_ex(ctx, out + outlen, &final_len) <= 0) return -1;
+    return outlen + final_len;
+}
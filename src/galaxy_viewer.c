@@ -14,22 +14,29 @@
 #include "../include/network.h"
 
 StarTrekGame galaxy_master;
-NPCShip npcs[MAX_NPC];
-NPCStar stars_data[MAX_STARS];
-NPCBlackHole black_holes[MAX_BH];
-NPCNebula nebulas[MAX_NEBULAS];
-NPCPulsar pulsars[MAX_PULSARS];
-NPCComet comets[MAX_COMETS];
-NPCAsteroid asteroids[MAX_ASTEROIDS];
-NPCDerelict derelicts[MAX_DERELICTS];
-NPCMine mines[MAX_MINES];
-NPCBuoy buoys[MAX_BUOYS];
-NPCPlatform platforms[MAX_PLATFORMS];
-NPCRift rifts[MAX_RIFTS];
-NPCMonster monsters[MAX_MONSTERS];
-NPCPlanet planets[MAX_PLANETS];
-NPCBase bases[MAX_BASES];
+int galaxy_q;
+int64_t *galaxy_map;
+NPCShip *npcs;
+NPCHotData npc_hot;
+NPCStar *stars_data;
+NPCBlackHole *black_holes;
+NPCNebula *nebulas;
+NPCPulsar *pulsars;
+NPCComet *comets;
+NPCAsteroid *asteroids;
+NPCDerelict *derelicts;
+NPCMine *mines;
+NPCBuoy *buoys;
+NPCPlatform *platforms;
+NPCRift *rifts;
+NPCMonster *monsters;
+NPCPlanet *planets;
+NPCBase *bases;
 ConnectedPlayer players[MAX_CLIENTS];
+int g_debug = 0;
+
+/* entity.c reports spawns to the spatial index; nothing is spawned here */
+void spatial_index_touch(int kind, int idx) {}
 
 const char* get_faction_name(int faction) {
     switch(faction) {
@@ -62,7 +69,7 @@ void print_help() {
     printf("Commands:\n");
     printf("  stats             Show global galaxy statistics\n");
     printf("  map <q3>          Show a 2D map slice for Z quadrant q3\n");
-    printf("  list <q1> <q2> <q3>  List objects in quadrant (1-10)\n");
+    printf("  list <q1> <q2> <q3>  List objects in quadrant\n");
     printf("  players           List all persistent players\n");
     printf("  search <name>     Search for a player or ship by name\n");
 }
@@ -91,22 +98,20 @@ int main(int argc, char *argv[]) {
         fclose(stream); return 1; \
     }
 
+    CHECK_READ(&galaxy_q, sizeof(int), 1, f);
+    if (galaxy_q < 1 || galaxy_q > GALAXY_Q_MAX) {
+        fprintf(stderr, "Invalid galaxy dimensions: %d\n", galaxy_q);
+        fclose(f); return 1;
+    }
+    galaxy_map = malloc(GALAXY_CELLS * sizeof(int64_t));
+    if (!galaxy_map) { perror("malloc"); fclose(f); return 1; }
+    CHECK_READ(galaxy_map, sizeof(int64_t), GALAXY_CELLS, f);
     CHECK_READ(&galaxy_master, sizeof(StarTrekGame), 1, f);
-    CHECK_READ(npcs, sizeof(NPCShip), MAX_NPC, f);
-    CHECK_READ(stars_data, sizeof(NPCStar), MAX_STARS, f);
-    CHECK_READ(black_holes, sizeof(NPCBlackHole), MAX_BH, f);
-    CHECK_READ(planets, sizeof(NPCPlanet), MAX_PLANETS, f);
-    CHECK_READ(bases, sizeof(NPCBase), MAX_BASES, f);
-    CHECK_READ(nebulas, sizeof(NPCNebula), MAX_NEBULAS, f);
-    CHECK_READ(pulsars, sizeof(NPCPulsar), MAX_PULSARS, f);
-    CHECK_READ(comets, sizeof(NPCComet), MAX_COMETS, f);
-    CHECK_READ(asteroids, sizeof(NPCAsteroid), MAX_ASTEROIDS, f);
-    CHECK_READ(derelicts, sizeof(NPCDerelict), MAX_DERELICTS, f);
-    CHECK_READ(mines, sizeof(NPCMine), MAX_MINES, f);
-    CHECK_READ(buoys, sizeof(NPCBuoy), MAX_BUOYS, f);
-    CHECK_READ(platforms, sizeof(NPCPlatform), MAX_PLATFORMS, f);
-    CHECK_READ(rifts, sizeof(NPCRift), MAX_RIFTS, f);
-    CHECK_READ(monsters, sizeof(NPCMonster), MAX_MONSTERS, f);
+    entity_init();
+    if (!entity_load_pools(f)) {
+        fprintf(stderr, "Error reading from galaxy.dat\n");
+        fclose(f); return 1;
+    }
     CHECK_READ(players, sizeof(ConnectedPlayer), MAX_CLIENTS, f);
     fclose(f);
 
@@ -117,24 +122,25 @@ int main(int argc, char *argv[]) {
 
     if (strcmp(argv[1], "stats") == 0) {
         int n_active = 0, s_active = 0, b_active = 0, p_active = 0, bh_active = 0, neb_active = 0, pul_active = 0, com_active = 0, ast_active = 0, der_active = 0, mine_active = 0, buoy_active = 0, plat_active = 0, rift_active = 0, mon_active = 0;
-        for(int i=0; i<MAX_NPC; i++) if(npcs[i].active) n_active++;
-        for(int i=0; i<MAX_STARS; i++) if(stars_data[i].active) s_active++;
-        for(int i=0; i<MAX_BASES; i++) if(bases[i].active) b_active++;
-        for(int i=0; i<MAX_PLANETS; i++) if(planets[i].active) p_active++;
-        for(int i=0; i<MAX_BH; i++) if(black_holes[i].active) bh_active++;
-        for(int i=0; i<MAX_NEBULAS; i++) if(nebulas[i].active) neb_active++;
-        for(int i=0; i<MAX_PULSARS; i++) if(pulsars[i].active) pul_active++;
-        for(int i=0; i<MAX_COMETS; i++) if(comets[i].active) com_active++;
-        for(int i=0; i<MAX_ASTEROIDS; i++) if(asteroids[i].active) ast_active++;
-        for(int i=0; i<MAX_DERELICTS; i++) if(derelicts[i].active) der_active++;
-        for(int i=0; i<MAX_MINES; i++) if(mines[i].active) mine_active++;
-        for(int i=0; i<MAX_BUOYS; i++) if(buoys[i].active) buoy_active++;
-        for(int i=0; i<MAX_PLATFORMS; i++) if(platforms[i].active) plat_active++;
-        for(int i=0; i<MAX_RIFTS; i++) if(rifts[i].active) rift_active++;
-        for(int i=0; i<MAX_MONSTERS; i++) if(monsters[i].active) mon_active++;
+        for(int i=0; i<entity_capacity(SI_NPC); i++) if(npc_hot.active[i]) n_active++;
+        for(int i=0; i<entity_capacity(SI_STAR); i++) if(stars_data[i].active) s_active++;
+        for(int i=0; i<entity_capacity(SI_BASE); i++) if(bases[i].active) b_active++;
+        for(int i=0; i<entity_capacity(SI_PLANET); i++) if(planets[i].active) p_active++;
+        for(int i=0; i<entity_capacity(SI_BH); i++) if(black_holes[i].active) bh_active++;
+        for(int i=0; i<entity_capacity(SI_NEBULA); i++) if(nebulas[i].active) neb_active++;
+        for(int i=0; i<entity_capacity(SI_PULSAR); i++) if(pulsars[i].active) pul_active++;
+        for(int i=0; i<entity_capacity(SI_COMET); i++) if(comets[i].active) com_active++;
+        for(int i=0; i<entity_capacity(SI_ASTEROID); i++) if(asteroids[i].active) ast_active++;
+        for(int i=0; i<entity_capacity(SI_DERELICT); i++) if(derelicts[i].active) der_active++;
+        for(int i=0; i<entity_capacity(SI_MINE); i++) if(mines[i].active) mine_active++;
+        for(int i=0; i<entity_capacity(SI_BUOY); i++) if(buoys[i].active) buoy_active++;
+        for(int i=0; i<entity_capacity(SI_PLATFORM); i++) if(platforms[i].active) plat_active++;
+        for(int i=0; i<entity_capacity(SI_RIFT); i++) if(rifts[i].active) rift_active++;
+        for(int i=0; i<entity_capacity(SI_MONSTER); i++) if(monsters[i].active) mon_active++;
 
         printf("--- Galaxy Statistics ---\n");
         printf("Version: %d\n", version);
+        printf("Dimensions: %dx%dx%d quadrants\n", galaxy_q, galaxy_q, galaxy_q);
         if (galaxy_master.encryption_flags & 0x01) {
             printf("Signature: VERIFIED (HMAC-SHA256)\n");
             printf("Encryption Flags: 0x%08X\n", galaxy_master.encryption_flags);
@@ -160,16 +166,18 @@ int main(int argc, char *argv[]) {
     } 
     else if (strcmp(argv[1], "map") == 0 && argc == 3) {
         int q3 = atoi(argv[2]);
-        if (q3 < 1 || q3 > 10) {
-            printf("Invalid Z quadrant (1-10)\n");
+        if (q3 < 1 || q3 > galaxy_q) {
+            printf("Invalid Z quadrant (1-%d)\n", galaxy_q);
             return 1;
         }
         printf("--- Galaxy Map Slice (Z=%d) ---\n", q3);
-        printf("    1  2  3  4  5  6  7  8  9  10 (X)\n");
-        for(int j=1; j<=10; j++) {
+        printf("   ");
+        for(int i=1; i<=galaxy_q; i++) printf("%2d ", i);
+        printf("(X)\n");
+        for(int j=1; j<=galaxy_q; j++) {
             printf("%2d ", j);
-            for(int i=1; i<=10; i++) {
-                long long bpnbs = galaxy_master.g[i][j][q3];
+            for(int i=1; i<=galaxy_q; i++) {
+                long long bpnbs = GALAXY_MAP(i, j, q3);
                 int mon  = (bpnbs/10000000000000000LL)%10;
                 int rift = (bpnbs/100000000000000LL)%10;
                 int plat = (bpnbs/10000000000000LL)%10;
@@ -204,58 +212,58 @@ int main(int argc, char *argv[]) {
         int q3 = atoi(argv[4]);
         
         if (!IS_Q_VALID(q1, q2, q3)) {
-            printf("Invalid quadrant coordinates (1-10)\n");
+            printf("Invalid quadrant coordinates (1-%d)\n", galaxy_q);
             return 1;
         }
 
         printf("--- Objects in Quadrant [%d,%d,%d] ---\n", q1, q2, q3);
         
-        long long bpnbs = galaxy_master.g[q1][q2][q3];
+        long long bpnbs = GALAXY_MAP(q1, q2, q3);
         printf("BPNBS Encoding: %017lld\n", bpnbs);
 
-        for(int i=0; i<MAX_NPC; i++) if(npcs[i].active && npcs[i].q1 == q1 && npcs[i].q2 == q2 && npcs[i].q3 == q3)
-            printf("[NPC] ID:%d Faction:%s Coord:%.1f,%.1f,%.1f Energy:%d AI:%d %s\n", npcs[i].id+1000, get_faction_name(npcs[i].faction), npcs[i].x, npcs[i].y, npcs[i].z, npcs[i].energy, npcs[i].ai_state, npcs[i].is_cloaked ? "[CLOAKED]" : "");
+        for(int i=0; i<entity_capacity(SI_NPC); i++) if(npc_hot.active[i] && npc_hot.q1[i] == q1 && npc_hot.q2[i] == q2 && npc_hot.q3[i] == q3)
+            printf("[NPC] ID:%d Faction:%s Coord:%.1f,%.1f,%.1f Energy:%d AI:%d %s\n", npcs[i].id+1000, get_faction_name(npcs[i].faction), npc_hot.x[i], npc_hot.y[i], npc_hot.z[i], npc_hot.energy[i], npc_hot.ai_state[i], npcs[i].is_cloaked ? "[CLOAKED]" : "");
 
-        for(int i=0; i<MAX_MONSTERS; i++) if(monsters[i].active && monsters[i].q1 == q1 && monsters[i].q2 == q2 && monsters[i].q3 == q3)
+        for(int i=0; i<entity_capacity(SI_MONSTER); i++) if(monsters[i].active && monsters[i].q1 == q1 && monsters[i].q2 == q2 && monsters[i].q3 == q3)
             printf("[MONSTER] ID:%d Type:%s Coord:%.1f,%.1f,%.1f Health:%d\n", monsters[i].id+18000, get_faction_name(monsters[i].type), monsters[i].x, monsters[i].y, monsters[i].z, monsters[i].health);
 
-        for(int i=0; i<MAX_BASES; i++) if(bases[i].active && bases[i].q1 == q1 && bases[i].q2 == q2 && bases[i].q3 == q3)
+        for(int i=0; i<entity_capacity(SI_BASE); i++) if(bases[i].active && bases[i].q1 == q1 && bases[i].q2 == q2 && bases[i].q3 == q3)
             printf("[BASE] ID:%d Faction:%s Coord:%.1f,%.1f,%.1f Health:%d\n", bases[i].id+2000, get_faction_name(bases[i].faction), bases[i].x, bases[i].y, bases[i].z, bases[i].health);
 
-        for(int i=0; i<MAX_PLANETS; i++) if(planets[i].active && planets[i].q1 == q1 && planets[i].q2 == q2 && planets[i].q3 == q3)
+        for(int i=0; i<entity_capacity(SI_PLANET); i++) if(planets[i].active && planets[i].q1 == q1 && planets[i].q2 == q2 && planets[i].q3 == q3)
             printf("[PLANET] ID:%d Type:%d Coord:%.1f,%.1f,%.1f Resources:%d\n", planets[i].id+3000, planets[i].resource_type, planets[i].x, planets[i].y, planets[i].z, planets[i].amount);
 
-        for(int i=0; i<MAX_STARS; i++) if(stars_data[i].active && stars_data[i].q1 == q1 && stars_data[i].q2 == q2 && stars_data[i].q3 == q3)
+        for(int i=0; i<entity_capacity(SI_STAR); i++) if(stars_data[i].active && stars_data[i].q1 == q1 && stars_data[i].q2 == q2 && stars_data[i].q3 == q3)
             printf("[STAR] ID:%d Coord:%.1f,%.1f,%.1f\n", stars_data[i].id+4000, stars_data[i].x, stars_data[i].y, stars_data[i].z);
 
-        for(int i=0; i<MAX_BH; i++) if(black_holes[i].active && black_holes[i].q1 == q1 && black_holes[i].q2 == q2 && black_holes[i].q3 == q3)
+        for(int i=0; i<entity_capacity(SI_BH); i++) if(black_holes[i].active && black_holes[i].q1 == q1 && black_holes[i].q2 == q2 && black_holes[i].q3 == q3)
             printf("[BLACK HOLE] ID:%d Coord:%.1f,%.1f,%.1f\n", black_holes[i].id+7000, black_holes[i].x, black_holes[i].y, black_holes[i].z);
 
-        for(int i=0; i<MAX_NEBULAS; i++) if(nebulas[i].active && nebulas[i].q1 == q1 && nebulas[i].q2 == q2 && nebulas[i].q3 == q3)
+        for(int i=0; i<entity_capacity(SI_NEBULA); i++) if(nebulas[i].active && nebulas[i].q1 == q1 && nebulas[i].q2 == q2 && nebulas[i].q3 == q3)
             printf("[NEBULA] ID:%d Coord:%.1f,%.1f,%.1f\n", nebulas[i].id+8000, nebulas[i].x, nebulas[i].y, nebulas[i].z);
 
-        for(int i=0; i<MAX_PULSARS; i++) if(pulsars[i].active && pulsars[i].q1 == q1 && pulsars[i].q2 == q2 && pulsars[i].q3 == q3)
+        for(int i=0; i<entity_capacity(SI_PULSAR); i++) if(pulsars[i].active && pulsars[i].q1 == q1 && pulsars[i].q2 == q2 && pulsars[i].q3 == q3)
             printf("[PULSAR] ID:%d Coord:%.1f,%.1f,%.1f\n", pulsars[i].id+9000, pulsars[i].x, pulsars[i].y, pulsars[i].z);
 
-        for(int i=0; i<MAX_COMETS; i++) if(comets[i].active && comets[i].q1 == q1 && comets[i].q2 == q2 && comets[i].q3 == q3)
+        for(int i=0; i<entity_capacity(SI_COMET); i++) if(comets[i].active && comets[i].q1 == q1 && comets[i].q2 == q2 && comets[i].q3 == q3)
             printf("[COMET] ID:%d Coord:%.1f,%.1f,%.1f Angle:%.3f Speed:%.3f\n", comets[i].id+10000, comets[i].x, comets[i].y, comets[i].z, comets[i].angle, comets[i].speed);
 
-        for(int i=0; i<MAX_ASTEROIDS; i++) if(asteroids[i].active && asteroids[i].q1 == q1 && asteroids[i].q2 == q2 && asteroids[i].q3 == q3)
+        for(int i=0; i<entity_capacity(SI_ASTEROID); i++) if(asteroids[i].active && asteroids[i].q1 == q1 && asteroids[i].q2 == q2 && asteroids[i].q3 == q3)
             printf("[ASTEROID] ID:%d Coord:%.1f,%.1f,%.1f Size:%.2f\n", asteroids[i].id+12000, asteroids[i].x, asteroids[i].y, asteroids[i].z, asteroids[i].size);
 
-        for(int i=0; i<MAX_DERELICTS; i++) if(derelicts[i].active && derelicts[i].q1 == q1 && derelicts[i].q2 == q2 && derelicts[i].q3 == q3)
+        for(int i=0; i<entity_capacity(SI_DERELICT); i++) if(derelicts[i].active && derelicts[i].q1 == q1 && derelicts[i].q2 == q2 && derelicts[i].q3 == q3)
             printf("[DERELICT] ID:%d Coord:%.1f,%.1f,%.1f Class:%d\n", derelicts[i].id+11000, derelicts[i].x, derelicts[i].y, derelicts[i].z, derelicts[i].ship_class);
 
-        for(int i=0; i<MAX_MINES; i++) if(mines[i].active && mines[i].q1 == q1 && mines[i].q2 == q2 && mines[i].q3 == q3)
+        for(int i=0; i<entity_capacity(SI_MINE); i++) if(mines[i].active && mines[i].q1 == q1 && mines[i].q2 == q2 && mines[i].q3 == q3)
             printf("[MINE] ID:%d Faction:%s Coord:%.1f,%.1f,%.1f\n", mines[i].id+14000, get_faction_name(mines[i].faction), mines[i].x, mines[i].y, mines[i].z);
 
-        for(int i=0; i<MAX_BUOYS; i++) if(buoys[i].active && buoys[i].q1 == q1 && buoys[i].q2 == q2 && buoys[i].q3 == q3)
+        for(int i=0; i<entity_capacity(SI_BUOY); i++) if(buoys[i].active && buoys[i].q1 == q1 && buoys[i].q2 == q2 && buoys[i].q3 == q3)
             printf("[BUOY] ID:%d Coord:%.1f,%.1f,%.1f\n", buoys[i].id+15000, buoys[i].x, buoys[i].y, buoys[i].z);
 
-        for(int i=0; i<MAX_PLATFORMS; i++) if(platforms[i].active && platforms[i].q1 == q1 && platforms[i].q2 == q2 && platforms[i].q3 == q3)
+        for(int i=0; i<entity_capacity(SI_PLATFORM); i++) if(platforms[i].active && platforms[i].q1 == q1 && platforms[i].q2 == q2 && platforms[i].q3 == q3)
             printf("[PLATFORM] ID:%d Faction:%s Coord:%.1f,%.1f,%.1f Health:%d Energy:%d\n", platforms[i].id+16000, get_faction_name(platforms[i].faction), platforms[i].x, platforms[i].y, platforms[i].z, platforms[i].health, platforms[i].energy);
 
-        for(int i=0; i<MAX_RIFTS; i++) if(rifts[i].active && rifts[i].q1 == q1 && rifts[i].q2 == q2 && rifts[i].q3 == q3)
+        for(int i=0; i<entity_capacity(SI_RIFT); i++) if(rifts[i].active && rifts[i].q1 == q1 && rifts[i].q2 == q2 && rifts[i].q3 == q3)
             printf("[RIFT] ID:%d Coord:%.1f,%.1f,%.1f\n", rifts[i].id+17000, rifts[i].x, rifts[i].y, rifts[i].z);
     }
     else if (strcmp(argv[1], "players") == 0) {
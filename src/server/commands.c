@@ -9,21 +9,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <time.h>
 #include <sys/socket.h>
 #include "server_internal.h"
 #include "ui.h"
 
-/* Helper macro to safely append to a buffer with length check (used in handle_srs) */
-#define SAFE_APPEND(buffer, max_len, format, ...) do { \
-    size_t _cur_len = strlen(buffer); \
-    if (_cur_len < (max_len)) { \
-        snprintf((buffer) + _cur_len, (max_len) - _cur_len, format, ##__VA_ARGS__); \
-    } \
-} while(0)
-
 /* Helper to get sensor error based on system health */
-static double get_sensor_error(int p_idx) {
-    float health = players[p_idx].state.system_health[2];
+static double get_sensor_error(float health) {
     if (health >= 100.0f) return 0.0;
     /* Noise increases exponentially as health drops */
     double noise_factor = pow(1.0 - (health / 100.0), 2.0);
@@ -32,6 +24,8 @@ static double get_sensor_error(int p_idx) {
 
 /* Type definition for command handlers */
 typedef void (*CommandHandler)(int p_idx, const char *params);
+/* Read-only reports: served from the published world snapshot without game_mutex */
+typedef void (*ViewHandler)(int p_idx, const WorldSnapshot *w, const char *params);
 
 void handle_help(int p_idx, const char *params);
 
@@ -39,6 +33,7 @@ typedef struct {
     const char *name;
     CommandHandler handler;
     const char *description;
+    ViewHandler view;
 } CommandDef;
 
 void normalize_upright(double *h, double *m) {
@@ -49,6 +44,12 @@ void normalize_upright(double *h, double *m) {
     else if (*m < -90.0) { *m = -180.0 - *m; *h = fmod(*h + 180.0, 360.0); }
 }
 
+/* The captain's own lock is followed by handle: once its id is reused, it names nothing */
+static bool target_ref(int i, int tid, EntityRef *t) {
+    if (tid == players[i].state.lock_target) return entity_resolve(tid, players[i].lock_gen, t);
+    return entity_lookup(tid, t);
+}
+
 /* --- Command Handlers --- */
 
 void handle_enc(int i, const char *params) {
@@ -95,6 +96,8 @@ void handle_enc(int i, const char *params) {
     } else {
         send_server_msg(i, "COMPUTER", "Usage: enc aes | chacha | aria | camellia | seed | cast | idea | 3des | bf | rc4 | des | pqc | off");
     }
+    /* Key schedule for the new algorithm runs now on the crypto pool, not on the first message */
+    crypto_pool_prepare(i);
 }
 
 void handle_pow(int i, const char *params) {
@@ -200,133 +203,11 @@ void handle_apr(int i, const char *params) {
         double tx, ty, tz; bool found = false;
         int pq1 = players[i].state.q1, pq2 = players[i].state.q2, pq3 = players[i].state.q3;
         
-        /* 1. Players (Global) */
-        if (tid >= 1 && tid <= 32) {
-            int idx = tid - 1;
-            if (players[idx].active) {
-                tx = players[idx].gx; ty = players[idx].gy; tz = players[idx].gz;
-                found = true;
-            }
-        }
-        /* 2. NPCs (Global) */
-        else if (tid >= 1000 && tid < 1000+MAX_NPC) {
-            int idx = tid - 1000;
-            if (npcs[idx].active) {
-                tx = npcs[idx].gx; ty = npcs[idx].gy; tz = npcs[idx].gz;
-                found = true;
-            }
-        }
-        /* 3. Starbases (Local) */
-        else if (tid >= 2000 && tid < 2000+MAX_BASES) {
-            int idx = tid - 2000;
-            if (bases[idx].active && bases[idx].q1==pq1 && bases[idx].q2==pq2 && bases[idx].q3==pq3) {
-                tx = (bases[idx].q1-1)*10+bases[idx].x; ty = (bases[idx].q2-1)*10+bases[idx].y; tz = (bases[idx].q3-1)*10+bases[idx].z;
-                found = true;
-            }
-        }
-        /* 4. Planets (Local) */
-        else if (tid >= 3000 && tid < 3000+MAX_PLANETS) {
-            int idx = tid - 3000;
-            if (planets[idx].active && planets[idx].q1==pq1 && planets[idx].q2==pq2 && planets[idx].q3==pq3) {
-                tx = (planets[idx].q1-1)*10+planets[idx].x; ty = (planets[idx].q2-1)*10+planets[idx].y; tz = (planets[idx].q3-1)*10+planets[idx].z;
-                found = true;
-            }
-        }
-        /* 5. Stars (Local) */
-        else if (tid >= 4000 && tid < 4000+MAX_STARS) {
-            int idx = tid - 4000;
-            if (stars_data[idx].active && stars_data[idx].q1==pq1 && stars_data[idx].q2==pq2 && stars_data[idx].q3==pq3) {
-                tx = (stars_data[idx].q1-1)*10+stars_data[idx].x; ty = (stars_data[idx].q2-1)*10+stars_data[idx].y; tz = (stars_data[idx].q3-1)*10+stars_data[idx].z;
-                found = true;
-            }
-        }
-        /* 6. Black Holes (Local) */
-        else if (tid >= 7000 && tid < 7000+MAX_BH) {
-            int idx = tid - 7000;
-            if (black_holes[idx].active && black_holes[idx].q1==pq1 && black_holes[idx].q2==pq2 && black_holes[idx].q3==pq3) {
-                tx = (black_holes[idx].q1-1)*10+black_holes[idx].x; ty = (black_holes[idx].q2-1)*10+black_holes[idx].y; tz = (black_holes[idx].q3-1)*10+black_holes[idx].z;
-                found = true;
-            }
-        }
-        /* 7. Comets (Global) */
-        else if (tid >= 10000 && tid < 10000+MAX_COMETS) {
-            int idx = tid - 10000;
-            if (comets[idx].active) {
-                tx = (comets[idx].q1-1)*10+comets[idx].x; ty = (comets[idx].q2-1)*10+comets[idx].y; tz = (comets[idx].q3-1)*10+comets[idx].z;
-                found = true;
-            }
-        }
-        /* 8. Monsters (Global) */
-        else if (tid >= 18000 && tid < 18000+MAX_MONSTERS) {
-            int idx = tid - 18000;
-            if (monsters[idx].active) {
-                tx = (monsters[idx].q1-1)*10+monsters[idx].x; ty = (monsters[idx].q2-1)*10+monsters[idx].y; tz = (monsters[idx].q3-1)*10+monsters[idx].z;
-                found = true;
-            }
-        }
-        /* 9. Nebulas (Local) */
-        else if (tid >= 8000 && tid < 8000+MAX_NEBULAS) {
-            int idx = tid - 8000;
-            if (nebulas[idx].active && nebulas[idx].q1==pq1 && nebulas[idx].q2==pq2 && nebulas[idx].q3==pq3) {
-                tx = (nebulas[idx].q1-1)*10+nebulas[idx].x; ty = (nebulas[idx].q2-1)*10+nebulas[idx].y; tz = (nebulas[idx].q3-1)*10+nebulas[idx].z;
-                found = true;
-            }
-        }
-        /* 10. Pulsars (Local) */
-        else if (tid >= 9000 && tid < 9000+MAX_PULSARS) {
-            int idx = tid - 9000;
-            if (pulsars[idx].active && pulsars[idx].q1==pq1 && pulsars[idx].q2==pq2 && pulsars[idx].q3==pq3) {
-                tx = (pulsars[idx].q1-1)*10+pulsars[idx].x; ty = (pulsars[idx].q2-1)*10+pulsars[idx].y; tz = (pulsars[idx].q3-1)*10+pulsars[idx].z;
-                found = true;
-            }
-        }
-        /* 11. Derelicts (Local) */
-        else if (tid >= 11000 && tid < 11000+MAX_DERELICTS) {
-            int idx = tid - 11000;
-            if (derelicts[idx].active && derelicts[idx].q1==pq1 && derelicts[idx].q2==pq2 && derelicts[idx].q3==pq3) {
-                tx = (derelicts[idx].q1-1)*10+derelicts[idx].x; ty = (derelicts[idx].q2-1)*10+derelicts[idx].y; tz = (derelicts[idx].q3-1)*10+derelicts[idx].z;
-                found = true;
-            }
-        }
-        /* 12. Asteroids (Local) */
-        else if (tid >= 12000 && tid < 12000+MAX_ASTEROIDS) {
-            int idx = tid - 12000;
-            if (asteroids[idx].active && asteroids[idx].q1==pq1 && asteroids[idx].q2==pq2 && asteroids[idx].q3==pq3) {
-                tx = (asteroids[idx].q1-1)*10+asteroids[idx].x; ty = (asteroids[idx].q2-1)*10+asteroids[idx].y; tz = (asteroids[idx].q3-1)*10+asteroids[idx].z;
-                found = true;
-            }
-        }
-        /* 13. Mines (Local) */
-        else if (tid >= 14000 && tid < 14000+MAX_MINES) {
-            int idx = tid - 14000;
-            if (mines[idx].active && mines[idx].q1==pq1 && mines[idx].q2==pq2 && mines[idx].q3==pq3) {
-                tx = (mines[idx].q1-1)*10+mines[idx].x; ty = (mines[idx].q2-1)*10+mines[idx].y; tz = (mines[idx].q3-1)*10+mines[idx].z;
-                found = true;
-            }
-        }
-        /* 14. Buoys (Local) */
-        else if (tid >= 15000 && tid < 15000+MAX_BUOYS) {
-            int idx = tid - 15000;
-            if (buoys[idx].active && buoys[idx].q1==pq1 && buoys[idx].q2==pq2 && buoys[idx].q3==pq3) {
-                tx = (buoys[idx].q1-1)*10+buoys[idx].x; ty = (buoys[idx].q2-1)*10+buoys[idx].y; tz = (buoys[idx].q3-1)*10+buoys[idx].z;
-                found = true;
-            }
-        }
-        /* 15. Platforms (Local) */
-        else if (tid >= 16000 && tid < 16000+MAX_PLATFORMS) {
-            int idx = tid - 16000;
-            if (platforms[idx].active && platforms[idx].q1==pq1 && platforms[idx].q2==pq2 && platforms[idx].q3==pq3) {
-                tx = (platforms[idx].q1-1)*10+platforms[idx].x; ty = (platforms[idx].q2-1)*10+platforms[idx].y; tz = (platforms[idx].q3-1)*10+platforms[idx].z;
-                found = true;
-            }
-        }
-        /* 16. Rifts (Local) */
-        else if (tid >= 17000 && tid < 17000+MAX_RIFTS) {
-            int idx = tid - 17000;
-            if (rifts[idx].active && rifts[idx].q1==pq1 && rifts[idx].q2==pq2 && rifts[idx].q3==pq3) {
-                tx = (rifts[idx].q1-1)*10+rifts[idx].x; ty = (rifts[idx].q2-1)*10+rifts[idx].y; tz = (rifts[idx].q3-1)*10+rifts[idx].z;
-                found = true;
-            }
+        /* Roaming bodies are reached anywhere, fixed ones only in this quadrant */
+        EntityRef t;
+        if (target_ref(i, tid, &t) && ((t.flags & ENT_ROAMS) || entity_in_quadrant(&t, pq1, pq2, pq3))) {
+            tx = t.gx; ty = t.gy; tz = t.gz;
+            found = true;
         }
 
         if(found) {
@@ -358,351 +239,188 @@ void handle_cha(int i, const char *params) {
     }
 }
 
-void handle_srs(int i, const char *params) {
-    char *b = calloc(LARGE_DATA_BUFFER, sizeof(char));
-    if (!b) return;
-
-    int q1=players[i].state.q1, q2=players[i].state.q2, q3=players[i].state.q3; 
-    double s1=players[i].state.s1, s2=players[i].state.s2, s3=players[i].state.s3;
-
-    snprintf(b, LARGE_DATA_BUFFER, CYAN "\n--- SHORT RANGE SENSOR ANALYSIS ---" RESET "\nQUADRANT: [%d,%d,%d] | SECTOR: [%.1f,%.1f,%.1f]\n", q1, q2, q3, s1, s2, s3);
-    snprintf(b+strlen(b), LARGE_DATA_BUFFER-strlen(b), "ENERGY: %d | TORPEDOES: %d | STATUS: %s\n", players[i].state.energy, players[i].state.torpedoes, players[i].state.is_cloaked ? MAGENTA "CLOAKED" RESET : GREEN "NORMAL" RESET);
-    strncat(b, "\nTYPE       ID    POSITION      DIST   H / M         DETAILS\n", LARGE_DATA_BUFFER-strlen(b)-1);
-
-    QuadrantIndex *local_q = &spatial_index[q1][q2][q3];
-    int locked_id = players[i].state.lock_target;
-    bool chasing = (players[i].nav_state == NAV_STATE_CHASE);
-    float sensor_h = players[i].state.system_health[2];
-
-    /* 1. Players */
-    for(int j=0; j<local_q->player_count; j++) {
-        ConnectedPlayer *p = local_q->players[j]; if (p == &players[i] || p->state.is_cloaked) continue;
-        
-        /* Chance to miss object if sensors are very damaged */
-        if (sensor_h < 30.0f && (rand()%100 > sensor_h + 50)) continue;
-
-        double dx=p->state.s1-s1 + get_sensor_error(i), dy=p->state.s2-s2 + get_sensor_error(i), dz=p->state.s3-s3 + get_sensor_error(i); 
-        double d=sqrt(dx*dx+dy*dy+dz*dz); double h=atan2(dx,-dy)*180/M_PI; if(h<0)h+=360; double m=asin(dz/d)*180/M_PI;
-        int pid = (int)(p-players)+1;
-        char status[64] = "";
-        if (pid == locked_id) { strcat(status, RED "[LOCKED]" RESET); if(chasing) strcat(status, B_RED "[CHASE]" RESET); }
-        SAFE_APPEND(b, LARGE_DATA_BUFFER, "%-10s %-5d [%.1f,%.1f,%.1f] %-5.1f %03.0f / %+03.0f     %s (Player) [E:%d] %s\n", "Vessel", pid, p->state.s1 + get_sensor_error(i), p->state.s2 + get_sensor_error(i), p->state.s3 + get_sensor_error(i), d, h, m, p->name, p->state.energy, status);
-    }
-
-    /* 2. NPC Ships */
-    for(int n=0; n<local_q->npc_count; n++) {
-        NPCShip *npc = local_q->npcs[n];
-        if (sensor_h < 30.0f && (rand()%100 > sensor_h + 50)) continue;
-
-        double dx=npc->x-s1 + get_sensor_error(i), dy=npc->y-s2 + get_sensor_error(i), dz=npc->z-s3 + get_sensor_error(i); 
-        double d=sqrt(dx*dx+dy*dy+dz*dz); double h=atan2(dx,-dy)*180/M_PI; if(h<0)h+=360; double m=asin(dz/d)*180/M_PI;
-        int nid = npc->id+1000;
-        char status[64] = "";
-        if (nid == locked_id) { strcat(status, RED "[LOCKED]" RESET); if(chasing) strcat(status, B_RED "[CHASE]" RESET); }
-        SAFE_APPEND(b, LARGE_DATA_BUFFER, "%-10s %-5d [%.1f,%.1f,%.1f] %-5.1f %03.0f / %+03.0f     %s [E:%d] [Engines:%.0f%%] %s\n", "Vessel", nid, npc->x + get_sensor_error(i), npc->y + get_sensor_error(i), npc->z + get_sensor_error(i), d, h, m, get_species_name(npc->faction), npc->energy, npc->engine_health, status);
-    }
-
-    /* 3. Starbases */
-    for(int b_idx=0; b_idx<local_q->base_count; b_idx++) {
-        NPCBase *ba = local_q->bases[b_idx];
-        double dx=ba->x-s1, dy=ba->y-s2, dz=ba->z-s3; double d=sqrt(dx*dx+dy*dy+dz*dz); double h=atan2(dx,-dy)*180/M_PI; if(h<0)h+=360; double m=(d>0.001)?asin(dz/d)*180/M_PI:0;
-        int baid = ba->id+2000;
-        char status[64] = "";
-        if (baid == locked_id) { strcat(status, RED "[LOCKED]" RESET); if(chasing) strcat(status, B_RED "[CHASE]" RESET); }
-        SAFE_APPEND(b, LARGE_DATA_BUFFER, "%-10s %-5d [%.1f,%.1f,%.1f] %-5.1f %03.0f / %+03.0f     Federation Starbase %s\n", "Starbase", baid, ba->x, ba->y, ba->z, d, h, m, status);
-    }
-
-    /* 4. Planets */
-    for(int p_idx=0; p_idx<local_q->planet_count; p_idx++) {
-        NPCPlanet *pl = local_q->planets[p_idx];
-        double dx=pl->x-s1, dy=pl->y-s2, dz=pl->z-s3; double d=sqrt(dx*dx+dy*dy+dz*dz); double h=atan2(dx,-dy)*180/M_PI; if(h<0)h+=360; double m=(d>0.001)?asin(dz/d)*180/M_PI:0;
-        int plid = pl->id+3000;
-        char status[64] = ""; if (plid == locked_id) strcat(status, RED "[LOCKED]" RESET);
-        SAFE_APPEND(b, LARGE_DATA_BUFFER, "%-10s %-5d [%.1f,%.1f,%.1f] %-5.1f %03.0f / %+03.0f     Class-M Planet %s\n", "Planet", plid, pl->x, pl->y, pl->z, d, h, m, status);
-    }
-
-    /* 5. Stars */
-    for(int s_idx=0; s_idx<local_q->star_count; s_idx++) {
-        NPCStar *st = local_q->stars[s_idx];
-        double dx=st->x-s1, dy=st->y-s2, dz=st->z-s3; double d=sqrt(dx*dx+dy*dy+dz*dz); double h=atan2(dx,-dy)*180/M_PI; if(h<0)h+=360; double m=(d>0.001)?asin(dz/d)*180/M_PI:0;
-        int sid = st->id+4000;
-        char status[64] = ""; if (sid == locked_id) strcat(status, RED "[LOCKED]" RESET);
-        SAFE_APPEND(b, LARGE_DATA_BUFFER, "%-10s %-5d [%.1f,%.1f,%.1f] %-5.1f %03.0f / %+03.0f     Star %s\n", "Star", sid, st->x, st->y, st->z, d, h, m, status);
-    }
-
-    /* 6. Black Holes */
-    for(int h_idx=0; h_idx<local_q->bh_count; h_idx++) {
-        NPCBlackHole *bh = local_q->black_holes[h_idx];
-        double dx=bh->x-s1, dy=bh->y-s2, dz=bh->z-s3; double d=sqrt(dx*dx+dy*dy+dz*dz); double hh=atan2(dx,-dy)*180/M_PI; if(hh<0)hh+=360; double m=(d>0.001)?asin(dz/d)*180/M_PI:0;
-        int bid = bh->id+7000;
-        char status[64] = ""; if (bid == locked_id) strcat(status, RED "[LOCKED]" RESET);
-        SAFE_APPEND(b, LARGE_DATA_BUFFER, "%-10s %-5d [%.1f,%.1f,%.1f] %-5.1f %03.0f / %+03.0f     Black Hole (Grav Pull) %s\n", "B-Hole", bid, bh->x, bh->y, bh->z, d, hh, m, status);
-    }
-
-    /* 7. Nebulas */
-    for(int n_idx=0; n_idx<local_q->nebula_count; n_idx++) {
-        NPCNebula *nb = local_q->nebulas[n_idx];
-        double dx=nb->x-s1, dy=nb->y-s2, dz=nb->z-s3; double d=sqrt(dx*dx+dy*dy+dz*dz); double h=atan2(dx,-dy)*180/M_PI; if(h<0)h+=360; double m=(d>0.001)?asin(dz/d)*180/M_PI:0;
-        int nid = nb->id+8000;
-        char status[64] = ""; if (nid == locked_id) strcat(status, RED "[LOCKED]" RESET);
-        SAFE_APPEND(b, LARGE_DATA_BUFFER, "%-10s %-5d [%.1f,%.1f,%.1f] %-5.1f %03.0f / %+03.0f     Mutara Nebula %s\n", "Nebula", nid, nb->x, nb->y, nb->z, d, h, m, status);
-    }
+/* --- Sensor Sweeps --- */
 
-    /* 8. Pulsars */
-    for (int p_idx=0; p_idx<local_q->pulsar_count; p_idx++) {
-        NPCPulsar *pu = local_q->pulsars[p_idx];
-        double dx=pu->x-s1, dy=pu->y-s2, dz=pu->z-s3; double d=sqrt(dx*dx+dy*dy+dz*dz); double h=atan2(dx,-dy)*180/M_PI; if(h<0)h+=360; double m=(d>0.001)?asin(dz/d)*180/M_PI:0;
-        int puid = pu->id+9000;
-        char status[64] = ""; if (puid == locked_id) strcat(status, RED "[LOCKED]" RESET);
-        SAFE_APPEND(b, LARGE_DATA_BUFFER, "%-10s %-5d [%.1f,%.1f,%.1f] %-5.1f %03.0f / %+03.0f     Pulsar (Radiation) %s\n", "Pulsar", puid, pu->x, pu->y, pu->z, d, h, m, status);
-    }
-
-    /* 9. Comets */
-    for (int c_idx=0; c_idx<local_q->comet_count; c_idx++) {
-        NPCComet *co = local_q->comets[c_idx];
-        double dx=co->x-s1, dy=co->y-s2, dz=co->z-s3; double d=sqrt(dx*dx+dy*dy+dz*dz); double h=atan2(dx,-dy)*180/M_PI; if(h<0)h+=360; double m=(d>0.001)?asin(dz/d)*180/M_PI:0;
-        int cid = co->id+10000;
-        char status[64] = ""; if (cid == locked_id) strcat(status, RED "[LOCKED]" RESET);
-        SAFE_APPEND(b, LARGE_DATA_BUFFER, "%-10s %-5d [%.1f,%.1f,%.1f] %-5.1f %03.0f / %+03.0f     Comet (Energy Source) %s\n", "Comet", cid, co->x, co->y, co->z, d, h, m, status);
-    }
+/* Contacts and the captain names they reference, packed into a PacketSensor on send */
+typedef struct {
+    const WorldSnapshot *w;
+    const PlayerView *me;
+    NetSensorContact contacts[MAX_SENSOR_CONTACTS];
+    int count;
+    int omitted;    /* Contacts that did not fit contacts[] */
+    NetSensorName names[MAX_CLIENTS];
+    int name_count;
+    uint32_t named; /* Slots already present in names[] */
+} SensorSweep;
+
+/* Report buffers come from the caller's arena: read-only commands may run on several threads */
+static PacketSensor *new_sensor_packet(void) {
+    PacketSensor *pkt = arena_alloc(sizeof(PacketSensor));
+    if (pkt) pkt->omitted = 0;
+    return pkt;
+}
 
-    /* 10. Asteroids */
-    for (int a_idx = 0; a_idx < local_q->asteroid_count; a_idx++) {
-        NPCAsteroid *as = local_q->asteroids[a_idx];
-        double dx=as->x-s1, dy=as->y-s2, dz=as->z-s3; double d=sqrt(dx*dx+dy*dy+dz*dz); double h=atan2(dx,-dy)*180/M_PI; if(h<0)h+=360; double m=(d>0.001)?asin(dz/d)*180/M_PI:0;
-        int aid = as->id+12000;
-        char status[64] = ""; if (aid == locked_id) strcat(status, RED "[LOCKED]" RESET);
-        SAFE_APPEND(b, LARGE_DATA_BUFFER, "%-10s %-5d [%.1f,%.1f,%.1f] %-5.1f %03.0f / %+03.0f     Asteroid (Hazard) %s\n", "Asteroid", aid, as->x, as->y, as->z, d, h, m, status);
-    }
+static void sweep_name(SensorSweep *sw, int slot) {
+    if (slot < 0 || slot >= MAX_CLIENTS || (sw->named & (1u << slot))) return;
+    sw->named |= (1u << slot);
+    NetSensorName *n = &sw->names[sw->name_count++];
+    n->slot = (int16_t)slot;
+    memcpy(n->name, sw->w->players[slot].name, sizeof(n->name));
+}
 
-    /* 11. Monsters */
-    for (int m_idx = 0; m_idx < local_q->monster_count; m_idx++) {
-        NPCMonster *mo = local_q->monsters[m_idx];
-        double dx=mo->x-s1, dy=mo->y-s2, dz=mo->z-s3; double d=sqrt(dx*dx+dy*dy+dz*dz); double h=atan2(dx,-dy)*180/M_PI; if(h<0)h+=360; double m=(d>0.001)?asin(dz/d)*180/M_PI:0;
-        int moid = mo->id+18000;
-        char status[64] = ""; if (moid == locked_id) strcat(status, RED "[LOCKED]" RESET);
-        SAFE_APPEND(b, LARGE_DATA_BUFFER, "%-10s %-5d [%.1f,%.1f,%.1f] %-5.1f %03.0f / %+03.0f     %s %s\n", "Monster", moid, mo->x, mo->y, mo->z, d, h, m, (mo->type==30)?"Crystalline Entity":"Space Amoeba", status);
+/* Noise is applied once to the position; distance and bearing are derived from the noisy fix */
+static NetSensorContact *sweep_add(SensorSweep *sw, int kind, int id, double x, double y, double z, bool noisy) {
+    const PlayerView *me = sw->me;
+    if (sw->count >= MAX_SENSOR_CONTACTS) { sw->omitted++; return NULL; }
+    if (noisy) {
+        float h = me->system_health[2];
+        x += get_sensor_error(h); y += get_sensor_error(h); z += get_sensor_error(h);
     }
 
-    /* 12. Subspace Probes (Global) */
-    for (int p_j = 0; p_j < MAX_CLIENTS; p_j++) {
-        if (!players[p_j].socket) continue;
-        for (int pr = 0; pr < 3; pr++) {
-            if (players[p_j].state.probes[pr].active) {
-                int pr_q1 = get_q_from_g(players[p_j].state.probes[pr].gx);
-                int pr_q2 = get_q_from_g(players[p_j].state.probes[pr].gy);
-                int pr_q3 = get_q_from_g(players[p_j].state.probes[pr].gz);
-                
-                if (pr_q1 == q1 && pr_q2 == q2 && pr_q3 == q3) {
-                    float ps1 = players[p_j].state.probes[pr].s1;
-                    float ps2 = players[p_j].state.probes[pr].s2;
-                    float ps3 = players[p_j].state.probes[pr].s3;
-                    double dx = ps1 - s1, dy = ps2 - s2, dz = ps3 - s3;
-                    double d = sqrt(dx*dx + dy*dy + dz*dz);
-                    double h = atan2(dx,-dy)*180/M_PI; if(h<0)h+=360;
-                    double m = (d > 0.001) ? asin(dz/d)*180/M_PI : 0;
-                    int prid = 19000 + (p_j * 3) + pr;
-                    const char *st = (players[p_j].state.probes[pr].status == 2) ? RED "DERELICT" RESET : CYAN "ACTIVE" RESET;
-                    char status[64] = ""; if (prid == locked_id) strcat(status, RED "[LOCKED]" RESET);
-                    SAFE_APPEND(b, LARGE_DATA_BUFFER, "%-10s %-5d [%.1f,%.1f,%.1f] %-5.1f %03.0f / %+03.0f     Subspace Probe (%s) %s %s\n", "Probe", prid, ps1, ps2, ps3, d, h, m, players[p_j].name, st, status);
-                }
-            }
-        }
+    double dx = x - me->s1, dy = y - me->s2, dz = z - me->s3;
+    double d = sqrt(dx*dx + dy*dy + dz*dz);
+    double h = atan2(dx, -dy) * 180 / M_PI; if (h < 0) h += 360;
+
+    NetSensorContact *c = &sw->contacts[sw->count++];
+    memset(c, 0, sizeof(*c));
+    c->id = id;
+    c->kind = (uint8_t)kind;
+    c->x = (float)x; c->y = (float)y; c->z = (float)z;
+    c->dist = (float)d;
+    c->heading = (float)h;
+    c->mark = (d > 0.001) ? (float)(asin(dz / d) * 180 / M_PI) : 0.0f;
+    c->owner = -1;
+    if (id == me->lock_target) {
+        c->flags |= CONTACT_F_LOCKED;
+        if (me->nav_state == NAV_STATE_CHASE) c->flags |= CONTACT_F_CHASE;
     }
+    return c;
+}
 
-    /* 12. Derelicts */
-    for (int d_idx = 0; d_idx < local_q->derelict_count; d_idx++) {
-        NPCDerelict *dr = local_q->derelicts[d_idx];
-        double dx=dr->x-s1, dy=dr->y-s2, dz=dr->z-s3; double d=sqrt(dx*dx+dy*dy+dz*dz); double h=atan2(dx,-dy)*180/M_PI; if(h<0)h+=360; double m=(d>0.001)?asin(dz/d)*180/M_PI:0;
-        int drid = dr->id+11000;
-        char status[64] = ""; if (drid == locked_id) strcat(status, RED "[LOCKED]" RESET);
-        SAFE_APPEND(b, LARGE_DATA_BUFFER, "%-10s %-5d [%.1f,%.1f,%.1f] %-5.1f %03.0f / %+03.0f     Derelict Ship %s\n", "Derelict", drid, dr->x, dr->y, dr->z, d, h, m, status);
-    }
+/* Neighbouring-quadrant contact: positions are relative to the captain's quadrant origin */
+static void sweep_neighbor(SensorSweep *sw, int kind, int id, double x, double y, double z, int nq1, int nq2, int nq3, int faction) {
+    double dx = x - sw->me->s1, dy = y - sw->me->s2, dz = z - sw->me->s3;
+    if (sqrt(dx*dx + dy*dy + dz*dz) > 8.0) return;
+    NetSensorContact *c = sweep_add(sw, kind, id, x, y, z, false);
+    if (!c) return;
+    c->flags = CONTACT_F_NEIGHBOR;
+    c->q1 = (uint8_t)nq1; c->q2 = (uint8_t)nq2; c->q3 = (uint8_t)nq3;
+    c->faction = (int16_t)faction;
+}
 
-    /* 13. Defense Platforms */
-    for (int pt_idx = 0; pt_idx < local_q->platform_count; pt_idx++) {
-        NPCPlatform *pt = local_q->platforms[pt_idx];
-        double dx=pt->x-s1, dy=pt->y-s2, dz=pt->z-s3; double d=sqrt(dx*dx+dy*dy+dz*dz); double h=atan2(dx,-dy)*180/M_PI; if(h<0)h+=360; double m=(d>0.001)?asin(dz/d)*180/M_PI:0;
-        int ptid = pt->id+16000;
-        char status[64] = ""; if (ptid == locked_id) strcat(status, RED "[LOCKED]" RESET);
-        SAFE_APPEND(b, LARGE_DATA_BUFFER, "%-10s %-5d [%.1f,%.1f,%.1f] %-5.1f %03.0f / %+03.0f     Defense Platform %s\n", "Platform", ptid, pt->x, pt->y, pt->z, d, h, m, status);
-    }
+/* Quadrant captured by the snapshot, NULL if nobody needed it when it was published */
+static const QuadrantView *snapshot_view(const WorldSnapshot *w, int q1, int q2, int q3) {
+    if (!IS_Q_VALID(q1, q2, q3) || w->quad_view[GALAXY_CELL(q1, q2, q3)] < 0) return NULL;
+    return &w->views[w->quad_view[GALAXY_CELL(q1, q2, q3)]];
+}
 
-    /* 14. Rifts, Buoys, Mines */
-    for (int rf_idx = 0; rf_idx < local_q->rift_count; rf_idx++) {
-        NPCRift *rf = local_q->rifts[rf_idx];
-        double dx=rf->x-s1, dy=rf->y-s2, dz=rf->z-s3; double d=sqrt(dx*dx+dy*dy+dz*dz); double h=atan2(dx,-dy)*180/M_PI; if(h<0)h+=360; double m=(d>0.001)?asin(dz/d)*180/M_PI:0;
-        int rfid = rf->id+17000;
-        char status[64] = ""; if (rfid == locked_id) strcat(status, RED "[LOCKED]" RESET);
-        SAFE_APPEND(b, LARGE_DATA_BUFFER, "%-10s %-5d [%.1f,%.1f,%.1f] %-5.1f %03.0f / %+03.0f     Spatial Rift %s\n", "Rift", rfid, rf->x, rf->y, rf->z, d, h, m, status);
-    }
-    for (int bu_idx = 0; bu_idx < local_q->buoy_count; bu_idx++) {
-        NPCBuoy *bu = local_q->buoys[bu_idx];
-        double dx=bu->x-s1, dy=bu->y-s2, dz=bu->z-s3; double d=sqrt(dx*dx+dy*dy+dz*dz); double h=atan2(dx,-dy)*180/M_PI; if(h<0)h+=360; double m_val=(d>0.001)?asin(dz/d)*180/M_PI:0;
-        int buid = bu->id+15000;
-        char status[64] = ""; if (buid == locked_id) strcat(status, RED "[LOCKED]" RESET);
-        SAFE_APPEND(b, LARGE_DATA_BUFFER, "%-10s %-5d [%.1f,%.1f,%.1f] %-5.1f %03.0f / %+03.0f     Comm Buoy %s\n", "Buoy", buid, bu->x, bu->y, bu->z, d, h, m_val, status);
-    }
-    for (int mi_idx = 0; mi_idx < local_q->mine_count; mi_idx++) {
-        NPCMine *mi = local_q->mines[mi_idx];
-        double dx=mi->x-s1, dy=mi->y-s2, dz=mi->z-s3; double d=sqrt(dx*dx+dy*dy+dz*dz); double h=atan2(dx,-dy)*180/M_PI; if(h<0)h+=360; double m_val=(d>0.001)?asin(dz/d)*180/M_PI:0;
-        int miid = mi->id+14000;
-        char status[64] = ""; if (miid == locked_id) strcat(status, RED "[LOCKED]" RESET);
-        SAFE_APPEND(b, LARGE_DATA_BUFFER, "%-10s %-5d [%.1f,%.1f,%.1f] %-5.1f %03.0f / %+03.0f     Cloaked Mine %s\n", "Mine", miid, mi->x, mi->y, mi->z, d, h, m_val, status);
+void handle_srs(int i, const WorldSnapshot *w, const char *params) {
+    SensorSweep *sw = arena_alloc(sizeof(SensorSweep));
+    PacketSensor *pkt = new_sensor_packet();
+    if (!sw || !pkt) return;
+    const PlayerView *me = &w->players[i];
+    sw->w = w; sw->me = me;
+    sw->count = 0; sw->omitted = 0; sw->name_count = 0; sw->named = 0;
+
+    int q1=me->q1, q2=me->q2, q3=me->q3;
+    double s1=me->s1, s2=me->s2, s3=me->s3;
+    float sensor_h = me->system_health[2];
+    const QuadrantView *v = snapshot_view(w, q1, q2, q3);
+    NetSensorContact *c;
+
+    /* 1. Local quadrant, in snapshot order */
+    for (int k = 0; v && k < v->count; k++) {
+        const SensorEntry *e = &w->entries[v->first + k];
+        if (e->kind == CONTACT_PLAYER && (e->owner == i || w->players[e->owner].is_cloaked)) continue;
+        /* Chance to miss object if sensors are very damaged */
+        if (e->noisy && sensor_h < 30.0f && (rand()%100 > sensor_h + 50)) continue;
+        c = sweep_add(sw, e->kind, e->id, e->x, e->y, e->z, e->noisy);
+        if (!c) continue;
+        c->flags |= e->flags;
+        if (e->kind == CONTACT_PLAYER || e->kind == CONTACT_NPC) c->energy = e->energy;
+        if (e->kind == CONTACT_NPC || e->kind == CONTACT_MONSTER) c->detail = e->detail;
+        c->faction = e->faction;
+        c->owner = e->owner;
+        if (e->owner >= 0) sweep_name(sw, e->owner);
     }
 
-    /* 15. Neighborhood Scan (Inter-Quadrant awareness) */
-    bool found_neighbor = false;
-    char neighbor_buf[4096] = "";
+    /* 2. Neighborhood Scan (Inter-Quadrant awareness): mobile entities and beacons only */
     if (s1 < 2.5 || s1 > 7.5 || s2 < 2.5 || s2 > 7.5 || s3 < 2.5 || s3 > 7.5) {
         for (int dq1 = -1; dq1 <= 1; dq1++) {
             for (int dq2 = -1; dq2 <= 1; dq2++) {
                 for (int dq3 = -1; dq3 <= 1; dq3++) {
                     if (dq1 == 0 && dq2 == 0 && dq3 == 0) continue;
                     int nq1 = q1 + dq1, nq2 = q2 + dq2, nq3 = q3 + dq3;
-                    if (!IS_Q_VALID(nq1, nq2, nq3)) continue;
-                    QuadrantIndex *nq = &spatial_index[nq1][nq2][nq3];
+                    const QuadrantView *nv = snapshot_view(w, nq1, nq2, nq3);
+                    if (!nv) continue;
                     double off_x = dq1 * 10.0, off_y = dq2 * 10.0, off_z = dq3 * 10.0;
-                    
-                    /* Scan for mobile entities and beacons only */
-                    for(int n=0; n<nq->npc_count; n++) {
-                        NPCShip *npc = nq->npcs[n]; if (!npc->active) continue;
-                        double dx=(npc->x+off_x)-s1, dy=(npc->y+off_y)-s2, dz=(npc->z+off_z)-s3;
-                        double d=sqrt(dx*dx+dy*dy+dz*dz); if (d > 8.0) continue;
-                        double h=atan2(dx,-dy)*180/M_PI; if(h<0)h+=360; double m=asin(dz/d)*180/M_PI;
-                        if(!found_neighbor) { sprintf(neighbor_buf, YELLOW "\n--- NEIGHBORHOOD SENSOR SCAN (Adjacent Quadrants) ---" RESET "\nTYPE       ID    QUADRANT      DIST   H / M         DETAILS\n"); found_neighbor=true; }
-                        char line[256]; sprintf(line, "%-10s %-5d [%d,%d,%d] %-5.1f %03.0f / %+03.0f     %s (NPC)\n", "Vessel", npc->id+1000, nq1, nq2, nq3, d, h, m, get_species_name(npc->faction));
-                        strcat(neighbor_buf, line);
-                    }
-                    for(int c=0; c<nq->comet_count; c++) {
-                        NPCComet *co = nq->comets[c]; if (!co->active) continue;
-                        double dx=(co->x+off_x)-s1, dy=(co->y+off_y)-s2, dz=(co->z+off_z)-s3;
-                        double d=sqrt(dx*dx+dy*dy+dz*dz); if (d > 8.0) continue;
-                        double h=atan2(dx,-dy)*180/M_PI; if(h<0)h+=360; double m=asin(dz/d)*180/M_PI;
-                        if(!found_neighbor) { sprintf(neighbor_buf, YELLOW "\n--- NEIGHBORHOOD SENSOR SCAN (Adjacent Quadrants) ---" RESET "\nTYPE       ID    QUADRANT      DIST   H / M         DETAILS\n"); found_neighbor=true; }
-                        char line[256]; sprintf(line, "%-10s %-5d [%d,%d,%d] %-5.1f %03.0f / %+03.0f     Comet\n", "Comet", co->id+10000, nq1, nq2, nq3, d, h, m);
-                        strcat(neighbor_buf, line);
-                    }
-                    for(int bu=0; bu<nq->buoy_count; bu++) {
-                        NPCBuoy *buoy = nq->buoys[bu]; if (!buoy->active) continue;
-                        double dx=(buoy->x+off_x)-s1, dy=(buoy->y+off_y)-s2, dz=(buoy->z+off_z)-s3;
-                        double d=sqrt(dx*dx+dy*dy+dz*dz); if (d > 8.0) continue;
-                        double h=atan2(dx,-dy)*180/M_PI; if(h<0)h+=360; double m=asin(dz/d)*180/M_PI;
-                        if(!found_neighbor) { sprintf(neighbor_buf, YELLOW "\n--- NEIGHBORHOOD SENSOR SCAN (Adjacent Quadrants) ---" RESET "\nTYPE       ID    QUADRANT      DIST   H / M         DETAILS\n"); found_neighbor=true; }
-                        char line[256]; sprintf(line, "%-10s %-5d [%d,%d,%d] %-5.1f %03.0f / %+03.0f     Comm Buoy\n", "Buoy", buoy->id+15000, nq1, nq2, nq3, d, h, m);
-                        strcat(neighbor_buf, line);
+                    for (int k = 0; k < nv->count; k++) {
+                        const SensorEntry *e = &w->entries[nv->first + k];
+                        if (!e->active || (e->kind != CONTACT_NPC && e->kind != CONTACT_COMET && e->kind != CONTACT_BUOY)) continue;
+                        sweep_neighbor(sw, e->kind, e->id, e->x+off_x, e->y+off_y, e->z+off_z, nq1, nq2, nq3, e->faction);
                     }
                 }
             }
         }
     }
-    if(found_neighbor) SAFE_APPEND(b, LARGE_DATA_BUFFER, "%s", neighbor_buf);
 
-    #undef SAFE_APPEND
-    send_server_msg(i, "TACTICAL", b);
-    free(b);
+    size_t names_len = sw->name_count * sizeof(NetSensorName);
+    size_t contacts_len = sw->count * sizeof(NetSensorContact);
+    pkt->report = SENSOR_SRS;
+    pkt->name_count = sw->name_count;
+    pkt->count = sw->count;
+    pkt->omitted = sw->omitted + (v ? v->dropped : 0);
+    memcpy(pkt->data, sw->names, names_len);
+    memcpy(pkt->data + names_len, sw->contacts, contacts_len);
+    send_sensor_report(i, me, pkt, names_len + contacts_len);
 }
 
-void handle_lrs(int i, const char *params) {
-    char *b = calloc(LARGE_DATA_BUFFER, sizeof(char));
-    if (!b) return;
-
-    int q1=players[i].state.q1, q2=players[i].state.q2, q3=players[i].state.q3;
-    double s1=players[i].state.s1, s2=players[i].state.s2, s3=players[i].state.s3;
-    
-    snprintf(b, LARGE_DATA_BUFFER, B_CYAN "\n.--- LCARS LONG RANGE TACTICAL SENSORS --------------------------------------.\n" RESET);
-    char status[256];
-    sprintf(status, WHITE " POS: [%d,%d,%d] SECTOR: [%.1f,%.1f,%.1f] | HDG: %03.0f MRK: %+03.0f\n" RESET, 
-            q1, q2, q3, s1, s2, s3, players[i].state.ent_h, players[i].state.ent_m);
-    strcat(b, status);
-    strcat(b, B_CYAN "'------------------------------------------------------------------------------'\n" RESET);
-    strcat(b, " DATA: [ H:B-Hole P:Planet N:NPC B:Base S:Star ]\n");
-    strcat(b, " Symbols: ~:Nebula *:Pulsar +:Comet #:Asteroid M:Monster >:Rift\n\n");
-
-    const char* section_names[] = {"[ GREEN TACTICAL ZONE ]", "[ YELLOW TACTICAL ZONE ]", "[ RED TACTICAL ZONE ]"};
-    const char* section_colors[] = {B_GREEN, B_YELLOW, B_RED};
-
-    for (int section = 0; section < 3; section++) {
-        int dq3 = (section == 0) ? 1 : (section == 1) ? 0 : -1;
-        int nq3 = q3 + dq3;
-        
-        if (nq3 < 1 || nq3 > 10) continue;
-
-        char header[128];
-        sprintf(header, "%s%s (Level Z:%d)" RESET "\n", section_colors[section], section_names[section], nq3);
-        strcat(b, header);
-        
+void handle_lrs(int i, const WorldSnapshot *w, const char *params) {
+    PacketSensor *pkt = new_sensor_packet();
+    if (!pkt) return;
+    const PlayerView *me = &w->players[i];
+    NetLrsCell *cells = (NetLrsCell *)pkt->data;
+    int q1=me->q1, q2=me->q2, q3=me->q3;
+    float sensor_h = me->system_health[2];
+    int n = 0;
+
+    /* Upper level first, rows north to south, columns west to east */
+    for (int dq3 = 1; dq3 >= -1; dq3--) {
         for (int dq2 = -1; dq2 <= 1; dq2++) {
-            int nq2 = q2 + dq2;
-            char line1[2048] = "  ";
-            char line2[2048] = "  ";
-            
             for (int dq1 = -1; dq1 <= 1; dq1++) {
-                int nq1 = q1 + dq1;
-                char cell1[256], cell2[256];
-                float sensor_h = players[i].state.system_health[2];
-                
-                if (IS_Q_VALID(nq1, nq2, nq3)) {
-                    long long v = galaxy_master.g[nq1][nq2][nq3];
-                    
-                    /* Scramble data if sensors are damaged */
-                    if (sensor_h < 50.0f && (rand()%100 > sensor_h)) {
-                        v = (v / 10) + (rand()%9); /* Randomize some counts */
-                    }
-
-                    int s=v%10, b_cnt=(v/10)%10, k=(v/100)%10, p=(v/1000)%10, bh=(v/10000)%10;
-                    int neb=(v/100000)%10, pul=(v/1000000)%10, com=(v/100000000)%10, ast=(v/1000000000)%10;
-                    int mon=(v/10000000000000000LL)%10;
-                    int rift=(v/100000000000000LL)%10;
-                    
-                    /* Navigation Solution */
-                    double dx = (nq1 - q1) * 10.0; double dy = (nq2 - q2) * 10.0; double dz = (nq3 - q3) * 10.0;
-                    double dist = sqrt(dx*dx + dy*dy + dz*dz);
-                    double h_v = 0, m_v = 0;
-                    if (dist > 0.01) { h_v = atan2(dx, -dy) * 180.0 / M_PI; if(h_v < 0) h_v += 360; m_v = asin(dz / dist) * 180.0 / M_PI; }
-
-                    /* LINE 1: COORDS & NAV */
-                    if (nq1==q1 && nq2==q2 && nq3==q3)
-                        sprintf(cell1, B_BLUE "[ %d,%d,%d ]" RESET "  *- CURRENT -*   ", nq1, nq2, nq3);
-                    else {
-                        if (sensor_h < 40.0f && (rand()%100 > sensor_h + 30))
-                            sprintf(cell1, WHITE "[ \?,\?,\? ]" RESET "  \?\?\?/\?\?\?/W\?.\?  ");
-                        else
-                            sprintf(cell1, WHITE "[ %d,%d,%d ]" RESET "  %03.0f/%+03.0f/W%.1f  ", nq1, nq2, nq3, h_v, m_v, dist/10.0);
-                    }
-
-                    /* LINE 2: OBJECTS [ H P N B S ] */
-                    char h_s[32], p_s[32], n_s[32], b_s[32], s_s[32];
-                    
-                    /* Scramble icons if sensors are critical */
-                    if (sensor_h < 25.0f && (rand()%100 > 50)) {
-                        strcpy(h_s, "?"); strcpy(p_s, "?"); strcpy(n_s, "?"); strcpy(b_s, "?"); strcpy(s_s, "?");
-                    } else {
-                        if(bh>0) sprintf(h_s, "%s%d" RESET, MAGENTA, bh); else strcpy(h_s, ".");
-                        if(p>0) sprintf(p_s, "%s%d" RESET, CYAN, p); else strcpy(p_s, ".");
-                        if(k>0) sprintf(n_s, "%s%d" RESET, RED, k); else strcpy(n_s, ".");
-                        if(b_cnt>0) sprintf(b_s, "%s%d" RESET, GREEN, b_cnt); else strcpy(b_s, ".");
-                        if(s>0) sprintf(s_s, "%s%d" RESET, YELLOW, s); else strcpy(s_s, ".");
-                    }
-
-                    char an[16] = "";
-                    if(neb>0) { strcat(an, "~"); } if(pul>0) { strcat(an, "*"); } if(com>0) { strcat(an, "+"); }
-                    if(ast>0) { strcat(an, "#"); } if(mon>0) { strcat(an, "M"); } if(rift>0) { strcat(an, ">"); }
-                    
-                    sprintf(cell2, "  [%s %s %s %s %s" RESET "] %-5s      ", h_s, p_s, n_s, b_s, s_s, an);
-                } else {
-                    strcpy(cell1, "  [ -,-,- ]  -------------   ");
-                    strcpy(cell2, "  [ . . . . . ]              ");
+                int nq1 = q1 + dq1, nq2 = q2 + dq2, nq3 = q3 + dq3;
+                NetLrsCell *cell = &cells[n++];
+                memset(cell, 0, sizeof(*cell));
+                cell->q1 = (uint8_t)nq1; cell->q2 = (uint8_t)nq2; cell->q3 = (uint8_t)nq3;
+                if (!IS_Q_VALID(nq1, nq2, nq3)) continue;
+
+                cell->flags = LRS_F_VALID;
+                long long v = me->lrs[dq1 + 1][dq2 + 1][dq3 + 1];
+                /* Scramble data if sensors are damaged */
+                if (sensor_h < 50.0f && (rand()%100 > sensor_h)) {
+                    v = (v / 10) + (rand()%9); /* Randomize some counts */
                 }
-                strcat(line1, cell1); strcat(line2, cell2);
+                cell->val = v;
+
+                /* Navigation Solution */
+                double dx = dq1 * 10.0, dy = dq2 * 10.0, dz = dq3 * 10.0;
+                double dist = sqrt(dx*dx + dy*dy + dz*dz);
+                double h_v = 0, m_v = 0;
+                if (dist > 0.01) { h_v = atan2(dx, -dy) * 180.0 / M_PI; if(h_v < 0) h_v += 360; m_v = asin(dz / dist) * 180.0 / M_PI; }
+                cell->heading = (float)h_v; cell->mark = (float)m_v; cell->dist = (float)dist;
+
+                if (dq1 == 0 && dq2 == 0 && dq3 == 0) cell->flags |= LRS_F_CURRENT;
+                else if (sensor_h < 40.0f && (rand()%100 > sensor_h + 30)) cell->flags |= LRS_F_NAV_LOST;
+                /* Scramble icons if sensors are critical */
+                if (sensor_h < 25.0f && (rand()%100 > 50)) cell->flags |= LRS_F_ICONS_LOST;
             }
-            strcat(b, line1); strcat(b, "\n");
-            strcat(b, line2); strcat(b, "\n\n");
         }
     }
-    strcat(b, B_CYAN "'------------------------------------------------------------------------------'\n" RESET);
-    send_server_msg(i, "SCIENCE", b);
-    free(b);
+
+    pkt->report = SENSOR_LRS;
+    pkt->name_count = 0;
+    pkt->count = n;
+    send_sensor_report(i, me, pkt, n * sizeof(NetLrsCell));
 }
 
 void handle_pha(int i, const char *params) {
@@ -735,24 +453,27 @@ void handle_pha(int i, const char *params) {
     double tx, ty, tz; bool found = false;
     int pq1=players[i].state.q1, pq2=players[i].state.q2, pq3=players[i].state.q3;
     
-    if (tid >= 1 && tid <= 32 && players[tid-1].active && players[tid-1].state.q1 == pq1 && players[tid-1].state.q2 == pq2 && players[tid-1].state.q3 == pq3) { tx=players[tid-1].state.s1; ty=players[tid-1].state.s2; tz=players[tid-1].state.s3; found=true; }
-    else if (tid >= 1000 && tid < 1000+MAX_NPC && npcs[tid-1000].active && npcs[tid-1000].q1 == pq1 && npcs[tid-1000].q2 == pq2 && npcs[tid-1000].q3 == pq3) { tx=npcs[tid-1000].x; ty=npcs[tid-1000].y; tz=npcs[tid-1000].z; found=true; }
-    else if (tid >= 16000 && tid < 16000+MAX_PLATFORMS && platforms[tid-16000].active && platforms[tid-16000].q1 == pq1 && platforms[tid-16000].q2 == pq2 && platforms[tid-16000].q3 == pq3) { tx=platforms[tid-16000].x; ty=platforms[tid-16000].y; tz=platforms[tid-16000].z; found=true; }
-    else if (tid >= 18000 && tid < 18000+MAX_MONSTERS && monsters[tid-18000].active && monsters[tid-18000].q1 == pq1 && monsters[tid-18000].q2 == pq2 && monsters[tid-18000].q3 == pq3) { tx=monsters[tid-18000].x; ty=monsters[tid-18000].y; tz=monsters[tid-18000].z; found=true; }
+    EntityRef t;
+    if (target_ref(i, tid, &t) && entity_in_quadrant(&t, pq1, pq2, pq3) &&
+        (t.kind == SI_PLAYER || t.kind == SI_NPC || t.kind == SI_PLATFORM || t.kind == SI_MONSTER)) {
+        tx = t.x; ty = t.y; tz = t.z; found = true;
+    }
     
+    /* Ships are hit where this captain saw them, not where they are by now */
+    if (found) lag_position(tid, lag_view_tick(lag_rewind_ticks(i)), pq1, pq2, pq3, &tx, &ty, &tz);
+
     if (found) {
         double dx=tx-players[i].state.s1, dy=ty-players[i].state.s2, dz=tz-players[i].state.s3; double dist=sqrt(dx*dx+dy*dy+dz*dz);
         if (dist < 0.1) dist = 0.1;
         /* Damage Scales with Weapons Power (0.0 - 1.0). Baseline is 1x, max is 3x */
         float weapon_mult = 0.5f + (players[i].state.power_dist[2] * 2.5f);
         int hit = (int)((e / dist) * (players[i].state.system_health[4] / 100.0f) * weapon_mult);
-        players[i].state.beam_count = 1; 
-        players[i].state.beams[0] = (NetBeam){(float)players[i].state.s1, (float)players[i].state.s2, (float)players[i].state.s3, (float)tx, (float)ty, (float)tz, 1};
-        if (tid <= 32) {
-            ConnectedPlayer *target = &players[tid-1];
+        fx_beam(pq1, pq2, pq3, entity_id(SI_PLAYER, i), players[i].state.s1, players[i].state.s2, players[i].state.s3, tx, ty, tz);
+        if (t.kind == SI_PLAYER) {
+            ConnectedPlayer *target = t.player;
             /* Calculate relative angle to determine which shield quadrant is hit */
-            double rel_dx = players[i].state.s1 - target->state.s1;
-            double rel_dy = players[i].state.s2 - target->state.s2;
+            double rel_dx = players[i].state.s1 - tx;
+            double rel_dy = players[i].state.s2 - ty;
             double angle = atan2(rel_dx, -rel_dy) * 180.0 / M_PI; if (angle < 0) angle += 360;
             /* Normalize relative to target heading */
             double rel_angle = angle - target->state.ent_h;
@@ -760,7 +481,7 @@ void handle_pha(int i, const char *params) {
             while (rel_angle >= 360) rel_angle -= 360;
 
             /* Full 3D Shield Mapping: 0:F, 1:R, 2:T, 3:B, 4:L, 5:RI */
-            double rel_dz = players[i].state.s3 - target->state.s3;
+            double rel_dz = players[i].state.s3 - tz;
             double dist_2d = sqrt(rel_dx*rel_dx + rel_dy*rel_dy);
             double vertical_angle = atan2(rel_dz, dist_2d) * 180.0 / M_PI;
 
@@ -808,7 +529,7 @@ void handle_pha(int i, const char *params) {
                     const char* sys_names[] = {"WARP", "IMPULSE", "SENSORS", "TRANSPORTERS", "PHASERS", "TORPEDOES", "COMPUTER", "LIFE SUPPORT", "SHIELDS", "AUXILIARY"};
                     char alert[128];
                     sprintf(alert, "CRITICAL: Direct hull impact! %s system damaged!", sys_names[sys_idx]);
-                    send_server_msg(tid-1, "DAMAGE", alert);
+                    send_server_msg(t.slot, "DAMAGE", alert);
                 }
 
                 target->state.energy -= dmg_rem / 2;
@@ -824,32 +545,35 @@ void handle_pha(int i, const char *params) {
 
             if (target->state.hull_integrity <= 0 || target->state.energy <= 0) { 
                 target->state.energy = 0; target->state.hull_integrity = 0; target->state.crew_count = 0; target->active = 0; 
-                target->state.boom = (NetPoint){(float)target->state.s1,(float)target->state.s2,(float)target->state.s3,1}; 
+                fx_point(pq1, pq2, pq3, FX_BOOM, 0, target->state.s1, target->state.s2, target->state.s3, 0); 
             }
-            send_server_msg(tid-1, "WARNING", "UNDER PHASER ATTACK!");
-        } else if (tid >= 1000 && tid < 1000+MAX_NPC) {
-            npcs[tid-1000].energy -= hit; float engine_dmg = (hit / 1000.0f) * 10.0f; npcs[tid-1000].engine_health -= engine_dmg; if (npcs[tid-1000].engine_health < 0) npcs[tid-1000].engine_health = 0;
+            send_server_msg(t.slot, "WARNING", "UNDER PHASER ATTACK!");
+        } else if (t.kind == SI_NPC) {
+            NPCShip *npc = t.npc;
+            npc_hot.energy[t.slot] -= hit; float engine_dmg = (hit / 1000.0f) * 10.0f; npc->engine_health -= engine_dmg; if (npc->engine_health < 0) npc->engine_health = 0;
             
             /* Renegade Status: Phaser friendly fire (NPC) */
-            if (npcs[tid-1000].faction == players[i].faction) {
+            if (npc->faction == players[i].faction) {
                 players[i].renegade_timer = 18000;
                 send_server_msg(i, "CRITICAL", "TRAITOROUS ATTACK! Friendly phaser lock detected!");
             }
 
-            if (npcs[tid-1000].energy <= 0) { npcs[tid-1000].active = 0; players[i].state.boom = (NetPoint){(float)npcs[tid-1000].x, (float)npcs[tid-1000].y, (float)npcs[tid-1000].z, 1}; }
-        } else if (tid >= 16000 && tid < 16000+MAX_PLATFORMS) {
-            platforms[tid-16000].energy -= hit;
+            if (npc_hot.energy[t.slot] <= 0) { entity_despawn(SI_NPC, t.slot); fx_point(players[i].state.q1, players[i].state.q2, players[i].state.q3, FX_BOOM, 0, t.x, t.y, t.z, 0); }
+        } else if (t.kind == SI_PLATFORM) {
+            NPCPlatform *pt = t.platform;
+            pt->energy -= hit;
             
             /* Renegade Status: Platforms */
-            if (platforms[tid-16000].faction == players[i].faction) {
+            if (pt->faction == players[i].faction) {
                 players[i].renegade_timer = 18000;
                 send_server_msg(i, "CRITICAL", "ACT OF SABOTAGE! Federation/Faction property attacked!");
             }
 
-            if (platforms[tid-16000].energy <= 0) { platforms[tid-16000].active = 0; players[i].state.boom = (NetPoint){(float)platforms[tid-16000].x, (float)platforms[tid-16000].y, (float)platforms[tid-16000].z, 1}; }
-        } else if (tid >= 18000 && tid < 18000+MAX_MONSTERS) {
-            monsters[tid-18000].energy -= hit;
-            if (monsters[tid-18000].energy <= 0) { monsters[tid-18000].active = 0; players[i].state.boom = (NetPoint){(float)monsters[tid-18000].x, (float)monsters[tid-18000].y, (float)monsters[tid-18000].z, 1}; }
+            if (pt->energy <= 0) { entity_despawn(SI_PLATFORM, t.slot); fx_point(players[i].state.q1, players[i].state.q2, players[i].state.q3, FX_BOOM, 0, pt->x, pt->y, pt->z, 0); }
+        } else if (t.kind == SI_MONSTER) {
+            NPCMonster *mon = t.monster;
+            mon->energy -= hit;
+            if (mon->energy <= 0) { entity_despawn(SI_MONSTER, t.slot); fx_point(players[i].state.q1, players[i].state.q2, players[i].state.q3, FX_BOOM, 0, mon->x, mon->y, mon->z, 0); }
         }
         char msg[64]; sprintf(msg, "Phasers locked. Target hit for %d damage.", hit); send_server_msg(i, "TACTICAL", msg);
     } else send_server_msg(i, "COMPUTER", "Target out of phaser range or not in current quadrant.");
@@ -866,11 +590,20 @@ void handle_tor(int i, const char *params) {
         players[i].torp_load_timer = 150; /* 5 seconds at 30Hz logic tick */
         players[i].torp_timeout = 300;    /* 10 seconds timeout */
         players[i].torp_target = players[i].state.lock_target;
+        players[i].torp_gen = players[i].lock_gen;
         double h=players[i].state.ent_h, m=players[i].state.ent_m;
         bool manual = true; if (players[i].torp_target > 0) manual = false;
         double rad_h = h * M_PI / 180.0; double rad_m = m * M_PI / 180.0;
         players[i].tx = players[i].state.s1; players[i].ty = players[i].state.s2; players[i].tz = players[i].state.s3;
         players[i].tdx = cos(rad_m) * sin(rad_h); players[i].tdy = cos(rad_m) * -cos(rad_h); players[i].tdz = sin(rad_m);
+        /* A locked launch leaves the tube pointed where the captain saw the target */
+        double ax, ay, az;
+        if (!manual && lag_position(players[i].torp_target, lag_view_tick(lag_rewind_ticks(i)),
+                                    players[i].state.q1, players[i].state.q2, players[i].state.q3, &ax, &ay, &az)) {
+            double dx = ax - players[i].tx, dy = ay - players[i].ty, dz = az - players[i].tz;
+            double d = sqrt(dx*dx + dy*dy + dz*dz);
+            if (d > 0.01) { players[i].tdx = dx/d; players[i].tdy = dy/d; players[i].tdz = dz/d; }
+        }
         send_server_msg(i, "TACTICAL", manual ? "Torpedo away (Manual)." : "Torpedo away (Locked).");
     } else send_server_msg(i, "TACTICAL", "Insufficient torpedoes.");
 }
@@ -884,127 +617,67 @@ void handle_she(int i, const char *params) {
 }
 
 void handle_lock(int i, const char *params) {
-    int tid; if(sscanf(params, " %d", &tid) == 1) {
-        players[i].state.lock_target = tid; send_server_msg(i, "TACTICAL", "Target locked.");
-    } else { players[i].state.lock_target = 0; send_server_msg(i, "TACTICAL", "Lock released."); }
+    int tid = 0; EntityRef t;
+    if (sscanf(params, " %d", &tid) != 1 || tid == 0) {
+        players[i].state.lock_target = 0; send_server_msg(i, "TACTICAL", "Lock released.");
+    } else if (entity_lookup(tid, &t) && (t.flags & ENT_LOCKABLE)) {
+        /* The lock follows this body: it goes stale if the id is ever given to another */
+        players[i].state.lock_target = tid; players[i].lock_gen = t.gen;
+        send_server_msg(i, "TACTICAL", "Target locked.");
+    } else send_server_msg(i, "COMPUTER", "Unable to lock on specified ID.");
 }
 
-void handle_scan(int i, const char *params) {
+void handle_scan(int i, const WorldSnapshot *w, const char *params) {
     int tid; if(sscanf(params, " %d", &tid) == 1) {
-        char *rep = calloc(1024, sizeof(char));
-        if (!rep) return;
-        bool found = false;
-        int pq1 = players[i].state.q1, pq2 = players[i].state.q2, pq3 = players[i].state.q3;
-        if (tid >= 1 && tid <= 32) {
-             ConnectedPlayer *t = &players[tid-1];
-             if (t->active && t->state.q1 == pq1 && t->state.q2 == pq2 && t->state.q3 == pq3) {
-                 found = true;
-                 snprintf(rep, 1024, CYAN "\n--- SENSOR SCAN ANALYSIS: TARGET ID %d ---" RESET, tid);
-                 snprintf(rep+strlen(rep), 1024-strlen(rep), "COMMANDER: %s\n", t->name);
-                 snprintf(rep+strlen(rep), 1024-strlen(rep), "ENERGY: %d | CREW: %d | TORPS: %d\n", t->state.energy, t->state.crew_count, t->state.torpedoes);
-                 strcat(rep, BLUE "SYSTEMS STATUS:\n" RESET);
-                 const char* sys[] = {"Warp", "Impulse", "Sensors", "Transp", "Phasers", "Torps", "Computer", "Life", "Shields", "Aux"};
-                 for(int s=0; s<10; s++) {
-                     char bar[11]; int fills = (int)(t->state.system_health[s]/10.0f); for(int k=0; k<10; k++) bar[k]=(k<fills)?'|':'.'; bar[10]=0;
-                     char line[64]; snprintf(line, sizeof(line), " %-8s [%s] %.1f%%\n", sys[s], bar, t->state.system_health[s]);
-                     if (strlen(rep) + strlen(line) < 1023) strcat(rep, line);
-                 }
+        PacketSensor *pkt = new_sensor_packet();
+        if (!pkt) return;
+        const PlayerView *me = &w->players[i];
+        NetScanReport *rep = (NetScanReport *)pkt->data;
+        memset(rep, 0, sizeof(*rep));
+        rep->target_id = tid;
+
+        int kind, slot;
+        if (entity_decode(tid, &kind, &slot) && kind == SI_PLAYER) {
+             const PlayerView *t = &w->players[slot];
+             if (t->active && t->q1 == me->q1 && t->q2 == me->q2 && t->q3 == me->q3) {
+                 rep->kind = CONTACT_PLAYER;
+                 memcpy(rep->name, t->name, sizeof(rep->name));
+                 rep->energy = t->energy;
+                 rep->crew = t->crew_count;
+                 rep->torpedoes = t->torpedoes;
+                 memcpy(rep->system_health, t->system_health, sizeof(rep->system_health));
              }
-        } 
-        if (!found && tid >= 1000 && tid < 1000+MAX_NPC) {
-            int idx = tid - 1000;
-            if (npcs[idx].active && npcs[idx].q1==pq1 && npcs[idx].q2==pq2 && npcs[idx].q3==pq3) {
-                found = true;
-                NPCShip *n = &npcs[idx];
-                snprintf(rep, 1024, CYAN "\n--- TACTICAL SCAN ANALYSIS: TARGET ID %d ---" RESET, tid);
-                snprintf(rep+strlen(rep), 1024-strlen(rep), "SPECIES: %s\n", get_species_name(n->faction));
-                snprintf(rep+strlen(rep), 1024-strlen(rep), "ENERGY CORE: %d\n", n->energy);
-                snprintf(rep+strlen(rep), 1024-strlen(rep), "PROPULSION: %.1f%%\n", n->engine_health);
-                snprintf(rep+strlen(rep), 1024-strlen(rep), "BEHAVIOR: %s\n", (n->ai_state==AI_STATE_FLEE)?"RETREATING":(n->ai_state==AI_STATE_CHASE)?"AGGRESSIVE":"PATROLLING");
-            }
-        } 
-        if (!found && tid >= 2000 && tid < 2000+MAX_BASES) {
-            int idx = tid - 2000;
-            if (bases[idx].active && bases[idx].q1==pq1 && bases[idx].q2==pq2 && bases[idx].q3==pq3) {
-                found = true;
-                snprintf(rep, 1024, WHITE "\n--- FEDERATION STARBASE ANALYSIS ---" RESET "\nTYPE: Supply and Repair Outpost\nSTATUS: Active\nSERVICES: Full Repair, Torpedo Reload, Energy Recharge.\n");
-            }
-        } 
-        if (!found && tid >= 3000 && tid < 3000+MAX_PLANETS) {
-            int idx = tid - 3000;
-            if (planets[idx].active && planets[idx].q1==pq1 && planets[idx].q2==pq2 && planets[idx].q3==pq3) {
-                found = true;
-                const char* res[] = {"-","Dilithium","Tritanium","Verterium","Monotanium","Isolinear","Gases","Duranium"};
-                snprintf(rep, 1024, GREEN "\n--- PLANETARY SURVEY ---" RESET "\nTYPE: Class-M Habitable\nRESOURCE: %s\nRESERVES: %d units\n", res[planets[idx].resource_type], planets[idx].amount);
-            }
-        } 
-        if (!found && tid >= 4000 && tid < 4000+MAX_STARS) {
-            int idx = tid - 4000;
-            if (stars_data[idx].active && stars_data[idx].q1==pq1 && stars_data[idx].q2==pq2 && stars_data[idx].q3==pq3) {
-                found = true;
-                snprintf(rep, 1024, YELLOW "\n--- STELLAR ANALYSIS ---" RESET "\nTYPE: Main Sequence G-Class Star\nLUMINOSITY: Standard\nADVISORY: Proximity scooping active (sco).\n");
-            }
-        } 
-        if (!found && tid >= 7000 && tid < 7000+MAX_BH) {
-            int idx = tid - 7000;
-            if (black_holes[idx].active && black_holes[idx].q1==pq1 && black_holes[idx].q2==pq2 && black_holes[idx].q3==pq3) {
-                found = true;
-                snprintf(rep, 1024, MAGENTA "\n--- SINGULARITY ANALYSIS ---" RESET "\nTYPE: Schwarzschild Black Hole\nEFFECT: Extreme Time-Dilation and Space Curvature.\nADVISORY: Significant gravitational pull detected within 3.0 units. Escape velocity required.\n");
-            }
-        } 
-        if (!found && tid >= 8000 && tid < 8000+MAX_NEBULAS) {
-            int idx = tid - 8000;
-            if (nebulas[idx].active && nebulas[idx].q1==pq1 && nebulas[idx].q2==pq2 && nebulas[idx].q3==pq3) {
-                found = true;
-                snprintf(rep, 1024, BLUE "\n--- STELLAR PHENOMENON ANALYSIS ---" RESET "\nTYPE: Class-Mutara Nebula\nCOMPOSITION: Ionized Gases, Sensor-dampening particulates.\nEFFECT: Reduced sensor range, Shield regeneration inhibition.\n");
-            }
-        } 
-        if (!found && tid >= 9000 && tid < 9000+MAX_PULSARS) {
-            int idx = tid - 9000;
-            if (pulsars[idx].active && pulsars[idx].q1==pq1 && pulsars[idx].q2==pq2 && pulsars[idx].q3==pq3) {
-                found = true;
-                snprintf(rep, 1024, RED "\n--- WARNING: PULSAR DETECTED ---" RESET "\nTYPE: Rotating Neutron Star\nRADIATION: Extreme (Gamma/X-Ray)\nADVISORY: Maintain minimum safe distance 2.0. Shield failure imminent in proximity.\n");
-            }
-        } 
-        if (!found && tid >= 10000 && tid < 10000+MAX_COMETS) {
-            int idx = tid - 10000;
-            if (comets[idx].active && comets[idx].q1==pq1 && comets[idx].q2==pq2 && comets[idx].q3==pq3) {
-                found = true;
-                snprintf(rep, 1024, CYAN "\n--- COMET TRACKING DATA ---" RESET "\nTYPE: Icy Nucleus / Ion Tail\nSPEED: Orbital Intercept possible.\nCOMPOSITION: Rare gases, frozen verterium.\n");
-            }
-        } 
-        if (!found && tid >= 11000 && tid < 11000+MAX_DERELICTS) {
-            int idx = tid - 11000;
-            if (derelicts[idx].active && derelicts[idx].q1==pq1 && derelicts[idx].q2==pq2 && derelicts[idx].q3==pq3) {
-                found = true;
-                snprintf(rep, 1024, WHITE "\n--- DERELICT SENSOR LOG ---" RESET "\nTYPE: Abandoned Vessel\nINTEGRITY: Critical (Adrift)\nADVISORY: Boarding (bor) may recover valuable resources or tech.\n");
-            }
-        } 
-        if (!found && tid >= 12000 && tid < 12000+MAX_ASTEROIDS) {
-            int idx = tid - 12000;
-            if (asteroids[idx].active && asteroids[idx].q1==pq1 && asteroids[idx].q2==pq2 && asteroids[idx].q3==pq3) {
-                found = true;
-                snprintf(rep, 1024, WHITE "\n--- ASTEROID ANALYSIS ---" RESET "\nTYPE: Carbonaceous / Metallic\nEFFECT: Navigation hazard at high impulse/warp.\n");
-            }
-        } 
-        if (!found && tid >= 16000 && tid < 16000+MAX_PLATFORMS) {
-            int idx = tid - 16000;
-            if (platforms[idx].active && platforms[idx].q1==pq1 && platforms[idx].q2==pq2 && platforms[idx].q3==pq3) {
-                found = true;
-                snprintf(rep, 1024, RED "\n--- DEFENSE PLATFORM TACTICAL ---" RESET "\nTYPE: Automated Weapon Sentry\nSTATUS: ACTIVE / HOSTILE\nENERGY CORE: %d\nCOOLDOWN: %d ticks\n", platforms[idx].energy, platforms[idx].fire_cooldown);
-            }
-        } 
-        if (!found && tid >= 18000 && tid < 18000+MAX_MONSTERS) {
-            int idx = tid - 18000;
-            if (monsters[idx].active && monsters[idx].q1==pq1 && monsters[idx].q2==pq2 && monsters[idx].q3==pq3) {
-                found = true;
-                snprintf(rep, 1024, MAGENTA "\n--- XENO-BIOLOGICAL ANALYSIS ---" RESET "\nTYPE: %s\nTHREAT LEVEL: EXTREME\nADVISORY: Conventional weapons effective but risky in close proximity.\n", (monsters[idx].type==30)?"Crystalline Entity":"Space Amoeba");
+        } else {
+            /* Everything else scannable is in the captain's own quadrant view */
+            const QuadrantView *v = snapshot_view(w, me->q1, me->q2, me->q3);
+            for (int k = 0; v && k < v->count; k++) {
+                const SensorEntry *e = &w->entries[v->first + k];
+                if (e->id != tid || !e->active) continue;
+                switch (e->kind) {
+                    case CONTACT_NPC:
+                        rep->faction = e->faction;
+                        rep->energy = e->energy;
+                        rep->engine = e->engine;
+                        rep->detail = e->scan_detail;
+                        break;
+                    case CONTACT_PLANET: rep->detail = e->scan_detail; rep->amount = e->amount; break;
+                    case CONTACT_PLATFORM: rep->energy = e->energy; rep->amount = e->amount; break;
+                    case CONTACT_MONSTER: rep->detail = e->scan_detail; break;
+                    case CONTACT_BASE: case CONTACT_STAR: case CONTACT_BLACKHOLE: case CONTACT_NEBULA: case CONTACT_PULSAR:
+                    case CONTACT_COMET: case CONTACT_DERELICT: case CONTACT_ASTEROID: break;
+                    default: continue; /* Probes, rifts, buoys and mines do not answer a scan */
+                }
+                rep->kind = e->kind;
+                break;
             }
         }
 
-        if (found) send_server_msg(i, "SCIENCE", rep);
-        else send_server_msg(i, "COMPUTER", "Unable to lock sensors on specified ID.");
-        free(rep);
+        if (rep->kind) {
+            pkt->report = SENSOR_SCAN;
+            pkt->name_count = 0;
+            pkt->count = 1;
+            send_sensor_report(i, me, pkt, sizeof(NetScanReport));
+        } else send_server_msg(i, "COMPUTER", "Unable to lock sensors on specified ID.");
     } else {
         send_server_msg(i, "COMPUTER", "Usage: scan <ID>");
     }
@@ -1026,18 +699,20 @@ void handle_bor(int i, const char *params) {
         players[i].state.energy -= 5000;
         double tx, ty, tz; bool found = false;
         int pq1=players[i].state.q1, pq2=players[i].state.q2, pq3=players[i].state.q3;
-        if (tid >= 1 && tid <= 32 && players[tid-1].active && players[tid-1].state.q1 == pq1 && players[tid-1].state.q2 == pq2 && players[tid-1].state.q3 == pq3) { tx=players[tid-1].state.s1; ty=players[tid-1].state.s2; tz=players[tid-1].state.s3; found=true; }
-        else if (tid >= 1000 && tid < 1000+MAX_NPC && npcs[tid-1000].active && npcs[tid-1000].q1 == pq1 && npcs[tid-1000].q2 == pq2 && npcs[tid-1000].q3 == pq3) { tx=npcs[tid-1000].x; ty=npcs[tid-1000].y; tz=npcs[tid-1000].z; found=true; }
-        else if (tid >= 11000 && tid < 11000+MAX_DERELICTS && derelicts[tid-11000].active && derelicts[tid-11000].q1 == pq1 && derelicts[tid-11000].q2 == pq2 && derelicts[tid-11000].q3 == pq3) { tx=derelicts[tid-11000].x; ty=derelicts[tid-11000].y; tz=derelicts[tid-11000].z; found=true; }
-        else if (tid >= 16000 && tid < 16000+MAX_PLATFORMS && platforms[tid-16000].active && platforms[tid-16000].q1 == pq1 && platforms[tid-16000].q2 == pq2 && platforms[tid-16000].q3 == pq3) { tx=platforms[tid-16000].x; ty=platforms[tid-16000].y; tz=platforms[tid-16000].z; found=true; }
+        EntityRef t;
+        if (target_ref(i, tid, &t) && entity_in_quadrant(&t, pq1, pq2, pq3) &&
+            (t.kind == SI_PLAYER || t.kind == SI_NPC || t.kind == SI_DERELICT || t.kind == SI_PLATFORM)) {
+            tx = t.x; ty = t.y; tz = t.z; found = true;
+        }
         
         if (found) {
             double dx=tx-players[i].state.s1, dy=ty-players[i].state.s2, dz=tz-players[i].state.s3; double dist=sqrt(dx*dx+dy*dy+dz*dz);
             if (dist < 1.0) {
                 /* New logic: If target is a PLAYER, show interactive menu */
-                if (tid >= 1 && tid <= 32) {
-                    ConnectedPlayer *target = &players[tid-1];
+                if (t.kind == SI_PLAYER) {
+                    ConnectedPlayer *target = t.player;
                     players[i].pending_bor_target = tid;
+                    players[i].pending_bor_gen = t.gen;
                     char menu[512];
                     if (target->faction == players[i].faction) {
                         players[i].pending_bor_type = 1; /* Ally */
@@ -1058,9 +733,10 @@ void handle_bor(int i, const char *params) {
                     return;
                 }
 
-                if (tid >= 16000) {
+                if (t.kind == SI_PLATFORM) {
                     /* Platform Boarding: Interactive Menu */
                     players[i].pending_bor_target = tid;
+                    players[i].pending_bor_gen = t.gen;
                     players[i].pending_bor_type = 3; /* PLATFORM */
                     char menu[512];
                     sprintf(menu, YELLOW "\n--- BOARDING MENU: DEFENSE PLATFORM [%d] ---\n" RESET 
@@ -1079,7 +755,7 @@ void handle_bor(int i, const char *params) {
                     else if (reward == 2) { 
                         /* Recover Crew or Prisoners */
                         int found_people = 5 + rand()%25;
-                        if (tid >= 11000) { /* Derelict */
+                        if (t.kind == SI_DERELICT) {
                             players[i].state.crew_count += found_people;
                             char m[128]; sprintf(m, "Success! Recovered %d survivors from the wreck.", found_people);
                             send_server_msg(i, "BOARDING", m);
@@ -1111,31 +787,35 @@ void handle_dis(int i, const char *params) {
         int pq1=players[i].state.q1, pq2=players[i].state.q2, pq3=players[i].state.q3;
         bool done = false;
 
-        /* 1. Case: Enemy NPC Wreck (ID 1000-1999) */
-        if (tid >= 1000 && tid < 1000+MAX_NPC && npcs[tid-1000].active && npcs[tid-1000].q1 == pq1 && npcs[tid-1000].q2 == pq2 && npcs[tid-1000].q3 == pq3) {
-            double dx=npcs[tid-1000].x-players[i].state.s1, dy=npcs[tid-1000].y-players[i].state.s2, dz=npcs[tid-1000].z-players[i].state.s3;
+        EntityRef t;
+        bool here = target_ref(i, tid, &t) && entity_in_quadrant(&t, pq1, pq2, pq3);
+
+        /* 1. Case: Enemy NPC Wreck */
+        if (here && t.kind == SI_NPC) {
+            NPCShip *npc = t.npc;
+            double dx=t.x-players[i].state.s1, dy=t.y-players[i].state.s2, dz=t.z-players[i].state.s3;
             if (sqrt(dx*dx+dy*dy+dz*dz) < 1.5) {
-                int yield = (npcs[tid-1000].energy / 100); 
+                int yield = (npc_hot.energy[t.slot] / 100); 
                 if (yield < 10) yield = 10;
                 players[i].state.inventory[2] += yield; 
                 players[i].state.inventory[5] += yield / 5; 
-                npcs[tid-1000].active = 0;
-                players[i].state.dismantle = (NetDismantle){(float)npcs[tid-1000].x, (float)npcs[tid-1000].y, (float)npcs[tid-1000].z, npcs[tid-1000].faction, 1};
+                entity_despawn(SI_NPC, t.slot);
+                fx_point(pq1, pq2, pq3, FX_DISMANTLE, entity_id(SI_PLAYER, i), t.x, t.y, t.z, npc->faction);
                 send_server_msg(i, "ENGINEERING", "Vessel dismantled. Resources transferred to cargo bay.");
                 if (players[i].state.lock_target == tid) players[i].state.lock_target = 0;
                 done = true;
             } else { send_server_msg(i, "COMPUTER", "Not in range for dismantling."); return; }
         } 
-        /* 2. Case: Static Derelict Wreck (ID 11000+) */
-        else if (tid >= 11000 && tid < 11000+MAX_DERELICTS && derelicts[tid-11000].active && derelicts[tid-11000].q1 == pq1 && derelicts[tid-11000].q2 == pq2 && derelicts[tid-11000].q3 == pq3) {
-            int d_idx = tid-11000;
+        /* 2. Case: Static Derelict Wreck */
+        else if (here && t.kind == SI_DERELICT) {
+            int d_idx = t.slot;
             double dx=derelicts[d_idx].x-players[i].state.s1, dy=derelicts[d_idx].y-players[i].state.s2, dz=derelicts[d_idx].z-players[i].state.s3;
             if (sqrt(dx*dx+dy*dy+dz*dz) < 1.5) {
                 int yield = 50 + rand()%150; /* Fixed yield for ancient wrecks */
                 players[i].state.inventory[2] += yield; 
                 players[i].state.inventory[5] += yield / 4; 
-                derelicts[d_idx].active = 0;
-                players[i].state.dismantle = (NetDismantle){(float)derelicts[d_idx].x, (float)derelicts[d_idx].y, (float)derelicts[d_idx].z, 0, 1};
+                entity_despawn(SI_DERELICT, d_idx);
+                fx_point(pq1, pq2, pq3, FX_DISMANTLE, entity_id(SI_PLAYER, i), derelicts[d_idx].x, derelicts[d_idx].y, derelicts[d_idx].z, 0);
                 send_server_msg(i, "ENGINEERING", "Ancient wreck dismantled. Raw materials salvaged.");
                 if (players[i].state.lock_target == tid) players[i].state.lock_target = 0;
                 done = true;
@@ -1151,19 +831,19 @@ void handle_dis(int i, const char *params) {
 void handle_min(int i, const char *params) {
     bool f=false; 
     /* 1. Cerca Pianeti (Distanza <= DIST_MINING_MAX + epsilon) */
-    for(int p=0;p<MAX_PLANETS;p++) if(planets[p].active && planets[p].q1==players[i].state.q1 && planets[p].q2==players[i].state.q2 && planets[p].q3==players[i].state.q3) {
+    for(int p=0, span=entity_span(SI_PLANET);p<span;p++) if(planets[p].active && planets[p].q1==players[i].state.q1 && planets[p].q2==players[i].state.q2 && planets[p].q3==players[i].state.q3) {
         double d=sqrt(pow(planets[p].x-players[i].state.s1,2)+pow(planets[p].y-players[i].state.s2,2)+pow(planets[p].z-players[i].state.s3,2));
         if(d <= (DIST_MINING_MAX + 0.05f)){ int ex=(planets[p].amount>100)?100:planets[p].amount; planets[p].amount-=ex; players[i].state.inventory[planets[p].resource_type]+=ex; send_server_msg(i,"GEOLOGY","Planetary mining successful."); f=true; break; }
     }
     
     /* 2. Cerca Asteroidi (Distanza <= DIST_MINING_MAX + epsilon) if no planet found */
-    if(!f) for(int a=0;a<MAX_ASTEROIDS;a++) if(asteroids[a].active && asteroids[a].q1==players[i].state.q1 && asteroids[a].q2==players[i].state.q2 && asteroids[a].q3==players[i].state.q3) {
+    if(!f) for(int a=0, span=entity_span(SI_ASTEROID);a<span;a++) if(asteroids[a].active && asteroids[a].q1==players[i].state.q1 && asteroids[a].q2==players[i].state.q2 && asteroids[a].q3==players[i].state.q3) {
         double d=sqrt(pow(asteroids[a].x-players[i].state.s1,2)+pow(asteroids[a].y-players[i].state.s2,2)+pow(asteroids[a].z-players[i].state.s3,2));
         if(d <= (DIST_MINING_MAX + 0.05f)){ 
             int ex=(asteroids[a].amount>50)?50:asteroids[a].amount; 
             asteroids[a].amount-=ex; 
             players[i].state.inventory[asteroids[a].resource_type]+=ex; 
-            if(asteroids[a].amount<=0) asteroids[a].active=0; /* Consumed */
+            if(asteroids[a].amount<=0) { entity_despawn(SI_ASTEROID, a); } /* Consumed */
             send_server_msg(i,"MINING","Asteroid extraction complete. Minerals transferred to cargo."); f=true; break; 
         }
     }
@@ -1172,7 +852,7 @@ void handle_min(int i, const char *params) {
 }
 
 void handle_sco(int i, const char *params) {
-    bool near=false; for(int s=0; s<MAX_STARS; s++) if(stars_data[s].active && stars_data[s].q1==players[i].state.q1 && stars_data[s].q2==players[i].state.q2 && stars_data[s].q3==players[i].state.q3) {
+    bool near=false; for(int s=0, span=entity_span(SI_STAR); s<span; s++) if(stars_data[s].active && stars_data[s].q1==players[i].state.q1 && stars_data[s].q2==players[i].state.q2 && stars_data[s].q3==players[i].state.q3) {
         double d=sqrt(pow(stars_data[s].x-players[i].state.s1,2)+pow(stars_data[s].y-players[i].state.s2,2)+pow(stars_data[s].z-players[i].state.s3,2)); if(d<DIST_SCOOPING_MAX) { near=true; break; }
     }
     if(near) { players[i].state.cargo_energy += 5000; if(players[i].state.cargo_energy > 1000000) players[i].state.cargo_energy = 1000000; int s_idx = rand()%6; players[i].state.shields[s_idx] -= 500; if(players[i].state.shields[s_idx]<0) players[i].state.shields[s_idx]=0; send_server_msg(i, "ENGINEERING", "Solar energy stored."); } 
@@ -1180,7 +860,7 @@ void handle_sco(int i, const char *params) {
 }
 
 void handle_har(int i, const char *params) {
-    bool near=false; for(int h=0; h<MAX_BH; h++) if(black_holes[h].active && black_holes[h].q1==players[i].state.q1 && black_holes[h].q2==players[i].state.q2 && black_holes[h].q3==players[i].state.q3) {
+    bool near=false; for(int h=0, span=entity_span(SI_BH); h<span; h++) if(black_holes[h].active && black_holes[h].q1==players[i].state.q1 && black_holes[h].q2==players[i].state.q2 && black_holes[h].q3==players[i].state.q3) {
         double d=sqrt(pow(black_holes[h].x-players[i].state.s1,2)+pow(black_holes[h].y-players[i].state.s2,2)+pow(black_holes[h].z-players[i].state.s3,2)); 
         if(d <= (DIST_INTERACTION_MAX + 0.05f)) { near=true; break; }
     }
@@ -1196,7 +876,7 @@ void handle_har(int i, const char *params) {
 }
 
 void handle_doc(int i, const char *params) {
-    bool near=false; for(int b=0; b<MAX_BASES; b++) if(bases[b].active && bases[b].q1==players[i].state.q1 && bases[b].q2==players[i].state.q2 && bases[b].q3==players[i].state.q3) {
+    bool near=false; for(int b=0, span=entity_span(SI_BASE); b<span; b++) if(bases[b].active && bases[b].q1==players[i].state.q1 && bases[b].q2==players[i].state.q2 && bases[b].q3==players[i].state.q3) {
         double d=sqrt(pow(bases[b].x-players[i].state.s1,2)+pow(bases[b].y-players[i].state.s2,2)+pow(bases[b].z-players[i].state.s3,2)); if(d <= (DIST_DOCKING_MAX + 0.05f)) { near=true; break; } 
     }
     if(near) { 
@@ -1245,12 +925,12 @@ void handle_psy(int i, const char *params) {
     if (players[i].state.corbomite_count > 0) {
         send_server_msg(i, "COMMANDER", "Broadcasting Corbomite threat on all frequencies...");
         int pq1 = players[i].state.q1, pq2 = players[i].state.q2, pq3 = players[i].state.q3;
-        QuadrantIndex *local_q = &spatial_index[pq1][pq2][pq3];
+        QuadrantIndex local_q_view = spatial_quadrant(pq1, pq2, pq3), *local_q = &local_q_view;
         
         if (rand() % 100 < 60) { /* 60% success rate */
             for (int n = 0; n < local_q->npc_count; n++) {
-                local_q->npcs[n]->ai_state = AI_STATE_FLEE;
-                local_q->npcs[n]->energy += 5000; /* Give them a 'panic' boost to run away */
+                npc_hot.ai_state[local_q->npcs[n]] = AI_STATE_FLEE;
+                npc_hot.energy[local_q->npcs[n]] += 5000; /* Give them a 'panic' boost to run away */
             }
             send_server_msg(i, "SCIENCE", "Bluff successful. Hostile vessels are breaking formation!");
         } else {
@@ -1276,17 +956,43 @@ void handle_supernova(int i, const char *params) {
     /* Find a star to explode */
     supernova_event.x = 5.0; supernova_event.y = 5.0; supernova_event.z = 5.0;
     supernova_event.star_id = -1;
-    QuadrantIndex *qi = &spatial_index[q1][q2][q3];
+    QuadrantIndex qi_view = spatial_quadrant(q1, q2, q3), *qi = &qi_view;
     if (qi->star_count > 0) {
-        supernova_event.x = qi->stars[0]->x;
-        supernova_event.y = qi->stars[0]->y;
-        supernova_event.z = qi->stars[0]->z;
-        supernova_event.star_id = qi->stars[0]->id;
+        supernova_event.x = stars_data[qi->stars[0]].x;
+        supernova_event.y = stars_data[qi->stars[0]].y;
+        supernova_event.z = stars_data[qi->stars[0]].z;
+        supernova_event.star_id = stars_data[qi->stars[0]].id;
     }
 
     send_server_msg(i, "ADMIN", "SUPERNOVA INITIATED IN CURRENT QUADRANT.");
 }
 
+/* Replays the recorded track of a ship, newest first, as the lag compensation sees it.
+   It reveals any ship's position, cloaked or not, so only a debug server (-d) answers. */
+void handle_hist(int i, const char *params) {
+    if (!g_debug) { send_server_msg(i, "COMPUTER", "Position history is only available on a debug server."); return; }
+    int tid, n = 10;
+    if (sscanf(params, " %d %d", &tid, &n) < 1) { send_server_msg(i, "COMPUTER", "Usage: hist <ID> [TICKS]"); return; }
+    if (n < 1) n = 1;
+    if (n > LAG_HISTORY_TICKS) n = LAG_HISTORY_TICKS;
+
+    char b[4096], line[128];
+    snprintf(b, sizeof(b), YELLOW "\n--- POSITION HISTORY: %d ---\n" RESET "Link RTT: %d ms | Shots rewound: %d ticks\n",
+             tid, lag_rtt_ms(i), lag_rewind_ticks(i));
+    int shown = 0;
+    for (int k = 0; k < n; k++) {
+        LagSample ls;
+        int tick = lag_view_tick(k);
+        if (!lag_sample(tid, tick, &ls)) break;
+        if (ls.valid) snprintf(line, sizeof(line), "T-%-2d [%d,%d,%d] %.2f,%.2f,%.2f\n", k, ls.q1, ls.q2, ls.q3, ls.x, ls.y, ls.z);
+        else snprintf(line, sizeof(line), "T-%-2d ---\n", k);
+        strncat(b, line, sizeof(b) - strlen(b) - 1);
+        shown++;
+    }
+    if (shown == 0) strncat(b, "No history recorded for that ID.\n", sizeof(b) - strlen(b) - 1);
+    send_server_msg(i, "ADMIN", b);
+}
+
 void handle_rep(int i, const char *params) {
     int sid; 
     if(sscanf(params," %d",&sid) == 1) {
@@ -1315,51 +1021,54 @@ void handle_rep(int i, const char *params) {
     }
 }
 
-void handle_sta(int i, const char *params) {
-    char *b = calloc(4096, sizeof(char));
+void handle_sta(int i, const WorldSnapshot *w, const char *params) {
+    const PlayerView *me = &w->players[i];
+    char *b = arena_alloc(4096);
     if (!b) return;
     
-    const char* f_name = get_species_name(players[i].faction);
+    const char* f_name = get_species_name(me->faction);
     const char* c_names[] = {"Constitution", "Miranda", "Excelsior", "Constellation", "Defiant", "Galaxy", "Sovereign", "Intrepid", "Akira", "Nebula", "Ambassador", "Oberth", "Steamrunner", "Vessel"};
-    const char* class_name = (players[i].ship_class >= 0 && players[i].ship_class <= 13) ? c_names[players[i].ship_class] : "Unknown";
-    snprintf(b, 4096, CYAN "\n.--- LCARS MAIN COMPUTER: SHIP DIAGNOSTICS -----------------------.\n" RESET WHITE " COMMANDER: %-18s CLASS: %-15s\n FACTION:   %-18s STATUS: %s\n CREW COMPLEMENT: %d\n" RESET, players[i].name, class_name, f_name, players[i].state.is_cloaked ? MAGENTA "[ CLOAKED ]" RESET : GREEN "[ ACTIVE ]" RESET, players[i].state.crew_count);
+    const char* class_name = (me->ship_class >= 0 && me->ship_class <= 13) ? c_names[me->ship_class] : "Unknown";
+    snprintf(b, 4096, CYAN "\n.--- LCARS MAIN COMPUTER: SHIP DIAGNOSTICS -----------------------.\n" RESET WHITE " COMMANDER: %-18s CLASS: %-15s\n FACTION:   %-18s STATUS: %s\n CREW COMPLEMENT: %d\n" RESET, me->name, class_name, f_name, me->is_cloaked ? MAGENTA "[ CLOAKED ]" RESET : GREEN "[ ACTIVE ]" RESET, me->crew_count);
     strcat(b, BLUE "\n[ POSITION AND TELEMETRY ]\n" RESET);
-    snprintf(b+strlen(b), 4096-strlen(b), " QUADRANT: [%d,%d,%d]  SECTOR: [%.2f, %.2f, %.2f]\n", players[i].state.q1, players[i].state.q2, players[i].state.q3, players[i].state.s1, players[i].state.s2, players[i].state.s3);
-    snprintf(b+strlen(b), 4096-strlen(b), " HEADING:  %03.0f\302\260        MARK:   %+03.0f\302\260\n", players[i].state.ent_h, players[i].state.ent_m);
-    snprintf(b+strlen(b), 4096-strlen(b), " NAV MODE: %s\n", (players[i].nav_state == NAV_STATE_CHASE) ? B_RED "[ CHASE ACTIVE ]" RESET : "[ NORMAL ]");
+    snprintf(b+strlen(b), 4096-strlen(b), " QUADRANT: [%d,%d,%d]  SECTOR: [%.2f, %.2f, %.2f]\n", me->q1, me->q2, me->q3, me->s1, me->s2, me->s3);
+    snprintf(b+strlen(b), 4096-strlen(b), " HEADING:  %03.0f\302\260        MARK:   %+03.0f\302\260\n", me->ent_h, me->ent_m);
+    snprintf(b+strlen(b), 4096-strlen(b), " NAV MODE: %s\n", (me->nav_state == NAV_STATE_CHASE) ? B_RED "[ CHASE ACTIVE ]" RESET : "[ NORMAL ]");
     strcat(b, BLUE "\n[ POWER AND REACTOR STATUS ]\n" RESET);
-    float en_pct = (players[i].state.energy / 1000000.0f) * 100.0f; char en_bar[21]; int en_fills = (int)(en_pct / 5); for(int j=0; j<20; j++) en_bar[j] = (j < en_fills) ? '|' : '-'; en_bar[20] = '\0';
-    snprintf(b+strlen(b), 4096-strlen(b), " MAIN REACTOR: [%s] %d / 1000000 (%.1f%%)\n ALLOCATION:   ENGINES: %.0f%%  SHIELDS: %.0f%%  WEAPONS: %.0f%%\n", en_bar, players[i].state.energy, en_pct, players[i].state.power_dist[0]*100, players[i].state.power_dist[1]*100, players[i].state.power_dist[2]*100);
+    float en_pct = (me->energy / 1000000.0f) * 100.0f; char en_bar[21]; int en_fills = (int)(en_pct / 5); for(int j=0; j<20; j++) en_bar[j] = (j < en_fills) ? '|' : '-'; en_bar[20] = '\0';
+    snprintf(b+strlen(b), 4096-strlen(b), " MAIN REACTOR: [%s] %d / 1000000 (%.1f%%)\n ALLOCATION:   ENGINES: %.0f%%  SHIELDS: %.0f%%  WEAPONS: %.0f%%\n", en_bar, me->energy, en_pct, me->power_dist[0]*100, me->power_dist[1]*100, me->power_dist[2]*100);
     strcat(b, YELLOW "[ CARGO BAY - LOGISTICS ]\n" RESET);
-    snprintf(b+strlen(b), 4096-strlen(b), " CARGO ANTIMATTER: %-7d  CARGO TORPEDOES: %-3d\n", players[i].state.cargo_energy, players[i].state.cargo_torpedoes);
+    snprintf(b+strlen(b), 4096-strlen(b), " CARGO ANTIMATTER: %-7d  CARGO TORPEDOES: %-3d\n", me->cargo_energy, me->cargo_torpedoes);
     strcat(b, YELLOW "[ STORED MINERALS & RESOURCES ]\n" RESET);
-    snprintf(b+strlen(b), 4096-strlen(b), " DILITHIUM:  %-5d  TRITANIUM:  %-5d  VERTERIUM: %-5d [WARHEADS]\n", players[i].state.inventory[1], players[i].state.inventory[2], players[i].state.inventory[3]);
-    snprintf(b+strlen(b), 4096-strlen(b), " MONOTANIUM: %-5d  ISOLINEAR:  %-5d  GASES:     %-5d\n", players[i].state.inventory[4], players[i].state.inventory[5], players[i].state.inventory[6]);
-    snprintf(b+strlen(b), 4096-strlen(b), " DURANIUM:   %-5d  PRISON UNIT: %-5d  PLATING:   %-5d\n", players[i].state.inventory[7], players[i].state.prison_unit, players[i].state.duranium_plating);
+    snprintf(b+strlen(b), 4096-strlen(b), " DILITHIUM:  %-5d  TRITANIUM:  %-5d  VERTERIUM: %-5d [WARHEADS]\n", me->inventory[1], me->inventory[2], me->inventory[3]);
+    snprintf(b+strlen(b), 4096-strlen(b), " MONOTANIUM: %-5d  ISOLINEAR:  %-5d  GASES:     %-5d\n", me->inventory[4], me->inventory[5], me->inventory[6]);
+    snprintf(b+strlen(b), 4096-strlen(b), " DURANIUM:   %-5d  PRISON UNIT: %-5d  PLATING:   %-5d\n", me->inventory[7], me->prison_unit, me->duranium_plating);
     strcat(b, BLUE "\n[ DEFENSIVE GRID AND ARMAMENTS ]\n" RESET);
-    snprintf(b+strlen(b), 4096-strlen(b), " SHIELDS: F:%-4d R:%-4d T:%-4d B:%-4d L:%-4d RI:%-4d\n PHOTON TORPEDOES: %-2d  LOCK: %s\n", players[i].state.shields[0], players[i].state.shields[1], players[i].state.shields[2], players[i].state.shields[3], players[i].state.shields[4], players[i].state.shields[5], players[i].state.torpedoes, (players[i].state.lock_target > 0) ? RED "[ LOCKED ]" RESET : "[ NONE ]");
+    snprintf(b+strlen(b), 4096-strlen(b), " SHIELDS: F:%-4d R:%-4d T:%-4d B:%-4d L:%-4d RI:%-4d\n PHOTON TORPEDOES: %-2d  LOCK: %s\n", me->shields[0], me->shields[1], me->shields[2], me->shields[3], me->shields[4], me->shields[5], me->torpedoes, (me->lock_target > 0) ? RED "[ LOCKED ]" RESET : "[ NONE ]");
     strcat(b, BLUE "\n[ SYSTEMS INTEGRITY ]\n" RESET);
     const char* sys[] = {"Warp","Imp","Sens","Tran","Phas","Torp","Comp","Life"};
-    for(int s=0; s<8; s++) { float hp = players[i].state.system_health[s]; const char* col = (hp > 75) ? GREEN : (hp > 25) ? YELLOW : RED; snprintf(b+strlen(b), 4096-strlen(b), " %-8s: %s%5.1f%%" RESET " ", sys[s], col, hp); if (s == 3) strcat(b, "\n"); }
+    for(int s=0; s<8; s++) { float hp = me->system_health[s]; const char* col = (hp > 75) ? GREEN : (hp > 25) ? YELLOW : RED; snprintf(b+strlen(b), 4096-strlen(b), " %-8s: %s%5.1f%%" RESET " ", sys[s], col, hp); if (s == 3) strcat(b, "\n"); }
     strcat(b, CYAN "\n'-----------------------------------------------------------------'\n" RESET);
     send_server_msg(i, "COMPUTER", b);
-    free(b);
 }
 
-void handle_inv(int i, const char *params) {
+void handle_inv(int i, const WorldSnapshot *w, const char *params) {
+    const PlayerView *me = &w->players[i];
     char b[512]=YELLOW "\n--- CARGO MANIFEST ---\n" RESET; char it[64]; const char* r[]={"-","Dilithium","Tritanium","Verterium (Torp)","Monotanium","Isolinear","Gases","Duranium","Prisoners"};
-    for(int j=1; j<=8; j++){ sprintf(it," %-16s: %-4d\n",r[j],players[i].state.inventory[j]); strcat(b,it); }
-    snprintf(it, sizeof(it), BLUE " CARGO Antimatter: %d\n CARGO Torpedoes:  %d\n" RESET, players[i].state.cargo_energy, players[i].state.cargo_torpedoes); strcat(b, it);
+    for(int j=1; j<=8; j++){ sprintf(it," %-16s: %-4d\n",r[j],me->inventory[j]); strcat(b,it); }
+    snprintf(it, sizeof(it), BLUE " CARGO Antimatter: %d\n CARGO Torpedoes:  %d\n" RESET, me->cargo_energy, me->cargo_torpedoes); strcat(b, it);
     send_server_msg(i, "LOGISTICS", b);
 }
 
-void handle_dam(int i, const char *params) {
+void handle_dam(int i, const WorldSnapshot *w, const char *params) {
+    const PlayerView *me = &w->players[i];
     char b[512]=RED "\n--- DAMAGE REPORT ---" RESET; char sbuf[64]; const char* sys[]={"Warp","Impulse","Sensors","Transp","Phasers","Torps","Computer","Life"};
-    for(int s=0; s<8; s++){ sprintf(sbuf," %-10s: %.1f%%\n",sys[s],players[i].state.system_health[s]); strcat(b,sbuf); }
+    for(int s=0; s<8; s++){ sprintf(sbuf," %-10s: %.1f%%\n",sys[s],me->system_health[s]); strcat(b,sbuf); }
     send_server_msg(i, "ENGINEERING", b);
 }
 
-void handle_cal(int i, const char *params) {
+void handle_cal(int i, const WorldSnapshot *w, const char *params) {
+    const PlayerView *me = &w->players[i];
     int qx, qy, qz; 
     float sx = 5.0f, sy = 5.0f, sz = 5.0f;
     int args = sscanf(params, "%d %d %d %f %f %f", &qx, &qy, &qz, &sx, &sy, &sz);
@@ -1375,9 +1084,9 @@ void handle_cal(int i, const char *params) {
         double target_gy = (qy - 1) * 10.0 + sy;
         double target_gz = (qz - 1) * 10.0 + sz;
         
-        double dx = target_gx - players[i].gx;
-        double dy = target_gy - players[i].gy;
-        double dz = target_gz - players[i].gz;
+        double dx = target_gx - me->gx;
+        double dy = target_gy - me->gy;
+        double dz = target_gz - me->gz;
         double d = sqrt(dx*dx + dy*dy + dz*dz);
         
         if (d < 0.001) {
@@ -1417,10 +1126,10 @@ void handle_cal(int i, const char *params) {
     }
 }
 
-void handle_who(int i, const char *params) {
+void handle_who(int i, const WorldSnapshot *w, const char *params) {
     char b[1024]=WHITE "\n--- ACTIVE CAPTAINS LOG ---\n" RESET;
-    for(int j=0; j<MAX_CLIENTS; j++) if(players[j].active) {
-        char line[128]; sprintf(line, " [%2d] %-18s (Q:%d,%d,%d)\n", j+1, players[j].name, players[j].state.q1, players[j].state.q2, players[j].state.q3);
+    for(int j=0; j<MAX_CLIENTS; j++) if(w->players[j].active) {
+        char line[128]; sprintf(line, " [%2d] %-18s (Q:%d,%d,%d)\n", j+1, w->players[j].name, w->players[j].q1, w->players[j].q2, w->players[j].q3);
         strcat(b, line);
     }
     send_server_msg(i, "COMPUTER", b);
@@ -1433,7 +1142,7 @@ void handle_aux(int i, const char *params) {
     if(strncmp(p_ptr, "jettison", 8) == 0) {
         send_server_msg(i, "ENGINEERING", "WARP CORE EJECTED! MASSIVE ENERGY DISCHARGE DETECTED!");
         players[i].state.energy = 0; players[i].active = 0;
-        players[i].state.boom = (NetPoint){(float)players[i].state.s1, (float)players[i].state.s2, (float)players[i].state.s3, 1};
+        fx_point(players[i].state.q1, players[i].state.q2, players[i].state.q3, FX_BOOM, 0, players[i].state.s1, players[i].state.s2, players[i].state.s3, 0);
     } else if(strncmp(p_ptr, "probe", 5) == 0) {
         int qx, qy, qz;
         const char *args = p_ptr + 5;
@@ -1459,6 +1168,7 @@ void handle_aux(int i, const char *params) {
             
             /* Launch probe */
             players[i].state.probes[p_idx].active = 1;
+            entity_spawned(ENT_PROBE, i * 3 + p_idx);
             players[i].state.probes[p_idx].q1 = qx;
             players[i].state.probes[p_idx].q2 = qy;
             players[i].state.probes[p_idx].q3 = qz;
@@ -1520,7 +1230,7 @@ void handle_aux(int i, const char *params) {
             int pq3 = players[i].state.probes[p_idx].q3;
             
             /* Real-time Query via Live Spatial Index */
-            QuadrantIndex *lq = &spatial_index[pq1][pq2][pq3];
+            QuadrantIndex lq_view = spatial_quadrant(pq1, pq2, pq3), *lq = &lq_view;
             
             char msg[1024];
             sprintf(msg, "\n" CYAN ".--- PROBE P%d: REAL-TIME DEEP SPACE TELEMETRY ---." RESET "\n"
@@ -1608,7 +1318,7 @@ void handle_aux(int i, const char *params) {
 void handle_xxx(int i, const char *params) {
     send_server_msg(i, "COMPUTER", "Self-destruct sequence initiated. Zero-zero-zero-destruct-zero.");
     players[i].state.energy = 0; players[i].state.crew_count = 0; players[i].active = 0;
-    players[i].state.boom = (NetPoint){(float)players[i].state.s1, (float)players[i].state.s2, (float)players[i].state.s3, 1};
+    fx_point(players[i].state.q1, players[i].state.q2, players[i].state.q3, FX_BOOM, 0, players[i].state.s1, players[i].state.s2, players[i].state.s3, 0);
 }
 
 void handle_hull(int i, const char *params) {
@@ -1707,14 +1417,119 @@ void handle_ical(int i, const char *params) {
 
 /* --- Command Registry Table --- */
 
+#define MAX_MACROS 8
+
+typedef struct {
+    char name[16];
+    int tick_delay;
+    char body[256]; /* ';' separated command list */
+} CommandMacro;
+
+typedef struct {
+    char cmds[MAX_BATCH_COMMANDS][256];
+    int count, next;
+    int tick_delay;
+    int next_tick;
+} CommandQueue;
+
+static CommandMacro player_macros[MAX_CLIENTS][MAX_MACROS];
+static CommandQueue pending_batches[MAX_CLIENTS];
+
+static void execute_batch(int i, const char (*cmds)[256], int count, int tick_delay);
+
+/* Splits "cmd; cmd; cmd" into trimmed entries. Returns the count, or -1 if a command
+   does not fit in 255 characters: it is never run cut short. */
+static int split_command_list(const char *text, char out[MAX_BATCH_COMMANDS][256]) {
+    int count = 0;
+    const char *p = text;
+    while (*p && count < MAX_BATCH_COMMANDS) {
+        while (*p == ' ' || *p == ';') p++;
+        if (!*p) break;
+        const char *end = strchr(p, ';');
+        if (!end) end = p + strlen(p);
+        size_t len = (size_t)(end - p);
+        while (len > 0 && p[len-1] == ' ') len--;
+        if (len > 255) return -1;
+        memcpy(out[count], p, len);
+        out[count][len] = '\0';
+        count++;
+        p = end;
+    }
+    return count;
+}
+
+void handle_mac(int i, const char *params) {
+    CommandMacro *macros = player_macros[i];
+    char verb[16] = {0};
+    int off = 0;
+    if (sscanf(params, " %15s %n", verb, &off) < 1) strcpy(verb, "list");
+    const char *rest = params + off;
+
+    if (strcmp(verb, "list") == 0) {
+        char b[4096];
+        int len = snprintf(b, sizeof(b), CYAN "\n--- STORED COMMAND MACROS ---\n" RESET);
+        int n = 0;
+        for (int m = 0; m < MAX_MACROS; m++) {
+            if (!macros[m].name[0]) continue;
+            len += snprintf(b + len, sizeof(b) - len, WHITE "%-15s" RESET " [+%d] %s\n", macros[m].name, macros[m].tick_delay, macros[m].body);
+            n++;
+        }
+        if (n == 0) snprintf(b + len, sizeof(b) - len, "No macros stored. Usage: mac def <NAME> [+TICKS] cmd; cmd; ...\n");
+        send_server_msg(i, "COMPUTER", b);
+    } else if (strcmp(verb, "def") == 0) {
+        char name[16]; int delay = 0, noff = 0;
+        if (sscanf(rest, "%15s %n", name, &noff) < 1 || !rest[noff]) {
+            send_server_msg(i, "COMPUTER", "Usage: mac def <NAME> [+TICKS] cmd; cmd; ...");
+            return;
+        }
+        const char *body = rest + noff;
+        if (body[0] == '+') { int doff = 0; sscanf(body + 1, "%d %n", &delay, &doff); body += 1 + doff; }
+        if (delay < 0) delay = 0;
+        if (delay > MAX_BATCH_TICK_DELAY) delay = MAX_BATCH_TICK_DELAY;
+        char cmds[MAX_BATCH_COMMANDS][256];
+        int count = split_command_list(body, cmds);
+        if (count < 0 || strlen(body) >= sizeof(macros[0].body)) { send_server_msg(i, "COMPUTER", "Macro too long (255 characters max)."); return; }
+        for (int c = 0; c < count; c++) {
+            if (strncmp(cmds[c], "mac", 3) == 0) { send_server_msg(i, "COMPUTER", "Macros cannot invoke other macros."); return; }
+        }
+        if (count == 0) { send_server_msg(i, "COMPUTER", "Macro body is empty."); return; }
+        int slot = -1;
+        for (int m = 0; m < MAX_MACROS; m++) if (strcmp(macros[m].name, name) == 0) { slot = m; break; }
+        if (slot == -1) for (int m = 0; m < MAX_MACROS; m++) if (!macros[m].name[0]) { slot = m; break; }
+        if (slot == -1) { send_server_msg(i, "COMPUTER", "Macro memory full. Delete one with 'mac del <NAME>'."); return; }
+        strcpy(macros[slot].name, name);
+        macros[slot].tick_delay = delay;
+        snprintf(macros[slot].body, sizeof(macros[slot].body), "%s", body);
+        char msg[128]; snprintf(msg, sizeof(msg), "Macro '%s' stored (%d commands).", name, count);
+        send_server_msg(i, "COMPUTER", msg);
+    } else if (strcmp(verb, "del") == 0) {
+        char name[16];
+        if (sscanf(rest, "%15s", name) != 1) { send_server_msg(i, "COMPUTER", "Usage: mac del <NAME>"); return; }
+        for (int m = 0; m < MAX_MACROS; m++) {
+            if (strcmp(macros[m].name, name) == 0) { memset(&macros[m], 0, sizeof(CommandMacro)); send_server_msg(i, "COMPUTER", "Macro deleted."); return; }
+        }
+        send_server_msg(i, "COMPUTER", "No such macro.");
+    } else {
+        for (int m = 0; m < MAX_MACROS; m++) {
+            if (strcmp(macros[m].name, verb) == 0) {
+                char cmds[MAX_BATCH_COMMANDS][256];
+                int count = split_command_list(macros[m].body, cmds);
+                if (count > 0) execute_batch(i, (const char (*)[256])cmds, count, macros[m].tick_delay);
+                return;
+            }
+        }
+        send_server_msg(i, "COMPUTER", "No such macro. Type 'mac list'.");
+    }
+}
+
 static const CommandDef command_registry[] = {
     {"nav ", handle_nav, "Warp Navigation <H> <M> <W> [Factor]"},
     {"imp ", handle_imp, "Impulse Drive <H> <M> <S>"},
     {"jum ", handle_jum, "Wormhole Jump <Q1> <Q2> <Q3>"},
     {"apr ", handle_apr, "Approach target <ID> <DIST>"},
     {"cha",  handle_cha, "Chase locked target"},
-    {"srs",  handle_srs, "Short Range Sensors"},
-    {"lrs",  handle_lrs, "Long Range Sensors"},
+    {"srs",  NULL, "Short Range Sensors", handle_srs},
+    {"lrs",  NULL, "Long Range Sensors", handle_lrs},
     {"pha ", handle_pha, "Fire Phasers <ID> <E> or <E> (Lock)"},
     {"tor",  handle_tor, "Fire Torpedo <H> <M> or auto (Lock)"},
     {"she ", handle_she, "Shield Configuration <F> <R> <T> <B> <L> <RI>"},
@@ -1722,33 +1537,35 @@ static const CommandDef command_registry[] = {
     {"enc ", handle_enc,  "Encryption Toggle <algo>"},
     {"pow ", handle_pow,  "Power Allocation <E> <S> <W>"},
     {"psy",  handle_psy,  "Psychological Warfare (Bluff)"},
-    {"scan ",handle_scan, "Detailed Scan <ID>"},
+    {"scan ", NULL, "Detailed Scan <ID>", handle_scan},
     {"clo",  handle_clo, "Cloaking Device"},
     {"bor",  handle_bor, "Boarding Party"},
     {"dis",  handle_dis, "Dismantle Wreck"},
     {"min",  handle_min, "Planetary Mining"},
+    {"mac",  handle_mac, "Command Macros <def|del|list|NAME>"},
     {"sco",  handle_sco, "Solar Scooping"},
     {"har",  handle_har, "Antimatter Harvest"},
     {"doc",  handle_doc, "Dock at Starbase"},
     {"con ", handle_con, "Resource Converter"},
     {"load ",handle_load, "Load Cargo"},
     {"rep",  handle_rep, "Repair Systems"},
-    {"sta",  handle_sta, "Status Report"},
-    {"inv",  handle_inv, "Inventory Report"},
-    {"dam",  handle_dam, "Damage Report"},
-    {"cal ", handle_cal, "Warp Calculator <QX><QY><QZ> [SX][SY][SZ]"},
+    {"sta",  NULL, "Status Report", handle_sta},
+    {"inv",  NULL, "Inventory Report", handle_inv},
+    {"dam",  NULL, "Damage Report", handle_dam},
+    {"cal ", NULL, "Warp Calculator <QX><QY><QZ> [SX][SY][SZ]", handle_cal},
     {"ical ",handle_ical, "Impulse Calculator (ETA)"},
-    {"who",  handle_who, "Active Captains List"},
+    {"who",  NULL, "Active Captains List", handle_who},
     {"help", handle_help, "Display this directory"},
     {"aux ", handle_aux, "Auxiliary (probe/report/recover)"},
     {"xxx",  handle_xxx, "Self-Destruct"},
     {"hull", handle_hull, "Reinforce Hull (100 Duranium)"},
     {"supernova", handle_supernova, "Admin: Trigger Supernova"},
+    {"hist ", handle_hist, "Debug: Position History <ID> [TICKS] (server -d only)"},
     {NULL, NULL, NULL}
 };
 
 void handle_help(int i, const char *params) {
-    char *b = calloc(4096, sizeof(char));
+    char *b = arena_alloc(4096);
     if (!b) return;
     
     strcpy(b, CYAN "\n--- LCARS COMMAND DIRECTORY ---" RESET);
@@ -1758,12 +1575,26 @@ void handle_help(int i, const char *params) {
         strcat(b, line);
     }
     send_server_msg(i, "COMPUTER", b);
-    free(b);
 }
 
-void process_command(int i, const char *cmd) {
-    pthread_mutex_lock(&game_mutex);
-    
+/* First registry entry whose name prefixes cmd */
+static const CommandDef *find_command(const char *cmd) {
+    for (int c = 0; command_registry[c].name != NULL; c++)
+        if (strncmp(cmd, command_registry[c].name, strlen(command_registry[c].name)) == 0) return &command_registry[c];
+    return NULL;
+}
+
+static void run_entry(int i, const CommandDef *def, const char *cmd) {
+    const char *params = cmd + strlen(def->name);
+    if (!def->view) { def->handler(i, params); return; }
+    const WorldSnapshot *w = snapshot_acquire();
+    if (!w) return;
+    def->view(i, w, params);
+    snapshot_release(w);
+}
+
+/* Caller holds game_mutex */
+static void dispatch_command(int i, const char *cmd) {
     /* Intercept numeric input for pending boarding actions */
     if (players[i].pending_bor_target > 0) {
         /* Check if input is a pure number 1-3 */
@@ -1771,42 +1602,39 @@ void process_command(int i, const char *cmd) {
             int choice = cmd[0] - '0';
             int tid = players[i].pending_bor_target;
             
-            /* Target resolution based on ID range */
-            double tx=0, ty=0, tz=0;
-            ConnectedPlayer *target_p = NULL;
-
-            if (tid <= 32) {
-                target_p = &players[tid-1];
-                tx = target_p->state.s1; ty = target_p->state.s2; tz = target_p->state.s3;
-            } else if (tid >= 16000) {
-                int pt_idx = tid - 16000;
-                tx = platforms[pt_idx].x; ty = platforms[pt_idx].y; tz = platforms[pt_idx].z;
-            }
+            /* The menu was offered for one body: a destroyed or replaced one cancels it */
+            EntityRef t;
+            bool held = entity_resolve(tid, players[i].pending_bor_gen, &t) &&
+                        entity_in_quadrant(&t, players[i].state.q1, players[i].state.q2, players[i].state.q3);
+            ConnectedPlayer *target_p = (held && t.kind == SI_PLAYER) ? t.player : NULL;
+            NPCPlatform *target_pt = (held && t.kind == SI_PLATFORM) ? t.platform : NULL;
 
             /* Verify distance */
-            double dx = tx - players[i].state.s1;
-            double dy = ty - players[i].state.s2;
-            double dz = tz - players[i].state.s3;
-            if (sqrt(dx*dx+dy*dy+dz*dz) > 1.2) {
+            double dx = held ? t.x - players[i].state.s1 : 0;
+            double dy = held ? t.y - players[i].state.s2 : 0;
+            double dz = held ? t.z - players[i].state.s3 : 0;
+            if (!held) {
+                send_server_msg(i, "COMPUTER", "Boarding target lost. Operation cancelled.");
+            } else if (sqrt(dx*dx+dy*dy+dz*dz) > 1.2) {
                 send_server_msg(i, "COMPUTER", "Target out of transporter range. Operation cancelled.");
             } else {
-                if (players[i].pending_bor_type == 1) { /* ALLY PLAYER */
+                if (players[i].pending_bor_type == 1 && target_p) { /* ALLY PLAYER */
                     if (choice == 1) {
                         int amount = 50000; if(players[i].state.energy < amount) amount = players[i].state.energy;
                         players[i].state.energy -= amount; target_p->state.energy += amount;
                         send_server_msg(i, "ENGINEERING", "Energy transfer complete.");
-                        send_server_msg(tid-1, "ENGINEERING", "Received emergency energy from allied vessel.");
+                        send_server_msg(t.slot, "ENGINEERING", "Received emergency energy from allied vessel.");
                     } else if (choice == 2) {
                         int sys = rand()%10; target_p->state.system_health[sys] = 100.0f;
                         send_server_msg(i, "ENGINEERING", "Repairs performed on allied ship.");
-                        send_server_msg(tid-1, "ENGINEERING", "Allied engineers fixed one of our systems.");
+                        send_server_msg(t.slot, "ENGINEERING", "Allied engineers fixed one of our systems.");
                     } else {
                         int crew = 20; if(players[i].state.crew_count < 50) crew = 0;
                         players[i].state.crew_count -= crew; target_p->state.crew_count += crew;
                         send_server_msg(i, "SECURITY", "Personnel transferred to ally.");
-                        send_server_msg(tid-1, "SECURITY", "Allied reinforcements joined our crew.");
+                        send_server_msg(t.slot, "SECURITY", "Allied reinforcements joined our crew.");
                     }
-                } else if (players[i].pending_bor_type == 2) { /* ENEMY PLAYER */
+                } else if (players[i].pending_bor_type == 2 && target_p) { /* ENEMY PLAYER */
                     if (rand()%100 < 30) {
                         int loss = 5 + rand()%10; players[i].state.crew_count -= loss;
                         send_server_msg(i, "SECURITY", "Raid repelled! Team suffered casualties.");
@@ -1814,30 +1642,29 @@ void process_command(int i, const char *cmd) {
                         if (choice == 1) {
                             int sys = rand()%10; target_p->state.system_health[sys] = 0.0f;
                             send_server_msg(i, "BOARDING", "Sabotage successful. Enemy system offline.");
-                            send_server_msg(tid-1, "CRITICAL", "Intruders sabotaged our systems!");
+                            send_server_msg(t.slot, "CRITICAL", "Intruders sabotaged our systems!");
                         } else if (choice == 2) {
                             int res = 1 + rand()%6; int amt = target_p->state.inventory[res] / 2;
                             target_p->state.inventory[res] -= amt; players[i].state.inventory[res] += amt;
                             send_server_msg(i, "BOARDING", "Raid successful. Resources seized.");
-                            send_server_msg(tid-1, "SECURITY", "Enemy raid in progress! Cargo hold breached!");
+                            send_server_msg(t.slot, "SECURITY", "Enemy raid in progress! Cargo hold breached!");
                         } else {
                             int pris = 2 + rand()%10; target_p->state.crew_count -= pris; players[i].state.prison_unit += pris;
                             send_server_msg(i, "SECURITY", "Hostages captured. Prisoners in Prison Unit.");
-                            send_server_msg(tid-1, "SECURITY", "Intruders captured our officers!");
+                            send_server_msg(t.slot, "SECURITY", "Intruders captured our officers!");
                         }
                     }
-                } else if (players[i].pending_bor_type == 3) { /* PLATFORM */
-                    int pt_idx = tid - 16000;
+                } else if (players[i].pending_bor_type == 3 && target_pt) { /* PLATFORM */
                     if (rand()%100 < 40) {
                         int loss = 10 + rand()%20; players[i].state.crew_count -= loss;
                         send_server_msg(i, "SECURITY", "Platform automated defenses active! Team suffered casualties.");
                     } else {
                         if (choice == 1) {
-                            platforms[pt_idx].faction = players[i].faction;
+                            target_pt->faction = players[i].faction;
                             send_server_msg(i, "BOARDING", "IFF Reprogrammed. Platform captured.");
                         } else if (choice == 2) {
-                            platforms[pt_idx].active = 0;
-                            players[i].state.boom = (NetPoint){(float)platforms[pt_idx].x, (float)platforms[pt_idx].y, (float)platforms[pt_idx].z, 1};
+                            entity_despawn(SI_PLATFORM, t.slot);
+                            fx_point(players[i].state.q1, players[i].state.q2, players[i].state.q3, FX_BOOM, 0, target_pt->x, target_pt->y, target_pt->z, 0);
                             send_server_msg(i, "BOARDING", "Self-destruct triggered. Platform neutralized.");
                         } else {
                             players[i].state.inventory[5] += 250;
@@ -1847,24 +1674,15 @@ void process_command(int i, const char *cmd) {
                 }
             }
             players[i].pending_bor_target = 0;
-            pthread_mutex_unlock(&game_mutex);
             return;
         } else {
             players[i].pending_bor_target = 0;
         }
     }
 
-    bool found = false;
-    for (int c = 0; command_registry[c].name != NULL; c++) {
-        size_t len = strlen(command_registry[c].name);
-        if (strncmp(cmd, command_registry[c].name, len) == 0) {
-            command_registry[c].handler(i, cmd + len);
-            found = true;
-            break;
-        }
-    }
-    
-    if (!found) {
+    const CommandDef *def = find_command(cmd);
+    if (def) run_entry(i, def, cmd);
+    else {
         char first_word[32]; sscanf(cmd, "%31s", first_word);
         int cmd_idx = -1;
         for (int c = 0; command_registry[c].name != NULL; c++) {
@@ -1896,9 +1714,10 @@ void process_command(int i, const char *cmd) {
                            " INFO:   Chase mode. Intercepts and follows locked target.\n"
                            "         Maintains optimal combat/interaction distance.\n");
             } else if (strcmp(n, "srs") == 0) {
-                strcat(hb, WHITE " USAGE:  " GREEN "srs" RESET "\n"
+                strcat(hb, WHITE " USAGE:  " GREEN "srs [TYPE]" RESET "\n"
                            " INFO:   Short Range Scan. Lists all objects in sector.\n"
-                           "         Provides IDs, coordinates, and health status.\n");
+                           "         Provides IDs, coordinates, and health status.\n"
+                           "         TYPE (e.g. 'srs vessel') filters the list on the console.\n");
             } else if (strcmp(n, "lrs") == 0) {
                 strcat(hb, WHITE " USAGE:  " GREEN "lrs" RESET "\n"
                            " INFO:   Long Range Scan. Maps adjacent 26 quadrants.\n"
@@ -1961,5 +1780,203 @@ void process_command(int i, const char *cmd) {
             send_server_msg(i, "COMPUTER", "Invalid command. Type 'help' for assistance.");
         }
     }
-    pthread_mutex_unlock(&game_mutex);
+}
+
+/* Handler scratch comes from the thread's arena and is dropped once the command returns */
+static void run_command(int i, const char *cmd) {
+    ArenaMark mark = arena_mark();
+    dispatch_command(i, cmd);
+    arena_release(mark);
+}
+
+/* --- Command Ingestion --- */
+
+/* A command parsed on the network thread, applied by the tick. Single commands carry the
+   registry entry they resolved to; batches carry their whole list. */
+typedef struct CommandRecord {
+    struct CommandRecord *next;
+    int p_idx;
+    int fd;              /* Link the command arrived on; dropped if the slot moved on */
+    const CommandDef *def; /* NULL: unknown or boarding input, goes through full dispatch */
+    int tick_delay;      /* Batches only */
+    int count;           /* 1 for a single command */
+    char cmds[][256];
+} CommandRecord;
+
+/* Token bucket per slot, touched only by the network thread, except for notice_fd */
+typedef struct {
+    int fd;
+    double tokens;
+    struct timespec last;
+    bool throttled;      /* Captain already told; cleared once input is accepted again */
+    int notice_fd;       /* Atomic: link owed a rate notice, sent by the tick; 0 for none */
+} CommandLimiter;
+
+static CommandRecord *cmd_inbox = NULL; /* MPSC stack: pushed by producers, taken whole by the tick */
+static int cmd_depth = 0, cmd_depth_high = 0;
+static uint64_t cmd_queued = 0, cmd_applied = 0, cmd_stale = 0, cmd_rate_drops = 0, cmd_full_drops = 0;
+static CommandLimiter limiters[MAX_CLIENTS];
+
+static bool admit_command(int i, int cost) {
+    CommandLimiter *l = &limiters[i];
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (l->fd != players[i].socket) { /* New link in this slot: full bucket */
+        l->fd = players[i].socket;
+        l->tokens = CMD_RATE_BURST;
+        l->throttled = false;
+    } else {
+        double dt = (now.tv_sec - l->last.tv_sec) + (now.tv_nsec - l->last.tv_nsec) / 1e9;
+        l->tokens += dt * CMD_RATE_PER_SEC;
+        if (l->tokens > CMD_RATE_BURST) l->tokens = CMD_RATE_BURST;
+    }
+    l->last = now;
+
+    if (l->tokens < cost) {
+        __atomic_fetch_add(&cmd_rate_drops, 1, __ATOMIC_RELAXED);
+        if (!l->throttled) __atomic_store_n(&l->notice_fd, l->fd, __ATOMIC_RELAXED);
+        l->throttled = true;
+        return false;
+    }
+    l->tokens -= cost;
+    l->throttled = false;
+    return true;
+}
+
+static void enqueue_command(CommandRecord *rec) {
+    int depth = __atomic_add_fetch(&cmd_depth, 1, __ATOMIC_RELAXED);
+    if (depth > CMD_QUEUE_MAX_RECORDS) {
+        __atomic_fetch_sub(&cmd_depth, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&cmd_full_drops, 1, __ATOMIC_RELAXED);
+        LOG_DEBUG("Command queue full, dropping input from slot %d\n", rec->p_idx);
+        slab_free(rec);
+        return;
+    }
+    int high = __atomic_load_n(&cmd_depth_high, __ATOMIC_RELAXED);
+    while (depth > high && !__atomic_compare_exchange_n(&cmd_depth_high, &high, depth, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    __atomic_fetch_add(&cmd_queued, 1, __ATOMIC_RELAXED);
+
+    rec->next = __atomic_load_n(&cmd_inbox, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&cmd_inbox, &rec->next, rec, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+static CommandRecord *new_record(int i, int count) {
+    CommandRecord *rec = slab_alloc(sizeof(CommandRecord) + count * sizeof(rec->cmds[0]));
+    if (!rec) return NULL;
+    rec->p_idx = i;
+    rec->fd = players[i].socket;
+    rec->def = NULL;
+    rec->tick_delay = 0;
+    rec->count = count;
+    return rec;
+}
+
+void process_command(int i, const char *cmd) {
+    if (!admit_command(i, 1)) return;
+    const CommandDef *def = find_command(cmd);
+
+    /* Reports are answered from the snapshot right away, unless a boarding prompt is waiting for this input.
+       The replies are queued under game_mutex after the handler, which itself runs without it. */
+    if (def && def->view && __atomic_load_n(&players[i].pending_bor_target, __ATOMIC_RELAXED) == 0) {
+        ArenaMark mark = arena_mark();
+        crypto_pool_hold();
+        run_entry(i, def, cmd);
+        crypto_pool_release();
+        arena_release(mark);
+        return;
+    }
+
+    CommandRecord *rec = new_record(i, 1);
+    if (!rec) return;
+    rec->def = def;
+    strncpy(rec->cmds[0], cmd, 255);
+    rec->cmds[0][255] = '\0';
+    enqueue_command(rec);
+}
+
+/* --- Command Batches & Macros --- */
+
+/* Runs a command list for captain i. Without a delay every step executes inside the
+   caller's lock scope; with one, the first step runs now and the rest are queued. */
+static void execute_batch(int i, const char (*cmds)[256], int count, int tick_delay) {
+    if (count <= 0) return;
+    if (tick_delay <= 0) {
+        for (int c = 0; c < count; c++) run_command(i, cmds[c]);
+        return;
+    }
+    if (pending_batches[i].next < pending_batches[i].count)
+        send_server_msg(i, "COMPUTER", "Previous command sequence superseded.");
+    CommandQueue *q = &pending_batches[i];
+    memcpy(q->cmds, cmds, count * sizeof(q->cmds[0]));
+    q->count = count;
+    q->next = 1;
+    q->tick_delay = tick_delay;
+    q->next_tick = global_tick + tick_delay;
+    run_command(i, cmds[0]);
+}
+
+void process_batch(int i, const PacketBatch *pkt) {
+    int count = (pkt->count > MAX_BATCH_COMMANDS) ? MAX_BATCH_COMMANDS : pkt->count;
+    if (count <= 0 || !admit_command(i, count)) return;
+    CommandRecord *rec = new_record(i, count);
+    if (!rec) return;
+    for (int c = 0; c < count; c++) { memcpy(rec->cmds[c], pkt->cmds[c], 255); rec->cmds[c][255] = '\0'; }
+    rec->tick_delay = (pkt->tick_delay > MAX_BATCH_TICK_DELAY) ? MAX_BATCH_TICK_DELAY : pkt->tick_delay;
+    enqueue_command(rec);
+}
+
+/* Applies everything received since the last tick, in arrival order. Caller holds game_mutex. */
+void run_queued_commands() {
+    CommandRecord *rec = __atomic_exchange_n(&cmd_inbox, NULL, __ATOMIC_ACQUIRE);
+    CommandRecord *fifo = NULL;
+    while (rec) { CommandRecord *next = rec->next; rec->next = fifo; fifo = rec; rec = next; }
+
+    while (fifo) {
+        rec = fifo;
+        fifo = rec->next;
+        __atomic_fetch_sub(&cmd_depth, 1, __ATOMIC_RELAXED);
+        int i = rec->p_idx;
+        if (players[i].socket != rec->fd || !players[i].active) {
+            cmd_stale++;
+        } else if (rec->count > 1 || rec->tick_delay > 0) {
+            execute_batch(i, (const char (*)[256])rec->cmds, rec->count, rec->tick_delay);
+            cmd_applied += rec->count;
+        } else if (rec->def && players[i].pending_bor_target == 0) {
+            ArenaMark mark = arena_mark();
+            run_entry(i, rec->def, rec->cmds[0]);
+            arena_release(mark);
+            cmd_applied++;
+        } else {
+            run_command(i, rec->cmds[0]);
+            cmd_applied++;
+        }
+        slab_free(rec);
+    }
+
+    /* Rate notices owed by the network thread, which cannot send without game_mutex. They
+       follow the inputs that were accepted before the bucket ran dry. */
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        int fd = __atomic_exchange_n(&limiters[i].notice_fd, 0, __ATOMIC_RELAXED);
+        if (fd != 0 && players[i].socket == fd) send_server_msg(i, "COMPUTER", "Command rate exceeded. Input discarded.");
+    }
+}
+
+void log_command_stats(void) {
+    LOG_DEBUG("Commands: %llu queued, %llu applied, %llu stale, %llu rate-limited, %llu dropped (queue full), depth high water %d/%d\n",
+              (unsigned long long)__atomic_load_n(&cmd_queued, __ATOMIC_RELAXED), (unsigned long long)cmd_applied,
+              (unsigned long long)cmd_stale, (unsigned long long)__atomic_load_n(&cmd_rate_drops, __ATOMIC_RELAXED),
+              (unsigned long long)__atomic_load_n(&cmd_full_drops, __ATOMIC_RELAXED),
+              __atomic_load_n(&cmd_depth_high, __ATOMIC_RELAXED), CMD_QUEUE_MAX_RECORDS);
+}
+
+/* Drains delayed batch steps at the start of the tick. Caller holds game_mutex. */
+void run_pending_batches() {
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        CommandQueue *q = &pending_batches[i];
+        if (q->next >= q->count) continue;
+        if (!players[i].active) { q->count = q->next = 0; continue; }
+        if (global_tick < q->next_tick) continue;
+        q->next_tick = global_tick + q->tick_delay;
+        run_command(i, q->cmds[q->next++]);
+    }
 }
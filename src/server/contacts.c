@@ -0,0 +1,231 @@
+/*
+ * STARTREK ULTRA - 3D LOGIC ENGINE
+ * Authors: Nicola Taibi, Supported by Google Gemini
+ * Copyright (C) 2026 Nicola Taibi
+ * License: GNU General Public License v3.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "server_internal.h"
+
+/* --- Contact Pairs --- */
+
+/* How far each kind reaches: the widest test its Phase 2 handler makes, plus CONTACT_SLACK
+   for the solid bodies the collision checks measure again after the ship moves. Mines are
+   found across quadrant borders through the proximity grid, the other kinds within the
+   captain's quadrant, as their handlers always judged them. */
+static const float contact_reach[SI_KINDS] = {
+    [SI_PLANET] = 0.8f + CONTACT_SLACK, [SI_STAR] = 0.8f + CONTACT_SLACK, [SI_BH] = DIST_GRAVITY_WELL + CONTACT_SLACK,
+    [SI_NEBULA] = 2.0f, [SI_PULSAR] = 2.5f, [SI_COMET] = 0.6f, [SI_ASTEROID] = 0.8f, [SI_MINE] = 0.4f, [SI_RIFT] = 0.5f,
+};
+#define CONTACT_SOLIDS (SI_MASK(SI_PLANET) | SI_MASK(SI_STAR) | SI_MASK(SI_BH))
+#define CONTACT_KINDS (CONTACT_SOLIDS | SI_MASK(SI_NEBULA) | SI_MASK(SI_PULSAR) | SI_MASK(SI_COMET) | \
+                       SI_MASK(SI_ASTEROID) | SI_MASK(SI_MINE) | SI_MASK(SI_RIFT))
+
+/* The tick's pairs, grouped by captain; each captain's sector as it was gathered */
+static Contact *tick_pairs, *moved_pairs;
+static int tick_cap = 0, moved_cap = 0;
+static int pair_first[MAX_CLIENTS], pair_count[MAX_CLIENTS];
+static struct { int q1, q2, q3; float s1, s2, s3; } gathered_at[MAX_CLIENTS];
+
+static uint64_t contact_ticks = 0, contact_pairs = 0, contact_shifts = 0, contact_regathers = 0;
+
+/* --- Hazard Fields --- */
+
+/* The kinds below only change when the index rebuilds their runs (a supernova, a depleted
+   asteroid). Each quadrant's field splits the sector into HAZARD_FIELD_RES cells per edge and
+   records, per cell, which of these kinds have a body within reach of some point of it. A
+   captain's exposure is then one lookup, and only the kinds it names are measured. Fields
+   are built on first use into a small four-way cache and all go stale when any of their
+   kinds does. */
+#define FIELD_KINDS (CONTACT_SOLIDS | SI_MASK(SI_NEBULA) | SI_MASK(SI_PULSAR) | SI_MASK(SI_ASTEROID) | SI_MASK(SI_RIFT))
+#define FIELD_CELL (10.0 / HAZARD_FIELD_RES)
+#define FIELD_WAYS 4
+#define FIELD_INDEX(v) ((v) <= 0 ? 0 : ((int)((v) / FIELD_CELL) >= HAZARD_FIELD_RES ? HAZARD_FIELD_RES - 1 : (int)((v) / FIELD_CELL)))
+_Static_assert((HAZARD_FIELD_CACHE & (HAZARD_FIELD_CACHE - 1)) == 0 && HAZARD_FIELD_CACHE >= FIELD_WAYS,
+               "field cache must be a power of two, one set at least");
+_Static_assert(SI_PLAYER < 16, "field masks hold one bit per kind in 16 bits");
+
+typedef struct {
+    int32_t cell;           /* Quadrant held, 0 (never a quadrant) when empty */
+    uint64_t version;       /* field_version it was built at */
+    uint64_t used;          /* field_lookups at its last lookup */
+    uint16_t kinds[HAZARD_FIELD_RES][HAZARD_FIELD_RES][HAZARD_FIELD_RES];  /* SI_MASK bits */
+} HazardField;
+
+static HazardField fields[HAZARD_FIELD_CACHE];
+static uint64_t field_version = 0;
+static uint64_t field_builds = 0, field_lookups = 0, field_clear = 0;
+
+static void body_sector(int kind, int idx, double *x, double *y, double *z) {
+    switch (kind) {
+        case SI_PLANET:   *x = planets[idx].x;     *y = planets[idx].y;     *z = planets[idx].z; break;
+        case SI_STAR:     *x = stars_data[idx].x;  *y = stars_data[idx].y;  *z = stars_data[idx].z; break;
+        case SI_BH:       *x = black_holes[idx].x; *y = black_holes[idx].y; *z = black_holes[idx].z; break;
+        case SI_NEBULA:   *x = nebulas[idx].x;     *y = nebulas[idx].y;     *z = nebulas[idx].z; break;
+        case SI_PULSAR:   *x = pulsars[idx].x;     *y = pulsars[idx].y;     *z = pulsars[idx].z; break;
+        case SI_ASTEROID: *x = asteroids[idx].x;   *y = asteroids[idx].y;   *z = asteroids[idx].z; break;
+        case SI_RIFT:     *x = rifts[idx].x;       *y = rifts[idx].y;       *z = rifts[idx].z; break;
+        default:          *x = *y = *z = 0; break;
+    }
+}
+
+/* Distance from v to the cell span [i, i+1) along one axis, 0 inside it */
+static inline double span_gap(double v, int i) {
+    double lo = i * FIELD_CELL, hi = lo + FIELD_CELL;
+    return v < lo ? lo - v : (v > hi ? v - hi : 0);
+}
+
+static void build_field(HazardField *f, int cell) {
+    memset(f->kinds, 0, sizeof(f->kinds));
+    for (int kind = 0; kind < SI_KINDS; kind++) {
+        if (!(FIELD_KINDS & SI_MASK(kind))) continue;
+        const uint16_t *slots;
+        int run = spatial_run(cell, kind, &slots);
+        double r = contact_reach[kind];
+        for (int k = 0; k < run; k++) {
+            double x, y, z;
+            body_sector(kind, slots[k], &x, &y, &z);
+            for (int i = FIELD_INDEX(x - r); i <= FIELD_INDEX(x + r); i++) {
+                double gi = span_gap(x, i);
+                for (int j = FIELD_INDEX(y - r); j <= FIELD_INDEX(y + r); j++) {
+                    double gj = span_gap(y, j);
+                    for (int l = FIELD_INDEX(z - r); l <= FIELD_INDEX(z + r); l++) {
+                        double gl = span_gap(z, l);
+                        if (gi * gi + gj * gj + gl * gl < r * r) f->kinds[i][j][l] |= (uint16_t)SI_MASK(kind);
+                    }
+                }
+            }
+        }
+    }
+    f->cell = cell;
+    f->version = field_version;
+    field_builds++;
+}
+
+/* Field kinds that may be in reach of a captain at sector (s1,s2,s3) of the quadrant */
+static uint32_t field_kinds(int cell, double s1, double s2, double s3) {
+    HazardField *set = &fields[((unsigned)cell * 2654435761u >> 8) & (HAZARD_FIELD_CACHE - FIELD_WAYS)], *f = set;
+    for (int w = 0; w < FIELD_WAYS; w++) {
+        if (set[w].cell == cell) { f = &set[w]; break; }
+        if (set[w].used < f->used) f = &set[w];
+    }
+    if (f->cell != cell || f->version != field_version) build_field(f, cell);
+    f->used = ++field_lookups;
+    uint32_t kinds = f->kinds[FIELD_INDEX(s1)][FIELD_INDEX(s2)][FIELD_INDEX(s3)];
+    if (!kinds) field_clear++;
+    return kinds;
+}
+
+/* --- Contact Gathering --- */
+
+static void fit_pairs(Contact **buf, int *cap, int need) {
+    if (need <= *cap) return;
+    int grown = *cap ? *cap : 256;
+    while (grown < need) grown *= 2;
+    Contact *p = realloc(*buf, grown * sizeof(Contact));
+    if (!p) { perror("Failed to grow contact pairs"); exit(1); }
+    *buf = p;
+    *cap = grown;
+}
+
+/* One quadrant run, measured against the captain's sector position */
+#define GATHER_RUN(kind, arr) do { \
+    const uint16_t *slots; \
+    int run = spatial_run(cell, (kind), &slots); \
+    float r2 = contact_reach[kind] * contact_reach[kind]; \
+    fit_pairs(buf, cap, n + run); \
+    for (int k = 0; k < run; k++) { \
+        double dx = (arr)[slots[k]].x - sx, dy = (arr)[slots[k]].y - sy, dz = (arr)[slots[k]].z - sz; \
+        double d2 = dx * dx + dy * dy + dz * dz; \
+        if (d2 < r2) (*buf)[n++] = (Contact){(kind), slots[k], (float)d2, (float)dx, (float)dy, (float)dz}; \
+    } } while (0)
+
+/* Appends captain p's pairs for the kinds in kind_mask, in enum order, and returns the new end */
+static int gather(int p, uint32_t kind_mask, Contact **buf, int *cap, int n) {
+    const StarTrekGame *s = &players[p].state;
+    gathered_at[p].q1 = s->q1; gathered_at[p].q2 = s->q2; gathered_at[p].q3 = s->q3;
+    gathered_at[p].s1 = s->s1; gathered_at[p].s2 = s->s2; gathered_at[p].s3 = s->s3;
+    if (!IS_Q_VALID(s->q1, s->q2, s->q3)) return n;
+    int cell = GALAXY_CELL(s->q1, s->q2, s->q3);
+    double sx = s->s1, sy = s->s2, sz = s->s3;
+    /* Static kinds are only measured where the quadrant's field says one can be in reach */
+    kind_mask &= field_kinds(cell, sx, sy, sz) | ~FIELD_KINDS;
+
+    if (kind_mask & SI_MASK(SI_PLANET))   GATHER_RUN(SI_PLANET, planets);
+    if (kind_mask & SI_MASK(SI_STAR))     GATHER_RUN(SI_STAR, stars_data);
+    if (kind_mask & SI_MASK(SI_BH))       GATHER_RUN(SI_BH, black_holes);
+    if (kind_mask & SI_MASK(SI_NEBULA))   GATHER_RUN(SI_NEBULA, nebulas);
+    if (kind_mask & SI_MASK(SI_PULSAR))   GATHER_RUN(SI_PULSAR, pulsars);
+    if (kind_mask & SI_MASK(SI_COMET))    GATHER_RUN(SI_COMET, comets);
+    if (kind_mask & SI_MASK(SI_ASTEROID)) GATHER_RUN(SI_ASTEROID, asteroids);
+
+    double gx, gy, gz;
+    if ((kind_mask & SI_MASK(SI_MINE)) && spatial_position(SI_PLAYER, p, &gx, &gy, &gz)) {
+        const SpatialHit *hits;
+        int found = spatial_query_all(gx, gy, gz, contact_reach[SI_MINE], SI_MASK(SI_MINE), &hits);
+        fit_pairs(buf, cap, n + found);
+        for (int k = 0; k < found; k++) {
+            double mx, my, mz;
+            if (!spatial_position(SI_MINE, hits[k].idx, &mx, &my, &mz)) continue;
+            (*buf)[n++] = (Contact){SI_MINE, hits[k].idx, hits[k].d2, (float)(mx - gx), (float)(my - gy), (float)(mz - gz)};
+        }
+    }
+
+    if (kind_mask & SI_MASK(SI_RIFT))     GATHER_RUN(SI_RIFT, rifts);
+    return n;
+}
+
+void contacts_build(void) {
+    uint64_t version = 0;
+    for (int kind = 0; kind < SI_KINDS; kind++) if (FIELD_KINDS & SI_MASK(kind)) version += spatial_kind_version(kind);
+    field_version = version;
+    int n = 0;
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        pair_first[i] = n;
+        if (players[i].active) n = gather(i, CONTACT_KINDS, &tick_pairs, &tick_cap, n);
+        pair_count[i] = n - pair_first[i];
+    }
+    contact_ticks++;
+    contact_pairs += n;
+}
+
+ContactList contacts_of(int player) {
+    return (ContactList){tick_pairs + pair_first[player], pair_count[player]};
+}
+
+ContactList contacts_moved(int player) {
+    const StarTrekGame *s = &players[player].state;
+    if (s->q1 == gathered_at[player].q1 && s->q2 == gathered_at[player].q2 && s->q3 == gathered_at[player].q3) {
+        float mx = s->s1 - gathered_at[player].s1, my = s->s2 - gathered_at[player].s2, mz = s->s3 - gathered_at[player].s3;
+        if (mx == 0 && my == 0 && mz == 0) return contacts_of(player);
+        /* Within the slack every solid body now in reach was already paired: shift them */
+        if (mx * mx + my * my + mz * mz <= CONTACT_SLACK * CONTACT_SLACK) {
+            ContactList was = contacts_of(player);
+            int n = 0;
+            fit_pairs(&moved_pairs, &moved_cap, was.count);
+            for (int k = 0; k < was.count; k++) {
+                if (!(CONTACT_SOLIDS & SI_MASK(was.pairs[k].kind))) continue;
+                Contact c = was.pairs[k];
+                c.dx -= mx; c.dy -= my; c.dz -= mz;
+                c.d2 = c.dx * c.dx + c.dy * c.dy + c.dz * c.dz;
+                moved_pairs[n++] = c;
+            }
+            contact_shifts++;
+            return (ContactList){moved_pairs, n};
+        }
+    }
+    contact_regathers++;
+    int n = gather(player, CONTACT_SOLIDS, &moved_pairs, &moved_cap, 0);
+    return (ContactList){moved_pairs, n};
+}
+
+void log_contact_stats(void) {
+    LOG_DEBUG("Contacts: %.1f pairs per tick; after moving %llu shifted, %llu gathered again\n",
+              contact_ticks ? (double)contact_pairs / contact_ticks : 0.0, (unsigned long long)contact_shifts,
+              (unsigned long long)contact_regathers);
+    LOG_DEBUG("Hazard fields: %llu built, %llu lookups, %llu out of reach of every static hazard\n",
+              (unsigned long long)field_builds, (unsigned long long)field_lookups, (unsigned long long)field_clear);
+}
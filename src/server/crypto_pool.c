@@ -0,0 +1,360 @@
+/*
+ * STARTREK ULTRA - 3D LOGIC ENGINE
+ * Authors: Nicola Taibi, Supported by Google Gemini
+ * Copyright (C) 2026 Nicola Taibi
+ * License: GNU General Public License v3.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/socket.h>
+#include "server_internal.h"
+
+/* --- Crypto Offload Pool --- */
+
+/* Every frame a captain's link receives after login passes through one queue per worker,
+   so chat, server messages, alerts, sensor reports and updates reach the client in the
+   order the server produced them. */
+typedef enum {
+    JOB_MESSAGE,  /* PacketMessage text, compressed and encrypted here */
+    JOB_FRAME,    /* A finished packet, written as is */
+    JOB_PREPARE,  /* Rekey and warm the context, nothing to send */
+    JOB_CLOSE     /* The link closed: discard what it has not taken */
+} CryptoJobKind;
+
+/* Produced under game_mutex, which every command and login path holds while it queues
+   (view command replies are stamped under it, see crypto_pool_hold). Everything the worker
+   needs is copied in, so encryption and the socket write run without touching shared
+   game state. */
+typedef struct CryptoJob {
+    struct CryptoJob *next;
+    CryptoJobKind kind;
+    int p_idx;
+    int fd;              /* Link the frame was produced for; dropped if the slot moved on */
+    int algo;            /* CRYPTO_NONE: sent as plaintext, still in order */
+    bool compress;       /* Link negotiated LINK_CAP_COMPRESS */
+    uint8_t key[32];
+    int64_t frame_id;
+    int len;
+    char head[offsetof(PacketMessage, text)];
+    char text[];         /* Message text, or the whole packet of a JOB_FRAME */
+} CryptoJob;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    CryptoJob *head, *tail;
+    int depth;
+    SubspaceCodec codec;  /* Worker-owned, shared by all of its connections */
+    uint8_t *scratch;     /* Compressed text awaiting encryption */
+    int backlog;          /* Its links with bytes still waiting in their outbox */
+} CryptoQueue;
+
+static CryptoQueue crypto_queues[CRYPTO_WORKERS];
+
+/* Each connection always maps to the same worker: its frames stay in order and its
+   CryptoSession is only ever touched by that thread. */
+static CryptoQueue *queue_for(int p_idx) {
+    return &crypto_queues[p_idx % CRYPTO_WORKERS];
+}
+
+/* --- Link Outboxes --- */
+
+/* What a link's socket has not taken yet. Sockets are written without blocking, so one
+   slow client never holds up the other links of its worker; its backlog is retried with
+   its next frame or after CRYPTO_FLUSH_MS. Owned by the slot's worker. */
+typedef struct {
+    int fd;
+    bool failed;         /* fd was shut down here: its frames are dropped until its JOB_CLOSE */
+    uint8_t *buf;
+    size_t len, cap;
+} Outbox;
+
+static Outbox outboxes[MAX_CLIENTS];
+static uint64_t outbox_drops = 0, outbox_dead_frames = 0;
+
+static void outbox_reset(CryptoQueue *q, Outbox *o, int fd) {
+    if (o->len) q->backlog--;
+    o->len = 0;
+    o->fd = fd;
+    o->failed = false;
+}
+
+/* Sends what the socket takes. A link that fails or falls OUTBOX_MAX_BYTES behind is shut
+   down, and the epoll loop reaps it: a frame is never dropped from the middle of a stream. */
+static void outbox_write(CryptoQueue *q, int p_idx, const void *data, size_t len) {
+    ConnectedPlayer *p = &players[p_idx];
+    Outbox *o = &outboxes[p_idx];
+    const uint8_t *src = data;
+    bool had_backlog = o->len > 0;
+
+    pthread_mutex_lock(&p->socket_mutex);
+    if (p->socket != o->fd) { pthread_mutex_unlock(&p->socket_mutex); outbox_reset(q, o, o->fd); return; }
+    /* Older bytes go first; new ones only skip the copy when nothing is waiting */
+    while (o->len > 0) {
+        ssize_t n = send(o->fd, o->buf, o->len, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n <= 0) break;
+        memmove(o->buf, o->buf + n, o->len - n);
+        o->len -= n;
+    }
+    int err = 0;
+    while (o->len == 0 && len > 0) {
+        ssize_t n = send(o->fd, src, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n <= 0) { err = (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) ? errno : 0; break; }
+        src += n;
+        len -= n;
+    }
+    pthread_mutex_unlock(&p->socket_mutex);
+
+    if (!err && o->len + len > OUTBOX_MAX_BYTES) err = ENOBUFS;
+    if (err) {
+        LOG_DEBUG("Link FD %d of slot %d stalled (%s), closing\n", o->fd, p_idx, strerror(err));
+        shutdown(o->fd, SHUT_RDWR);
+        outbox_drops++;
+        if (had_backlog) q->backlog--;
+        o->len = 0;
+        o->failed = true;  /* Keeps fd, so later frames for it are not taken for a new link */
+        return;
+    }
+    if (len > 0) {
+        if (o->len + len > o->cap) {
+            size_t cap = o->cap ? o->cap : 65536;
+            while (cap < o->len + len) cap *= 2;
+            uint8_t *b = realloc(o->buf, cap);
+            if (!b) { perror("outbox"); exit(1); }
+            o->buf = b;
+            o->cap = cap;
+        }
+        memcpy(o->buf + o->len, src, len);
+        o->len += len;
+    }
+    if (had_backlog && o->len == 0) q->backlog--;
+    else if (!had_backlog && o->len > 0) q->backlog++;
+}
+
+/* Retries the backlog of every link the worker owns */
+static void outbox_flush(CryptoQueue *q) {
+    int w = (int)(q - crypto_queues);
+    for (int i = w; i < MAX_CLIENTS; i += CRYPTO_WORKERS)
+        if (outboxes[i].len > 0) outbox_write(q, i, NULL, 0);
+}
+
+static void process_job(CryptoQueue *q, CryptoJob *job, PacketMessage *out) {
+    ConnectedPlayer *p = &players[job->p_idx];
+    Outbox *o = &outboxes[job->p_idx];
+    if (job->kind == JOB_CLOSE) {
+        if (o->fd == job->fd) outbox_reset(q, o, 0);
+        return;
+    }
+    crypto_session_bind(&p->crypto, job->key);
+    if (job->kind == JOB_PREPARE) {
+        crypto_session_prepare(&p->crypto, job->algo);
+        return;
+    }
+    /* First frame for a new link: whatever the previous one left is not for it */
+    if (o->fd != job->fd) outbox_reset(q, o, job->fd);
+    if (o->failed) { outbox_dead_frames++; return; }
+    if (job->kind == JOB_FRAME) {
+        outbox_write(q, job->p_idx, job->text, job->len);
+        return;
+    }
+
+    memcpy(out, job->head, sizeof(job->head));
+    out->is_compressed = 0;
+    if (job->compress) {
+        /* Compress before encrypting: ciphertext does not compress */
+        int clen = subspace_compress(&q->codec, (const uint8_t*)job->text, job->len, q->scratch, 65536);
+        if (clen > 0) {
+            memcpy(job->text, q->scratch, clen);
+            job->len = clen;
+            out->is_compressed = 1;
+        }
+    }
+    if (job->algo != CRYPTO_NONE) {
+        out->is_encrypted = 1;
+        out->crypto_algo = (uint8_t)job->algo;
+        /* The nonce already embeds the frame; the IV field is XORed with it for transmission.
+           The client MUST reverse this BEFORE decrypting using the embedded origin_frame. */
+        out->origin_frame = job->frame_id;
+        int len = crypto_session_encrypt(&p->crypto, job->algo, CRYPTO_CHANNEL_MESSAGES, job->frame_id, (const uint8_t*)job->text, job->len,
+                                         (uint8_t*)out->text, out->iv, out->tag);
+        for(int i=0; i<8; i++) out->iv[i] ^= ((out->origin_frame >> (i*8)) & 0xFF);
+        out->length = (len > 0) ? len : 0;
+    } else {
+        out->is_encrypted = 0;
+        memcpy(out->text, job->text, job->len);
+        out->text[job->len] = '\0';
+        out->length = job->len;
+    }
+
+    outbox_write(q, job->p_idx, out, offsetof(PacketMessage, text) + out->length);
+}
+
+static void *crypto_worker(void *arg) {
+    CryptoQueue *q = (CryptoQueue *)arg;
+    PacketMessage *out = malloc(sizeof(PacketMessage));
+    q->scratch = malloc(65536);
+    if (!out || !q->scratch) { perror("crypto worker"); return NULL; }
+
+    while (1) {
+        pthread_mutex_lock(&q->lock);
+        while (!q->head) {
+            if (!q->backlog) { pthread_cond_wait(&q->ready, &q->lock); continue; }
+            struct timespec until;
+            clock_gettime(CLOCK_REALTIME, &until);
+            until.tv_nsec += CRYPTO_FLUSH_MS * 1000000L;
+            if (until.tv_nsec >= 1000000000L) { until.tv_sec++; until.tv_nsec -= 1000000000L; }
+            if (pthread_cond_timedwait(&q->ready, &q->lock, &until) == ETIMEDOUT && !q->head) {
+                pthread_mutex_unlock(&q->lock);
+                outbox_flush(q);
+                pthread_mutex_lock(&q->lock);
+            }
+        }
+        CryptoJob *job = q->head;
+        q->head = job->next;
+        if (!q->head) q->tail = NULL;
+        q->depth--;
+        pthread_mutex_unlock(&q->lock);
+
+        process_job(q, job, out);
+        slab_free(job);
+    }
+    return NULL;
+}
+
+void crypto_pool_init(void) {
+    for (int w = 0; w < CRYPTO_WORKERS; w++) {
+        pthread_mutex_init(&crypto_queues[w].lock, NULL);
+        pthread_cond_init(&crypto_queues[w].ready, NULL);
+        pthread_t tid;
+        pthread_create(&tid, NULL, crypto_worker, &crypto_queues[w]);
+        pthread_detach(tid);
+    }
+}
+
+static void enqueue_job(int p_idx, CryptoJob *job) {
+    CryptoQueue *q = queue_for(p_idx);
+    pthread_mutex_lock(&q->lock);
+    if (q->depth >= CRYPTO_QUEUE_MAX_JOBS) {
+        pthread_mutex_unlock(&q->lock);
+        LOG_DEBUG("Crypto queue full, dropping frame for slot %d\n", p_idx);
+        slab_free(job);
+        return;
+    }
+    job->next = NULL;
+    if (q->tail) q->tail->next = job; else q->head = job;
+    q->tail = job;
+    q->depth++;
+    pthread_cond_signal(&q->ready);
+    pthread_mutex_unlock(&q->lock);
+}
+
+/* Copies the link parameters of the slot into the job. Caller holds game_mutex. */
+static void stamp_job(CryptoJob *job) {
+    ConnectedPlayer *p = &players[job->p_idx];
+    const uint8_t *k = p->session_key;
+    bool all_zero = true; for(int z=0; z<32; z++) if(k[z]!=0) all_zero=false;
+    memcpy(job->key, all_zero ? MASTER_SESSION_KEY : k, 32);
+    job->fd = p->socket;
+    job->compress = (p->link_caps & LINK_CAP_COMPRESS) != 0;
+    job->frame_id = galaxy_master.frame_id;
+}
+
+/* --- Held Replies --- */
+
+/* A view command runs on the network thread without game_mutex. Between crypto_pool_hold()
+   and crypto_pool_release() its replies are built but kept back, and are stamped and
+   queued under the lock once the handler has returned. */
+static _Thread_local bool holding = false;
+static _Thread_local CryptoJob *held_head = NULL, *held_tail = NULL;
+
+void crypto_pool_hold(void) {
+    holding = true;
+}
+
+/* Takes game_mutex: the caller must not hold it */
+void crypto_pool_release(void) {
+    holding = false;
+    if (!held_head) return;
+    pthread_mutex_lock(&game_mutex);
+    while (held_head) {
+        CryptoJob *job = held_head;
+        held_head = job->next;
+        ConnectedPlayer *p = &players[job->p_idx];
+        if (p->socket == 0) { slab_free(job); continue; }
+        stamp_job(job);
+        /* Replies only go to the captain's own link, under its current cipher */
+        if (job->kind == JOB_MESSAGE) job->algo = p->crypto_algo;
+        enqueue_job(job->p_idx, job);
+    }
+    held_tail = NULL;
+    pthread_mutex_unlock(&game_mutex);
+}
+
+static CryptoJob *new_job(int p_idx, CryptoJobKind kind, int algo, int len) {
+    CryptoJob *job = slab_alloc(sizeof(CryptoJob) + len + 1);
+    if (!job) return NULL;
+    job->kind = kind;
+    job->p_idx = p_idx;
+    job->algo = algo;
+    job->len = len;
+    if (!holding) stamp_job(job);
+    return job;
+}
+
+/* Queues the job, or keeps it back for crypto_pool_release() while a view command runs */
+static void submit_job(CryptoJob *job) {
+    if (!holding) { enqueue_job(job->p_idx, job); return; }
+    job->next = NULL;
+    if (held_tail) held_tail->next = job; else held_head = job;
+    held_tail = job;
+}
+
+/* Caller holds game_mutex or is holding replies: only the plaintext copy happens here */
+void crypto_pool_send(int p_idx, const PacketMessage *head, const char *text, int algo) {
+    int len = strlen(text);
+    if (len > 65535) len = 65535;
+    CryptoJob *job = new_job(p_idx, JOB_MESSAGE, algo, len);
+    if (!job) return;
+    memcpy(job->head, head, sizeof(job->head));
+    memcpy(job->text, text, len);
+    job->text[len] = '\0';
+    submit_job(job);
+}
+
+/* Queues a finished packet behind the captain's earlier frames. Caller holds game_mutex or
+   is holding replies. */
+void crypto_pool_frame(int p_idx, const void *pkt, size_t len) {
+    if (!holding && players[p_idx].socket == 0) return;
+    CryptoJob *job = new_job(p_idx, JOB_FRAME, CRYPTO_NONE, (int)len);
+    if (!job) return;
+    memcpy(job->text, pkt, len);
+    submit_job(job);
+}
+
+/* Rebinds the captain's session after a handshake, resume or 'enc' change. Caller holds game_mutex. */
+void crypto_pool_prepare(int p_idx) {
+    CryptoJob *job = new_job(p_idx, JOB_PREPARE, players[p_idx].crypto_algo, 0);
+    if (!job) return;
+    enqueue_job(p_idx, job);
+}
+
+/* fd is closing: its unsent bytes must not reach a later link that reuses the number.
+   Caller holds game_mutex. */
+void crypto_pool_close(int p_idx, int fd) {
+    CryptoJob *job = new_job(p_idx, JOB_CLOSE, CRYPTO_NONE, 0);
+    if (!job) return;
+    job->fd = fd;
+    enqueue_job(p_idx, job);
+}
+
+void log_outbox_stats(void) {
+    int backlog = 0;
+    for (int w = 0; w < CRYPTO_WORKERS; w++) backlog += __atomic_load_n(&crypto_queues[w].backlog, __ATOMIC_RELAXED);
+    LOG_DEBUG("Link outboxes: %d links behind, %llu stalled links closed, %llu frames dropped after\n", backlog,
+              (unsigned long long)outbox_drops, (unsigned long long)outbox_dead_frames);
+}
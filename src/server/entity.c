@@ -0,0 +1,460 @@
+/*
+ * STARTREK ULTRA - 3D LOGIC ENGINE
+ * Authors: Nicola Taibi, Supported by Google Gemini
+ * Copyright (C) 2026 Nicola Taibi
+ * License: GNU General Public License v3.0
+ */
+
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "server_internal.h"
+
+/* --- Entity Handles --- */
+
+/* Ids are handed out in blocks of ENT_ID_BLOCK. A kind takes consecutive blocks from its
+   documented base until it meets the base of another kind, then continues in the overflow
+   blocks, so raising a limit never makes two kinds share an id. Every block records its
+   kind and which run of the kind's slots it covers. */
+#define ENT_ID_BLOCK       1000
+#define ENT_MAX_BLOCKS     1200  /* Ids below 1200000 */
+#define ENT_OVERFLOW_BLOCK 20    /* First block past the documented ranges */
+#define ENT_MAX_CHUNKS     ((ENT_POOL_MAX + ENT_ID_BLOCK) / ENT_ID_BLOCK) /* Blocks per kind */
+
+static const struct {
+    const char *name;  /* As given to trek_server -l */
+    int base;          /* Documented first id */
+    int max;           /* Default soft limit */
+    int bias;          /* Captain 1 is slot 0 */
+    uint8_t flags;
+} kind_info[ENT_KINDS] = {
+    [SI_PLAYER]   = {"player",        0, MAX_CLIENTS,     1, ENT_ROAMS | ENT_LOCK_HOLDS | ENT_LOCKABLE},
+    [SI_NPC]      = {"npc",        1000, MAX_NPC,         0, ENT_ROAMS | ENT_LOCK_HOLDS | ENT_LOCKABLE},
+    [SI_BASE]     = {"base",       2000, MAX_BASES,       0, ENT_LOCKABLE},
+    [SI_PLANET]   = {"planet",     3000, MAX_PLANETS,     0, ENT_LOCKABLE},
+    [SI_STAR]     = {"star",       4000, MAX_STARS,       0, ENT_LOCKABLE},
+    [SI_BH]       = {"blackhole",  7000, MAX_BH,          0, ENT_LOCKABLE},
+    [SI_NEBULA]   = {"nebula",     8000, MAX_NEBULAS,     0, ENT_LOCKABLE},
+    [SI_PULSAR]   = {"pulsar",     9000, MAX_PULSARS,     0, ENT_LOCKABLE},
+    [SI_COMET]    = {"comet",     10000, MAX_COMETS,      0, ENT_ROAMS | ENT_LOCK_HOLDS | ENT_LOCKABLE},
+    [SI_DERELICT] = {"derelict",  11000, MAX_DERELICTS,   0, ENT_LOCKABLE},
+    [SI_ASTEROID] = {"asteroid",  12000, MAX_ASTEROIDS,   0, ENT_LOCKABLE},
+    [SI_MINE]     = {"mine",      14000, MAX_MINES,       0, ENT_LOCKABLE},
+    [SI_BUOY]     = {"buoy",      15000, MAX_BUOYS,       0, ENT_LOCKABLE},
+    [SI_PLATFORM] = {"platform",  16000, MAX_PLATFORMS,   0, ENT_LOCK_HOLDS | ENT_LOCKABLE},
+    [SI_RIFT]     = {"rift",      17000, MAX_RIFTS,       0, ENT_LOCKABLE},
+    [SI_MONSTER]  = {"monster",   18000, MAX_MONSTERS,    0, ENT_ROAMS | ENT_LOCK_HOLDS | ENT_LOCKABLE},
+    [ENT_PROBE]   = {"probe",     19000, MAX_CLIENTS * 3, 0, ENT_ROAMS},
+};
+
+typedef struct { uint8_t owner; uint8_t chunk; } EntBlock; /* owner: kind + 1, 0 if free */
+
+static EntBlock id_blocks[ENT_MAX_BLOCKS];
+static uint16_t kind_blocks[ENT_KINDS][ENT_MAX_CHUNKS];
+static int kind_chunks[ENT_KINDS];
+static bool reserved_block[ENT_MAX_BLOCKS];
+static int overflow_block;
+
+/* Pools: a kind's live slots packed at the front of live_slots, live_pos[] the place of each
+   slot there (-1 when free), and its free slots stacked in free_slots[] with the lowest on
+   top after a rebuild. Captains and probes have a fixed capacity and no lists. */
+typedef struct {
+    int live, free, span;
+    int capacity;   /* Slots committed */
+    int limit;      /* Soft limit: capacity never grows past it */
+    int chunks;     /* Times the pool grew */
+    uint16_t *generation, *live_slots, *free_slots;
+    int32_t *live_pos;
+} EntPool;
+
+static EntPool pools[ENT_KINDS];
+static bool limit_given[ENT_KINDS];
+static bool pools_ready = false;
+
+/* Ids for every slot up to the kind's limit. False when the id space cannot hold them;
+   the kind then keeps only the blocks it had. */
+static bool assign_blocks(int k) {
+    int chunks = (pools[k].limit + kind_info[k].bias + ENT_ID_BLOCK - 1) / ENT_ID_BLOCK;
+    for (int c = kind_chunks[k]; c < chunks; c++) {
+        int b = (c == 0) ? kind_info[k].base / ENT_ID_BLOCK : kind_blocks[k][c - 1] + 1;
+        if (c > 0 && (b >= ENT_MAX_BLOCKS || reserved_block[b] || id_blocks[b].owner)) {
+            /* A kind that overflowed earlier may have run on through the next blocks */
+            while (overflow_block < ENT_MAX_BLOCKS && (id_blocks[overflow_block].owner || reserved_block[overflow_block])) overflow_block++;
+            b = overflow_block;
+        }
+        if (c >= ENT_MAX_CHUNKS || b >= ENT_MAX_BLOCKS) {
+            fprintf(stderr, "Entity id space exhausted (%s, %d slots)\n", kind_info[k].name, pools[k].limit);
+            for (int r = kind_chunks[k]; r < c; r++) id_blocks[kind_blocks[k][r]] = (EntBlock){0, 0};
+            return false;
+        }
+        id_blocks[b] = (EntBlock){(uint8_t)(k + 1), (uint8_t)c};
+        kind_blocks[k][c] = (uint16_t)b;
+        if (b >= ENT_OVERFLOW_BLOCK) LOG_DEBUG("Entity kind %d ids %d+ continue at %d\n", k, kind_info[k].base, b * ENT_ID_BLOCK);
+    }
+    kind_chunks[k] = chunks;
+    return true;
+}
+
+/* --- Pool Storage --- */
+
+/* Every per-slot array of a pooled kind, in save order. Each lives in an address range
+   reserved for ENT_POOL_MAX slots at startup and committed ENT_POOL_CHUNK slots at a time,
+   so a pool grows without its array ever moving: slot indices and pointers taken earlier
+   stay valid, and memory follows the bodies actually spawned. */
+typedef struct { int kind; void **array; size_t size; } EntColumn;
+
+static const EntColumn columns[] = {
+    {SI_NPC, (void **)&npcs, sizeof(NPCShip)},
+    {SI_NPC, (void **)&npc_hot.gx, sizeof(double)}, {SI_NPC, (void **)&npc_hot.gy, sizeof(double)},
+    {SI_NPC, (void **)&npc_hot.gz, sizeof(double)}, {SI_NPC, (void **)&npc_hot.vx, sizeof(double)},
+    {SI_NPC, (void **)&npc_hot.vy, sizeof(double)}, {SI_NPC, (void **)&npc_hot.vz, sizeof(double)},
+    {SI_NPC, (void **)&npc_hot.x, sizeof(double)},  {SI_NPC, (void **)&npc_hot.y, sizeof(double)},
+    {SI_NPC, (void **)&npc_hot.z, sizeof(double)},  {SI_NPC, (void **)&npc_hot.q1, sizeof(int32_t)},
+    {SI_NPC, (void **)&npc_hot.q2, sizeof(int32_t)}, {SI_NPC, (void **)&npc_hot.q3, sizeof(int32_t)},
+    {SI_NPC, (void **)&npc_hot.energy, sizeof(int32_t)}, {SI_NPC, (void **)&npc_hot.active, sizeof(uint8_t)},
+    {SI_NPC, (void **)&npc_hot.ai_state, sizeof(uint8_t)},
+    {SI_PLANET,   (void **)&planets,     sizeof(NPCPlanet)},
+    {SI_BASE,     (void **)&bases,       sizeof(NPCBase)},
+    {SI_STAR,     (void **)&stars_data,  sizeof(NPCStar)},
+    {SI_BH,       (void **)&black_holes, sizeof(NPCBlackHole)},
+    {SI_NEBULA,   (void **)&nebulas,     sizeof(NPCNebula)},
+    {SI_PULSAR,   (void **)&pulsars,     sizeof(NPCPulsar)},
+    {SI_COMET,    (void **)&comets,      sizeof(NPCComet)},
+    {SI_ASTEROID, (void **)&asteroids,   sizeof(NPCAsteroid)},
+    {SI_DERELICT, (void **)&derelicts,   sizeof(NPCDerelict)},
+    {SI_MINE,     (void **)&mines,       sizeof(NPCMine)},
+    {SI_BUOY,     (void **)&buoys,       sizeof(NPCBuoy)},
+    {SI_PLATFORM, (void **)&platforms,   sizeof(NPCPlatform)},
+    {SI_RIFT,     (void **)&rifts,       sizeof(NPCRift)},
+    {SI_MONSTER,  (void **)&monsters,    sizeof(NPCMonster)},
+};
+#define ENT_COLUMNS ((int)(sizeof(columns) / sizeof(columns[0])))
+
+/* Bookkeeping per slot: generation, live and free list entries, live position */
+#define ENT_SLOT_BYTES (3 * sizeof(uint16_t) + sizeof(int32_t))
+
+static size_t page_bytes;
+
+static void *reserve(size_t bytes) {
+    void *p = mmap(NULL, bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (p == MAP_FAILED) { perror("Failed to reserve entity pool"); exit(1); }
+    return p;
+}
+
+/* Makes bytes [from, to) of a reservation usable; fresh pages read as zero */
+static void commit(void *base, size_t from, size_t to) {
+    size_t lo = from / page_bytes * page_bytes, hi = (to + page_bytes - 1) / page_bytes * page_bytes;
+    if (hi > lo && mprotect((char *)base + lo, hi - lo, PROT_READ | PROT_WRITE) != 0) {
+        perror("Failed to commit entity pool"); exit(1);
+    }
+}
+
+/* Commits slots up to 'to', the new ones stacked on the free list lowest on top */
+static void commit_slots(int kind, int to) {
+    EntPool *p = &pools[kind];
+    int from = p->capacity;
+    if (to <= from) return;
+    for (int c = 0; c < ENT_COLUMNS; c++)
+        if (columns[c].kind == kind) commit(*columns[c].array, from * columns[c].size, to * columns[c].size);
+    commit(p->generation, from * sizeof(uint16_t), to * sizeof(uint16_t));
+    if (kind < SI_PLAYER) {
+        commit(p->live_slots, from * sizeof(uint16_t), to * sizeof(uint16_t));
+        commit(p->free_slots, from * sizeof(uint16_t), to * sizeof(uint16_t));
+        commit(p->live_pos, from * sizeof(int32_t), to * sizeof(int32_t));
+        for (int s = to - 1; s >= from; s--) {
+            p->live_pos[s] = -1;
+            p->free_slots[p->free++] = (uint16_t)s;
+        }
+    }
+    p->chunks++;
+    __atomic_store_n(&p->capacity, to, __ATOMIC_RELEASE); /* entity_decode() reads it lock-free */
+}
+
+static bool grow(int kind) {
+    EntPool *p = &pools[kind];
+    if (p->capacity >= p->limit) return false;
+    int to = p->capacity + ENT_POOL_CHUNK;
+    commit_slots(kind, to < p->limit ? to : p->limit);
+    LOG_DEBUG("Entity pool %s grew to %d slots (limit %d)\n", kind_info[kind].name, p->capacity, p->limit);
+    return true;
+}
+
+bool entity_set_limit(const char *name, int slots) {
+    if (pools_ready || slots < 0 || slots > ENT_POOL_MAX) return false;
+    for (int k = 0; k < SI_PLAYER; k++) {
+        if (strcmp(name, kind_info[k].name) == 0) { pools[k].limit = slots; limit_given[k] = true; return true; }
+    }
+    return false;
+}
+
+void entity_init(void) {
+    if (pools_ready) return;
+    page_bytes = (size_t)sysconf(_SC_PAGESIZE);
+
+    /* Documented bases first, so no kind can grow into another's numbering */
+    for (int k = 0; k < ENT_KINDS; k++) reserved_block[kind_info[k].base / ENT_ID_BLOCK] = true;
+    overflow_block = ENT_OVERFLOW_BLOCK;
+
+    for (int k = 0; k < ENT_KINDS; k++) {
+        EntPool *p = &pools[k];
+        if (!limit_given[k]) p->limit = kind_info[k].max;
+        /* Pools reserve room for any limit a save may raise them to; captains and probes
+           are bound to connections and committed whole */
+        size_t room = (k < SI_PLAYER) ? ENT_POOL_MAX : (size_t)p->limit;
+        for (int c = 0; c < ENT_COLUMNS; c++)
+            if (columns[c].kind == k) *columns[c].array = reserve(room * columns[c].size);
+        p->generation = reserve(room * sizeof(uint16_t));
+        if (k < SI_PLAYER) {
+            p->live_slots = reserve(room * sizeof(uint16_t));
+            p->free_slots = reserve(room * sizeof(uint16_t));
+            p->live_pos = reserve(room * sizeof(int32_t));
+        } else {
+            commit_slots(k, p->limit);
+        }
+        if (!assign_blocks(k)) exit(1);
+    }
+    pools_ready = true;
+}
+
+int entity_id(int kind, int slot) {
+    int local = slot + kind_info[kind].bias;
+    return kind_blocks[kind][local / ENT_ID_BLOCK] * ENT_ID_BLOCK + local % ENT_ID_BLOCK;
+}
+
+bool entity_decode(int id, int *kind, int *slot) {
+    if (id <= 0 || id >= ENT_MAX_BLOCKS * ENT_ID_BLOCK) return false;
+    EntBlock b = id_blocks[id / ENT_ID_BLOCK];
+    if (!b.owner) return false;
+    int k = b.owner - 1;
+    int s = b.chunk * ENT_ID_BLOCK + id % ENT_ID_BLOCK - kind_info[k].bias;
+    if (s < 0 || s >= __atomic_load_n(&pools[k].capacity, __ATOMIC_ACQUIRE)) return false;
+    *kind = k; *slot = s;
+    return true;
+}
+
+uint16_t entity_generation(int kind, int slot) {
+    return pools[kind].generation[slot];
+}
+
+void entity_spawned(int kind, int slot) {
+    pools[kind].generation[slot]++;
+}
+
+/* Quadrant bodies all share the same id/q/x/active layout */
+#define BODY_VIEW(r, arr) do { \
+    (r)->any = &(arr)[(r)->slot]; \
+    if (!(arr)[(r)->slot].active) return false; \
+    place(r, (arr)[(r)->slot].q1, (arr)[(r)->slot].q2, (arr)[(r)->slot].q3, \
+          (arr)[(r)->slot].x, (arr)[(r)->slot].y, (arr)[(r)->slot].z); \
+} while (0)
+
+static void place(EntityRef *r, int q1, int q2, int q3, double x, double y, double z) {
+    r->q1 = q1; r->q2 = q2; r->q3 = q3;
+    r->x = x; r->y = y; r->z = z;
+    r->gx = (q1 - 1) * 10.0 + x; r->gy = (q2 - 1) * 10.0 + y; r->gz = (q3 - 1) * 10.0 + z;
+}
+
+static bool view(EntityRef *r) {
+    r->gen = entity_generation(r->kind, r->slot);
+    r->flags = kind_info[r->kind].flags;
+    switch (r->kind) {
+        case SI_PLAYER: {
+            ConnectedPlayer *p = r->player = &players[r->slot];
+            if (!p->active) return false;
+            place(r, p->state.q1, p->state.q2, p->state.q3, p->state.s1, p->state.s2, p->state.s3);
+            r->gx = p->gx; r->gy = p->gy; r->gz = p->gz;
+            return true;
+        }
+        case SI_NPC: {
+            int s = r->slot;
+            r->npc = &npcs[s];
+            if (!npc_hot.active[s]) return false;
+            place(r, npc_hot.q1[s], npc_hot.q2[s], npc_hot.q3[s], npc_hot.x[s], npc_hot.y[s], npc_hot.z[s]);
+            r->gx = npc_hot.gx[r->slot]; r->gy = npc_hot.gy[r->slot]; r->gz = npc_hot.gz[r->slot];
+            return true;
+        }
+        case ENT_PROBE: {
+            NetProbe *pr = r->probe = &players[r->slot / 3].state.probes[r->slot % 3];
+            if (!pr->active) return false;
+            place(r, get_q_from_g(pr->gx), get_q_from_g(pr->gy), get_q_from_g(pr->gz), pr->s1, pr->s2, pr->s3);
+            r->gx = pr->gx; r->gy = pr->gy; r->gz = pr->gz;
+            return true;
+        }
+        case SI_PLANET:   BODY_VIEW(r, planets); return true;
+        case SI_BASE:     BODY_VIEW(r, bases); return true;
+        case SI_STAR:     BODY_VIEW(r, stars_data); return true;
+        case SI_BH:       BODY_VIEW(r, black_holes); return true;
+        case SI_NEBULA:   BODY_VIEW(r, nebulas); return true;
+        case SI_PULSAR:   BODY_VIEW(r, pulsars); return true;
+        case SI_COMET:    BODY_VIEW(r, comets); return true;
+        case SI_ASTEROID: BODY_VIEW(r, asteroids); return true;
+        case SI_DERELICT: BODY_VIEW(r, derelicts); return true;
+        case SI_MINE:     BODY_VIEW(r, mines); return true;
+        case SI_BUOY:     BODY_VIEW(r, buoys); return true;
+        case SI_PLATFORM: BODY_VIEW(r, platforms); return true;
+        case SI_RIFT:     BODY_VIEW(r, rifts); return true;
+        case SI_MONSTER:  BODY_VIEW(r, monsters); return true;
+    }
+    return false;
+}
+
+bool entity_lookup(int id, EntityRef *ref) {
+    if (!entity_decode(id, &ref->kind, &ref->slot)) return false;
+    return view(ref);
+}
+
+bool entity_resolve(int id, uint16_t gen, EntityRef *ref) {
+    return entity_lookup(id, ref) && ref->gen == gen;
+}
+
+/* --- Entity Pools --- */
+
+static void clear_active(int kind, int slot) {
+    switch (kind) {
+        case SI_NPC:      npc_hot.active[slot] = 0; break;
+        case SI_PLANET:   planets[slot].active = 0; break;
+        case SI_BASE:     bases[slot].active = 0; break;
+        case SI_STAR:     stars_data[slot].active = 0; break;
+        case SI_BH:       black_holes[slot].active = 0; break;
+        case SI_NEBULA:   nebulas[slot].active = 0; break;
+        case SI_PULSAR:   pulsars[slot].active = 0; break;
+        case SI_COMET:    comets[slot].active = 0; break;
+        case SI_ASTEROID: asteroids[slot].active = 0; break;
+        case SI_DERELICT: derelicts[slot].active = 0; break;
+        case SI_MINE:     mines[slot].active = 0; break;
+        case SI_BUOY:     buoys[slot].active = 0; break;
+        case SI_PLATFORM: platforms[slot].active = 0; break;
+        case SI_RIFT:     rifts[slot].active = 0; break;
+        case SI_MONSTER:  monsters[slot].active = 0; break;
+    }
+}
+
+void entity_rebuild_pools(void) {
+    for (int k = 0; k < SI_PLAYER; k++) {
+        EntPool *p = &pools[k];
+        p->live = p->free = p->span = 0;
+        for (int s = 0; s < p->capacity; s++) {
+            EntityRef r = {.kind = k, .slot = s};
+            if (view(&r)) {
+                p->live_pos[s] = p->live;
+                p->live_slots[p->live++] = (uint16_t)s;
+                p->span = s + 1;
+            } else {
+                p->live_pos[s] = -1;
+            }
+        }
+        for (int s = p->capacity - 1; s >= 0; s--)
+            if (p->live_pos[s] < 0) p->free_slots[p->free++] = (uint16_t)s;
+    }
+}
+
+int entity_alloc(int kind) {
+    EntPool *p = &pools[kind];
+    if (p->free == 0 && !grow(kind)) return -1;
+    int s = p->free_slots[--p->free];
+    p->live_pos[s] = p->live;
+    p->live_slots[p->live++] = (uint16_t)s;
+    if (s >= p->span) p->span = s + 1;
+    entity_spawned(kind, s);
+    spatial_index_touch(kind, s);
+    return s;
+}
+
+void entity_despawn(int kind, int slot) {
+    EntPool *p = &pools[kind];
+    int at = p->live_pos[slot];
+    clear_active(kind, slot);
+    if (at < 0) return;
+    int last = p->live_slots[--p->live];
+    p->live_slots[at] = (uint16_t)last;
+    p->live_pos[last] = at;
+    p->live_pos[slot] = -1;
+    p->free_slots[p->free++] = (uint16_t)slot;
+    while (p->span > 0 && p->live_pos[p->span - 1] < 0) p->span--;
+    spatial_index_touch(kind, slot);
+}
+
+int entity_live(int kind, const uint16_t **slots) {
+    *slots = pools[kind].live_slots;
+    return pools[kind].live;
+}
+
+int entity_span(int kind) {
+    return pools[kind].span;
+}
+
+int entity_capacity(int kind) {
+    return pools[kind].capacity;
+}
+
+int entity_limit(int kind) {
+    return pools[kind].limit;
+}
+
+bool entity_reserve(int kind, int slots) {
+    if (slots > pools[kind].limit) return false;
+    while (pools[kind].capacity < slots) grow(kind);
+    return true;
+}
+
+/* Zeroes every committed body, for a galaxy generated from scratch */
+void entity_clear_pools(void) {
+    for (int c = 0; c < ENT_COLUMNS; c++)
+        memset(*columns[c].array, 0, pools[columns[c].kind].capacity * columns[c].size);
+    entity_rebuild_pools();
+}
+
+size_t entity_pool_bytes(int kind) {
+    size_t per_slot = (kind < SI_PLAYER) ? ENT_SLOT_BYTES : sizeof(uint16_t);
+    for (int c = 0; c < ENT_COLUMNS; c++) if (columns[c].kind == kind) per_slot += columns[c].size;
+    return pools[kind].capacity * per_slot;
+}
+
+/* --- Pool Persistence --- */
+
+/* Pooled kinds in enum order: the span, then each of the kind's columns up to it. Slots
+   above the span are free, so a save holds what is alive rather than what the limits allow. */
+void entity_save_pools(FILE *f) {
+    for (int k = 0; k < SI_PLAYER; k++) {
+        int span = pools[k].span;
+        fwrite(&span, sizeof(int), 1, f);
+        for (int c = 0; c < ENT_COLUMNS; c++)
+            if (columns[c].kind == k) fwrite(*columns[c].array, columns[c].size, span, f);
+    }
+}
+
+/* A save holding more bodies than a limit allows raises the limit: the galaxy is kept whole */
+bool entity_load_pools(FILE *f) {
+    for (int k = 0; k < SI_PLAYER; k++) {
+        EntPool *p = &pools[k];
+        int span;
+        if (fread(&span, sizeof(int), 1, f) != 1 || span < 0 || span > ENT_POOL_MAX) return false;
+        if (span > p->limit) {
+            int was = p->limit;
+            p->limit = span;
+            if (!assign_blocks(k)) { p->limit = was; return false; }
+            printf("--- SAVED GALAXY HOLDS %d %s SLOTS: LIMIT RAISED FROM %d ---\n", span, kind_info[k].name, was);
+        }
+        entity_reserve(k, span);
+        for (int c = 0; c < ENT_COLUMNS; c++) {
+            if (columns[c].kind == k && fread(*columns[c].array, columns[c].size, span, f) != (size_t)span) return false;
+        }
+    }
+    return true;
+}
+
+void log_entity_stats(void) {
+    size_t total = 0;
+    for (int k = 0; k < ENT_KINDS; k++) {
+        const EntPool *p = &pools[k];
+        size_t bytes = entity_pool_bytes(k);
+        total += bytes;
+        if (k < SI_PLAYER)
+            LOG_DEBUG("Pool %-9s: %d live, %d/%d slots committed in %d chunks, %zu bytes\n",
+                      kind_info[k].name, p->live, p->capacity, p->limit, p->chunks, bytes);
+    }
+    LOG_DEBUG("Entity pools: %zu bytes committed\n", total);
+}
@@ -0,0 +1,106 @@
+/*
+ * STARTREK ULTRA - 3D LOGIC ENGINE
+ * Authors: Nicola Taibi, Supported by Google Gemini
+ * Copyright (C) 2026 Nicola Taibi
+ * License: GNU General Public License v3.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "server_internal.h"
+
+/* --- Combat FX --- */
+
+#define FX_QUADRANT_EVENTS ((int)(FX_BYTE_BUDGET / sizeof(NetFxEvent)))
+_Static_assert(FX_BYTE_BUDGET / sizeof(NetFxEvent) <= MAX_FX_EVENTS, "FX budget exceeds the wire limit");
+
+/* Events are chained per quadrant in emission order; only quadrants touched this tick
+   are reset, and each is serialized at most once however many captains are there. */
+static NetFxEvent fx_events[FX_TICK_EVENTS];
+static int fx_next[FX_TICK_EVENTS];
+static int fx_used = 0;
+
+typedef struct {
+    int head, tail;      /* Indices into fx_events, -1 when empty */
+    int count;
+    int wire;            /* Offset in fx_wire once serialized this tick, -1 before */
+} FxQuadrant;
+
+static FxQuadrant *fx_quads;          /* Per GALAXY_CELL */
+static int fx_touched[FX_TICK_EVENTS];  /* A quadrant is touched by its first event */
+static int fx_touched_count = 0;
+static NetFxEvent fx_wire[FX_TICK_EVENTS];
+static int fx_wire_used = 0;
+static bool fx_ready = false;
+static uint64_t fx_emitted = 0, fx_dropped = 0;
+
+void fx_begin_tick(void) {
+    if (!fx_ready) {
+        if (!(fx_quads = malloc(GALAXY_CELLS * sizeof(FxQuadrant)))) { perror("Failed to allocate FX quadrants"); exit(1); }
+        for (int q = 0; q < GALAXY_CELLS; q++) {
+            FxQuadrant *fq = &fx_quads[q];
+            fq->head = fq->tail = fq->wire = -1;
+            fq->count = 0;
+        }
+        fx_ready = true;
+    }
+    for (int t = 0; t < fx_touched_count; t++) {
+        FxQuadrant *fq = &fx_quads[fx_touched[t]];
+        fq->head = fq->tail = fq->wire = -1;
+        fq->count = 0;
+    }
+    fx_touched_count = 0;
+    fx_used = 0;
+    fx_wire_used = 0;
+}
+
+static NetFxEvent *fx_append(int q1, int q2, int q3) {
+    if (!fx_ready || !IS_Q_VALID(q1, q2, q3)) return NULL;
+    FxQuadrant *fq = &fx_quads[GALAXY_CELL(q1, q2, q3)];
+    if (fx_used >= FX_TICK_EVENTS || fq->count >= FX_QUADRANT_EVENTS) { fx_dropped++; return NULL; }
+    if (fq->count == 0) fx_touched[fx_touched_count++] = GALAXY_CELL(q1, q2, q3);
+
+    int e = fx_used++;
+    fx_next[e] = -1;
+    if (fq->tail >= 0) fx_next[fq->tail] = e; else fq->head = e;
+    fq->tail = e;
+    fq->count++;
+    fx_emitted++;
+    memset(&fx_events[e], 0, sizeof(NetFxEvent));
+    return &fx_events[e];
+}
+
+void fx_beam(int q1, int q2, int q3, int source, double sx, double sy, double sz, double tx, double ty, double tz) {
+    NetFxEvent *ev = fx_append(q1, q2, q3);
+    if (!ev) return;
+    ev->kind = FX_BEAM; ev->source = source;
+    ev->x = (float)sx; ev->y = (float)sy; ev->z = (float)sz;
+    ev->tx = (float)tx; ev->ty = (float)ty; ev->tz = (float)tz;
+}
+
+void fx_point(int q1, int q2, int q3, int kind, int source, double x, double y, double z, int detail) {
+    NetFxEvent *ev = fx_append(q1, q2, q3);
+    if (!ev) return;
+    ev->kind = (uint8_t)kind; ev->source = source;
+    ev->x = (float)x; ev->y = (float)y; ev->z = (float)z;
+    ev->detail = detail;
+}
+
+const NetFxEvent *fx_quadrant(int q1, int q2, int q3, int *count) {
+    *count = 0;
+    if (!fx_ready || !IS_Q_VALID(q1, q2, q3)) return NULL;
+    FxQuadrant *fq = &fx_quads[GALAXY_CELL(q1, q2, q3)];
+    if (fq->count == 0) return NULL;
+    if (fq->wire < 0) {
+        fq->wire = fx_wire_used;
+        for (int e = fq->head; e >= 0; e = fx_next[e]) fx_wire[fx_wire_used++] = fx_events[e];
+    }
+    *count = fq->count;
+    return &fx_wire[fq->wire];
+}
+
+void log_fx_stats(void) {
+    LOG_DEBUG("FX: %llu events emitted, %llu over budget (%d per quadrant)\n",
+              (unsigned long long)fx_emitted, (unsigned long long)fx_dropped, FX_QUADRANT_EVENTS);
+}
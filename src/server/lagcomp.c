@@ -0,0 +1,121 @@
+/*
+ * STARTREK ULTRA - 3D LOGIC ENGINE
+ * Authors: Nicola Taibi, Supported by Google Gemini
+ * Copyright (C) 2026 Nicola Taibi
+ * License: GNU General Public License v3.0
+ */
+
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "server_internal.h"
+
+/* --- Lag Compensation --- */
+
+/* One row per tick, indexed by tick modulo the ring: recording writes a contiguous row,
+   and a lookup checks the row still belongs to the requested tick. */
+static LagSample lag_players[LAG_HISTORY_TICKS][MAX_CLIENTS];
+static int lag_row_tick[LAG_HISTORY_TICKS];
+/* NPC rows are as wide as the pool's capacity; growing the pool widens them and drops the
+   history, which only costs rewinds during the few ticks after */
+static LagSample *lag_npcs;
+static int lag_npc_width = 0;
+/* NPC slots recorded in each row: the pool's span at the time, every slot above is dead */
+static int lag_row_npcs[LAG_HISTORY_TICKS];
+static bool lag_ready = false;
+
+/* Smoothed round trip of each link as seen by the kernel, in milliseconds */
+static int link_rtt[MAX_CLIENTS];
+
+static void store(LagSample *s, bool active, double x, double y, double z, int q1, int q2, int q3) {
+    s->valid = active;
+    s->x = (float)x; s->y = (float)y; s->z = (float)z;
+    s->q1 = (int8_t)q1; s->q2 = (int8_t)q2; s->q3 = (int8_t)q3;
+}
+
+/* TCP keeps an RTT estimate per connection; reading it costs one syscall and needs no
+   protocol support from the client. */
+static void sample_rtt(void) {
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (!players[i].active || players[i].socket <= 0) { link_rtt[i] = 0; continue; }
+        struct tcp_info ti;
+        socklen_t len = sizeof(ti);
+        if (getsockopt(players[i].socket, IPPROTO_TCP, TCP_INFO, &ti, &len) == 0)
+            link_rtt[i] = (int)(ti.tcpi_rtt / 1000);
+    }
+}
+
+void lag_record(void) {
+    if (!lag_ready) {
+        for (int r = 0; r < LAG_HISTORY_TICKS; r++) lag_row_tick[r] = -1;
+        lag_ready = true;
+    }
+    int row = global_tick % LAG_HISTORY_TICKS;
+    lag_row_tick[row] = global_tick;
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        StarTrekGame *s = &players[i].state;
+        store(&lag_players[row][i], players[i].active, s->s1, s->s2, s->s3, s->q1, s->q2, s->q3);
+    }
+    if (entity_capacity(SI_NPC) > lag_npc_width) {
+        lag_npc_width = entity_capacity(SI_NPC);
+        if (!(lag_npcs = realloc(lag_npcs, (size_t)LAG_HISTORY_TICKS * lag_npc_width * sizeof(LagSample)))) {
+            perror("Failed to grow lag history"); exit(1);
+        }
+        for (int r = 0; r < LAG_HISTORY_TICKS; r++) lag_row_npcs[r] = 0;
+    }
+    int span = entity_span(SI_NPC);
+    LagSample *npc_row = &lag_npcs[row * lag_npc_width];
+    lag_row_npcs[row] = span;
+    for (int n = 0; n < span; n++) {
+        store(&npc_row[n], npc_hot.active[n], npc_hot.x[n], npc_hot.y[n], npc_hot.z[n], npc_hot.q1[n], npc_hot.q2[n], npc_hot.q3[n]);
+        npc_row[n].gen = entity_generation(SI_NPC, n);
+    }
+    if (global_tick % LAG_RTT_SAMPLE_TICKS == 0) sample_rtt();
+}
+
+int lag_rtt_ms(int p_idx) {
+    if (p_idx < 0 || p_idx >= MAX_CLIENTS) return 0;
+    return link_rtt[p_idx];
+}
+
+/* A command arriving now was aimed at an update sent one round trip ago, and the client
+   draws that update one interpolation step late. */
+int lag_rewind_ticks(int p_idx) {
+    int ms = lag_rtt_ms(p_idx) + LAG_VIEW_DELAY_MS;
+    if (ms > LAG_REWIND_MAX_MS) ms = LAG_REWIND_MAX_MS;
+    int ticks = (ms * 30 + 500) / 1000;
+    if (ticks > LAG_HISTORY_TICKS - 1) ticks = LAG_HISTORY_TICKS - 1;
+    return ticks;
+}
+
+/* Commands and the Phase 2 weapons both run before lag_record(), so while the tick is in
+   progress the newest row is the previous tick's. Every rewind counts back from it. */
+int lag_view_tick(int behind) {
+    return global_tick - 1 - (behind > 0 ? behind : 0);
+}
+
+bool lag_sample(int id, int tick, LagSample *out) {
+    if (!lag_ready || tick < 0) return false;
+    int row = tick % LAG_HISTORY_TICKS;
+    if (lag_row_tick[row] != tick) return false;
+    int kind, slot;
+    if (!entity_decode(id, &kind, &slot)) return false;
+    if (kind == SI_PLAYER) *out = lag_players[row][slot];
+    else if (kind == SI_NPC && slot < lag_row_npcs[row]) *out = lag_npcs[row * lag_npc_width + slot];
+    else return false;
+    /* A pool slot freed and refilled within the ring held another ship back then */
+    if (kind == SI_NPC && out->gen != entity_generation(kind, slot)) out->valid = false;
+    return true;
+}
+
+bool lag_position(int id, int tick, int q1, int q2, int q3, double *x, double *y, double *z) {
+    LagSample s;
+    if (!lag_sample(id, tick, &s) || !s.valid) return false;
+    if (s.q1 != q1 || s.q2 != q2 || s.q3 != q3) return false;
+    *x = s.x; *y = s.y; *z = s.z;
+    return true;
+}
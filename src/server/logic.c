@@ -16,22 +16,23 @@
 /* --- Modular AI Controller --- */
 
 void update_npc_ai(int n) {
-    if (!npcs[n].active) return;
-
     /* Sync absolute if first time */
-    if (npcs[n].gx <= 0.001 && npcs[n].gy <= 0.001) {
-        npcs[n].gx = (npcs[n].q1-1)*10.0 + npcs[n].x;
-        npcs[n].gy = (npcs[n].q2-1)*10.0 + npcs[n].y;
-        npcs[n].gz = (npcs[n].q3-1)*10.0 + npcs[n].z;
+    if (npc_hot.gx[n] <= 0.001 && npc_hot.gy[n] <= 0.001) {
+        npc_hot.gx[n] = (npc_hot.q1[n]-1)*10.0 + npc_hot.x[n];
+        npc_hot.gy[n] = (npc_hot.q2[n]-1)*10.0 + npc_hot.y[n];
+        npc_hot.gz[n] = (npc_hot.q3[n]-1)*10.0 + npc_hot.z[n];
     }
 
-    int q1 = npcs[n].q1, q2 = npcs[n].q2, q3 = npcs[n].q3;
+    int q1 = npc_hot.q1[n], q2 = npc_hot.q2[n], q3 = npc_hot.q3[n];
     if (!IS_Q_VALID(q1, q2, q3)) return;
-    QuadrantIndex *local_q = &spatial_index[q1][q2][q3];
+
+    /* Sensors reach 10 units in every direction, across quadrant borders too */
+    const SpatialHit *near;
+    int near_count = spatial_query_all(npc_hot.gx[n], npc_hot.gy[n], npc_hot.gz[n], 10.0, SI_MASK(SI_PLAYER), &near);
     
     int closest_p = -1; double min_d2 = 100.0;
-    for (int j = 0; j < local_q->player_count; j++) {
-        ConnectedPlayer *p = local_q->players[j]; if (p->state.is_cloaked) continue;
+    for (int j = 0; j < near_count; j++) {
+        ConnectedPlayer *p = &players[near[j].idx]; if (p->state.is_cloaked) continue;
         
         /* Faction/Reputation Logic: NPCs only attack if:
          * 1. Player is from a different faction
@@ -39,26 +40,25 @@ void update_npc_ai(int n) {
          */
         if (p->faction == npcs[n].faction && p->renegade_timer <= 0) continue;
 
-        double d2 = pow(npcs[n].gx - p->gx, 2) + pow(npcs[n].gy - p->gy, 2) + pow(npcs[n].gz - p->gz, 2);
-        if (d2 < min_d2) { min_d2 = d2; closest_p = (int)(p - players); }
+        if (near[j].d2 < min_d2) { min_d2 = near[j].d2; closest_p = (int)(p - players); }
     }
     
     /* State Machine Logic */
-    if (npcs[n].energy < 200) npcs[n].ai_state = AI_STATE_FLEE;
+    if (npc_hot.energy[n] < 200) npc_hot.ai_state[n] = AI_STATE_FLEE;
     else if (closest_p != -1) {
         /* Transition from legacy/patrol to attack run */
-        if (npcs[n].ai_state == AI_STATE_PATROL || npcs[n].ai_state == AI_STATE_CHASE) {
-            npcs[n].ai_state = AI_STATE_ATTACK_RUN;
+        if (npc_hot.ai_state[n] == AI_STATE_PATROL || npc_hot.ai_state[n] == AI_STATE_CHASE) {
+            npc_hot.ai_state[n] = AI_STATE_ATTACK_RUN;
             npcs[n].nav_timer = 0; /* Force immediate target pick */
         }
     } else {
-        npcs[n].ai_state = AI_STATE_PATROL;
+        npc_hot.ai_state[n] = AI_STATE_PATROL;
     }
 
     /* Romulan Cloak Logic */
     if (npcs[n].faction == FACTION_ROMULAN) {
         if (closest_p == -1) npcs[n].is_cloaked = 1; /* Stalking/Patrolling */
-        else if (npcs[n].ai_state == AI_STATE_FLEE) npcs[n].is_cloaked = 1;
+        else if (npc_hot.ai_state[n] == AI_STATE_FLEE) npcs[n].is_cloaked = 1;
         else npcs[n].is_cloaked = 0; /* Reveal to attack */
     } else {
         npcs[n].is_cloaked = 0;
@@ -67,23 +67,23 @@ void update_npc_ai(int n) {
     double d_dx = 0, d_dy = 0, d_dz = 0, speed = 0.03;
     if (npcs[n].engine_health < 10.0f) speed = 0; else speed *= (npcs[n].engine_health/100.0f);
 
-    if (npcs[n].ai_state == AI_STATE_ATTACK_RUN && closest_p != -1) {
+    if (npc_hot.ai_state[n] == AI_STATE_ATTACK_RUN && closest_p != -1) {
         /* 1. Pick a random destination in the quadrant if timer expired or first run */
         if (npcs[n].nav_timer <= 0) {
             npcs[n].tx = (double)(rand() % 100) / 10.0;
             npcs[n].ty = (double)(rand() % 100) / 10.0;
             npcs[n].tz = (double)(rand() % 100) / 10.0;
             /* Convert to absolute global coordinates */
-            npcs[n].tx += (npcs[n].q1 - 1) * 10.0;
-            npcs[n].ty += (npcs[n].q2 - 1) * 10.0;
-            npcs[n].tz += (npcs[n].q3 - 1) * 10.0;
+            npcs[n].tx += (npc_hot.q1[n] - 1) * 10.0;
+            npcs[n].ty += (npc_hot.q2[n] - 1) * 10.0;
+            npcs[n].tz += (npc_hot.q3[n] - 1) * 10.0;
             npcs[n].nav_timer = 3000; /* Timeout failsafe */
         }
 
         /* 2. Move towards target */
-        double dx = npcs[n].tx - npcs[n].gx;
-        double dy = npcs[n].ty - npcs[n].gy;
-        double dz = npcs[n].tz - npcs[n].gz;
+        double dx = npcs[n].tx - npc_hot.gx[n];
+        double dy = npcs[n].ty - npc_hot.gy[n];
+        double dz = npcs[n].tz - npc_hot.gz[n];
         double dist = sqrt(dx*dx + dy*dy + dz*dz);
 
         if (dist > 0.5) {
@@ -94,18 +94,18 @@ void update_npc_ai(int n) {
             npcs[n].m = asin(d_dz) * 180.0 / M_PI;
         } else {
             /* Arrived! Switch to engagement */
-            npcs[n].ai_state = AI_STATE_ATTACK_POSITION;
+            npc_hot.ai_state[n] = AI_STATE_ATTACK_POSITION;
             npcs[n].nav_timer = 120; /* Wait 4 seconds (30 ticks/s * 4) */
         }
         
-    } else if (npcs[n].ai_state == AI_STATE_ATTACK_POSITION && closest_p != -1) {
+    } else if (npc_hot.ai_state[n] == AI_STATE_ATTACK_POSITION && closest_p != -1) {
         /* Hold Position and Fire */
         speed = 0.0; /* Stop engines */
         
         ConnectedPlayer *target = &players[closest_p];
-        double dx = target->gx - npcs[n].gx;
-        double dy = target->gy - npcs[n].gy;
-        double dz = target->gz - npcs[n].gz;
+        double dx = target->gx - npc_hot.gx[n];
+        double dy = target->gy - npc_hot.gy[n];
+        double dz = target->gz - npc_hot.gz[n];
         double dist_to_player = sqrt(dx*dx + dy*dy + dz*dz);
 
         /* Turn bow towards player */
@@ -117,9 +117,10 @@ void update_npc_ai(int n) {
         /* Fire Logic */
         if (npcs[n].fire_cooldown > 0) npcs[n].fire_cooldown--;
         if (npcs[n].fire_cooldown <= 0 && dist_to_player < 8.0) {
-             /* Beam FX logic mapped to player state for transmission */
-            players[closest_p].state.beam_count = 1; 
-            players[closest_p].state.beams[0] = (NetBeam){(float)npcs[n].x, (float)npcs[n].y, (float)npcs[n].z, (float)target->state.s1, (float)target->state.s2, (float)target->state.s3, 1};
+            /* The beam is drawn in both quadrants when it crosses a border */
+            fx_beam(npc_hot.q1[n], npc_hot.q2[n], npc_hot.q3[n], entity_id(SI_NPC, n), npc_hot.x[n], npc_hot.y[n], npc_hot.z[n], npc_hot.x[n] + dx, npc_hot.y[n] + dy, npc_hot.z[n] + dz);
+            if (target->state.q1 != npc_hot.q1[n] || target->state.q2 != npc_hot.q2[n] || target->state.q3 != npc_hot.q3[n])
+                fx_beam(target->state.q1, target->state.q2, target->state.q3, entity_id(SI_NPC, n), target->state.s1 - dx, target->state.s2 - dy, target->state.s3 - dz, target->state.s1, target->state.s2, target->state.s3);
             
             /* Damage Calculation */
             float base_dmg = DMG_PHASER_BASE;
@@ -132,16 +133,16 @@ void update_npc_ai(int n) {
             int dmg = (int)(base_dmg * dist_factor);
 
             /* Directional Shield Damage Logic (Standardized) */
-            double rel_dx = npcs[n].x - target->state.s1;
-            double rel_dy = npcs[n].y - target->state.s2;
+            double rel_dx = -dx;
+            double rel_dy = -dy;
             double angle = atan2(rel_dx, -rel_dy) * 180.0 / M_PI; if (angle < 0) angle += 360;
             double rel_angle = angle - target->state.ent_h;
             while (rel_angle < 0) rel_angle += 360;
             while (rel_angle >= 360) rel_angle -= 360;
             
             /* 3D Shield Mapping: 0:F, 1:R, 2:T, 3:B, 4:L, 5:RI */
-            double rel_dz = npcs[n].z - target->state.s3;
-            double dist_2d = sqrt(pow(npcs[n].x - target->state.s1, 2) + pow(npcs[n].y - target->state.s2, 2));
+            double rel_dz = -dz;
+            double dist_2d = sqrt(dx*dx + dy*dy);
             double vertical_angle = atan2(rel_dz, dist_2d) * 180.0 / M_PI;
 
             int s_idx = 0;
@@ -187,10 +188,7 @@ void update_npc_ai(int n) {
                     target->state.system_health[sys_idx] -= sys_dmg;
                     if (target->state.system_health[sys_idx] < 0) target->state.system_health[sys_idx] = 0;
                     
-                    const char* sys_names[] = {"WARP", "IMPULSE", "SENSORS", "TRANSPORTERS", "PHASERS", "TORPEDOES", "COMPUTER", "LIFE SUPPORT", "SHIELDS", "AUXILIARY"};
-                    char alert[128];
-                    sprintf(alert, "CRITICAL: Impact on bare hull! %s system damaged!", sys_names[sys_idx]);
-                    send_server_msg(closest_p, "DAMAGE", alert);
+                    send_alert(closest_p, ALERT_HULL_SYSTEM_HIT, sys_idx, 0);
                 }
 
                 /* Energy also takes some impact damage */
@@ -201,7 +199,7 @@ void update_npc_ai(int n) {
             
             if (target->state.hull_integrity <= 0 || target->state.energy <= 0) {
                 target->state.energy = 0; target->state.hull_integrity = 0; target->state.crew_count = 0; target->active = 0;
-                target->state.boom = (NetPoint){(float)target->state.s1, (float)target->state.s2, (float)target->state.s3, 1};
+                fx_point(target->state.q1, target->state.q2, target->state.q3, FX_BOOM, 0, target->state.s1, target->state.s2, target->state.s3, 0);
             }
             
             npcs[n].fire_cooldown = (npcs[n].faction == FACTION_BORG) ? 100 : 150;
@@ -210,15 +208,15 @@ void update_npc_ai(int n) {
         /* Countdown to next move */
         npcs[n].nav_timer--;
         if (npcs[n].nav_timer <= 0) {
-            npcs[n].ai_state = AI_STATE_ATTACK_RUN; /* Pick new position */
+            npc_hot.ai_state[n] = AI_STATE_ATTACK_RUN; /* Pick new position */
             npcs[n].nav_timer = 0;
         }
 
-    } else if (npcs[n].ai_state == AI_STATE_FLEE && closest_p != -1) {
-        double dx = npcs[n].gx - players[closest_p].gx, dy = npcs[n].gy - players[closest_p].gy, dz = npcs[n].gz - players[closest_p].gz;
+    } else if (npc_hot.ai_state[n] == AI_STATE_FLEE && closest_p != -1) {
+        double dx = npc_hot.gx[n] - players[closest_p].gx, dy = npc_hot.gy[n] - players[closest_p].gy, dz = npc_hot.gz[n] - players[closest_p].gz;
         double d = sqrt(dx*dx + dy*dy + dz*dz);
         if (d > 0.1) { d_dx = dx/d; d_dy = dy/d; d_dz = dz/d; speed *= 1.8; }
-        if (d > 8.5) npcs[n].ai_state = AI_STATE_PATROL; /* Safely away */
+        if (d > 8.5) npc_hot.ai_state[n] = AI_STATE_PATROL; /* Safely away */
     } else {
         if (npcs[n].nav_timer-- <= 0) { 
             npcs[n].nav_timer = 100 + rand()%200; 
@@ -229,53 +227,169 @@ void update_npc_ai(int n) {
         d_dx = npcs[n].dx; d_dy = npcs[n].dy; d_dz = npcs[n].dz;
     }
     
-    /* Movement and Collision with Celestial Bodies */
-    npcs[n].gx += d_dx * speed; npcs[n].gy += d_dy * speed; npcs[n].gz += d_dz * speed;
-    
-    /* Clamp to galaxy bounds */
-    if (npcs[n].gx < 0.05) { npcs[n].gx = 0.05; }
-    if (npcs[n].gx > 99.95) { npcs[n].gx = 99.95; }
-    if (npcs[n].gy < 0.05) { npcs[n].gy = 0.05; }
-    if (npcs[n].gy > 99.95) { npcs[n].gy = 99.95; }
-    if (npcs[n].gz < 0.05) { npcs[n].gz = 0.05; }
-    if (npcs[n].gz > 99.95) { npcs[n].gz = 99.95; }
+    /* Displacement for this tick; npc_move applies it */
+    npc_hot.vx[n] = d_dx * speed; npc_hot.vy[n] = d_dy * speed; npc_hot.vz[n] = d_dz * speed;
+}
 
-    npcs[n].q1 = get_q_from_g(npcs[n].gx); npcs[n].q2 = get_q_from_g(npcs[n].gy); npcs[n].q3 = get_q_from_g(npcs[n].gz);
-    npcs[n].x = npcs[n].gx - (npcs[n].q1 - 1) * 10.0; npcs[n].y = npcs[n].gy - (npcs[n].q2 - 1) * 10.0; npcs[n].z = npcs[n].gz - (npcs[n].q3 - 1) * 10.0;
+/* Moves every NPC up to the highest live slot at once, then lets the black holes take the
+   live ones */
+static void npc_move(void) {
+    int span = entity_span(SI_NPC);
+    npc_integrate(npc_hot.gx, npc_hot.vx, npc_hot.x, npc_hot.q1, span, 0.05, GALAXY_UNITS - 0.05, galaxy_q);
+    npc_integrate(npc_hot.gy, npc_hot.vy, npc_hot.y, npc_hot.q2, span, 0.05, GALAXY_UNITS - 0.05, galaxy_q);
+    npc_integrate(npc_hot.gz, npc_hot.vz, npc_hot.z, npc_hot.q3, span, 0.05, GALAXY_UNITS - 0.05, galaxy_q);
 
     /* Enviromental Hazards */
-    for(int h=0; h<local_q->bh_count; h++) {
-        double d=sqrt(pow(local_q->black_holes[h]->x-npcs[n].x,2)+pow(local_q->black_holes[h]->y-npcs[n].y,2)+pow(local_q->black_holes[h]->z-npcs[n].z,2));
-        if(d < 1.0) npcs[n].active = 0;
+    const uint16_t *live;
+    for (int k = entity_live(SI_NPC, &live) - 1; k >= 0; k--) {
+        int n = live[k];
+        SpatialHit bh;
+        if (spatial_query(npc_hot.gx[n], npc_hot.gy[n], npc_hot.gz[n], 1.0, SI_MASK(SI_BH), &bh, 1) > 0) entity_despawn(SI_NPC, n);
+    }
+}
+
+/* Ship entries of an update, at a position in the receiving frame */
+static void net_player_object(NetObject *no, const ConnectedPlayer *p, float x, float y, float z) {
+    *no = (NetObject){x, y, z, (float)p->state.ent_h, (float)p->state.ent_m, 1, p->ship_class, 1, (int)p->state.hull_integrity, p->state.energy, p->state.duranium_plating, (int)p->state.hull_integrity, p->faction, entity_id(SI_PLAYER, (int)(p-players)), p->state.is_cloaked, ""};
+    size_t nlen = strlen(p->name);
+    if (nlen > 63) nlen = 63;
+    memcpy(no->name, p->name, nlen);
+    no->name[nlen] = '\0';
+}
+
+static void net_npc_object(NetObject *no, const NPCShip *npc, float x, float y, float z) {
+    *no = (NetObject){x, y, z, (float)npc->h, (float)npc->m, npc->faction, 0, 1, (int)npc->engine_health, npc_hot.energy[npc->id], 0, (int)npc->engine_health, npc->faction, entity_id(SI_NPC, npc->id), npc->is_cloaked, ""};
+    strncpy(no->name, get_species_name(npc->faction), 63);
+}
+
+static void net_monster_object(NetObject *no, const NPCMonster *mon, float x, float y, float z) {
+    *no = (NetObject){x, y, z, 0, 0, mon->type, 0, 1, 100, (int)mon->energy, 0, 100, 0, entity_id(SI_MONSTER, mon->id), 0, ""};
+    strncpy(no->name, (mon->type==30)?"Crystalline Entity":"Space Amoeba", 63);
+}
+
+/* Appends everything visible in a quadrant to an update's object list. viewer is the
+   receiving captain (skipped, sees own-faction cloaks) or NULL for a spectator view. */
+static int append_quadrant_objects(NetObject *objects, int o_idx, int q1, int q2, int q3, const ConnectedPlayer *viewer) {
+    if (IS_Q_VALID(q1, q2, q3)) {
+        QuadrantIndex lq_view = spatial_quadrant(q1, q2, q3), *lq = &lq_view;
+        /* Players in current quadrant */
+        for(int j=0; j<lq->player_count; j++) {
+            ConnectedPlayer *p = &players[lq->players[j]]; 
+            if (p == viewer || !p->active || o_idx >= MAX_NET_OBJECTS) continue;
+            if (p->state.is_cloaked && (!viewer || p->faction != viewer->faction)) continue;
+            net_player_object(&objects[o_idx++], p, (float)p->state.s1, (float)p->state.s2, (float)p->state.s3);
+        }
+        /* NPCs in current quadrant */
+        for(int n=0; n<lq->npc_count && o_idx < MAX_NET_OBJECTS; n++) {
+            NPCShip *npc = &npcs[lq->npcs[n]]; if (!npc_hot.active[npc->id]) continue;
+            net_npc_object(&objects[o_idx++], npc, (float)npc_hot.x[npc->id], (float)npc_hot.y[npc->id], (float)npc_hot.z[npc->id]);
+        }
+        /* Static objects in current quadrant */
+            for(int p=0; p<lq->planet_count && o_idx < MAX_NET_OBJECTS; p++) if(planets[lq->planets[p]].active) objects[o_idx++] = (NetObject){(float)planets[lq->planets[p]].x, (float)planets[lq->planets[p]].y, (float)planets[lq->planets[p]].z, 0, 0, 5, planets[lq->planets[p]].resource_type, 1, 100, 0, 0, 100, 0, entity_id(SI_PLANET, lq->planets[p]), 0, "Planet"};
+            for(int s=0; s<lq->star_count && o_idx < MAX_NET_OBJECTS; s++) if(stars_data[lq->stars[s]].active) objects[o_idx++] = (NetObject){(float)stars_data[lq->stars[s]].x, (float)stars_data[lq->stars[s]].y, (float)stars_data[lq->stars[s]].z, 0, 0, 4, stars_data[lq->stars[s]].id % 7, 1, 100, 0, 0, 100, 0, entity_id(SI_STAR, lq->stars[s]), 0, "Star"};
+            for(int h=0; h<lq->bh_count && o_idx < MAX_NET_OBJECTS; h++) if(black_holes[lq->black_holes[h]].active) objects[o_idx++] = (NetObject){(float)black_holes[lq->black_holes[h]].x, (float)black_holes[lq->black_holes[h]].y, (float)black_holes[lq->black_holes[h]].z, 0, 0, 6, 0, 1, 100, 0, 0, 100, 0, entity_id(SI_BH, lq->black_holes[h]), 0, "Black Hole"};
+            for(int b=0; b<lq->base_count && o_idx < MAX_NET_OBJECTS; b++) if(bases[lq->bases[b]].active) objects[o_idx++] = (NetObject){(float)bases[lq->bases[b]].x, (float)bases[lq->bases[b]].y, (float)bases[lq->bases[b]].z, 0, 0, 3, 0, 1, 100, 0, 0, 100, 0, entity_id(SI_BASE, lq->bases[b]), 0, "Starbase"};
+            for(int n=0; n<lq->nebula_count && o_idx < MAX_NET_OBJECTS; n++) objects[o_idx++] = (NetObject){(float)nebulas[lq->nebulas[n]].x, (float)nebulas[lq->nebulas[n]].y, (float)nebulas[lq->nebulas[n]].z, 0, 0, 7, nebulas[lq->nebulas[n]].id % 5, 1, 100, 0, 0, 100, 0, entity_id(SI_NEBULA, lq->nebulas[n]), 0, "Nebula"};
+            for(int p=0; p<lq->pulsar_count && o_idx < MAX_NET_OBJECTS; p++) objects[o_idx++] = (NetObject){(float)pulsars[lq->pulsars[p]].x, (float)pulsars[lq->pulsars[p]].y, (float)pulsars[lq->pulsars[p]].z, 0, 0, 8, 0, 1, 100, 0, 0, 100, 0, entity_id(SI_PULSAR, lq->pulsars[p]), 0, "Pulsar"};
+            for(int c=0; c<lq->comet_count && o_idx < MAX_NET_OBJECTS; c++) objects[o_idx++] = (NetObject){(float)comets[lq->comets[c]].x, (float)comets[lq->comets[c]].y, (float)comets[lq->comets[c]].z, (float)comets[lq->comets[c]].h, (float)comets[lq->comets[c]].m, 9, 0, 1, 100, 0, 0, 100, 0, entity_id(SI_COMET, lq->comets[c]), 0, "Comet"};
+            for(int a=0; a<lq->asteroid_count && o_idx < MAX_NET_OBJECTS; a++) objects[o_idx++] = (NetObject){(float)asteroids[lq->asteroids[a]].x, (float)asteroids[lq->asteroids[a]].y, (float)asteroids[lq->asteroids[a]].z, 0, 0, 21, asteroids[lq->asteroids[a]].resource_type, 1, 100, asteroids[lq->asteroids[a]].amount, 0, 100, 0, entity_id(SI_ASTEROID, lq->asteroids[a]), 0, "Asteroid"};
+            for(int d=0; d<lq->derelict_count && o_idx < MAX_NET_OBJECTS; d++) objects[o_idx++] = (NetObject){(float)derelicts[lq->derelicts[d]].x, (float)derelicts[lq->derelicts[d]].y, (float)derelicts[lq->derelicts[d]].z, 0, 0, 22, lq->derelict_count, 1, 30, 0, 0, 100, 0, entity_id(SI_DERELICT, lq->derelicts[d]), 0, "Derelict"};
+            for(int pt=0; pt<lq->platform_count && o_idx < MAX_NET_OBJECTS; pt++) objects[o_idx++] = (NetObject){(float)platforms[lq->platforms[pt]].x, (float)platforms[lq->platforms[pt]].y, (float)platforms[lq->platforms[pt]].z, 0, 0, 25, 0, 1, (int)((platforms[lq->platforms[pt]].energy/10000.0)*100), (int)platforms[lq->platforms[pt]].energy, 0, 100, platforms[lq->platforms[pt]].faction, entity_id(SI_PLATFORM, lq->platforms[pt]), 0, "Defense Platform"};
+            for(int mo=0; mo<lq->monster_count && o_idx < MAX_NET_OBJECTS; mo++) { const NPCMonster *mon = &monsters[lq->monsters[mo]]; net_monster_object(&objects[o_idx++], mon, (float)mon->x, (float)mon->y, (float)mon->z); }
+        /* Global Probes: Check ALL probes from ALL players */
+        for (int p_j = 0; p_j < MAX_CLIENTS; p_j++) {
+            if (!players[p_j].socket) continue;
+            for (int pr = 0; pr < 3; pr++) {
+                if (players[p_j].state.probes[pr].active && o_idx < MAX_NET_OBJECTS) {
+                    /* Check if this probe is in player i's current quadrant */
+                    int pr_q1 = get_q_from_g(players[p_j].state.probes[pr].gx);
+                    int pr_q2 = get_q_from_g(players[p_j].state.probes[pr].gy);
+                    int pr_q3 = get_q_from_g(players[p_j].state.probes[pr].gz);
+                    
+                    if (pr_q1 == q1 && pr_q2 == q2 && pr_q3 == q3) {
+                        NetObject *no = &objects[o_idx++];
+                        no->net_x = players[p_j].state.probes[pr].s1;
+                        no->net_y = players[p_j].state.probes[pr].s2;
+                        no->net_z = players[p_j].state.probes[pr].s3;
+                        no->type = 27; /* TYPE_PROBE */
+                        no->id = entity_id(ENT_PROBE, p_j * 3 + pr);
+                        no->ship_class = players[p_j].state.probes[pr].status; /* Pass status here */
+                        no->is_cloaked = 0;
+                        snprintf(no->name, 64, "P:%.58s", players[p_j].name);
+                        no->active = 1;
+                    }
+                }
+            }
+        }
+    }
+    return o_idx;
+}
+
+/* Ships just across the borders of the viewer's quadrant, placed in the viewer's frame.
+   Only captains near a border look: everyone else is a whole quadrant away. */
+static int append_border_contacts(NetObject *objects, int o_idx, const ConnectedPlayer *viewer) {
+    const StarTrekGame *v = &viewer->state;
+    const double lo = SPATIAL_BORDER_VIEW, hi = 10.0 - SPATIAL_BORDER_VIEW;
+    if (v->s1 >= lo && v->s1 <= hi && v->s2 >= lo && v->s2 <= hi && v->s3 >= lo && v->s3 <= hi) return o_idx;
+
+    double vx, vy, vz;
+    if (!spatial_position(SI_PLAYER, (int)(viewer - players), &vx, &vy, &vz)) return o_idx;
+    const SpatialHit *near;
+    int near_count = spatial_query_all(vx, vy, vz, SPATIAL_BORDER_VIEW, SI_MASK(SI_PLAYER) | SI_MASK(SI_NPC) | SI_MASK(SI_MONSTER), &near);
+    for (int h = 0; h < near_count && o_idx < MAX_NET_OBJECTS; h++) {
+        const ConnectedPlayer *p = (near[h].kind == SI_PLAYER) ? &players[near[h].idx] : NULL;
+        const NPCShip *npc = (near[h].kind == SI_NPC) ? &npcs[near[h].idx] : NULL;
+        const NPCMonster *mon = (near[h].kind == SI_MONSTER) ? &monsters[near[h].idx] : NULL;
+        /* Bodies inside the quadrant are already listed */
+        int q1 = p ? p->state.q1 : npc ? npc_hot.q1[npc->id] : mon->q1;
+        int q2 = p ? p->state.q2 : npc ? npc_hot.q2[npc->id] : mon->q2;
+        int q3 = p ? p->state.q3 : npc ? npc_hot.q3[npc->id] : mon->q3;
+        if (q1 == v->q1 && q2 == v->q2 && q3 == v->q3) continue;
+        if (p && p->state.is_cloaked && p->faction != viewer->faction) continue;
+
+        double x, y, z;
+        spatial_position(near[h].kind, near[h].idx, &x, &y, &z);
+        x -= (v->q1 - 1) * 10.0; y -= (v->q2 - 1) * 10.0; z -= (v->q3 - 1) * 10.0;
+        if (p) net_player_object(&objects[o_idx++], p, (float)x, (float)y, (float)z);
+        else if (npc) net_npc_object(&objects[o_idx++], npc, (float)x, (float)y, (float)z);
+        else net_monster_object(&objects[o_idx++], mon, (float)x, (float)y, (float)z);
     }
+    return o_idx;
 }
 
 void update_game_logic() {
     global_tick++;
+    arena_reset();
 
     pthread_mutex_lock(&game_mutex);
+    galaxy_master.frame_id++;
+    fx_begin_tick();
+    run_queued_commands();
+    run_pending_batches();
     
     /* Phase 0: Map cleanup (Storms) */
     if (global_tick % 500 == 0) {
-        for(int i=1; i<=10; i++) for(int j=1; j<=10; j++) for(int l=1; l<=10; l++) {
-            if (galaxy_master.g[i][j][l] >= 10000000) galaxy_master.g[i][j][l] -= 10000000;
+        for (int c = 0; c < GALAXY_CELLS; c++) {
+            if (galaxy_map[c] >= 10000000) galaxy_map_set(c, galaxy_map[c] - 10000000);
         }
     }
 
-    /* Phase 1: NPC Movement & AI */
-    for (int n = 0; n < MAX_NPC; n++) update_npc_ai(n);
+    /* Phase 1: NPC Movement & AI. Tick loops walk the pools' live lists, never the capacity. */
+    const uint16_t *live;
+    for (int k = entity_live(SI_NPC, &live) - 1; k >= 0; k--) update_npc_ai(live[k]);
+    npc_move();
 
     /* Phase 1.2: Platform AI (Static Defense) */
-    for (int pt = 0; pt < MAX_PLATFORMS; pt++) {
-        if (!platforms[pt].active) continue;
+    for (int k = entity_live(SI_PLATFORM, &live) - 1; k >= 0; k--) {
+        int pt = live[k];
         if (platforms[pt].fire_cooldown > 0) platforms[pt].fire_cooldown--;
         
         if (platforms[pt].fire_cooldown <= 0) {
             int q1 = platforms[pt].q1, q2 = platforms[pt].q2, q3 = platforms[pt].q3;
-            QuadrantIndex *local_q = &spatial_index[q1][q2][q3];
+            QuadrantIndex local_q_view = spatial_quadrant(q1, q2, q3), *local_q = &local_q_view;
             
             for (int j = 0; j < local_q->player_count; j++) {
-                ConnectedPlayer *p = local_q->players[j];
+                ConnectedPlayer *p = &players[local_q->players[j]];
                 if (p->state.is_cloaked) continue;
                 
                 /* Faction Check for Platforms */
@@ -288,8 +402,7 @@ void update_game_logic() {
                 
                 if (dist < 5.0) {
                     /* Fire! */
-                    p->state.beam_count = 1;
-                    p->state.beams[0] = (NetBeam){(float)platforms[pt].x, (float)platforms[pt].y, (float)platforms[pt].z, (float)p->state.s1, (float)p->state.s2, (float)p->state.s3, 1};
+                    fx_beam(platforms[pt].q1, platforms[pt].q2, platforms[pt].q3, entity_id(SI_PLATFORM, pt), platforms[pt].x, platforms[pt].y, platforms[pt].z, p->state.s1, p->state.s2, p->state.s3);
                     
                     /* Tactical Damage Logic */
                     int dmg = 2000; /* Platform phaser base damage */
@@ -335,7 +448,7 @@ void update_game_logic() {
                             int sys_idx = rand() % 10;
                             p->state.system_health[sys_idx] -= (5.0f + (rand() % 15));
                             if (p->state.system_health[sys_idx] < 0) p->state.system_health[sys_idx] = 0;
-                            send_server_msg(j, "DAMAGE", "Platform hit bypassed shields! System damage detected!");
+                            send_alert(j, ALERT_PLATFORM_SYSTEM_HIT, 0, 0);
                         }
                         p->state.energy -= dmg_rem / 2;
                     }
@@ -343,11 +456,11 @@ void update_game_logic() {
                     p->shield_regen_delay = 90;
                     if (p->state.hull_integrity <= 0 || p->state.energy <= 0) {
                         p->state.energy = 0; p->state.hull_integrity = 0; p->state.crew_count = 0; p->active = 0;
-                        p->state.boom = (NetPoint){(float)p->state.s1, (float)p->state.s2, (float)p->state.s3, 1};
+                        fx_point(p->state.q1, p->state.q2, p->state.q3, FX_BOOM, 0, p->state.s1, p->state.s2, p->state.s3, 0);
                     }
 
                     platforms[pt].fire_cooldown = 100; /* ~3.3 seconds */
-                    send_server_msg(j, "WARNING", "UNDER ATTACK BY DEFENSE PLATFORM!");
+                    send_alert(j, ALERT_PLATFORM_ATTACK, 0, 0);
                     break;
                 }
             }
@@ -355,8 +468,8 @@ void update_game_logic() {
     }
 
     /* Phase 1.5: Comet Orbital Movement */
-    for (int c = 0; c < MAX_COMETS; c++) {
-        if (!comets[c].active) continue;
+    for (int k = entity_live(SI_COMET, &live) - 1; k >= 0; k--) {
+        int c = live[k];
         
         /* 1. Update orbital angle */
         comets[c].angle += comets[c].speed;
@@ -371,15 +484,15 @@ void update_game_logic() {
         double gy = comets[c].cy + oy * cos(comets[c].inc);
         double gz = comets[c].cz + oy * sin(comets[c].inc);
         
-        /* 4. Clamp to Galactic Bounds 0-100 */
-        if (gx < 0) { gx = 0; } if (gx > 100) { gx = 100; }
-        if (gy < 0) { gy = 0; } if (gy > 100) { gy = 100; }
-        if (gz < 0) { gz = 0; } if (gz > 100) { gz = 100; }
+        /* 4. Clamp to Galactic Bounds */
+        if (gx < 0) { gx = 0; } if (gx > GALAXY_UNITS) { gx = GALAXY_UNITS; }
+        if (gy < 0) { gy = 0; } if (gy > GALAXY_UNITS) { gy = GALAXY_UNITS; }
+        if (gz < 0) { gz = 0; } if (gz > GALAXY_UNITS) { gz = GALAXY_UNITS; }
         
         /* 5. Update local quadrant and sector */
-        int nq1 = (int)(gx / 10.0) + 1; if(nq1>10) nq1=10; if(nq1<1) nq1=1;
-        int nq2 = (int)(gy / 10.0) + 1; if(nq2>10) nq2=10; if(nq2<1) nq2=1;
-        int nq3 = (int)(gz / 10.0) + 1; if(nq3>10) nq3=10; if(nq3<1) nq3=1;
+        int nq1 = get_q_from_g(gx);
+        int nq2 = get_q_from_g(gy);
+        int nq3 = get_q_from_g(gz);
         
         comets[c].q1 = nq1; comets[c].q2 = nq2; comets[c].q3 = nq3;
         comets[c].x = gx - (nq1-1)*10.0;
@@ -393,7 +506,7 @@ void update_game_logic() {
         
         int q1 = supernova_event.supernova_q1, q2 = supernova_event.supernova_q2, q3 = supernova_event.supernova_q3;
         /* Force negative value in galaxy grid to trigger red blinking on all client maps */
-        galaxy_master.g[q1][q2][q3] = -supernova_event.supernova_timer;
+        galaxy_map_set(GALAXY_CELL(q1, q2, q3), -supernova_event.supernova_timer);
 
         int sec = supernova_event.supernova_timer / 30;
         if (sec > 0 && (supernova_event.supernova_timer % 300 == 0 || (sec <= 10 && supernova_event.supernova_timer % 30 == 0))) {
@@ -409,41 +522,43 @@ void update_game_logic() {
             LOG_DEBUG("SUPERNOVA EXPLOSION in Q-%d-%d-%d\n", q1, q2, q3);
 
             /* Destroy the specific star */
-            if (supernova_event.star_id >= 0 && supernova_event.star_id < MAX_STARS) {
-                stars_data[supernova_event.star_id].active = 0;
+            if (supernova_event.star_id >= 0 && supernova_event.star_id < entity_capacity(SI_STAR)) {
+                entity_despawn(SI_STAR, supernova_event.star_id);
             }
             
-            /* Destroy Planets */
-            for(int p=0; p<MAX_PLANETS; p++) if(planets[p].active && planets[p].q1 == q1 && planets[p].q2 == q2 && planets[p].q3 == q3) planets[p].active = 0;
-            /* Destroy NPCs */
-            for(int n=0; n<MAX_NPC; n++) if(npcs[n].active && npcs[n].q1 == q1 && npcs[n].q2 == q2 && npcs[n].q3 == q3) npcs[n].active = 0;
-            /* Destroy Bases */
-            for(int b=0; b<MAX_BASES; b++) if(bases[b].active && bases[b].q1 == q1 && bases[b].q2 == q2 && bases[b].q3 == q3) bases[b].active = 0;
+            /* Destroy Planets and Bases: they never move, so the quadrant's runs list them (and
+               stay as they are until the index is next updated) */
+            QuadrantIndex blast_view = spatial_quadrant(q1, q2, q3), *blast = &blast_view;
+            for(int p=0; p<blast->planet_count; p++) entity_despawn(SI_PLANET, blast->planets[p]);
+            for(int b=0; b<blast->base_count; b++) entity_despawn(SI_BASE, blast->bases[b]);
+            /* Destroy NPCs: they moved this tick after the index was last updated */
+            for (int k = entity_live(SI_NPC, &live) - 1; k >= 0; k--) {
+                int n = live[k];
+                if (npc_hot.q1[n] == q1 && npc_hot.q2[n] == q2 && npc_hot.q3[n] == q3) entity_despawn(SI_NPC, n);
+            }
             
             /* Destroy Players */
             for(int i=0; i<MAX_CLIENTS; i++) {
                 if(players[i].active && players[i].state.q1 == q1 && players[i].state.q2 == q2 && players[i].state.q3 == q3) {
                     send_server_msg(i, "CRITICAL", "SUPERNOVA IMPACT. VESSEL VAPORIZED.");
                     players[i].state.energy = 0; players[i].state.crew_count = 0;
-                    players[i].state.boom = (NetPoint){(float)players[i].state.s1, (float)players[i].state.s2, (float)players[i].state.s3, 1};
+                    fx_point(players[i].state.q1, players[i].state.q2, players[i].state.q3, FX_BOOM, 0, players[i].state.s1, players[i].state.s2, players[i].state.s3, 0);
                     players[i].active = 0;
                 }
             }
 
             /* Convert to a Black Hole remnant in the galaxy map */
-            galaxy_master.g[q1][q2][q3] = 10000; /* BPNBS: 1 Black Hole, 0 Planets, 0 Bases, 0 Stars */
+            galaxy_map_set(GALAXY_CELL(q1, q2, q3), 10000); /* BPNBS: 1 Black Hole, 0 Planets, 0 Bases, 0 Stars */
             
             /* Create the physical Black Hole object in the quadrant */
-            for(int bh=0; bh<MAX_BH; bh++) {
-                if(!black_holes[bh].active) {
-                    black_holes[bh].id = bh;
-                    black_holes[bh].q1 = q1; black_holes[bh].q2 = q2; black_holes[bh].q3 = q3;
-                    black_holes[bh].x = supernova_event.x;
-                    black_holes[bh].y = supernova_event.y;
-                    black_holes[bh].z = supernova_event.z;
-                    black_holes[bh].active = 1;
-                    break;
-                }
+            int bh = entity_alloc(SI_BH);
+            if (bh >= 0) {
+                black_holes[bh].id = bh;
+                black_holes[bh].q1 = q1; black_holes[bh].q2 = q2; black_holes[bh].q3 = q3;
+                black_holes[bh].x = supernova_event.x;
+                black_holes[bh].y = supernova_event.y;
+                black_holes[bh].z = supernova_event.z;
+                black_holes[bh].active = 1;
             }
 
             supernova_event.supernova_timer = 0; /* EXPLICITLY CLEAR EVENT */
@@ -460,32 +575,30 @@ void update_game_logic() {
     } else {
         /* Small chance to trigger a new supernova if none active */
         if (global_tick > 100 && supernova_event.supernova_timer <= 0 && (rand() % 100000 < 1)) {
-            int rq1 = rand()%10+1, rq2 = rand()%10+1, rq3 = rand()%10+1;
-            QuadrantIndex *qi = &spatial_index[rq1][rq2][rq3];
+            int rq1 = rand()%galaxy_q+1, rq2 = rand()%galaxy_q+1, rq3 = rand()%galaxy_q+1;
+            QuadrantIndex qi_view = spatial_quadrant(rq1, rq2, rq3), *qi = &qi_view;
             if (qi->star_count > 0) {
                 supernova_event.supernova_q1 = rq1;
                 supernova_event.supernova_q2 = rq2;
                 supernova_event.supernova_q3 = rq3;
                 supernova_event.supernova_timer = TIMER_SUPERNOVA;
-                supernova_event.x = qi->stars[0]->x;
-                supernova_event.y = qi->stars[0]->y;
-                supernova_event.z = qi->stars[0]->z;
-                supernova_event.star_id = qi->stars[0]->id;
+                supernova_event.x = stars_data[qi->stars[0]].x;
+                supernova_event.y = stars_data[qi->stars[0]].y;
+                supernova_event.z = stars_data[qi->stars[0]].z;
+                supernova_event.star_id = stars_data[qi->stars[0]].id;
             }
         }
     }
 
     /* Phase 1.7: Monster AI Logic */
-
-    /* Phase 1.7: Monster AI Logic */
-    for (int mo = 0; mo < MAX_MONSTERS; mo++) {
-        if (!monsters[mo].active) continue;
+    for (int k = entity_live(SI_MONSTER, &live) - 1; k >= 0; k--) {
+        int mo = live[k];
         int q1 = monsters[mo].q1, q2 = monsters[mo].q2, q3 = monsters[mo].q3;
-        QuadrantIndex *local_q = &spatial_index[q1][q2][q3];
+        QuadrantIndex local_q_view = spatial_quadrant(q1, q2, q3), *local_q = &local_q_view;
         
         ConnectedPlayer *target = NULL; double min_d = 10.0;
         for (int j = 0; j < local_q->player_count; j++) {
-            ConnectedPlayer *p = local_q->players[j]; if (p->state.is_cloaked) continue;
+            ConnectedPlayer *p = &players[local_q->players[j]]; if (p->state.is_cloaked) continue;
             double dx = p->state.s1 - monsters[mo].x, dy = p->state.s2 - monsters[mo].y, dz = p->state.s3 - monsters[mo].z;
             double d = sqrt(dx*dx + dy*dy + dz*dz);
             if (d < min_d) { min_d = d; target = p; }
@@ -497,21 +610,22 @@ void update_game_logic() {
                 double dist = (min_d > 0.001) ? min_d : 0.001;
                 monsters[mo].x += (dx/dist) * 0.05; monsters[mo].y += (dy/dist) * 0.05; monsters[mo].z += (dz/dist) * 0.05;
                 if (min_d < 4.0 && global_tick % 60 == 0) {
-                    target->state.beam_count = 1;
-                    target->state.beams[0] = (NetBeam){(float)monsters[mo].x, (float)monsters[mo].y, (float)monsters[mo].z, 30};
+                    fx_beam(monsters[mo].q1, monsters[mo].q2, monsters[mo].q3, entity_id(SI_MONSTER, mo), monsters[mo].x, monsters[mo].y, monsters[mo].z, target->state.s1, target->state.s2, target->state.s3);
                     target->state.energy -= 500;
-                    send_server_msg((int)(target-players), "SCIENCE", "CRYSTALLINE RESONANCE DETECTED! SHIELDS BUCKLING!");
+                    send_alert((int)(target-players), ALERT_CRYSTALLINE_RESONANCE, 0, 0);
                 }
             }
         } else if (monsters[mo].type == 31) { /* Space Amoeba */
             if (target && min_d < 1.5) {
                 target->state.energy -= 200;
-                if (global_tick % 30 == 0) send_server_msg((int)(target-players), "WARNING", "SPACE AMOEBA ADHERING TO HULL! ENERGY DRAIN CRITICAL!");
+                send_alert((int)(target-players), ALERT_AMOEBA_DRAIN, 0, 0);
             }
         }
     }
 
-    /* Phase 2: Player Interaction & Hazards */
+    /* Phase 2: Player Interaction & Hazards. One broadphase pass pairs every captain with the
+       hazards in reach; the handlers below only read their pairs. */
+    contacts_build();
     for (int i = 0; i < MAX_CLIENTS; i++) {
         if (!players[i].active) continue;
         
@@ -525,9 +639,9 @@ void update_game_logic() {
                 if (players[i].state.crew_count == 0) {
                     send_server_msg(i, "CRITICAL", "Life support failure. Crew lost. Vessel adrift.");
                     players[i].active = 0;
-                    players[i].state.boom = (NetPoint){(float)players[i].state.s1, (float)players[i].state.s2, (float)players[i].state.s3, 1};
-                } else if (global_tick % 300 == 0) {
-                    send_server_msg(i, "MEDICAL", "Warning: Casualties reported due to life support instability.");
+                    fx_point(players[i].state.q1, players[i].state.q2, players[i].state.q3, FX_BOOM, 0, players[i].state.s1, players[i].state.s2, players[i].state.s3, 0);
+                } else {
+                    send_alert(i, ALERT_LIFE_SUPPORT_CASUALTIES, 0, 0);
                 }
             }
         }
@@ -541,7 +655,7 @@ void update_game_logic() {
                 /* Mark storm in galaxy grid for the map (8th digit) */
                 int q1=players[i].state.q1, q2=players[i].state.q2, q3=players[i].state.q3;
                 if (IS_Q_VALID(q1,q2,q3)) {
-                    if (galaxy_master.g[q1][q2][q3] < 10000000) galaxy_master.g[q1][q2][q3] += 10000000;
+                    if (GALAXY_MAP(q1, q2, q3) < 10000000) galaxy_map_set(GALAXY_CELL(q1, q2, q3), GALAXY_MAP(q1, q2, q3) + 10000000);
                 }
             } else if (event_type == 1) {
                 send_server_msg(i, "HELMSMAN", "Spatial shear encountered! We are being pushed off course!");
@@ -555,23 +669,24 @@ void update_game_logic() {
             }
         }
 
-        /* Anomaly Effects: Nebulas & Pulsars */
-        QuadrantIndex *anomaly_q = &spatial_index[players[i].state.q1][players[i].state.q2][players[i].state.q3];
-        
-        for (int n = 0; n < anomaly_q->nebula_count; n++) {
-            double d = sqrt(pow(players[i].state.s1 - anomaly_q->nebulas[n]->x, 2) + pow(players[i].state.s2 - anomaly_q->nebulas[n]->y, 2) + pow(players[i].state.s3 - anomaly_q->nebulas[n]->z, 2));
-            if (d < 2.0) {
+        /* Anomaly Effects: Nebulas & Pulsars. Hazards within reach come from the tick's contact pairs. */
+        ContactList hazards = contacts_of(i);
+
+        for (int n = 0; n < hazards.count; n++) {
+            if (hazards.pairs[n].kind != SI_NEBULA) continue;
+            if (hazards.pairs[n].d2 < 2.0 * 2.0) {
                  if (global_tick % 60 == 0) { /* Once per second */
                      players[i].state.energy -= 50;
                      if (players[i].state.energy < 0) players[i].state.energy = 0;
                  }
-                 if (global_tick % 300 == 0) send_server_msg(i, "COMPUTER", "Alert: Nebular interference draining shields.");
+                 send_alert(i, ALERT_NEBULA_DRAIN, 0, 0);
             }
         }
-        for (int p = 0; p < anomaly_q->pulsar_count; p++) {
-            double d = sqrt(pow(players[i].state.s1 - anomaly_q->pulsars[p]->x, 2) + pow(players[i].state.s2 - anomaly_q->pulsars[p]->y, 2) + pow(players[i].state.s3 - anomaly_q->pulsars[p]->z, 2));
-            if (d < 2.5) {
+        for (int p = 0; p < hazards.count; p++) {
+            if (hazards.pairs[p].kind != SI_PULSAR) continue;
+            if (hazards.pairs[p].d2 < 2.5 * 2.5) {
                 if (global_tick % 60 == 0) {
+                    double d = sqrt(hazards.pairs[p].d2);
                     int dmg = (int)((2.5 - d) * 400.0);
                     int shield_hit = 0;
                     for(int s=0; s<6; s++) { 
@@ -586,48 +701,46 @@ void update_game_logic() {
                         players[i].state.crew_count -= (rand()%5 + 1);
                         if (players[i].state.crew_count < 0) players[i].state.crew_count = 0;
                     }
-                    char msg[64]; sprintf(msg, "Radiation Critical! Shield Integrity Failing. (Dmg: %d)", dmg);
-                    send_server_msg(i, "WARNING", msg);
+                    send_alert(i, ALERT_PULSAR_RADIATION, dmg, 0);
                     
                     if (players[i].state.crew_count == 0) {
                          send_server_msg(i, "CRITICAL", "ALL HANDS LOST TO RADIATION.");
                          players[i].active = 0;
-                         players[i].state.boom = (NetPoint){(float)players[i].state.s1, (float)players[i].state.s2, (float)players[i].state.s3, 1};
+                         fx_point(players[i].state.q1, players[i].state.q2, players[i].state.q3, FX_BOOM, 0, players[i].state.s1, players[i].state.s2, players[i].state.s3, 0);
                     }
                 }
             }
         }
 
         /* Comet Interception Logic */
-        for (int c = 0; c < anomaly_q->comet_count; c++) {
-            double d = sqrt(pow(players[i].state.s1 - anomaly_q->comets[c]->x, 2) + pow(players[i].state.s2 - anomaly_q->comets[c]->y, 2) + pow(players[i].state.s3 - anomaly_q->comets[c]->z, 2));
-            if (d < 0.6) {
+        for (int c = 0; c < hazards.count; c++) {
+            if (hazards.pairs[c].kind != SI_COMET) continue;
+            if (hazards.pairs[c].d2 < 0.6 * 0.6) {
                 if (global_tick % 100 == 0) {
                     players[i].state.inventory[6] += 5; /* Gases */
-                    send_server_msg(i, "ENGINEERING", "Collecting rare gases from comet tail.");
+                    send_alert(i, ALERT_COMET_GAS, 0, 0);
                 }
             }
         }
 
         /* Asteroid Collision Logic */
-        for (int a = 0; a < anomaly_q->asteroid_count; a++) {
-            double d = sqrt(pow(players[i].state.s1 - anomaly_q->asteroids[a]->x, 2) + pow(players[i].state.s2 - anomaly_q->asteroids[a]->y, 2) + pow(players[i].state.s3 - anomaly_q->asteroids[a]->z, 2));
-            if (d < 0.8) {
+        for (int a = 0; a < hazards.count; a++) {
+            if (hazards.pairs[a].kind != SI_ASTEROID) continue;
+            if (hazards.pairs[a].d2 < 0.8 * 0.8) {
                 if (players[i].warp_speed > 0.1) {
                     if (global_tick % 30 == 0) {
                         int dmg = (int)(players[i].warp_speed * 1000.0);
                         for(int s=0; s<6; s++) players[i].state.shields[s] -= (dmg/10);
                         players[i].state.system_health[1] -= 0.5f; /* Impulse engines damage */
-                        send_server_msg(i, "WARNING", "Colliding with asteroids! Reduce speed!");
+                        send_alert(i, ALERT_ASTEROID_COLLISION, 0, 0);
                     }
                 }
             }
         }
 
         bool in_nebula = false;
-        for (int n = 0; n < anomaly_q->nebula_count; n++) {
-            double d = sqrt(pow(players[i].state.s1 - anomaly_q->nebulas[n]->x, 2) + pow(players[i].state.s2 - anomaly_q->nebulas[n]->y, 2) + pow(players[i].state.s3 - anomaly_q->nebulas[n]->z, 2));
-            if (d < 2.0) { in_nebula = true; break; }
+        for (int n = 0; n < hazards.count; n++) {
+            if (hazards.pairs[n].kind == SI_NEBULA && hazards.pairs[n].d2 < 2.0 * 2.0) { in_nebula = true; break; }
         }
 
         /* Nebula Shield Interference */
@@ -639,24 +752,23 @@ void update_game_logic() {
         }
 
         /* Pulsar Radiation Logic */
-        for (int p = 0; p < anomaly_q->pulsar_count; p++) {
-            double d = sqrt(pow(players[i].state.s1 - anomaly_q->pulsars[p]->x, 2) + pow(players[i].state.s2 - anomaly_q->pulsars[p]->y, 2) + pow(players[i].state.s3 - anomaly_q->pulsars[p]->z, 2));
-            if (d < 2.0) {
+        for (int p = 0; p < hazards.count; p++) {
+            if (hazards.pairs[p].kind != SI_PULSAR) continue;
+            if (hazards.pairs[p].d2 < 2.0 * 2.0) {
                 /* Radiation penetrates shields */
                 if (rand()%100 < 10) {
                     players[i].state.crew_count--;
-                    send_server_msg(i, "MEDICAL", "RADIATION ALERT! EQUIPMENT FAILURE IN SICKBAY!");
+                    send_alert(i, ALERT_SICKBAY_RADIATION, 0, 0);
                 }
                 players[i].state.energy -= 50; 
             }
         }
 
         /* Black Hole Gravity Pull */
-        for (int h = 0; h < anomaly_q->bh_count; h++) {
-            double dx = anomaly_q->black_holes[h]->x - players[i].state.s1;
-            double dy = anomaly_q->black_holes[h]->y - players[i].state.s2;
-            double dz = anomaly_q->black_holes[h]->z - players[i].state.s3;
-            double d = sqrt(dx*dx + dy*dy + dz*dz);
+        for (int h = 0; h < hazards.count; h++) {
+            if (hazards.pairs[h].kind != SI_BH) continue;
+            double dx = hazards.pairs[h].dx, dy = hazards.pairs[h].dy, dz = hazards.pairs[h].dz;
+            double d = sqrt(hazards.pairs[h].d2);
             if (d < 3.0 && d > 0.1) {
                 /* Pull player towards center */
                 double force = 0.05 / (d * d);
@@ -670,29 +782,31 @@ void update_game_logic() {
             }
         }
 
-        /* Mine Detonation Logic */
-        for (int m = 0; m < anomaly_q->mine_count; m++) {
-            if (!anomaly_q->mines[m]->active) continue;
-            double d = sqrt(pow(players[i].state.s1 - anomaly_q->mines[m]->x, 2) + pow(players[i].state.s2 - anomaly_q->mines[m]->y, 2) + pow(players[i].state.s3 - anomaly_q->mines[m]->z, 2));
-            if (d < 0.4) {
-                /* BOOM! */
-                anomaly_q->mines[m]->active = 0;
-                players[i].state.boom = (NetPoint){(float)anomaly_q->mines[m]->x, (float)anomaly_q->mines[m]->y, (float)anomaly_q->mines[m]->z, 1};
-                int dmg = 25000;
-                for(int s=0; s<6; s++) { int abs=(players[i].state.shields[s]>=dmg/6)?dmg/6:players[i].state.shields[s]; players[i].state.shields[s]-=abs; dmg-=abs; }
-                players[i].state.energy -= dmg;
-                send_server_msg(i, "CRITICAL", "MINE DETONATION! PROXIMITY ALERT FAILURE!");
-            }
+        /* Mine Detonation Logic: a mine just across the border is as close as one inside.
+           A mine in two captains' pairs goes off for the first one only. */
+        for (int m = 0; m < hazards.count; m++) {
+            const Contact *c = &hazards.pairs[m];
+            if (c->kind != SI_MINE || !mines[c->idx].active) continue;
+            NPCMine *mine = &mines[c->idx];
+            /* BOOM! */
+            entity_despawn(SI_MINE, c->idx);
+            fx_point(players[i].state.q1, players[i].state.q2, players[i].state.q3, FX_BOOM, 0,
+                     (mine->q1 - players[i].state.q1) * 10.0 + mine->x, (mine->q2 - players[i].state.q2) * 10.0 + mine->y,
+                     (mine->q3 - players[i].state.q3) * 10.0 + mine->z, 0);
+            int dmg = 25000;
+            for(int s=0; s<6; s++) { int abs=(players[i].state.shields[s]>=dmg/6)?dmg/6:players[i].state.shields[s]; players[i].state.shields[s]-=abs; dmg-=abs; }
+            players[i].state.energy -= dmg;
+            send_server_msg(i, "CRITICAL", "MINE DETONATION! PROXIMITY ALERT FAILURE!");
         }
 
         /* Spatial Rift Teleportation Logic */
-        for (int rf = 0; rf < anomaly_q->rift_count; rf++) {
-            double d = sqrt(pow(players[i].state.s1 - anomaly_q->rifts[rf]->x, 2) + pow(players[i].state.s2 - anomaly_q->rifts[rf]->y, 2) + pow(players[i].state.s3 - anomaly_q->rifts[rf]->z, 2));
-            if (d < 0.5) {
+        for (int rf = 0; rf < hazards.count; rf++) {
+            if (hazards.pairs[rf].kind != SI_RIFT) continue;
+            if (hazards.pairs[rf].d2 < 0.5 * 0.5) {
                 /* Random Jump */
-                int nq1 = 1 + rand()%10;
-                int nq2 = 1 + rand()%10;
-                int nq3 = 1 + rand()%10;
+                int nq1 = 1 + rand() % galaxy_q;
+                int nq2 = 1 + rand() % galaxy_q;
+                int nq3 = 1 + rand() % galaxy_q;
                 double ns1 = (rand()%100)/10.0;
                 double ns2 = (rand()%100)/10.0;
                 double ns3 = (rand()%100)/10.0;
@@ -810,13 +924,10 @@ void update_game_logic() {
                     
                     players[i].warp_speed = dist / players[i].nav_timer;
                     
-                    char msg[128];
-                    sprintf(msg, "Warp drive engaged. Velocity: Warp %.1f. ETA: %.1f seconds.", factor, (double)players[i].nav_timer / 30.0);
-                    send_server_msg(i, "HELMSMAN", msg);
+                    send_alert(i, ALERT_WARP_ENGAGED, (int)(factor * 10.0 + 0.5), players[i].nav_timer);
                 } else {
                     players[i].nav_state = NAV_STATE_IMPULSE;
-                    char msg[64]; sprintf(msg, "Impulse engaged at %.0f%%.", players[i].warp_speed * 200.0);
-                    send_server_msg(i, "HELMSMAN", msg);
+                    send_alert(i, ALERT_IMPULSE_ENGAGED, (int)(players[i].warp_speed * 200.0 + 0.5), 0);
                 }
             }
         }
@@ -843,7 +954,7 @@ void update_game_logic() {
             if (players[i].nav_timer <= 0) { 
                 players[i].state.ent_m = 0; 
                 players[i].nav_state = NAV_STATE_IDLE; 
-                send_server_msg(i, "HELMSMAN", "Stabilization complete. Ship aligned.");
+                send_alert(i, ALERT_SHIP_ALIGNED, 0, 0);
             }
         }
         else if (players[i].nav_state == NAV_STATE_IMPULSE) {
@@ -871,11 +982,11 @@ void update_game_logic() {
             
             /* Sci-Fi Message Sequence */
             if (players[i].nav_timer == 420) 
-                send_server_msg(i, "ENGINEERING", "Injecting exotic matter into local Schwarzschild metric...");
+                send_alert(i, ALERT_WORMHOLE_EXOTIC_MATTER, 0, 0);
             else if (players[i].nav_timer == 380)
-                send_server_msg(i, "SCIENCE", "Einstein-Rosen Bridge detected. Stabilizing singularity...");
+                send_alert(i, ALERT_WORMHOLE_BRIDGE, 0, 0);
             else if (players[i].nav_timer == 320)
-                send_server_msg(i, "HELMSMAN", "Wormhole mouth stable. Entering event horizon.");
+                send_alert(i, ALERT_WORMHOLE_ENTRY, 0, 0);
 
             /* Update Wormhole visual position in packet (Only before jump) */
             if (players[i].nav_timer > 300) {
@@ -916,14 +1027,14 @@ void update_game_logic() {
             }
 
             if (players[i].nav_timer == 240) { /* T+2.0s from arrival */
-                send_server_msg(i, "HELMSMAN", "Wormhole stabilized in target sector. Maintaining hull integrity.");
+                send_alert(i, ALERT_WORMHOLE_STABILIZED, 0, 0);
             }
 
             if (players[i].nav_timer <= 150) { /* Exactly 3.0s after the previous message */
                 players[i].nav_state = NAV_STATE_IDLE;
                 players[i].state.wormhole.active = 0;
                 players[i].state.jump_arrival.active = 0;
-                send_server_msg(i, "HELMSMAN", "Wormhole traversal successful. Welcome to destination.");
+                send_alert(i, ALERT_WORMHOLE_ARRIVAL, 0, 0);
             }
         }
         else if (players[i].nav_state == NAV_STATE_CHASE) {
@@ -931,29 +1042,25 @@ void update_game_logic() {
             double tx, ty, tz, tvx=0, tvy=0, tvz=0; bool found = false;
             int tq1=0, tq2=0, tq3=0;
 
-            if (tid >= 1 && tid <= 32 && players[tid-1].active) {
-                tx = players[tid-1].gx; ty = players[tid-1].gy; tz = players[tid-1].gz;
-                tvx = players[tid-1].dx * players[tid-1].warp_speed; tvy = players[tid-1].dy * players[tid-1].warp_speed; tvz = players[tid-1].dz * players[tid-1].warp_speed;
-                tq1 = players[tid-1].state.q1; tq2 = players[tid-1].state.q2; tq3 = players[tid-1].state.q3;
-                found = true;
-            } else if (tid >= 100 && tid < 100+MAX_NPC && npcs[tid-100].active) {
-                tx = npcs[tid-100].gx; ty = npcs[tid-100].gy; tz = npcs[tid-100].gz;
-                tvx = npcs[tid-100].dx * 0.03; tvy = npcs[tid-100].dy * 0.03; tvz = npcs[tid-100].dz * 0.03;
-                tq1 = npcs[tid-100].q1; tq2 = npcs[tid-100].q2; tq3 = npcs[tid-100].q3;
-                found = true;
-            } else if (tid >= 10000 && tid < 10000+MAX_COMETS && comets[tid-10000].active) {
-                int c = tid - 10000;
-                tx = (comets[c].q1-1)*10.0 + comets[c].x;
-                ty = (comets[c].q2-1)*10.0 + comets[c].y;
-                tz = (comets[c].q3-1)*10.0 + comets[c].z;
-                /* Approximate velocity from heading/mark */
-                double rad_h = comets[c].h * M_PI / 180.0;
-                double rad_m = comets[c].m * M_PI / 180.0;
-                tvx = cos(rad_m) * sin(rad_h) * 0.02; 
-                tvy = cos(rad_m) * -cos(rad_h) * 0.02;
-                tvz = sin(rad_m) * 0.02;
-                tq1 = comets[c].q1; tq2 = comets[c].q2; tq3 = comets[c].q3;
-                found = true;
+            EntityRef t;
+            if (entity_resolve(tid, players[i].lock_gen, &t)) {
+                tx = t.gx; ty = t.gy; tz = t.gz;
+                tq1 = t.q1; tq2 = t.q2; tq3 = t.q3;
+                if (t.kind == SI_PLAYER) {
+                    tvx = t.player->dx * t.player->warp_speed; tvy = t.player->dy * t.player->warp_speed; tvz = t.player->dz * t.player->warp_speed;
+                    found = true;
+                } else if (t.kind == SI_NPC) {
+                    tvx = t.npc->dx * 0.03; tvy = t.npc->dy * 0.03; tvz = t.npc->dz * 0.03;
+                    found = true;
+                } else if (t.kind == SI_COMET) {
+                    /* Approximate velocity from heading/mark */
+                    double rad_h = t.comet->h * M_PI / 180.0;
+                    double rad_m = t.comet->m * M_PI / 180.0;
+                    tvx = cos(rad_m) * sin(rad_h) * 0.02; 
+                    tvy = cos(rad_m) * -cos(rad_h) * 0.02;
+                    tvz = sin(rad_m) * 0.02;
+                    found = true;
+                }
             }
 
             if (found && players[i].state.energy > 5000) {
@@ -1010,13 +1117,13 @@ void update_game_logic() {
         /* Galactic Barrier Enforcement: Standardized for all axes and corners */
         bool hit_barrier = false;
         if (players[i].gx < 0.05) { players[i].gx = 0.05; hit_barrier = true; }
-        else if (players[i].gx > 99.95) { players[i].gx = 99.95; hit_barrier = true; }
+        else if (players[i].gx > GALAXY_UNITS - 0.05) { players[i].gx = GALAXY_UNITS - 0.05; hit_barrier = true; }
         
         if (players[i].gy < 0.05) { players[i].gy = 0.05; hit_barrier = true; }
-        else if (players[i].gy > 99.95) { players[i].gy = 99.95; hit_barrier = true; }
+        else if (players[i].gy > GALAXY_UNITS - 0.05) { players[i].gy = GALAXY_UNITS - 0.05; hit_barrier = true; }
         
         if (players[i].gz < 0.05) { players[i].gz = 0.05; hit_barrier = true; }
-        else if (players[i].gz > 99.95) { players[i].gz = 99.95; hit_barrier = true; }
+        else if (players[i].gz > GALAXY_UNITS - 0.05) { players[i].gz = GALAXY_UNITS - 0.05; hit_barrier = true; }
 
         if (hit_barrier && players[i].nav_state != NAV_STATE_CHASE && players[i].nav_state != NAV_STATE_IDLE) {
             players[i].nav_state = NAV_STATE_IDLE;
@@ -1032,13 +1139,12 @@ void update_game_logic() {
         players[i].state.s2 = players[i].gy - (players[i].state.q2 - 1) * 10.0;
         players[i].state.s3 = players[i].gz - (players[i].state.q3 - 1) * 10.0;
 
-        /* Collision Detection: Celestial Bodies */
-        QuadrantIndex *current_q = &spatial_index[players[i].state.q1][players[i].state.q2][players[i].state.q3];
-        for (int h = 0; h < current_q->bh_count; h++) {
-            double dx = current_q->black_holes[h]->x - players[i].state.s1;
-            double dy = current_q->black_holes[h]->y - players[i].state.s2;
-            double dz = current_q->black_holes[h]->z - players[i].state.s3;
-            double d = sqrt(dx*dx + dy*dy + dz*dz);
+        /* Collision Detection: Celestial Bodies, measured where the ship is after moving */
+        ContactList solids = contacts_moved(i);
+        for (int h = 0; h < solids.count; h++) {
+            if (solids.pairs[h].kind != SI_BH) continue;
+            double dx = solids.pairs[h].dx, dy = solids.pairs[h].dy, dz = solids.pairs[h].dz;
+            double d = sqrt(solids.pairs[h].d2);
             
             if (d < DIST_GRAVITY_WELL) {
                 /* Gravity Well Effect: Drain Shields and Energy */
@@ -1054,37 +1160,37 @@ void update_game_logic() {
                     players[i].gz += (dz / d) * pull_strength;
                 }
 
-                if (global_tick % 20 == 0) send_server_msg(i, "WARNING", "Extreme gravitational shear detected! Hull integrity at risk.");
+                send_alert(i, ALERT_GRAVITY_SHEAR, 0, 0);
             }
             if (d < DIST_EVENT_HORIZON) { 
                 send_server_msg(i, "CRITICAL", "Event Horizon crossed! Spaghettification in progress..."); 
                 players[i].state.energy = 0; players[i].state.crew_count = 0;
                 players[i].nav_state = NAV_STATE_IDLE; players[i].warp_speed = 0;
                 players[i].dx = 0; players[i].dy = 0; players[i].dz = 0;
-                players[i].state.boom = (NetPoint){(float)players[i].state.s1, (float)players[i].state.s2, (float)players[i].state.s3, 1}; 
+                fx_point(players[i].state.q1, players[i].state.q2, players[i].state.q3, FX_BOOM, 0, players[i].state.s1, players[i].state.s2, players[i].state.s3, 0); 
                 players[i].active = 0; /* Ship destroyed */
                 break; 
             }
         }
-        if (players[i].active && players[i].state.energy > 0) for (int s = 0; s < current_q->star_count; s++) {
-            double d = sqrt(pow(players[i].state.s1 - current_q->stars[s]->x, 2) + pow(players[i].state.s2 - current_q->stars[s]->y, 2) + pow(players[i].state.s3 - current_q->stars[s]->z, 2));
-            if (d < 0.8) { 
+        if (players[i].active && players[i].state.energy > 0) for (int s = 0; s < solids.count; s++) {
+            if (solids.pairs[s].kind != SI_STAR) continue;
+            if (solids.pairs[s].d2 < 0.8 * 0.8) { 
                 send_server_msg(i, "CRITICAL", "Impact with star corona! Hull melting..."); 
                 players[i].state.energy = 0; players[i].state.crew_count = 0;
                 players[i].nav_state = NAV_STATE_IDLE; players[i].warp_speed = 0;
                 players[i].dx = 0; players[i].dy = 0; players[i].dz = 0;
-                players[i].state.boom = (NetPoint){(float)players[i].state.s1, (float)players[i].state.s2, (float)players[i].state.s3, 1}; 
+                fx_point(players[i].state.q1, players[i].state.q2, players[i].state.q3, FX_BOOM, 0, players[i].state.s1, players[i].state.s2, players[i].state.s3, 0); 
                 break; 
             }
         }
-        if (players[i].active && players[i].state.energy > 0) for (int p = 0; p < current_q->planet_count; p++) {
-            double d = sqrt(pow(players[i].state.s1 - current_q->planets[p]->x, 2) + pow(players[i].state.s2 - current_q->planets[p]->y, 2) + pow(players[i].state.s3 - current_q->planets[p]->z, 2));
-            if (d < 0.8) { 
+        if (players[i].active && players[i].state.energy > 0) for (int p = 0; p < solids.count; p++) {
+            if (solids.pairs[p].kind != SI_PLANET) continue;
+            if (solids.pairs[p].d2 < 0.8 * 0.8) { 
                 send_server_msg(i, "CRITICAL", "Planetary collision! Structural failure."); 
                 players[i].state.energy = 0; players[i].state.crew_count = 0;
                 players[i].nav_state = NAV_STATE_IDLE; players[i].warp_speed = 0;
                 players[i].dx = 0; players[i].dy = 0; players[i].dz = 0;
-                players[i].state.boom = (NetPoint){(float)players[i].state.s1, (float)players[i].state.s2, (float)players[i].state.s3, 1}; 
+                fx_point(players[i].state.q1, players[i].state.q2, players[i].state.q3, FX_BOOM, 0, players[i].state.s1, players[i].state.s2, players[i].state.s3, 0); 
                 break; 
             }
         }
@@ -1092,44 +1198,12 @@ void update_game_logic() {
         /* Target Lock Validation (Inter-Quadrant aware) */
         if (players[i].state.lock_target > 0) {
             int tid = players[i].state.lock_target;
-            bool valid = false;
             int pq1 = players[i].state.q1, pq2 = players[i].state.q2, pq3 = players[i].state.q3;
-            
-            if (tid >= 1 && tid <= 32) {
-                /* Players can be locked as long as they are active anywhere */
-                if (players[tid-1].active) valid = true;
-            } else if (tid >= 1000 && tid < 1000+MAX_NPC) {
-                if (npcs[tid-1000].active) valid = true;
-            } else if (tid >= 2000 && tid < 2000+MAX_BASES) {
-                /* Static objects remain local-only for locking sanity */
-                if (bases[tid-2000].active && bases[tid-2000].q1 == pq1 && bases[tid-2000].q2 == pq2 && bases[tid-2000].q3 == pq3) valid = true;
-            } else if (tid >= 3000 && tid < 3000+MAX_PLANETS) {
-                if (planets[tid-3000].active && planets[tid-3000].q1 == pq1 && planets[tid-3000].q2 == pq2 && planets[tid-3000].q3 == pq3) valid = true;
-            } else if (tid >= 4000 && tid < 4000+MAX_STARS) {
-                if (stars_data[tid-4000].active && stars_data[tid-4000].q1 == pq1 && stars_data[tid-4000].q2 == pq2 && stars_data[tid-4000].q3 == pq3) valid = true;
-            } else if (tid >= 7000 && tid < 7000+MAX_BH) {
-                if (black_holes[tid-7000].active && black_holes[tid-7000].q1 == pq1 && black_holes[tid-7000].q2 == pq2 && black_holes[tid-7000].q3 == pq3) valid = true;
-            } else if (tid >= 8000 && tid < 8000+MAX_NEBULAS) {
-                if (nebulas[tid-8000].active && nebulas[tid-8000].q1 == pq1 && nebulas[tid-8000].q2 == pq2 && nebulas[tid-8000].q3 == pq3) valid = true;
-            } else if (tid >= 9000 && tid < 9000+MAX_PULSARS) {
-                if (pulsars[tid-9000].active && pulsars[tid-9000].q1 == pq1 && pulsars[tid-9000].q2 == pq2 && pulsars[tid-9000].q3 == pq3) valid = true;
-            } else if (tid >= 10000 && tid < 10000+MAX_COMETS) {
-                if (comets[tid-10000].active) valid = true; /* Persistent across quadrants */
-            } else if (tid >= 11000 && tid < 11000+MAX_DERELICTS) {
-                if (derelicts[tid-11000].active && derelicts[tid-11000].q1 == pq1 && derelicts[tid-11000].q2 == pq2 && derelicts[tid-11000].q3 == pq3) valid = true;
-            } else if (tid >= 12000 && tid < 12000+MAX_ASTEROIDS) {
-                if (asteroids[tid-12000].active && asteroids[tid-12000].q1 == pq1 && asteroids[tid-12000].q2 == pq2 && asteroids[tid-12000].q3 == pq3) valid = true;
-            } else if (tid >= 14000 && tid < 14000+MAX_MINES) {
-                if (mines[tid-14000].active && mines[tid-14000].q1 == pq1 && mines[tid-14000].q2 == pq2 && mines[tid-14000].q3 == pq3) valid = true;
-            } else if (tid >= 15000 && tid < 15000+MAX_BUOYS) {
-                if (buoys[tid-15000].active && buoys[tid-15000].q1 == pq1 && buoys[tid-15000].q2 == pq2 && buoys[tid-15000].q3 == pq3) valid = true;
-            } else if (tid >= 16000 && tid < 16000+MAX_PLATFORMS) {
-                if (platforms[tid-16000].active) valid = true; /* Persistent */
-            } else if (tid >= 17000 && tid < 17000+MAX_RIFTS) {
-                if (rifts[tid-17000].active && rifts[tid-17000].q1 == pq1 && rifts[tid-17000].q2 == pq2 && rifts[tid-17000].q3 == pq3) valid = true;
-            } else if (tid >= 18000 && tid < 18000+MAX_MONSTERS) {
-                if (monsters[tid-18000].active) valid = true; /* Persistent */
-            }
+            /* Ships, comets, monsters and platforms stay locked anywhere; other bodies only
+               while in this quadrant. A reused id is a different body and drops the lock. */
+            EntityRef t;
+            bool valid = entity_resolve(tid, players[i].lock_gen, &t) &&
+                         ((t.flags & ENT_LOCK_HOLDS) || entity_in_quadrant(&t, pq1, pq2, pq3));
 
             if (!valid) {
                 players[i].state.lock_target = 0;
@@ -1166,10 +1240,10 @@ void update_game_logic() {
                         int pq2 = players[i].state.probes[p].q2;
                         int pq3 = players[i].state.probes[p].q3;
                         
-                        players[i].state.z[pq1][pq2][pq3] = 1;
+                        if (IS_CHART_Q(pq1, pq2, pq3)) players[i].state.z[pq1][pq2][pq3] = 1;
                         
                         /* Real-time Query via Live Spatial Index */
-                        QuadrantIndex *lq = &spatial_index[pq1][pq2][pq3];
+                        QuadrantIndex lq_view = spatial_quadrant(pq1, pq2, pq3), *lq = &lq_view;
                         char msg[128];
                         sprintf(msg, "Probe arrived at [%d,%d,%d]. Hostiles: %d, Bases: %d, Stars: %d", pq1, pq2, pq3, lq->npc_count, lq->base_count, lq->star_count);
                         send_server_msg(i, "SCIENCE", msg);
@@ -1190,14 +1264,10 @@ void update_game_logic() {
                 double target_x = -1, target_y = -1, target_z = -1;
                 int tid = players[i].torp_target;
                 int pq1 = players[i].state.q1, pq2 = players[i].state.q2, pq3 = players[i].state.q3;
-                if (tid <= 32 && players[tid-1].active && players[tid-1].state.q1 == pq1 && players[tid-1].state.q2 == pq2 && players[tid-1].state.q3 == pq3) {
-                    target_x = players[tid-1].state.s1; target_y = players[tid-1].state.s2; target_z = players[tid-1].state.s3;
-                } else if (tid >= 1000 && tid < 1000+MAX_NPC && npcs[tid-1000].active && npcs[tid-1000].q1 == pq1 && npcs[tid-1000].q2 == pq2 && npcs[tid-1000].q3 == pq3) {
-                    target_x = npcs[tid-1000].x; target_y = npcs[tid-1000].y; target_z = npcs[tid-1000].z;
-                } else if (tid >= 16000 && tid < 16000+MAX_PLATFORMS && platforms[tid-16000].active && platforms[tid-16000].q1 == pq1 && platforms[tid-16000].q2 == pq2 && platforms[tid-16000].q3 == pq3) {
-                    target_x = platforms[tid-16000].x; target_y = platforms[tid-16000].y; target_z = platforms[tid-16000].z;
-                } else if (tid >= 18000 && tid < 18000+MAX_MONSTERS && monsters[tid-18000].active && monsters[tid-18000].q1 == pq1 && monsters[tid-18000].q2 == pq2 && monsters[tid-18000].q3 == pq3) {
-                    target_x = monsters[tid-18000].x; target_y = monsters[tid-18000].y; target_z = monsters[tid-18000].z;
+                EntityRef t;
+                if (entity_resolve(tid, players[i].torp_gen, &t) && entity_in_quadrant(&t, pq1, pq2, pq3) &&
+                    (t.kind == SI_PLAYER || t.kind == SI_NPC || t.kind == SI_PLATFORM || t.kind == SI_MONSTER)) {
+                    target_x = t.x; target_y = t.y; target_z = t.z;
                 }
                 if (target_x != -1) {
                     double dx = target_x - players[i].tx, dy = target_y - players[i].ty, dz = target_z - players[i].tz;
@@ -1214,27 +1284,42 @@ void update_game_logic() {
             }
             /* Increased velocity: 0.25 units per tick */
             players[i].tx += players[i].tdx * 0.25; players[i].ty += players[i].tdy * 0.25; players[i].tz += players[i].tdz * 0.25;
-            players[i].state.torp = (NetPoint){(float)players[i].tx, (float)players[i].ty, (float)players[i].tz, 1};
-            
+
             /* Collision Detection (Radius increased to 0.8 to prevent tunneling) */
             bool hit = false;
-            QuadrantIndex *lq = &spatial_index[players[i].state.q1][players[i].state.q2][players[i].state.q3];
+            int tq1 = players[i].state.q1, tq2 = players[i].state.q2, tq3 = players[i].state.q3;
+
+            /* Candidates come from around the torpedo, neighbour quadrants included, and are
+               placed in the shooter's quadrant frame. Ships get extra reach for the rewind. */
+            const SpatialHit *near;
+            int near_count = spatial_query_all((tq1 - 1) * 10.0 + players[i].tx, (tq2 - 1) * 10.0 + players[i].ty, (tq3 - 1) * 10.0 + players[i].tz,
+                                               DIST_COLLISION_TORP + SPATIAL_REWIND_REACH,
+                                               SI_MASK(SI_PLAYER) | SI_MASK(SI_NPC) | SI_MASK(SI_PLANET) | SI_MASK(SI_STAR) |
+                                               SI_MASK(SI_BASE) | SI_MASK(SI_PLATFORM) | SI_MASK(SI_MONSTER), &near);
+
+            /* Ships are judged where the shooter saw them at launch. The allowance runs out as
+               the torpedo flies, since its flight is watched with the same delay as its targets. */
+            int rewind = lag_rewind_ticks(i) - (300 - players[i].torp_timeout);
+            int view_tick = lag_view_tick(rewind);
             
             /* 1. Players */
-            for (int j=0; j<lq->player_count; j++) {
-                ConnectedPlayer *p = lq->players[j]; if (p == &players[i] || !p->active) continue;
-                double d = sqrt(pow(players[i].tx - p->state.s1, 2) + pow(players[i].ty - p->state.s2, 2) + pow(players[i].tz - p->state.s3, 2));
+            for (int j=0; j<near_count; j++) {
+                if (near[j].kind != SI_PLAYER) continue;
+                ConnectedPlayer *p = &players[near[j].idx]; if (p == &players[i] || !p->active) continue;
+                double px = (p->state.q1 - tq1) * 10.0 + p->state.s1, py = (p->state.q2 - tq2) * 10.0 + p->state.s2, pz = (p->state.q3 - tq3) * 10.0 + p->state.s3;
+                if (rewind > 0) lag_position(entity_id(SI_PLAYER, (int)(p - players)), view_tick, tq1, tq2, tq3, &px, &py, &pz);
+                double d = sqrt(pow(players[i].tx - px, 2) + pow(players[i].ty - py, 2) + pow(players[i].tz - pz, 2));
                 if (d < DIST_COLLISION_TORP) {
                     int dmg = DMG_TORPEDO;
                     /* Calculate hit angle for torpedo */
-                    double rel_dx = players[i].tx - p->state.s1;
-                    double rel_dy = players[i].ty - p->state.s2;
+                    double rel_dx = players[i].tx - px;
+                    double rel_dy = players[i].ty - py;
                     double angle = atan2(rel_dx, -rel_dy) * 180.0 / M_PI; if (angle < 0) angle += 360;
                     double rel_angle = angle - p->state.ent_h;
                     while (rel_angle < 0) rel_angle += 360;
                     while (rel_angle >= 360) rel_angle -= 360;
                     
-                    double rel_dz = players[i].tz - p->state.s3;
+                    double rel_dz = players[i].tz - pz;
                     double dist_2d = sqrt(rel_dx*rel_dx + rel_dy*rel_dy);
                     double vertical_angle = atan2(rel_dz, dist_2d) * 180.0 / M_PI;
 
@@ -1267,10 +1352,7 @@ void update_game_logic() {
                             p->state.system_health[sys_idx] -= sys_dmg;
                             if (p->state.system_health[sys_idx] < 0) p->state.system_health[sys_idx] = 0;
                             
-                            const char* sys_names[] = {"WARP", "IMPULSE", "SENSORS", "TRANSPORTERS", "PHASERS", "TORPEDOES", "COMPUTER", "LIFE SUPPORT", "SHIELDS", "AUXILIARY"};
-                            char alert[128];
-                            sprintf(alert, "SYSTEM ALERT: Torpedo impact caused critical failure in %s!", sys_names[sys_idx]);
-                            send_server_msg((int)(p-players), "DAMAGE", alert);
+                            send_alert((int)(p-players), ALERT_TORPEDO_SYSTEM_HIT, sys_idx, 0);
                         }
                     }
 
@@ -1280,21 +1362,24 @@ void update_game_logic() {
                         send_server_msg(i, "CRITICAL", "FRIENDLY FIRE DETECTED! You have been marked as a TRAITOR by the fleet!");
                     }
 
-                    send_server_msg((int)(p-players), "WARNING", "HIT BY PHOTON TORPEDO!");
+                    send_alert((int)(p-players), ALERT_TORPEDO_HIT, 0, 0);
                     if(p->state.energy <= 0) { 
                         p->state.energy = 0; p->state.crew_count = 0;
                         p->nav_state = NAV_STATE_IDLE; p->warp_speed = 0;
-                        p->state.boom = (NetPoint){(float)players[i].tx, (float)players[i].ty, (float)players[i].tz, 1}; 
                     }
                     hit = true; break;
                 }
             }
             /* 2. NPCs */
-            if (!hit) for (int n=0; n<lq->npc_count; n++) {
-                NPCShip *npc = lq->npcs[n];
-                double d = sqrt(pow(players[i].tx - npc->x, 2) + pow(players[i].ty - npc->y, 2) + pow(players[i].tz - npc->z, 2));
-                if (d < 0.8) { 
-                    npc->energy -= 75000; 
+            if (!hit) for (int n=0; n<near_count; n++) {
+                if (near[n].kind != SI_NPC) continue;
+                int ni = near[n].idx;
+                NPCShip *npc = &npcs[ni];
+                double nx = (npc_hot.q1[ni] - tq1) * 10.0 + npc_hot.x[ni], ny = (npc_hot.q2[ni] - tq2) * 10.0 + npc_hot.y[ni], nz = (npc_hot.q3[ni] - tq3) * 10.0 + npc_hot.z[ni];
+                if (rewind > 0) lag_position(entity_id(SI_NPC, ni), view_tick, tq1, tq2, tq3, &nx, &ny, &nz);
+                double ex = players[i].tx - nx, ey = players[i].ty - ny, ez = players[i].tz - nz;
+                if (ex*ex + ey*ey + ez*ez < 0.8 * 0.8) { 
+                    npc_hot.energy[ni] -= 75000; 
                     
                     /* Renegade Status: If you hit a friendly NPC */
                     if (npc->faction == players[i].faction) {
@@ -1302,179 +1387,164 @@ void update_game_logic() {
                         send_server_msg(i, "CRITICAL", "ATTACKING FRIENDLY VESSEL! Sector command has revoked your status!");
                     }
 
-                    if(npc->energy <= 0) { npc->active = 0; players[i].state.boom = (NetPoint){(float)players[i].tx, (float)players[i].ty, (float)players[i].tz, 1}; } hit = true; break; 
+                    if(npc_hot.energy[ni] <= 0) { entity_despawn(SI_NPC, ni); } hit = true; break; 
                 }
             }
-            /* 3. Planets/Stars/Bases (Solid obstacles) */
-            if (!hit) for (int p=0; p<lq->planet_count; p++) {
-                double d = sqrt(pow(players[i].tx - lq->planets[p]->x, 2) + pow(players[i].ty - lq->planets[p]->y, 2) + pow(players[i].tz - lq->planets[p]->z, 2));
-                if (d < 1.2) { hit = true; break; } /* Planet hit (absorbed) */
+            /* 3. Planets/Stars/Bases (Solid obstacles): they do not move, the query distance is exact */
+            if (!hit) for (int p=0; p<near_count; p++) {
+                if (near[p].kind == SI_PLANET && near[p].d2 < 1.2 * 1.2) { hit = true; break; } /* Planet hit (absorbed) */
             }
-            if (!hit) for (int s=0; s<lq->star_count; s++) {
-                double d = sqrt(pow(players[i].tx - lq->stars[s]->x, 2) + pow(players[i].ty - lq->stars[s]->y, 2) + pow(players[i].tz - lq->stars[s]->z, 2));
-                if (d < 1.5) { hit = true; break; } /* Star hit (vaporized) */
+            if (!hit) for (int s=0; s<near_count; s++) {
+                if (near[s].kind == SI_STAR && near[s].d2 < 1.5 * 1.5) { hit = true; break; } /* Star hit (vaporized) */
             }
-            if (!hit) for (int b=0; b<lq->base_count; b++) {
-                double d = sqrt(pow(players[i].tx - lq->bases[b]->x, 2) + pow(players[i].ty - lq->bases[b]->y, 2) + pow(players[i].tz - lq->bases[b]->z, 2));
-                if (d < 1.0) { hit = true; break; } /* Base hit (absorbed by planetary shields) */
+            if (!hit) for (int b=0; b<near_count; b++) {
+                if (near[b].kind == SI_BASE && near[b].d2 < 1.0 * 1.0) { hit = true; break; } /* Base hit (absorbed by planetary shields) */
             }
             /* 4. Platforms/Monsters */
-            if (!hit) for (int pt=0; pt<lq->platform_count; pt++) {
-                NPCPlatform *plat = lq->platforms[pt];
-                double d = sqrt(pow(players[i].tx - plat->x, 2) + pow(players[i].ty - plat->y, 2) + pow(players[i].tz - plat->z, 2));
-                if (d < DIST_COLLISION_TORP) { plat->energy -= DMG_TORPEDO_PLATFORM; if(plat->energy <= 0) { plat->active = 0; players[i].state.boom = (NetPoint){(float)players[i].tx, (float)players[i].ty, (float)players[i].tz, 1}; } hit = true; break; }
+            if (!hit) for (int pt=0; pt<near_count; pt++) {
+                if (near[pt].kind != SI_PLATFORM || near[pt].d2 >= DIST_COLLISION_TORP * DIST_COLLISION_TORP) continue;
+                NPCPlatform *plat = &platforms[near[pt].idx];
+                plat->energy -= DMG_TORPEDO_PLATFORM; if(plat->energy <= 0) { entity_despawn(SI_PLATFORM, near[pt].idx); } hit = true; break;
             }
-            if (!hit) for (int mo=0; mo<lq->monster_count; mo++) {
-                NPCMonster *mon = lq->monsters[mo];
-                double d = sqrt(pow(players[i].tx - mon->x, 2) + pow(players[i].ty - mon->y, 2) + pow(players[i].tz - mon->z, 2));
-                if (d < 1.0) { mon->energy -= DMG_TORPEDO_MONSTER; if(mon->energy <= 0) { mon->active = 0; players[i].state.boom = (NetPoint){(float)players[i].tx, (float)players[i].ty, (float)players[i].tz, 1}; } hit = true; break; }
+            if (!hit) for (int mo=0; mo<near_count; mo++) {
+                if (near[mo].kind != SI_MONSTER || near[mo].d2 >= 1.0 * 1.0) continue;
+                NPCMonster *mon = &monsters[near[mo].idx];
+                mon->energy -= DMG_TORPEDO_MONSTER; if(mon->energy <= 0) { entity_despawn(SI_MONSTER, near[mo].idx); } hit = true; break;
             }
             if (players[i].torp_timeout > 0) players[i].torp_timeout--;
 
             if (hit || players[i].tx<0||players[i].tx>10||players[i].ty<0||players[i].ty>10||players[i].tz<0||players[i].tz>10 || players[i].torp_timeout <= 0) {
-                if (hit) { players[i].state.boom = (NetPoint){(float)players[i].tx, (float)players[i].ty, (float)players[i].tz, 1}; send_server_msg(i, "TACTICAL", "Torpedo impact confirmed."); }
+                if (hit) { fx_point(players[i].state.q1, players[i].state.q2, players[i].state.q3, FX_BOOM, entity_id(SI_PLAYER, i), players[i].tx, players[i].ty, players[i].tz, 0); send_server_msg(i, "TACTICAL", "Torpedo impact confirmed."); }
                 else if (players[i].torp_timeout <= 0) { send_server_msg(i, "TACTICAL", "Torpedo lost - Self-destruct activated."); }
-                players[i].torp_active = false; players[i].state.torp.active = 0;
+                players[i].torp_active = false;
+            } else {
+                fx_point(players[i].state.q1, players[i].state.q2, players[i].state.q3, FX_TORPEDO, entity_id(SI_PLAYER, i), players[i].tx, players[i].ty, players[i].tz, 0);
             }
         }
     }
 
-    rebuild_spatial_index();
-    if (global_tick % 1800 == 0) save_galaxy();
+    update_spatial_index();
+    lag_record();
+    track_galaxy_changes();
+    if (global_tick % 1800 == 0) { save_galaxy(); log_memory_stats(); log_command_stats(); log_fx_stats(); log_update_stats(); log_outbox_stats(); log_spatial_stats(); log_entity_stats(); log_contact_stats(); }
 
     /* Phase 3: Network Updates - Atomic Broadcast */
-    for (int i = 0; i < MAX_CLIENTS; i++) {
+    /* One tick-arena frame reused for every captain, cleared whole each time so nothing the
+       previous captain was sent (or the arena held) can reach the wire in an object a helper
+       filled field by field. Room is kept for the quadrant FX after the objects. */
+    PacketUpdate *upd = arena_alloc(sizeof(PacketUpdate) + MAX_FX_EVENTS * sizeof(NetFxEvent));
+    for (int i = 0; i < MAX_CLIENTS && upd; i++) {
         if (players[i].socket == 0 || !players[i].active) continue;
-        PacketUpdate upd; memset(&upd, 0, sizeof(PacketUpdate)); upd.type = PKT_UPDATE;
-        upd.q1 = players[i].state.q1; upd.q2 = players[i].state.q2; upd.q3 = players[i].state.q3;
-        upd.s1 = players[i].state.s1; upd.s2 = players[i].state.s2; upd.s3 = players[i].state.s3;
-        upd.ent_h = players[i].state.ent_h; upd.ent_m = players[i].state.ent_m;
-        upd.energy = players[i].state.energy; upd.torpedoes = players[i].state.torpedoes;
-        upd.cargo_energy = players[i].state.cargo_energy; upd.cargo_torpedoes = players[i].state.cargo_torpedoes;
-        upd.crew_count = players[i].state.crew_count;
-        upd.prison_unit = players[i].state.prison_unit;
-        upd.duranium_plating = players[i].state.duranium_plating;
-        upd.hull_integrity = players[i].state.hull_integrity;
-        for(int s=0; s<6; s++) upd.shields[s] = players[i].state.shields[s];
-        for(int inv=0; inv<10; inv++) upd.inventory[inv] = players[i].state.inventory[inv];
-        for(int sys=0; sys<10; sys++) upd.system_health[sys] = players[i].state.system_health[sys];
-        for(int p=0; p<3; p++) upd.power_dist[p] = players[i].state.power_dist[p];
-        upd.life_support = players[i].state.life_support;
-        upd.corbomite_count = players[i].state.corbomite_count;
-        upd.lock_target = players[i].state.lock_target;
-        upd.tube_state = players[i].state.tube_state;
-        upd.phaser_charge = players[i].state.phaser_charge;
-        upd.is_cloaked = players[i].state.is_cloaked;
-        upd.encryption_enabled = players[i].crypto_algo;
+        memset(upd, 0, sizeof(PacketUpdate)); upd->type = PKT_UPDATE;
+        upd->frame_id = galaxy_master.frame_id;
+        upd->q1 = players[i].state.q1; upd->q2 = players[i].state.q2; upd->q3 = players[i].state.q3;
+        upd->s1 = players[i].state.s1; upd->s2 = players[i].state.s2; upd->s3 = players[i].state.s3;
+        upd->ent_h = players[i].state.ent_h; upd->ent_m = players[i].state.ent_m;
+        upd->energy = players[i].state.energy; upd->torpedoes = players[i].state.torpedoes;
+        upd->cargo_energy = players[i].state.cargo_energy; upd->cargo_torpedoes = players[i].state.cargo_torpedoes;
+        upd->crew_count = players[i].state.crew_count;
+        upd->prison_unit = players[i].state.prison_unit;
+        upd->duranium_plating = players[i].state.duranium_plating;
+        upd->hull_integrity = players[i].state.hull_integrity;
+        for(int s=0; s<6; s++) upd->shields[s] = players[i].state.shields[s];
+        for(int inv=0; inv<10; inv++) upd->inventory[inv] = players[i].state.inventory[inv];
+        for(int sys=0; sys<10; sys++) upd->system_health[sys] = players[i].state.system_health[sys];
+        for(int p=0; p<3; p++) upd->power_dist[p] = players[i].state.power_dist[p];
+        upd->life_support = players[i].state.life_support;
+        upd->corbomite_count = players[i].state.corbomite_count;
+        upd->lock_target = players[i].state.lock_target;
+        upd->tube_state = players[i].state.tube_state;
+        upd->phaser_charge = players[i].state.phaser_charge;
+        upd->is_cloaked = players[i].state.is_cloaked;
+        upd->encryption_enabled = players[i].crypto_algo;
         int o_idx = 0;
-        upd.objects[o_idx] = (NetObject){(float)players[i].state.s1,(float)players[i].state.s2,(float)players[i].state.s3,(float)players[i].state.ent_h,(float)players[i].state.ent_m,1,players[i].ship_class,1,(int)players[i].state.hull_integrity,players[i].state.energy,players[i].state.duranium_plating,(int)players[i].state.hull_integrity,players[i].faction,i+1,players[i].state.is_cloaked,""};
-        strncpy(upd.objects[o_idx++].name, players[i].name, 63);
+        upd->objects[o_idx] = (NetObject){(float)players[i].state.s1,(float)players[i].state.s2,(float)players[i].state.s3,(float)players[i].state.ent_h,(float)players[i].state.ent_m,1,players[i].ship_class,1,(int)players[i].state.hull_integrity,players[i].state.energy,players[i].state.duranium_plating,(int)players[i].state.hull_integrity,players[i].faction,entity_id(SI_PLAYER, i),players[i].state.is_cloaked,""};
+        strncpy(upd->objects[o_idx++].name, players[i].name, 63);
         
         /* 1. Prioritize Current Quadrant Objects (Critical for SRS/HUD) */
-        if (IS_Q_VALID(upd.q1, upd.q2, upd.q3)) {
-            QuadrantIndex *lq = &spatial_index[upd.q1][upd.q2][upd.q3];
-            /* Players in current quadrant */
-            for(int j=0; j<lq->player_count; j++) {
-                ConnectedPlayer *p = lq->players[j]; 
-                if (p == &players[i] || !p->active || o_idx >= MAX_NET_OBJECTS) continue;
-                if (p->state.is_cloaked && p->faction != players[i].faction) continue;
-                NetObject *no = &upd.objects[o_idx];
-                *no = (NetObject){(float)p->state.s1, (float)p->state.s2, (float)p->state.s3, (float)p->state.ent_h, (float)p->state.ent_m, 1, p->ship_class, 1, (int)p->state.hull_integrity, p->state.energy, p->state.duranium_plating, (int)p->state.hull_integrity, p->faction, (int)(p-players)+1, p->state.is_cloaked, ""};
-                size_t nlen = strlen(p->name);
-                if (nlen > 63) nlen = 63;
-                memcpy(no->name, p->name, nlen);
-                no->name[nlen] = '\0';
-                o_idx++;
-            }
-            /* NPCs in current quadrant */
-            for(int n=0; n<lq->npc_count && o_idx < MAX_NET_OBJECTS; n++) {
-                NPCShip *npc = lq->npcs[n]; if (!npc->active) continue;
-                NetObject *no = &upd.objects[o_idx];
-                *no = (NetObject){(float)npc->x, (float)npc->y, (float)npc->z, (float)npc->h, (float)npc->m, npc->faction, 0, 1, (int)npc->engine_health, npc->energy, 0, (int)npc->engine_health, npc->faction, npc->id+1000, npc->is_cloaked, ""};
-                strncpy(no->name, get_species_name(npc->faction), 63); o_idx++;
-            }
-            /* Static objects in current quadrant */
-                for(int p=0; p<lq->planet_count && o_idx < MAX_NET_OBJECTS; p++) if(lq->planets[p]->active) upd.objects[o_idx++] = (NetObject){(float)lq->planets[p]->x, (float)lq->planets[p]->y, (float)lq->planets[p]->z, 0, 0, 5, lq->planets[p]->resource_type, 1, 100, 0, 0, 100, 0, lq->planets[p]->id+3000, 0, "Planet"};
-                for(int s=0; s<lq->star_count && o_idx < MAX_NET_OBJECTS; s++) if(lq->stars[s]->active) upd.objects[o_idx++] = (NetObject){(float)lq->stars[s]->x, (float)lq->stars[s]->y, (float)lq->stars[s]->z, 0, 0, 4, lq->stars[s]->id % 7, 1, 100, 0, 0, 100, 0, lq->stars[s]->id+4000, 0, "Star"};
-                for(int h=0; h<lq->bh_count && o_idx < MAX_NET_OBJECTS; h++) if(lq->black_holes[h]->active) upd.objects[o_idx++] = (NetObject){(float)lq->black_holes[h]->x, (float)lq->black_holes[h]->y, (float)lq->black_holes[h]->z, 0, 0, 6, 0, 1, 100, 0, 0, 100, 0, lq->black_holes[h]->id+7000, 0, "Black Hole"};
-                for(int b=0; b<lq->base_count && o_idx < MAX_NET_OBJECTS; b++) if(lq->bases[b]->active) upd.objects[o_idx++] = (NetObject){(float)lq->bases[b]->x, (float)lq->bases[b]->y, (float)lq->bases[b]->z, 0, 0, 3, 0, 1, 100, 0, 0, 100, 0, lq->bases[b]->id+2000, 0, "Starbase"};
-                for(int n=0; n<lq->nebula_count && o_idx < MAX_NET_OBJECTS; n++) upd.objects[o_idx++] = (NetObject){(float)lq->nebulas[n]->x, (float)lq->nebulas[n]->y, (float)lq->nebulas[n]->z, 0, 0, 7, lq->nebulas[n]->id % 5, 1, 100, 0, 0, 100, 0, lq->nebulas[n]->id+8000, 0, "Nebula"};
-                for(int p=0; p<lq->pulsar_count && o_idx < MAX_NET_OBJECTS; p++) upd.objects[o_idx++] = (NetObject){(float)lq->pulsars[p]->x, (float)lq->pulsars[p]->y, (float)lq->pulsars[p]->z, 0, 0, 8, 0, 1, 100, 0, 0, 100, 0, lq->pulsars[p]->id+9000, 0, "Pulsar"};
-                for(int c=0; c<lq->comet_count && o_idx < MAX_NET_OBJECTS; c++) upd.objects[o_idx++] = (NetObject){(float)lq->comets[c]->x, (float)lq->comets[c]->y, (float)lq->comets[c]->z, (float)lq->comets[c]->h, (float)lq->comets[c]->m, 9, 0, 1, 100, 0, 0, 100, 0, lq->comets[c]->id+10000, 0, "Comet"};
-                for(int a=0; a<lq->asteroid_count && o_idx < MAX_NET_OBJECTS; a++) upd.objects[o_idx++] = (NetObject){(float)lq->asteroids[a]->x, (float)lq->asteroids[a]->y, (float)lq->asteroids[a]->z, 0, 0, 21, lq->asteroids[a]->resource_type, 1, 100, lq->asteroids[a]->amount, 0, 100, 0, lq->asteroids[a]->id+12000, 0, "Asteroid"};
-                for(int d=0; d<lq->derelict_count && o_idx < MAX_NET_OBJECTS; d++) upd.objects[o_idx++] = (NetObject){(float)lq->derelicts[d]->x, (float)lq->derelicts[d]->y, (float)lq->derelicts[d]->z, 0, 0, 22, lq->derelict_count, 1, 30, 0, 0, 100, 0, lq->derelicts[d]->id+11000, 0, "Derelict"};
-                for(int pt=0; pt<lq->platform_count && o_idx < MAX_NET_OBJECTS; pt++) upd.objects[o_idx++] = (NetObject){(float)lq->platforms[pt]->x, (float)lq->platforms[pt]->y, (float)lq->platforms[pt]->z, 0, 0, 25, 0, 1, (int)((lq->platforms[pt]->energy/10000.0)*100), (int)lq->platforms[pt]->energy, 0, 100, lq->platforms[pt]->faction, lq->platforms[pt]->id+16000, 0, "Defense Platform"};
-                for(int mo=0; mo<lq->monster_count && o_idx < MAX_NET_OBJECTS; mo++) { NetObject *no = &upd.objects[o_idx++]; *no = (NetObject){(float)lq->monsters[mo]->x, (float)lq->monsters[mo]->y, (float)lq->monsters[mo]->z, 0, 0, lq->monsters[mo]->type, 0, 1, 100, (int)lq->monsters[mo]->energy, 0, 100, 0, lq->monsters[mo]->id+18000, 0, ""}; strncpy(no->name, (lq->monsters[mo]->type==30)?"Crystalline Entity":"Space Amoeba", 63); }
-            /* Global Probes: Check ALL probes from ALL players */
-            for (int p_j = 0; p_j < MAX_CLIENTS; p_j++) {
-                if (!players[p_j].socket) continue;
-                for (int pr = 0; pr < 3; pr++) {
-                    if (players[p_j].state.probes[pr].active && o_idx < MAX_NET_OBJECTS) {
-                        /* Check if this probe is in player i's current quadrant */
-                        int pr_q1 = get_q_from_g(players[p_j].state.probes[pr].gx);
-                        int pr_q2 = get_q_from_g(players[p_j].state.probes[pr].gy);
-                        int pr_q3 = get_q_from_g(players[p_j].state.probes[pr].gz);
-                        
-                        if (pr_q1 == upd.q1 && pr_q2 == upd.q2 && pr_q3 == upd.q3) {
-                            NetObject *no = &upd.objects[o_idx++];
-                            no->net_x = players[p_j].state.probes[pr].s1;
-                            no->net_y = players[p_j].state.probes[pr].s2;
-                            no->net_z = players[p_j].state.probes[pr].s3;
-                            no->type = 27; /* TYPE_PROBE */
-                            no->id = 19000 + (p_j * 3) + pr; /* Unique ID range for probes */
-                            no->ship_class = players[p_j].state.probes[pr].status; /* Pass status here */
-                            no->is_cloaked = 0;
-                            snprintf(no->name, 64, "P:%.58s", players[p_j].name);
-                            no->active = 1;
-                        }
-                    }
-                }
-            }
-        }
+        o_idx = append_quadrant_objects(upd->objects, o_idx, upd->q1, upd->q2, upd->q3, &players[i]);
+        /* 2. Ships close enough across a border */
+        o_idx = append_border_contacts(upd->objects, o_idx, &players[i]);
 
-        upd.object_count = o_idx;
-        upd.beam_count = players[i].state.beam_count; for(int b=0; b<upd.beam_count && b<MAX_NET_BEAMS; b++) upd.beams[b] = players[i].state.beams[b];
+        upd->object_count = o_idx;
+        const NetFxEvent *fx = fx_quadrant(upd->q1, upd->q2, upd->q3, &upd->fx_count);
         
         /* Map Synchronizer: Always send supernova quadrant if active, otherwise send current */
         if (supernova_event.supernova_timer > 0) {
-            upd.map_update_q[0] = supernova_event.supernova_q1;
-            upd.map_update_q[1] = supernova_event.supernova_q2;
-            upd.map_update_q[2] = supernova_event.supernova_q3;
-            upd.map_update_val = -supernova_event.supernova_timer;
+            upd->map_update_q[0] = supernova_event.supernova_q1;
+            upd->map_update_q[1] = supernova_event.supernova_q2;
+            upd->map_update_q[2] = supernova_event.supernova_q3;
+            upd->map_update_val = -supernova_event.supernova_timer;
         } else {
-            upd.map_update_q[0] = upd.q1;
-            upd.map_update_q[1] = upd.q2;
-            upd.map_update_q[2] = upd.q3;
-            upd.map_update_val = galaxy_master.g[upd.q1][upd.q2][upd.q3];
+            upd->map_update_q[0] = upd->q1;
+            upd->map_update_q[1] = upd->q2;
+            upd->map_update_q[2] = upd->q3;
+            upd->map_update_val = GALAXY_MAP(upd->q1, upd->q2, upd->q3);
         }
 
-        upd.torp = players[i].state.torp; upd.boom = players[i].state.boom; upd.dismantle = players[i].state.dismantle; 
-        upd.wormhole = players[i].state.wormhole;
-        upd.jump_arrival = players[i].state.jump_arrival;
-        upd.recovery_fx = players[i].state.recovery_fx;
-        for(int p=0; p<3; p++) upd.probes[p] = players[i].state.probes[p];
+        upd->wormhole = players[i].state.wormhole;
+        upd->jump_arrival = players[i].state.jump_arrival;
+        upd->recovery_fx = players[i].state.recovery_fx;
+        for(int p=0; p<3; p++) upd->probes[p] = players[i].state.probes[p];
         
         if (supernova_event.supernova_timer > 0) {
-            upd.supernova_pos = (NetPoint){(float)supernova_event.x, (float)supernova_event.y, (float)supernova_event.z, supernova_event.supernova_timer};
-            upd.supernova_q[0] = supernova_event.supernova_q1;
-            upd.supernova_q[1] = supernova_event.supernova_q2;
-            upd.supernova_q[2] = supernova_event.supernova_q3;
+            upd->supernova_pos = (NetPoint){(float)supernova_event.x, (float)supernova_event.y, (float)supernova_event.z, supernova_event.supernova_timer};
+            upd->supernova_q[0] = supernova_event.supernova_q1;
+            upd->supernova_q[1] = supernova_event.supernova_q2;
+            upd->supernova_q[2] = supernova_event.supernova_q3;
         } else {
-            upd.supernova_pos.active = 0;
+            upd->supernova_pos.active = 0;
         }
 
-        players[i].state.beam_count = 0; players[i].state.boom.active = 0; players[i].state.dismantle.active = 0;
         if (players[i].state.recovery_fx.active > 0) players[i].state.recovery_fx.active--;
         int current_sock = players[i].socket;
         if (current_sock != 0) { 
-            size_t p_size = sizeof(PacketUpdate) - sizeof(NetObject) * (MAX_NET_OBJECTS - upd.object_count); 
+            size_t p_size = sizeof(PacketUpdate) - sizeof(NetObject) * (MAX_NET_OBJECTS - upd->object_count); 
             if (p_size < offsetof(PacketUpdate, objects)) p_size = offsetof(PacketUpdate, objects); 
+            if (upd->fx_count > 0) { memcpy((char*)upd + p_size, fx, upd->fx_count * sizeof(NetFxEvent)); p_size += upd->fx_count * sizeof(NetFxEvent); }
             
-            pthread_mutex_lock(&players[i].socket_mutex);
-            write_all(current_sock, &upd, p_size); 
-            pthread_mutex_unlock(&players[i].socket_mutex);
+            send_update(i, upd, p_size);
+            spectator_fanout_captain(i, upd, p_size);
+            flush_alerts(i);
         }
     }
+
+    /* Phase 4: Spectator Quadrant Views - encoded once per quadrant, shared by all its viewers */
+    for (int s = 0; s < MAX_SPECTATORS; s++) {
+        Spectator *sp = &spectators[s];
+        if (!upd || sp->socket == 0 || !sp->ready || sp->mode != SPECTATE_QUADRANT || sp->sent_frame == galaxy_master.frame_id) continue;
+
+        PacketUpdate *view = upd; /* Captains are done with the tick frame */
+        memset(view, 0, sizeof(PacketUpdate));
+        view->type = PKT_UPDATE;
+        view->frame_id = galaxy_master.frame_id;
+        view->q1 = sp->q1; view->q2 = sp->q2; view->q3 = sp->q3;
+        view->s1 = 5.0f; view->s2 = 5.0f; view->s3 = 5.0f;
+        view->hull_integrity = 100.0f;
+        /* Slot 0 is the viewer's own ship for the renderer: use a neutral observer marker */
+        view->objects[0] = (NetObject){5.0f, 5.0f, 5.0f, 0, 0, 27, 0, 1, 100, 0, 0, 100, 0, 0, 0, "SPECTATOR"};
+        view->object_count = append_quadrant_objects(view->objects, 1, sp->q1, sp->q2, sp->q3, NULL);
+        view->map_update_q[0] = sp->q1; view->map_update_q[1] = sp->q2; view->map_update_q[2] = sp->q3;
+        view->map_update_val = GALAXY_MAP(sp->q1, sp->q2, sp->q3);
+        if (supernova_event.supernova_timer > 0) {
+            view->supernova_pos = (NetPoint){(float)supernova_event.x, (float)supernova_event.y, (float)supernova_event.z, supernova_event.supernova_timer};
+            view->supernova_q[0] = supernova_event.supernova_q1;
+            view->supernova_q[1] = supernova_event.supernova_q2;
+            view->supernova_q[2] = supernova_event.supernova_q3;
+        }
+        size_t v_size = offsetof(PacketUpdate, objects) + sizeof(NetObject) * view->object_count;
+        const NetFxEvent *fx = fx_quadrant(sp->q1, sp->q2, sp->q3, &view->fx_count);
+        if (view->fx_count > 0) { memcpy((char*)view + v_size, fx, view->fx_count * sizeof(NetFxEvent)); v_size += view->fx_count * sizeof(NetFxEvent); }
+
+        for (int t = s; t < MAX_SPECTATORS; t++) {
+            Spectator *st = &spectators[t];
+            if (st->socket != 0 && st->ready && st->mode == SPECTATE_QUADRANT &&
+                st->q1 == sp->q1 && st->q2 == sp->q2 && st->q3 == sp->q3) spectator_send(st, view, v_size);
+        }
+    }
+
+    /* Read-only commands see this tick from now on */
+    snapshot_publish();
     pthread_mutex_unlock(&game_mutex);
 }
         
\ No newline at end of file
@@ -0,0 +1,182 @@
+/*
+ * STARTREK ULTRA - 3D LOGIC ENGINE
+ * Authors: Nicola Taibi, Supported by Google Gemini
+ * Copyright (C) 2026 Nicola Taibi
+ * License: GNU General Public License v3.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdalign.h>
+#include "server_internal.h"
+
+/* --- Per-Thread Bump Arena --- */
+
+/* Requests that do not fit in the arena are malloc'd and chained here, so they are
+   released by the same mark/reset that covers the arena memory around them. */
+struct ArenaSpill {
+    ArenaSpill *next;
+    alignas(max_align_t) uint8_t data[];
+};
+
+typedef struct {
+    uint8_t *base;
+    size_t used;
+    size_t high_water;
+    ArenaSpill *spill;
+    uint64_t allocs, fallbacks;
+} FrameArena;
+
+static FrameArena arenas[MAX_ARENAS];
+static int arena_count = 0;
+static pthread_mutex_t arena_reg_mutex = PTHREAD_MUTEX_INITIALIZER;
+static _Thread_local FrameArena *tls_arena = NULL;
+static _Thread_local FrameArena spill_only; /* No base: every request spills to the heap */
+
+static FrameArena *thread_arena(void) {
+    if (tls_arena) return tls_arena;
+    pthread_mutex_lock(&arena_reg_mutex);
+    if (arena_count < MAX_ARENAS) {
+        FrameArena *a = &arenas[arena_count];
+        a->base = malloc(ARENA_BYTES);
+        if (a->base) { tls_arena = a; arena_count++; }
+    }
+    pthread_mutex_unlock(&arena_reg_mutex);
+    if (!tls_arena) tls_arena = &spill_only;
+    return tls_arena;
+}
+
+static void *spill_alloc(FrameArena *a, size_t size) {
+    ArenaSpill *s = malloc(sizeof(ArenaSpill) + size);
+    if (!s) return NULL;
+    s->next = a->spill;
+    a->spill = s;
+    a->fallbacks++;
+    return s->data;
+}
+
+void *arena_alloc(size_t size) {
+    FrameArena *a = thread_arena();
+    a->allocs++;
+    size_t off = (a->used + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+    if (!a->base || off + size > ARENA_BYTES) return spill_alloc(a, size);
+    a->used = off + size;
+    if (a->used > a->high_water) a->high_water = a->used;
+    return a->base + off;
+}
+
+ArenaMark arena_mark(void) {
+    FrameArena *a = thread_arena();
+    return (ArenaMark){a->used, a->spill};
+}
+
+void arena_release(ArenaMark mark) {
+    FrameArena *a = tls_arena;
+    if (!a) return;
+    while (a->spill && a->spill != mark.spill) {
+        ArenaSpill *next = a->spill->next;
+        free(a->spill);
+        a->spill = next;
+    }
+    a->used = mark.used;
+}
+
+void arena_reset(void) {
+    arena_release((ArenaMark){0, NULL});
+}
+
+/* --- Fixed-Size Slab Pools --- */
+
+/* Blocks are carved from one preallocated region per size class and recycled through a
+   free list. Each block is prefixed with its class so slab_free needs no size. */
+typedef struct SlabBlock {
+    struct SlabBlock *next;
+    int cls;                 /* Index in slabs[], -1 for a malloc fallback */
+    alignas(max_align_t) uint8_t data[];
+} SlabBlock;
+
+typedef struct {
+    const char *name;
+    size_t size;
+    int count;
+    pthread_mutex_t lock;
+    SlabBlock *free_list;
+    int in_use, high_water;
+    uint64_t fallbacks;
+} SlabPool;
+
+static SlabPool slabs[] = {
+    {"small",  SLAB_SMALL_SIZE,  SLAB_SMALL_COUNT,  PTHREAD_MUTEX_INITIALIZER, NULL, 0, 0, 0},
+    {"medium", SLAB_MEDIUM_SIZE, SLAB_MEDIUM_COUNT, PTHREAD_MUTEX_INITIALIZER, NULL, 0, 0, 0},
+    {"frame",  SLAB_FRAME_SIZE,  SLAB_FRAME_COUNT,  PTHREAD_MUTEX_INITIALIZER, NULL, 0, 0, 0},
+    {"large",  SLAB_LARGE_SIZE,  SLAB_LARGE_COUNT,  PTHREAD_MUTEX_INITIALIZER, NULL, 0, 0, 0},
+};
+#define SLAB_CLASSES ((int)(sizeof(slabs) / sizeof(slabs[0])))
+static uint64_t slab_oversize = 0;
+
+void mempool_init(void) {
+    for (int c = 0; c < SLAB_CLASSES; c++) {
+        size_t stride = (sizeof(SlabBlock) + slabs[c].size + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+        uint8_t *region = malloc(stride * slabs[c].count);
+        if (!region) { perror("slab pool"); exit(1); }
+        for (int b = slabs[c].count - 1; b >= 0; b--) {
+            SlabBlock *blk = (SlabBlock *)(region + stride * b);
+            blk->cls = c;
+            blk->next = slabs[c].free_list;
+            slabs[c].free_list = blk;
+        }
+    }
+}
+
+void *slab_alloc(size_t size) {
+    int c = 0;
+    while (c < SLAB_CLASSES && slabs[c].size < size) c++;
+    if (c < SLAB_CLASSES) {
+        SlabPool *sp = &slabs[c];
+        pthread_mutex_lock(&sp->lock);
+        SlabBlock *blk = sp->free_list;
+        if (blk) {
+            sp->free_list = blk->next;
+            if (++sp->in_use > sp->high_water) sp->high_water = sp->in_use;
+        } else sp->fallbacks++;
+        pthread_mutex_unlock(&sp->lock);
+        if (blk) return blk->data;
+    } else __atomic_fetch_add(&slab_oversize, 1, __ATOMIC_RELAXED);
+
+    /* Class exhausted or oversized: plain heap block, still freed through slab_free */
+    SlabBlock *blk = malloc(sizeof(SlabBlock) + size);
+    if (!blk) return NULL;
+    blk->cls = -1;
+    return blk->data;
+}
+
+void slab_free(void *ptr) {
+    if (!ptr) return;
+    SlabBlock *blk = (SlabBlock *)((uint8_t *)ptr - offsetof(SlabBlock, data));
+    if (blk->cls < 0) { free(blk); return; }
+    SlabPool *sp = &slabs[blk->cls];
+    pthread_mutex_lock(&sp->lock);
+    blk->next = sp->free_list;
+    sp->free_list = blk;
+    sp->in_use--;
+    pthread_mutex_unlock(&sp->lock);
+}
+
+/* --- Counters --- */
+
+void log_memory_stats(void) {
+    if (!g_debug) return;
+    pthread_mutex_lock(&arena_reg_mutex);
+    for (int a = 0; a < arena_count; a++)
+        LOG_DEBUG("Arena %d: high water %zu/%d bytes, %llu allocs, %llu spilled to heap\n", a, arenas[a].high_water,
+                  ARENA_BYTES, (unsigned long long)arenas[a].allocs, (unsigned long long)arenas[a].fallbacks);
+    pthread_mutex_unlock(&arena_reg_mutex);
+    for (int c = 0; c < SLAB_CLASSES; c++) {
+        pthread_mutex_lock(&slabs[c].lock);
+        LOG_DEBUG("Slab %-6s (%zu B): %d in use, high water %d/%d, %llu heap fallbacks\n", slabs[c].name, slabs[c].size,
+                  slabs[c].in_use, slabs[c].high_water, slabs[c].count, (unsigned long long)slabs[c].fallbacks);
+        pthread_mutex_unlock(&slabs[c].lock);
+    }
+    LOG_DEBUG("Slab oversize requests: %llu\n", (unsigned long long)__atomic_load_n(&slab_oversize, __ATOMIC_RELAXED));
+}
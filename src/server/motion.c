@@ -0,0 +1,37 @@
+/*
+ * STARTREK ULTRA - 3D LOGIC ENGINE
+ * Authors: Nicola Taibi, Supported by Google Gemini
+ * Copyright (C) 2026 Nicola Taibi
+ * License: GNU General Public License v3.0
+ */
+
+#include "server_internal.h"
+
+/* --- NPC Motion --- */
+
+/* NPCs are moved in fixed-size blocks: at -O2 gcc only vectorizes loops whose trip count is
+   a known multiple of the vector width, so a block compiles to SSE2 lanes (AVX with -march)
+   and only the tail of an array runs scalar. */
+#define MOTION_BLOCK 8
+
+/* Same code for a block and for the tail */
+static inline void move_axis(double *restrict g, double *restrict v, double *restrict s, int32_t *restrict q,
+                             int count, double lo, double hi, int32_t qmax) {
+    for (int k = 0; k < count; k++) {
+        double p = g[k] + v[k];
+        p = p < lo ? lo : p;
+        p = p > hi ? hi : p;
+        int32_t qk = (int32_t)(p / 10.0) + 1;
+        qk = qk < 1 ? 1 : qk;
+        qk = qk > qmax ? qmax : qk;
+        g[k] = p; v[k] = 0.0;
+        q[k] = qk; s[k] = p - (qk - 1) * 10.0;
+    }
+}
+
+void npc_integrate(double *restrict g, double *restrict v, double *restrict s, int32_t *restrict q,
+                   int count, double lo, double hi, int qmax) {
+    int n = 0;
+    for (; n + MOTION_BLOCK <= count; n += MOTION_BLOCK) move_axis(g + n, v + n, s + n, q + n, MOTION_BLOCK, lo, hi, qmax);
+    move_axis(g + n, v + n, s + n, q + n, count - n, lo, hi, qmax);
+}
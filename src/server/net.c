@@ -10,6 +10,7 @@
 #include <stddef.h>
 #include <sys/socket.h>
 #include <unistd.h>
+#include <openssl/crypto.h>
 #include <openssl/evp.h>
 #include <openssl/rand.h>
 #include "server_internal.h"
@@ -18,55 +19,6 @@
 /* Master Key for Subspace Communications (Loaded from ENV) */
 uint8_t MASTER_SESSION_KEY[32];
 
-/* Advanced Subspace Encryption Engine */
-void encrypt_payload(PacketMessage *msg, const char *plaintext, const uint8_t *key) {
-    int plaintext_len = strlen(plaintext);
-    if (plaintext_len > 65535) plaintext_len = 65535;
-
-    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
-    RAND_bytes(msg->iv, 12); 
-    
-    const EVP_CIPHER *cipher;
-    int is_gcm = 0;
-
-    if (msg->crypto_algo == CRYPTO_CHACHA) { cipher = EVP_chacha20_poly1305(); is_gcm = 1; }
-    else if (msg->crypto_algo == CRYPTO_ARIA) { cipher = EVP_aria_256_gcm(); is_gcm = 1; }
-    else if (msg->crypto_algo == CRYPTO_CAMELLIA) { cipher = EVP_camellia_256_ctr(); is_gcm = 0; }
-    else if (msg->crypto_algo == CRYPTO_SEED) { cipher = EVP_seed_cbc(); is_gcm = 0; }
-    else if (msg->crypto_algo == CRYPTO_CAST5) { cipher = EVP_cast5_cbc(); is_gcm = 0; }
-    else if (msg->crypto_algo == CRYPTO_IDEA) { cipher = EVP_idea_cbc(); is_gcm = 0; }
-    else if (msg->crypto_algo == CRYPTO_3DES) { cipher = EVP_des_ede3_cbc(); is_gcm = 0; }
-    else if (msg->crypto_algo == CRYPTO_BLOWFISH) { cipher = EVP_bf_cbc(); is_gcm = 0; }
-    else if (msg->crypto_algo == CRYPTO_RC4) { cipher = EVP_rc4(); is_gcm = 0; }
-    else if (msg->crypto_algo == CRYPTO_DES) { cipher = EVP_des_cbc(); is_gcm = 0; }
-    else if (msg->crypto_algo == CRYPTO_PQC) { cipher = EVP_aes_256_gcm(); is_gcm = 1; }
-    else { cipher = EVP_aes_256_gcm(); is_gcm = 1; }
-    
-    /* We use the random IV for encryption. 
-       THEN we will XOR the IV in the packet for transmission. */
-    EVP_EncryptInit_ex(ctx, cipher, NULL, key, msg->iv);
-    
-    int outlen;
-    EVP_EncryptUpdate(ctx, (uint8_t*)msg->text, &outlen, (const uint8_t*)plaintext, plaintext_len);
-    int final_len;
-    EVP_EncryptFinal_ex(ctx, (uint8_t*)msg->text + outlen, &final_len);
-    
-    /* Get Auth Tag if GCM */
-    if (is_gcm) {
-        EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, 16, msg->tag);
-    } else {
-        memset(msg->tag, 0, 16);
-    }
-    
-    /* Rotating Frequency Integration: XOR the packet's IV field with frame_id for transmission.
-       The client MUST reverse this BEFORE calling DecryptInit using the embedded origin_frame. */
-    msg->origin_frame = galaxy_master.frame_id;
-    for(int i=0; i<8; i++) msg->iv[i] ^= ((msg->origin_frame >> (i*8)) & 0xFF);
-
-    msg->length = outlen + final_len;
-    EVP_CIPHER_CTX_free(ctx);
-}
-
 int read_all(int fd, void *buf, size_t len) {
     size_t total = 0;
     char *p = (char *)buf;
@@ -91,11 +43,10 @@ int write_all(int fd, const void *buf, size_t len) {
 }
 
 void broadcast_message(PacketMessage *msg) {
-    char plaintext[65536];
-    size_t plen = (msg->length < 65536) ? msg->length : 65535;
-    memcpy(plaintext, msg->text, plen);
-    plaintext[plen] = '\0';
+    size_t plen = (msg->length >= 0 && msg->length < 65536) ? msg->length : 65535;
+    msg->text[plen] = '\0'; /* Terminated in place: crypto_pool_send copies it per recipient */
 
+    /* The world lock only covers recipient selection; ciphers run on the crypto pool */
     pthread_mutex_lock(&game_mutex);
     
     int sender_algo = CRYPTO_NONE;
@@ -110,56 +61,369 @@ void broadcast_message(PacketMessage *msg) {
         if (players[i].active && players[i].socket != 0) {
             if (msg->scope == SCOPE_FACTION && players[i].faction != msg->faction) continue;
             if (msg->scope == SCOPE_PRIVATE) {
-                bool is_target = ((i + 1) == msg->target_id);
+                bool is_target = (entity_id(SI_PLAYER, i) == msg->target_id);
                 bool is_sender = (strcmp(players[i].name, msg->from) == 0);
                 if (!is_target && !is_sender) continue;
             }
-            
-            PacketMessage individual_msg = *msg;
-            if (sender_algo != CRYPTO_NONE) { 
-                individual_msg.is_encrypted = 1;
-                individual_msg.crypto_algo = sender_algo;
-                const uint8_t *k = players[i].session_key;
-                bool all_zero = true; for(int z=0; z<32; z++) if(k[z]!=0) all_zero=false;
-                encrypt_payload(&individual_msg, plaintext, all_zero ? MASTER_SESSION_KEY : k);
-            } else {
-                individual_msg.is_encrypted = 0;
-                size_t tlen = strlen(plaintext);
-                if (tlen > 65535) tlen = 65535;
-                memcpy(individual_msg.text, plaintext, tlen);
-                individual_msg.text[tlen] = '\0';
-                individual_msg.length = tlen;
-            }
-            
-            size_t pkt_size = offsetof(PacketMessage, text) + individual_msg.length;
-            pthread_mutex_lock(&players[i].socket_mutex);
-            write_all(players[i].socket, &individual_msg, pkt_size);
-            pthread_mutex_unlock(&players[i].socket_mutex);
+            crypto_pool_send(i, msg, msg->text, sender_algo);
         }
     }
     pthread_mutex_unlock(&game_mutex);
 }
 
+/* Caller holds game_mutex, or is inside crypto_pool_hold() on the network thread */
 void send_server_msg(int p_idx, const char *from, const char *text) {
-    PacketMessage msg;
-    memset(&msg, 0, sizeof(PacketMessage));
-    msg.type = PKT_MESSAGE;
-    strncpy(msg.from, from, 63);
-    
-    if (players[p_idx].crypto_algo != CRYPTO_NONE) {
-        msg.is_encrypted = 1;
-        msg.crypto_algo = players[p_idx].crypto_algo;
-        const uint8_t *k = players[p_idx].session_key;
-        bool all_zero = true; for(int z=0; z<32; z++) if(k[z]!=0) all_zero=false;
-        encrypt_payload(&msg, text, all_zero ? MASTER_SESSION_KEY : k);
-    } else {
-        msg.is_encrypted = 0;
-        strncpy(msg.text, text, 65535);
-        msg.length = strlen(msg.text);
+    PacketMessage head;
+    memset(&head, 0, offsetof(PacketMessage, text));
+    head.type = PKT_MESSAGE;
+    strncpy(head.from, from, 63);
+    crypto_pool_send(p_idx, &head, text, players[p_idx].crypto_algo);
+}
+
+/* --- Session Resume --- */
+
+/* Signs galaxy_master and copies it, followed by the PacketChart of the quadrants beyond
+   its corner, so a link can be sent both after game_mutex is released without the tick
+   changing what the signature covers. Returns the length at *out. Caller holds game_mutex;
+   network thread only, the buffer is reused by the next call. */
+size_t signed_galaxy_sync(const void **out) {
+    static uint8_t *buf = NULL;
+    static size_t cap = 0;
+    sign_galaxy_data();
+
+    int count = 0;
+    for(int i=1; i<=galaxy_q; i++) for(int j=1; j<=galaxy_q; j++) for(int l=1; l<=galaxy_q; l++)
+        if (!IS_CHART_Q(i, j, l) && GALAXY_MAP(i, j, l) != 0) count++;
+    size_t len = sizeof(StarTrekGame) + sizeof(PacketChart) + count * sizeof(NetGalaxyCell);
+    if (len > cap) {
+        uint8_t *b = realloc(buf, len);
+        if (!b) { perror("galaxy sync"); exit(1); }
+        buf = b;
+        cap = len;
     }
-    
-    size_t pkt_size = offsetof(PacketMessage, text) + msg.length;
-    pthread_mutex_lock(&players[p_idx].socket_mutex);
-    write_all(players[p_idx].socket, &msg, pkt_size);
-    pthread_mutex_unlock(&players[p_idx].socket_mutex);
-}
\ No newline at end of file
+
+    memcpy(buf, &galaxy_master, sizeof(StarTrekGame));
+    PacketChart *chart = (PacketChart *)(buf + sizeof(StarTrekGame));
+    chart->type = PKT_CHART;
+    chart->galaxy_q = galaxy_q;
+    chart->count = count;
+    int n = 0;
+    for(int i=1; i<=galaxy_q; i++) for(int j=1; j<=galaxy_q; j++) for(int l=1; l<=galaxy_q; l++)
+        if (!IS_CHART_Q(i, j, l) && GALAXY_MAP(i, j, l) != 0)
+            chart->cells[n++] = (NetGalaxyCell){(uint8_t)i, (uint8_t)j, (uint8_t)l, GALAXY_MAP(i, j, l)};
+    *out = buf;
+    return len;
+}
+
+/* Issues a fresh resume token right after the Galaxy Master has been delivered at login */
+void send_session_token(int slot) {
+    PacketResumeAck ack;
+    memset(&ack, 0, sizeof(PacketResumeAck));
+    ack.type = PKT_RESUME;
+    ack.status = RESUME_FULL;
+    RAND_bytes((uint8_t*)&ack.token, sizeof(ack.token));
+
+    pthread_mutex_lock(&game_mutex);
+    players[slot].resume_token = ack.token;
+    ack.frame_id = galaxy_master.frame_id;
+    int fd = players[slot].socket;
+    pthread_mutex_unlock(&game_mutex);
+
+    pthread_mutex_lock(&players[slot].socket_mutex);
+    write_all(fd, &ack, sizeof(PacketResumeAck));
+    pthread_mutex_unlock(&players[slot].socket_mutex);
+}
+
+/* Moves the key and capabilities negotiated by fd's handshake onto slot and releases the
+   slot the handshake reserved. Caller holds game_mutex. */
+void adopt_handshake_link(int slot, int fd) {
+    bool negotiated = (players[slot].socket == fd);
+    for (int j = 0; j < MAX_CLIENTS; j++) {
+        if (j != slot && players[j].socket == fd) {
+            memcpy(players[slot].session_key, players[j].session_key, 32);
+            players[slot].link_caps = players[j].link_caps;
+            players[j].socket = 0;
+            negotiated = true;
+        }
+    }
+    if (!negotiated) players[slot].link_caps = 0; /* Never let a previous link's caps leak */
+    crypto_pool_prepare(slot);
+}
+
+/* Only a link whose handshake stored its session key in a reserved slot may log in or
+   resume. Spectator links gave that slot back, and a handshake made while every slot was
+   taken never had one: either would be answered without a key. Caller holds game_mutex. */
+bool link_has_session_key(int fd) {
+    for (int s = 0; s < MAX_SPECTATORS; s++) if (spectators[s].socket == fd) return false;
+    for (int j = 0; j < MAX_CLIENTS; j++) if (players[j].socket == fd) return true;
+    return false;
+}
+
+/* Reattaches a dropped captain to its persistent slot. Only the map cells changed after
+   the client's last frame are sent; player state follows with the next PacketUpdate. */
+void handle_resume(int fd, const PacketResume *pkt) {
+    static NetGalaxyCell cells[RESUME_MAX_DELTA_CELLS];
+    PacketResumeAck ack;
+    memset(&ack, 0, sizeof(PacketResumeAck));
+    ack.type = PKT_RESUME;
+    ack.status = RESUME_REJECTED;
+
+    pthread_mutex_lock(&game_mutex);
+    if (!link_has_session_key(fd)) {
+        pthread_mutex_unlock(&game_mutex);
+        LOG_DEBUG("Resume refused for FD %d: no session key on this link\n", fd);
+        shutdown(fd, SHUT_RDWR);
+        return;
+    }
+    /* The token is a secret: compared in constant time, so timing does not reveal its bytes */
+    int slot = -1;
+    for (int j = 0; j < MAX_CLIENTS; j++) {
+        if (players[j].resume_token != 0 &&
+            CRYPTO_memcmp(&players[j].resume_token, &pkt->token, sizeof(pkt->token)) == 0 &&
+            strncmp(players[j].name, pkt->name, 64) == 0) { slot = j; break; }
+    }
+
+    if (slot == -1) {
+        pthread_mutex_unlock(&game_mutex);
+        LOG_DEBUG("Resume rejected for FD %d: unknown session token\n", fd);
+        write_all(fd, &ack, sizeof(PacketResumeAck));
+        return;
+    }
+
+    adopt_handshake_link(slot, fd);
+
+    /* The old link may not have been reaped yet: shut it down so the epoll loop closes it */
+    if (players[slot].socket != 0 && players[slot].socket != fd) shutdown(players[slot].socket, SHUT_RDWR);
+    players[slot].socket = fd;
+    players[slot].active = 0; /* Block updates during sync */
+
+    ack.status = RESUME_FULL;
+    const void *sync = NULL;
+    size_t sync_len = 0;
+    int64_t gap = galaxy_master.frame_id - pkt->last_frame;
+    if (pkt->last_frame > 0 && gap >= 0 && gap <= RESUME_MAX_FRAME_GAP) {
+        int n = 0;
+        for(int i=1; i<=galaxy_q && n >= 0; i++) for(int j=1; j<=galaxy_q && n >= 0; j++) for(int l=1; l<=galaxy_q; l++) {
+            if (galaxy_cell_frame[GALAXY_CELL(i, j, l)] <= pkt->last_frame) continue;
+            if (n == RESUME_MAX_DELTA_CELLS) { n = -1; break; }
+            cells[n++] = (NetGalaxyCell){(uint8_t)i, (uint8_t)j, (uint8_t)l, GALAXY_MAP(i, j, l)};
+        }
+        if (n >= 0) { ack.status = RESUME_DELTA; ack.cell_count = n; }
+    }
+    if (ack.status == RESUME_FULL) sync_len = signed_galaxy_sync(&sync);
+
+    RAND_bytes((uint8_t*)&ack.token, sizeof(ack.token));
+    players[slot].resume_token = ack.token;
+    ack.frame_id = galaxy_master.frame_id;
+    pthread_mutex_unlock(&game_mutex);
+
+    LOG_DEBUG("Session resumed for FD %d (Slot %d): %s, %d cells, gap %lld frames\n", fd, slot,
+              ack.status == RESUME_DELTA ? "delta" : "full", ack.cell_count, (long long)gap);
+
+    pthread_mutex_lock(&players[slot].socket_mutex);
+    int w_res = write_all(fd, &ack, sizeof(PacketResumeAck));
+    if (w_res > 0) {
+        if (ack.status == RESUME_DELTA) w_res = (ack.cell_count > 0) ? write_all(fd, cells, ack.cell_count * sizeof(NetGalaxyCell)) : 1;
+        else w_res = write_all(fd, sync, sync_len);
+    }
+    pthread_mutex_unlock(&players[slot].socket_mutex);
+    if (w_res <= 0) return;
+
+    pthread_mutex_lock(&game_mutex);
+    if (players[slot].socket == fd) {
+        players[slot].active = 1;
+        send_server_msg(slot, "SERVER", "Subspace link restored. Session resumed.");
+    }
+    pthread_mutex_unlock(&game_mutex);
+}
+
+/* --- Spectator Links --- */
+
+Spectator spectators[MAX_SPECTATORS];
+
+/* Non-blocking write of a shared, already serialized update. A viewer whose socket
+   buffer is full is dropped rather than allowed to stall the game loop. Caller holds game_mutex. */
+void spectator_send(Spectator *sp, const void *buf, size_t len) {
+    ssize_t n = send(sp->socket, buf, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+    sp->sent_frame = galaxy_master.frame_id;
+    if (n != (ssize_t)len) {
+        LOG_DEBUG("Spectator FD %d lagging, dropping link\n", sp->socket);
+        sp->mode = 0;
+        shutdown(sp->socket, SHUT_RDWR); /* Reaped by the epoll loop */
+    }
+}
+
+/* Followers of a captain receive the exact buffer that captain was sent this tick */
+void spectator_fanout_captain(int p_idx, const void *buf, size_t len) {
+    for (int s = 0; s < MAX_SPECTATORS; s++) {
+        Spectator *sp = &spectators[s];
+        if (sp->socket != 0 && sp->ready && sp->mode == SPECTATE_CAPTAIN && sp->target == p_idx)
+            spectator_send(sp, buf, len);
+    }
+}
+
+/* Caller holds game_mutex */
+void remove_spectator(int fd) {
+    for (int s = 0; s < MAX_SPECTATORS; s++) {
+        if (spectators[s].socket == fd) { memset(&spectators[s], 0, sizeof(Spectator)); break; }
+    }
+}
+
+void handle_spectate(int fd, const PacketSpectate *pkt) {
+    bool valid = (pkt->mode == SPECTATE_QUADRANT && IS_Q_VALID(pkt->q1, pkt->q2, pkt->q3)) ||
+                 (pkt->mode == SPECTATE_CAPTAIN && pkt->target_id >= 1 && pkt->target_id <= MAX_CLIENTS);
+
+    pthread_mutex_lock(&game_mutex);
+    /* Captains already receive their own stream */
+    for (int j = 0; j < MAX_CLIENTS; j++) {
+        if (players[j].socket == fd && players[j].active) { pthread_mutex_unlock(&game_mutex); return; }
+    }
+    Spectator *sp = NULL;
+    const void *sync = NULL;
+    size_t sync_len = 0;
+    bool is_new = false;
+    for (int s = 0; s < MAX_SPECTATORS; s++) if (spectators[s].socket == fd) { sp = &spectators[s]; break; }
+    if (!sp && valid) {
+        for (int s = 0; s < MAX_SPECTATORS; s++) if (spectators[s].socket == 0) { sp = &spectators[s]; is_new = true; break; }
+    }
+    if (!sp) {
+        pthread_mutex_unlock(&game_mutex);
+        LOG_DEBUG("Spectate request on FD %d refused (%s)\n", fd, valid ? "no free spectator link" : "invalid subscription");
+        shutdown(fd, SHUT_RDWR);
+        return;
+    }
+    if (!valid) { pthread_mutex_unlock(&game_mutex); return; }
+
+    if (is_new) {
+        /* Give back the player slot the handshake reserved for this connection */
+        for (int j = 0; j < MAX_CLIENTS; j++) if (players[j].socket == fd && !players[j].active) players[j].socket = 0;
+        memset(sp, 0, sizeof(Spectator));
+        sp->socket = fd;
+        sync_len = signed_galaxy_sync(&sync);
+    }
+    sp->mode = pkt->mode;
+    sp->q1 = pkt->q1; sp->q2 = pkt->q2; sp->q3 = pkt->q3;
+    sp->target = pkt->target_id - 1;
+    pthread_mutex_unlock(&game_mutex);
+
+    LOG_DEBUG("Spectator FD %d subscribed to %s %d-%d-%d / captain %d\n", fd,
+              pkt->mode == SPECTATE_QUADRANT ? "quadrant" : "captain", pkt->q1, pkt->q2, pkt->q3, pkt->target_id);
+    if (!is_new) return;
+
+    if (write_all(fd, sync, sync_len) != (int)sync_len) return;
+    pthread_mutex_lock(&game_mutex);
+    if (sp->socket == fd) sp->ready = 1;
+    pthread_mutex_unlock(&game_mutex);
+}
+
+/* --- Alert Channel --- */
+
+typedef struct {
+    int pending;
+    int repeat;       /* Occurrences this tick */
+    int last_tick;
+    int p1, p2;
+} AlertState;
+
+static AlertState alert_state[MAX_CLIENTS][ALERT_COUNT];
+
+/* Hazard alerts fire every few ticks while the condition lasts: one per window is enough.
+   Hits and navigation sequences are one-shot and always delivered. */
+static const bool alert_coalesced[ALERT_COUNT] = {
+    [ALERT_GRAVITY_SHEAR] = true, [ALERT_NEBULA_DRAIN] = true, [ALERT_PULSAR_RADIATION] = true,
+    [ALERT_SICKBAY_RADIATION] = true, [ALERT_ASTEROID_COLLISION] = true, [ALERT_COMET_GAS] = true,
+    [ALERT_AMOEBA_DRAIN] = true, [ALERT_CRYSTALLINE_RESONANCE] = true, [ALERT_LIFE_SUPPORT_CASUALTIES] = true,
+};
+
+/* Queues an alert for the end-of-tick flush. A one-shot alert that differs from the one
+   already queued (another system hit) sends the queue first, so neither is lost.
+   Caller holds game_mutex. */
+void send_alert(int p_idx, int code, int p1, int p2) {
+    if (code <= ALERT_NONE || code >= ALERT_COUNT) return;
+    AlertState *st = &alert_state[p_idx][code];
+    if (st->pending && !alert_coalesced[code] && (st->p1 != p1 || st->p2 != p2)) flush_alerts(p_idx);
+    st->p1 = p1; st->p2 = p2;
+    if (st->pending) { st->repeat++; return; }
+    if (alert_coalesced[code] && st->last_tick > 0 && global_tick - st->last_tick < ALERT_COALESCE_TICKS) return;
+    st->pending = 1;
+    st->repeat = 1;
+    st->last_tick = global_tick;
+}
+
+/* A new captain in the slot, or the same one back from a dropped link or a rescue, starts
+   with no alert windows open. Caller holds game_mutex. */
+void reset_alerts(int p_idx) {
+    memset(alert_state[p_idx], 0, sizeof(alert_state[p_idx]));
+}
+
+/* Sends every pending alert of a player as one PacketAlert. Caller holds game_mutex. */
+void flush_alerts(int p_idx) {
+    PacketAlert pkt;
+    pkt.type = PKT_ALERT;
+    pkt.count = 0;
+    for (int c = 1; c < ALERT_COUNT; c++) {
+        AlertState *st = &alert_state[p_idx][c];
+        if (!st->pending) continue;
+        pkt.alerts[pkt.count++] = (NetAlert){(uint16_t)c, (uint16_t)(st->repeat > 65535 ? 65535 : st->repeat), st->p1, st->p2};
+        st->pending = 0;
+    }
+    if (pkt.count == 0) return;
+    crypto_pool_frame(p_idx, &pkt, offsetof(PacketAlert, alerts) + pkt.count * sizeof(NetAlert));
+}
+
+/* --- Sensor Reports --- */
+
+/* Stamps the header with the captain's telemetry, taken from the same snapshot the report
+   was built from, and ships the used part of data[] */
+void send_sensor_report(int p_idx, const PlayerView *me, PacketSensor *pkt, size_t data_len) {
+    pkt->type = PKT_SENSOR;
+    pkt->q1 = me->q1; pkt->q2 = me->q2; pkt->q3 = me->q3;
+    pkt->s1 = me->s1; pkt->s2 = me->s2; pkt->s3 = me->s3;
+    pkt->heading = me->ent_h; pkt->mark = me->ent_m;
+    pkt->energy = me->energy;
+    pkt->torpedoes = me->torpedoes;
+    pkt->cloaked = me->is_cloaked ? 1 : 0;
+
+    crypto_pool_frame(p_idx, pkt, offsetof(PacketSensor, data) + data_len);
+}
+
+/* --- Sealed Updates --- */
+
+/* Owned by the tick thread. The crypto workers keep separate sessions for chat, so the
+   two never share cipher contexts and neither waits on the other. */
+static CryptoSession update_sessions[MAX_CLIENTS];
+static uint64_t sealed_frames = 0, sealed_bytes = 0, seal_failures = 0;
+
+/* Tick only, with game_mutex held. Links that negotiated LINK_CAP_SEALED_UPDATES get the
+   frame as PKT_UPDATE_SEALED; a frame that fails to seal is dropped, never sent in clear. */
+void send_update(int p_idx, const PacketUpdate *upd, size_t len) {
+    ConnectedPlayer *p = &players[p_idx];
+    const void *out = upd;
+    size_t out_len = len;
+    ArenaMark mark = arena_mark();
+
+    if (p->link_caps & LINK_CAP_SEALED_UPDATES) {
+        PacketSealedUpdate *s = arena_alloc(sizeof(PacketSealedUpdate) + len + 16);
+        int clen = -1;
+        if (s) {
+            crypto_session_bind(&update_sessions[p_idx], p->session_key);
+            clen = crypto_session_encrypt(&update_sessions[p_idx], CRYPTO_AES, CRYPTO_CHANNEL_UPDATES, upd->frame_id,
+                                          (const uint8_t*)upd, (int)len, s->data, s->iv, s->tag);
+        }
+        if (clen < 0) { seal_failures++; arena_release(mark); return; }
+        s->type = PKT_UPDATE_SEALED;
+        s->length = clen;
+        out = s;
+        out_len = offsetof(PacketSealedUpdate, data) + clen;
+        sealed_frames++;
+        sealed_bytes += clen;
+    }
+
+    crypto_pool_frame(p_idx, out, out_len);
+    arena_release(mark);
+}
+
+void log_update_stats(void) {
+    LOG_DEBUG("Sealed updates: %llu frames, %llu bytes, %llu failures\n",
+              (unsigned long long)sealed_frames, (unsigned long long)sealed_bytes, (unsigned long long)seal_failures);
+}
@@ -0,0 +1,200 @@
+/*
+ * STARTREK ULTRA - 3D LOGIC ENGINE
+ * Authors: Nicola Taibi, Supported by Google Gemini
+ * Copyright (C) 2026 Nicola Taibi
+ * License: GNU General Public License v3.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "server_internal.h"
+
+/* --- World Snapshot --- */
+
+/* A small ring of buffers with reader counts. The tick fills a buffer nobody is reading,
+   then swaps the published pointer; readers pin the buffer they loaded and re-check that
+   it is still the published one, so a buffer is never rewritten under a reader. */
+static WorldSnapshot *snap_buffers[SNAPSHOT_BUFFERS];
+static WorldSnapshot *published = NULL;
+static uint64_t publish_skips = 0;
+
+static SensorEntry *view_add(WorldSnapshot *w, int kind, int id, double x, double y, double z, bool active) {
+    QuadrantView *v = &w->views[w->view_count - 1];
+    if (w->entry_count >= SNAPSHOT_MAX_ENTRIES || v->count >= MAX_SENSOR_CONTACTS + 1) { /* +1: the observer itself is skipped later */
+        v->dropped++;
+        return NULL;
+    }
+    SensorEntry *e = &w->entries[w->entry_count++];
+    v->count++;
+    memset(e, 0, sizeof(*e));
+    e->kind = (uint8_t)kind; e->id = id;
+    e->x = x; e->y = y; e->z = z;
+    e->owner = -1;
+    e->active = active;
+    return e;
+}
+
+/* Neighbour views keep only what a border sweep can see across: ships, comets, buoys */
+static void capture_quadrant(WorldSnapshot *w, int q1, int q2, int q3, bool full) {
+    int cell = GALAXY_CELL(q1, q2, q3);
+    if (w->quad_view[cell] >= 0 || w->view_count >= SNAPSHOT_MAX_QUADS) return;
+    QuadrantIndex lq_view = spatial_quadrant(q1, q2, q3), *lq = &lq_view;
+    w->quad_view[cell] = (int16_t)w->view_count;
+    w->views[w->view_count++] = (QuadrantView){w->entry_count, 0, 0, cell, full};
+    SensorEntry *e;
+
+    if (full) {
+        for(int j=0; j<lq->player_count; j++) {
+            ConnectedPlayer *p = &players[lq->players[j]];
+            int slot = (int)(p-players);
+            if (!(e = view_add(w, CONTACT_PLAYER, entity_id(SI_PLAYER, slot), p->state.s1, p->state.s2, p->state.s3, true))) break;
+            e->energy = p->state.energy; e->owner = (int16_t)slot; e->noisy = true;
+        }
+    }
+    for(int n=0; n<lq->npc_count; n++) {
+        int s = lq->npcs[n];
+        NPCShip *npc = &npcs[s];
+        if (!full && !npc_hot.active[s]) continue;
+        if (!(e = view_add(w, CONTACT_NPC, entity_id(SI_NPC, npc->id), npc_hot.x[s], npc_hot.y[s], npc_hot.z[s], npc_hot.active[s]))) break;
+        e->energy = npc_hot.energy[s]; e->faction = (int16_t)npc->faction; e->noisy = true;
+        e->detail = (int16_t)npc->engine_health;
+        e->engine = npc->engine_health;
+        e->scan_detail = (npc_hot.ai_state[s]==AI_STATE_FLEE) ? 2 : (npc_hot.ai_state[s]==AI_STATE_CHASE) ? 1 : 0;
+    }
+    if (full) {
+        for(int k=0; k<lq->base_count; k++) { NPCBase *o = &bases[lq->bases[k]]; view_add(w, CONTACT_BASE, entity_id(SI_BASE, o->id), o->x, o->y, o->z, true); }
+        for(int k=0; k<lq->planet_count; k++) {
+            NPCPlanet *o = &planets[lq->planets[k]];
+            if ((e = view_add(w, CONTACT_PLANET, entity_id(SI_PLANET, o->id), o->x, o->y, o->z, true))) { e->scan_detail = (int16_t)o->resource_type; e->amount = o->amount; }
+        }
+        for(int k=0; k<lq->star_count; k++) { NPCStar *o = &stars_data[lq->stars[k]]; view_add(w, CONTACT_STAR, entity_id(SI_STAR, o->id), o->x, o->y, o->z, true); }
+        for(int k=0; k<lq->bh_count; k++) { NPCBlackHole *o = &black_holes[lq->black_holes[k]]; view_add(w, CONTACT_BLACKHOLE, entity_id(SI_BH, o->id), o->x, o->y, o->z, true); }
+        for(int k=0; k<lq->nebula_count; k++) { NPCNebula *o = &nebulas[lq->nebulas[k]]; view_add(w, CONTACT_NEBULA, entity_id(SI_NEBULA, o->id), o->x, o->y, o->z, true); }
+        for(int k=0; k<lq->pulsar_count; k++) { NPCPulsar *o = &pulsars[lq->pulsars[k]]; view_add(w, CONTACT_PULSAR, entity_id(SI_PULSAR, o->id), o->x, o->y, o->z, true); }
+    }
+    for(int k=0; k<lq->comet_count; k++) {
+        NPCComet *o = &comets[lq->comets[k]];
+        if (!full && !o->active) continue;
+        view_add(w, CONTACT_COMET, entity_id(SI_COMET, o->id), o->x, o->y, o->z, o->active);
+    }
+    if (full) {
+        for(int k=0; k<lq->asteroid_count; k++) { NPCAsteroid *o = &asteroids[lq->asteroids[k]]; view_add(w, CONTACT_ASTEROID, entity_id(SI_ASTEROID, o->id), o->x, o->y, o->z, true); }
+        for(int k=0; k<lq->monster_count; k++) {
+            NPCMonster *o = &monsters[lq->monsters[k]];
+            if ((e = view_add(w, CONTACT_MONSTER, entity_id(SI_MONSTER, o->id), o->x, o->y, o->z, true))) e->detail = e->scan_detail = (int16_t)o->type;
+        }
+
+        /* Subspace probes are not indexed: found through their owners */
+        for (int p_j = 0; p_j < MAX_CLIENTS; p_j++) {
+            if (!players[p_j].socket) continue;
+            for (int pr = 0; pr < 3; pr++) {
+                NetProbe *probe = &players[p_j].state.probes[pr];
+                if (!probe->active) continue;
+                if (get_q_from_g(probe->gx) != q1 || get_q_from_g(probe->gy) != q2 || get_q_from_g(probe->gz) != q3) continue;
+                if (!(e = view_add(w, CONTACT_PROBE, entity_id(ENT_PROBE, p_j * 3 + pr), probe->s1, probe->s2, probe->s3, true))) continue;
+                if (probe->status == 2) e->flags |= CONTACT_F_DERELICT;
+                e->owner = (int16_t)p_j;
+            }
+        }
+
+        for(int k=0; k<lq->derelict_count; k++) { NPCDerelict *o = &derelicts[lq->derelicts[k]]; view_add(w, CONTACT_DERELICT, entity_id(SI_DERELICT, o->id), o->x, o->y, o->z, true); }
+        for(int k=0; k<lq->platform_count; k++) {
+            NPCPlatform *o = &platforms[lq->platforms[k]];
+            if ((e = view_add(w, CONTACT_PLATFORM, entity_id(SI_PLATFORM, o->id), o->x, o->y, o->z, true))) { e->energy = o->energy; e->amount = o->fire_cooldown; }
+        }
+        for(int k=0; k<lq->rift_count; k++) { NPCRift *o = &rifts[lq->rifts[k]]; view_add(w, CONTACT_RIFT, entity_id(SI_RIFT, o->id), o->x, o->y, o->z, true); }
+    }
+    for(int k=0; k<lq->buoy_count; k++) {
+        NPCBuoy *o = &buoys[lq->buoys[k]];
+        if (!full && !o->active) continue;
+        view_add(w, CONTACT_BUOY, entity_id(SI_BUOY, o->id), o->x, o->y, o->z, o->active);
+    }
+    if (full) {
+        for(int k=0; k<lq->mine_count; k++) { NPCMine *o = &mines[lq->mines[k]]; view_add(w, CONTACT_MINE, entity_id(SI_MINE, o->id), o->x, o->y, o->z, true); }
+    }
+}
+
+static void capture_player(PlayerView *v, const ConnectedPlayer *p) {
+    const StarTrekGame *st = &p->state;
+    v->active = p->active != 0;
+    memcpy(v->name, p->name, sizeof(v->name));
+    v->faction = p->faction; v->ship_class = p->ship_class; v->nav_state = p->nav_state;
+    v->gx = p->gx; v->gy = p->gy; v->gz = p->gz;
+    v->q1 = st->q1; v->q2 = st->q2; v->q3 = st->q3;
+    v->s1 = st->s1; v->s2 = st->s2; v->s3 = st->s3;
+    v->ent_h = st->ent_h; v->ent_m = st->ent_m;
+    v->energy = st->energy; v->torpedoes = st->torpedoes;
+    v->cargo_energy = st->cargo_energy; v->cargo_torpedoes = st->cargo_torpedoes;
+    v->crew_count = st->crew_count; v->prison_unit = st->prison_unit; v->duranium_plating = st->duranium_plating;
+    memcpy(v->inventory, st->inventory, sizeof(v->inventory));
+    memcpy(v->shields, st->shields, sizeof(v->shields));
+    memcpy(v->power_dist, st->power_dist, sizeof(v->power_dist));
+    memcpy(v->system_health, st->system_health, sizeof(v->system_health));
+    v->lock_target = st->lock_target;
+    v->is_cloaked = st->is_cloaked;
+    /* The map itself is too large to copy every tick: each captain gets the cells lrs shows */
+    if (!v->active) return;
+    for (int d1 = -1; d1 <= 1; d1++) for (int d2 = -1; d2 <= 1; d2++) for (int d3 = -1; d3 <= 1; d3++) {
+        int q1 = v->q1 + d1, q2 = v->q2 + d2, q3 = v->q3 + d3;
+        v->lrs[d1 + 1][d2 + 1][d3 + 1] = IS_Q_VALID(q1, q2, q3) ? GALAXY_MAP(q1, q2, q3) : 0;
+    }
+}
+
+void snapshot_publish(void) {
+    WorldSnapshot *w = NULL;
+    for (int b = 0; b < SNAPSHOT_BUFFERS && !w; b++) {
+        if (!snap_buffers[b]) {
+            snap_buffers[b] = malloc(sizeof(WorldSnapshot));
+            if (!snap_buffers[b]) { perror("world snapshot"); exit(1); }
+            snap_buffers[b]->readers = 0;
+            snap_buffers[b]->view_count = 0;
+            if (!(snap_buffers[b]->quad_view = malloc(GALAXY_CELLS * sizeof(int16_t)))) { perror("world snapshot"); exit(1); }
+            memset(snap_buffers[b]->quad_view, 0xFF, GALAXY_CELLS * sizeof(int16_t));
+        }
+        if (snap_buffers[b] != __atomic_load_n(&published, __ATOMIC_ACQUIRE) &&
+            __atomic_load_n(&snap_buffers[b]->readers, __ATOMIC_ACQUIRE) == 0) w = snap_buffers[b];
+    }
+    if (!w) { /* Every spare buffer still pinned: readers keep the previous frame */
+        if ((++publish_skips % 300) == 1) LOG_DEBUG("World snapshot skipped (%llu so far)\n", (unsigned long long)publish_skips);
+        return;
+    }
+
+    w->version = galaxy_master.frame_id;
+    for (int i = 0; i < MAX_CLIENTS; i++) capture_player(&w->players[i], &players[i]);
+
+    /* Only the cells captured last time through this buffer are set */
+    for (int q = 0; q < w->view_count; q++) w->quad_view[w->views[q].cell] = -1;
+    w->view_count = 0;
+    w->entry_count = 0;
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        const PlayerView *v = &w->players[i];
+        if (v->active && IS_Q_VALID(v->q1, v->q2, v->q3)) capture_quadrant(w, v->q1, v->q2, v->q3, true);
+    }
+    /* Neighbours only for captains close enough to a boundary for srs to look across it */
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        const PlayerView *v = &w->players[i];
+        if (!v->active || !IS_Q_VALID(v->q1, v->q2, v->q3)) continue;
+        if (!(v->s1 < 2.5 || v->s1 > 7.5 || v->s2 < 2.5 || v->s2 > 7.5 || v->s3 < 2.5 || v->s3 > 7.5)) continue;
+        for (int dq1 = -1; dq1 <= 1; dq1++) for (int dq2 = -1; dq2 <= 1; dq2++) for (int dq3 = -1; dq3 <= 1; dq3++) {
+            int nq1 = v->q1 + dq1, nq2 = v->q2 + dq2, nq3 = v->q3 + dq3;
+            if (IS_Q_VALID(nq1, nq2, nq3)) capture_quadrant(w, nq1, nq2, nq3, false);
+        }
+    }
+
+    __atomic_store_n(&published, w, __ATOMIC_RELEASE);
+}
+
+const WorldSnapshot *snapshot_acquire(void) {
+    while (1) {
+        WorldSnapshot *w = __atomic_load_n(&published, __ATOMIC_ACQUIRE);
+        if (!w) return NULL;
+        __atomic_fetch_add(&w->readers, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&published, __ATOMIC_SEQ_CST) == w) return w;
+        __atomic_fetch_sub(&w->readers, 1, __ATOMIC_SEQ_CST); /* Superseded meanwhile: retry */
+    }
+}
+
+void snapshot_release(const WorldSnapshot *w) {
+    if (w) __atomic_fetch_sub(&((WorldSnapshot *)w)->readers, 1, __ATOMIC_RELEASE);
+}
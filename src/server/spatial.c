@@ -0,0 +1,446 @@
+/*
+ * STARTREK ULTRA - 3D LOGIC ENGINE
+ * Authors: Nicola Taibi, Supported by Google Gemini
+ * Copyright (C) 2026 Nicola Taibi
+ * License: GNU General Public License v3.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "server_internal.h"
+
+/* --- Spatial Index --- */
+
+#define ENTITY_CELL(e) (((e).active && IS_Q_VALID((e).q1, (e).q2, (e).q3)) ? GALAXY_CELL((e).q1, (e).q2, (e).q3) : -1)
+
+static const char *kind_name[SI_KINDS] = {
+    "npc", "planet", "base", "star", "black hole", "nebula", "pulsar", "comet",
+    "asteroid", "derelict", "mine", "buoy", "platform", "rift", "monster", "player"
+};
+
+/* Slot indices and run offsets are 16-bit, counted from the start of the kind's region */
+_Static_assert(ENT_POOL_MAX <= 65535, "spatial index offsets are 16-bit");
+
+/* Kinds are sorted separately: a tick where only ships crossed a border re-sorts the NPC
+   runs and leaves the thousands of stars and asteroids alone. */
+_Static_assert(sizeof(SpatialRun) * SI_KINDS == 64, "a cell's runs should fill one cache line");
+SpatialRun (*spatial_runs)[SI_KINDS];
+uint16_t *spatial_slots[SI_KINDS];
+
+/* Slots each kind's storage below is sized for, following the pool as it grows */
+static int kind_cap[SI_KINDS];
+static bool kind_stale[SI_KINDS];
+static uint64_t kind_builds[SI_KINDS];
+
+/* Only these move on their own; everything else changes cell only by spawning or dying,
+   which entity_alloc()/entity_despawn() report through spatial_index_touch(). */
+static const int moving_kinds[] = {SI_NPC, SI_COMET, SI_MONSTER, SI_PLAYER};
+
+/* Cell each entity is listed in, -1 when it is not in the index */
+static int32_t *indexed_cell[SI_KINDS];
+
+static uint16_t player_slots[MAX_CLIENTS];
+
+/* Slots that can be in the index: a pool's live slots, every connection slot for captains */
+static int kind_slots(int kind, const uint16_t **slots) {
+    if (kind == SI_PLAYER) { *slots = player_slots; return MAX_CLIENTS; }
+    return entity_live(kind, slots);
+}
+
+static struct { int32_t kind, idx; } touched[SPATIAL_TOUCH_MAX];
+static int touched_count = 0;
+static bool touched_overflow = false;
+
+/* Sized from galaxy_q when the index is first built */
+static bool *cell_dirty;
+static int32_t *dirty_cells;
+static int dirty_count = 0;
+static uint16_t *cell_count;
+/* Cells holding each kind as of its last build */
+static int32_t *occupied_cells[SI_KINDS];
+static int occupied_count[SI_KINDS];
+
+static bool index_ready = false;
+
+static uint64_t index_moves = 0, index_checks = 0, index_drifts = 0;
+
+/* Where an entity belongs right now, -1 when it should not be indexed */
+static int entity_cell(int kind, int i) {
+    switch (kind) {
+        case SI_NPC:       return npc_hot.active[i] && IS_Q_VALID(npc_hot.q1[i], npc_hot.q2[i], npc_hot.q3[i]) ? GALAXY_CELL(npc_hot.q1[i], npc_hot.q2[i], npc_hot.q3[i]) : -1;
+        case SI_PLANET:    return ENTITY_CELL(planets[i]);
+        case SI_BASE:      return ENTITY_CELL(bases[i]);
+        case SI_STAR:      return ENTITY_CELL(stars_data[i]);
+        case SI_BH:        return ENTITY_CELL(black_holes[i]);
+        case SI_NEBULA:    return ENTITY_CELL(nebulas[i]);
+        case SI_PULSAR:    return ENTITY_CELL(pulsars[i]);
+        case SI_COMET:     return ENTITY_CELL(comets[i]);
+        case SI_ASTEROID:  return ENTITY_CELL(asteroids[i]);
+        case SI_DERELICT:  return ENTITY_CELL(derelicts[i]);
+        case SI_MINE:      return ENTITY_CELL(mines[i]);
+        case SI_BUOY:      return ENTITY_CELL(buoys[i]);
+        case SI_PLATFORM:  return ENTITY_CELL(platforms[i]);
+        case SI_RIFT:      return ENTITY_CELL(rifts[i]);
+        case SI_MONSTER:   return ENTITY_CELL(monsters[i]);
+        case SI_PLAYER: {
+            StarTrekGame *s = &players[i].state;
+            if (!players[i].active || players[i].name[0] == '\0' || !IS_Q_VALID(s->q1, s->q2, s->q3)) return -1;
+            return GALAXY_CELL(s->q1, s->q2, s->q3);
+        }
+    }
+    return -1;
+}
+
+static void build_grid(int kind);
+
+static void mark_dirty(int key) {
+    if (key >= 0 && !cell_dirty[key]) { cell_dirty[key] = true; dirty_cells[dirty_count++] = key; }
+}
+
+/* Counting sort of one kind's live bodies by cell, from the recorded cells. Runs come out
+   in live-list order, and only occupied cells get one: the cost follows the bodies, not the
+   size of the galaxy. */
+static void build_kind(int kind) {
+    int32_t *occupied = occupied_cells[kind];
+    for (int o = 0; o < occupied_count[kind]; o++) spatial_runs[occupied[o]][kind] = (SpatialRun){0, 0};
+    const uint16_t *slots;
+    int live = kind_slots(kind, &slots);
+    int n = 0;
+    for (int k = 0; k < live; k++) {
+        int c = indexed_cell[kind][slots[k]];
+        if (c >= 0 && cell_count[c]++ == 0) occupied[n++] = c;
+    }
+    int at = 0;
+    for (int o = 0; o < n; o++) {
+        int c = occupied[o];
+        spatial_runs[c][kind] = (SpatialRun){(uint16_t)at, 0};
+        at += cell_count[c];
+        cell_count[c] = 0;
+    }
+    occupied_count[kind] = n;
+    for (int k = 0; k < live; k++) {
+        int c = indexed_cell[kind][slots[k]];
+        if (c < 0) continue;
+        SpatialRun *r = &spatial_runs[c][kind];
+        spatial_slots[kind][r->start + r->count++] = slots[k];
+    }
+    kind_stale[kind] = false;
+    kind_builds[kind]++;
+    build_grid(kind);
+}
+
+/* --- Proximity Grid --- */
+
+#define ENTITY_POS(e) do { *gx = ((e).q1 - 1) * 10.0 + (e).x; *gy = ((e).q2 - 1) * 10.0 + (e).y; *gz = ((e).q3 - 1) * 10.0 + (e).z; } while (0)
+
+/* Cell coordinates are packed 10 bits each; the galaxy spans far fewer cells than that */
+#define GRID_COORD(g) ((g) <= 0.0 ? 0 : ((int)((g) / SPATIAL_GRID_CELL) > 1023 ? 1023 : (int)((g) / SPATIAL_GRID_CELL)))
+#define GRID_KEY(cx,cy,cz) (((cx) << 20) | ((cy) << 10) | (cz))
+#define GRID_HASH(cx,cy,cz) ((((unsigned)(cx) * 73856093u) ^ ((unsigned)(cy) * 19349663u) ^ ((unsigned)(cz) * 83492791u)) & (SPATIAL_GRID_BUCKETS - 1))
+
+_Static_assert((SPATIAL_GRID_BUCKETS & (SPATIAL_GRID_BUCKETS - 1)) == 0, "grid buckets must be a power of two");
+
+/* Same layout as the quadrant runs: each kind owns an item per slot, sorted by bucket. An item keeps its exact cell so buckets shared by several cells are
+   told apart, and a query never sees one body twice. The position it was filed at rejects
+   far candidates without touching the entity arrays. */
+typedef struct { int32_t key; float x, y, z; uint16_t idx; } GridItem;
+static uint16_t grid_start[SI_KINDS][SPATIAL_GRID_BUCKETS + 1];
+static GridItem *grid_items[SI_KINDS];
+static GridItem *staged;  /* Sized for the largest kind */
+static int grid_count[SI_KINDS];
+static int grid_built_tick[SI_KINDS];
+
+static uint64_t grid_queries = 0, grid_tested = 0, grid_hits = 0, grid_linear = 0, grid_grown = 0;
+
+/* Result buffer of spatial_query_all(), grown to the largest result seen */
+static SpatialHit *query_hits;
+static int query_cap = 0;
+
+bool spatial_position(int kind, int idx, double *gx, double *gy, double *gz) {
+    if (kind < 0 || kind >= SI_KINDS || idx < 0 || idx >= kind_cap[kind] || entity_cell(kind, idx) < 0) return false;
+    switch (kind) {
+        case SI_NPC:       *gx = npc_hot.gx[idx]; *gy = npc_hot.gy[idx]; *gz = npc_hot.gz[idx]; break;
+        case SI_PLANET:    ENTITY_POS(planets[idx]); break;
+        case SI_BASE:      ENTITY_POS(bases[idx]); break;
+        case SI_STAR:      ENTITY_POS(stars_data[idx]); break;
+        case SI_BH:        ENTITY_POS(black_holes[idx]); break;
+        case SI_NEBULA:    ENTITY_POS(nebulas[idx]); break;
+        case SI_PULSAR:    ENTITY_POS(pulsars[idx]); break;
+        case SI_COMET:     ENTITY_POS(comets[idx]); break;
+        case SI_ASTEROID:  ENTITY_POS(asteroids[idx]); break;
+        case SI_DERELICT:  ENTITY_POS(derelicts[idx]); break;
+        case SI_MINE:      ENTITY_POS(mines[idx]); break;
+        case SI_BUOY:      ENTITY_POS(buoys[idx]); break;
+        case SI_PLATFORM:  ENTITY_POS(platforms[idx]); break;
+        case SI_RIFT:      ENTITY_POS(rifts[idx]); break;
+        case SI_MONSTER:   ENTITY_POS(monsters[idx]); break;
+        case SI_PLAYER: {
+            StarTrekGame *s = &players[idx].state;
+            *gx = (s->q1 - 1) * 10.0 + s->s1; *gy = (s->q2 - 1) * 10.0 + s->s2; *gz = (s->q3 - 1) * 10.0 + s->s3;
+            break;
+        }
+    }
+    return true;
+}
+
+/* Counting sort of one kind's indexed bodies by bucket */
+static void build_grid(int kind) {
+    static uint16_t bucket_count[SPATIAL_GRID_BUCKETS];
+    memset(bucket_count, 0, sizeof(bucket_count));
+    const uint16_t *slots;
+    int live = kind_slots(kind, &slots), n = 0;
+    for (int k = 0; k < live; k++) {
+        int i = slots[k];
+        double x, y, z;
+        if (indexed_cell[kind][i] < 0 || !spatial_position(kind, i, &x, &y, &z)) continue;
+        int cx = GRID_COORD(x), cy = GRID_COORD(y), cz = GRID_COORD(z);
+        staged[n] = (GridItem){GRID_KEY(cx, cy, cz), (float)x, (float)y, (float)z, (uint16_t)i};
+        bucket_count[GRID_HASH(cx, cy, cz)]++;
+        n++;
+    }
+    uint16_t *start = grid_start[kind];
+    int at = 0;
+    for (int b = 0; b < SPATIAL_GRID_BUCKETS; b++) { start[b] = (uint16_t)at; at += bucket_count[b]; }
+    start[SPATIAL_GRID_BUCKETS] = (uint16_t)at;
+    for (int k = 0; k < n; k++) {
+        int key = staged[k].key;
+        int b = GRID_HASH(key >> 20, (key >> 10) & 1023, key & 1023);
+        grid_items[kind][start[b] + --bucket_count[b]] = staged[k];
+    }
+    grid_count[kind] = n;
+    grid_built_tick[kind] = global_tick;
+}
+
+/* Filed position within reach, then live distance within radius. Hits past max are counted
+   but not written. */
+static inline int grid_test(int kind, const GridItem *it, float fx, float fy, float fz, float reach2,
+                            double gx, double gy, double gz, double r2, SpatialHit *hits, int n, int max) {
+    float dx = it->x - fx, dy = it->y - fy, dz = it->z - fz;
+    if (dx * dx + dy * dy + dz * dz > reach2) return n;
+    grid_tested++;
+    int idx = it->idx;
+    double x, y, z;
+    if (!spatial_position(kind, idx, &x, &y, &z)) return n;
+    double d2 = (x - gx) * (x - gx) + (y - gy) * (y - gy) + (z - gz) * (z - gz);
+    if (d2 > r2) return n;
+    if (n < max) hits[n] = (SpatialHit){(uint16_t)kind, (uint16_t)idx, (float)d2};
+    return n + 1;
+}
+
+/* Visits the cells overlapping the sphere grown by SPATIAL_GRID_SLACK. A kind with fewer
+   bodies than cells to visit is scanned whole instead, so a wide query over a sparse kind
+   costs no more than its body count. */
+int spatial_query(double gx, double gy, double gz, double radius, uint32_t kind_mask, SpatialHit *hits, int max) {
+    if (!index_ready || radius < 0 || max <= 0) return 0;
+    grid_queries++;
+    double reach = radius + SPATIAL_GRID_SLACK, r2 = radius * radius;
+    float fx = (float)gx, fy = (float)gy, fz = (float)gz, reach2 = (float)(reach * reach);
+    int x0 = GRID_COORD(gx - reach), x1 = GRID_COORD(gx + reach);
+    int y0 = GRID_COORD(gy - reach), y1 = GRID_COORD(gy + reach);
+    int z0 = GRID_COORD(gz - reach), z1 = GRID_COORD(gz + reach);
+    int cells = (x1 - x0 + 1) * (y1 - y0 + 1) * (z1 - z0 + 1);
+    int n = 0;
+    for (int kind = 0; kind < SI_KINDS; kind++) {
+        if (!(kind_mask & SI_MASK(kind)) || grid_count[kind] == 0) continue;
+        const uint16_t *start = grid_start[kind];
+        const GridItem *items = grid_items[kind];
+        if (cells > grid_count[kind]) {
+            grid_linear++;
+            for (int k = start[0]; k < start[SPATIAL_GRID_BUCKETS]; k++)
+                n = grid_test(kind, &items[k], fx, fy, fz, reach2, gx, gy, gz, r2, hits, n, max);
+            continue;
+        }
+        for (int cx = x0; cx <= x1; cx++) for (int cy = y0; cy <= y1; cy++) for (int cz = z0; cz <= z1; cz++) {
+            int b = GRID_HASH(cx, cy, cz), key = GRID_KEY(cx, cy, cz);
+            for (int k = start[b]; k < start[b + 1]; k++) {
+                if (items[k].key == key) n = grid_test(kind, &items[k], fx, fy, fz, reach2, gx, gy, gz, r2, hits, n, max);
+            }
+        }
+    }
+    grid_hits += n;
+    return n;
+}
+
+/* Tick only. Queries again into a larger buffer when the first pass did not fit. */
+int spatial_query_all(double gx, double gy, double gz, double radius, uint32_t kind_mask, const SpatialHit **hits) {
+    if (query_cap == 0) {
+        if (!(query_hits = malloc(SPATIAL_QUERY_MAX * sizeof(SpatialHit)))) { perror("Failed to allocate query buffer"); exit(1); }
+        query_cap = SPATIAL_QUERY_MAX;
+    }
+    int n = spatial_query(gx, gy, gz, radius, kind_mask, query_hits, query_cap);
+    if (n > query_cap) {
+        int cap = query_cap;
+        while (cap < n) cap *= 2;
+        if (!(query_hits = realloc(query_hits, cap * sizeof(SpatialHit)))) { perror("Failed to grow query buffer"); exit(1); }
+        query_cap = cap;
+        grid_grown++;
+        n = spatial_query(gx, gy, gz, radius, kind_mask, query_hits, query_cap);
+    }
+    *hits = query_hits;
+    return n;
+}
+
+size_t spatial_index_bytes(void) {
+    size_t bytes = GALAXY_CELLS * sizeof(*spatial_runs) + sizeof(grid_start);
+    for (int kind = 0; kind < SI_KINDS; kind++) bytes += kind_cap[kind] * (sizeof(uint16_t) + sizeof(GridItem));
+    return bytes;
+}
+
+/* Follows a pool that grew since the index last looked. Slots keep their place, so runs and
+   grid items stay valid; the new slots start out unindexed. */
+static void fit_kind(int kind) {
+    int cap = entity_capacity(kind), was = kind_cap[kind];
+    if (cap <= was) return;
+    if (!(indexed_cell[kind] = realloc(indexed_cell[kind], cap * sizeof(int32_t))) ||
+        !(occupied_cells[kind] = realloc(occupied_cells[kind], cap * sizeof(int32_t))) ||
+        !(spatial_slots[kind] = realloc(spatial_slots[kind], cap * sizeof(uint16_t))) ||
+        !(grid_items[kind] = realloc(grid_items[kind], cap * sizeof(GridItem)))) {
+        perror("Failed to grow spatial index"); exit(1);
+    }
+    memset(&indexed_cell[kind][was], 0xff, (cap - was) * sizeof(int32_t));
+    kind_cap[kind] = cap;
+    int widest = 0;
+    for (int k = 0; k < SI_KINDS; k++) if (kind_cap[k] > widest) widest = kind_cap[k];
+    if (cap == widest && !(staged = realloc(staged, cap * sizeof(GridItem)))) { perror("Failed to grow spatial index"); exit(1); }
+}
+
+/* Refresh BPNBS code of one cell for LRS Display */
+static void refresh_cell_code(int i, int j, int l) {
+    QuadrantIndex qv = spatial_quadrant(i, j, l), *q = &qv;
+    int c_mon = (q->monster_count > 9) ? 9 : q->monster_count;
+    int c_rift = (q->rift_count > 9) ? 9 : q->rift_count;
+    int c_plat = (q->platform_count > 9) ? 9 : q->platform_count;
+    int c_buoy = (q->buoy_count > 9) ? 9 : q->buoy_count;
+    int c_mine = (q->mine_count > 9) ? 9 : q->mine_count;
+    int c_der = (q->derelict_count > 9) ? 9 : q->derelict_count;
+    int c_ast = (q->asteroid_count > 9) ? 9 : q->asteroid_count;
+    int c_com = (q->comet_count > 9) ? 9 : q->comet_count;
+    int c_pul = (q->pulsar_count > 9) ? 9 : q->pulsar_count;
+    int c_neb = (q->nebula_count > 9) ? 9 : q->nebula_count;
+    int c_bh = (q->bh_count > 9) ? 9 : q->bh_count;
+    int c_p = (q->planet_count > 9) ? 9 : q->planet_count;
+    int c_k = (q->npc_count + q->player_count) > 9 ? 9 : (q->npc_count + q->player_count);
+    int c_b = (q->base_count > 9) ? 9 : q->base_count;
+    int c_s = (q->star_count > 9) ? 9 : q->star_count;
+
+    galaxy_map_set(GALAXY_CELL(i, j, l), (long long)c_mon * 10000000000000000LL + (long long)c_rift * 100000000000000LL + (long long)c_plat * 10000000000000LL + (long long)c_buoy * 1000000000000LL + (long long)c_mine * 100000000000LL + (long long)c_der * 10000000000LL + (long long)c_ast * 1000000000LL + (long long)c_com * 100000000LL + c_pul * 1000000 + c_neb * 100000 + c_bh * 10000 + c_p * 1000 + c_k * 100 + c_b * 10 + c_s);
+}
+
+/* Full build: statics are indexed here once, everything after that is kept current by
+   update_spatial_index(). Also used after a load or a supernova reshapes a quadrant. */
+void init_static_spatial_index() {
+    if (!index_ready) {
+        /* A cell's runs for all kinds share one cache line */
+        spatial_runs = aligned_alloc(64, GALAXY_CELLS * sizeof(*spatial_runs));
+        cell_dirty = calloc(GALAXY_CELLS, sizeof(bool));
+        dirty_cells = malloc(GALAXY_CELLS * sizeof(int32_t));
+        cell_count = calloc(GALAXY_CELLS, sizeof(uint16_t));
+        if (spatial_runs) memset(spatial_runs, 0, GALAXY_CELLS * sizeof(*spatial_runs));
+        if (!spatial_runs || !cell_dirty || !dirty_cells || !cell_count) { perror("Failed to allocate spatial index runs"); exit(1); }
+        for (int i = 0; i < MAX_CLIENTS; i++) player_slots[i] = (uint16_t)i;
+        index_ready = true;
+    }
+    for (int kind = 0; kind < SI_KINDS; kind++) {
+        const uint16_t *slots;
+        int live = kind_slots(kind, &slots);
+        fit_kind(kind);
+        memset(indexed_cell[kind], 0xff, kind_cap[kind] * sizeof(int32_t));
+        for (int k = 0; k < live; k++) indexed_cell[kind][slots[k]] = entity_cell(kind, slots[k]);
+        build_kind(kind);
+    }
+    touched_count = 0;
+    touched_overflow = false;
+    for (int c = 0; c < dirty_count; c++) cell_dirty[dirty_cells[c]] = false;
+    dirty_count = 0;
+
+    for(int i=1; i<=galaxy_q; i++) for(int j=1; j<=galaxy_q; j++) for(int l=1; l<=galaxy_q; l++) refresh_cell_code(i, j, l);
+}
+
+void rebuild_spatial_index() {
+    init_static_spatial_index();
+}
+
+uint64_t spatial_kind_version(int kind) {
+    return kind_builds[kind];
+}
+
+void spatial_index_touch(int kind, int idx) {
+    if (touched_count >= SPATIAL_TOUCH_MAX) { touched_overflow = true; return; }
+    touched[touched_count].kind = kind;
+    touched[touched_count].idx = idx;
+    touched_count++;
+}
+
+/* Records the cell an entity belongs in, if that changed since it was indexed */
+static void reindex_entity(int kind, int i) {
+    int now = entity_cell(kind, i), was = indexed_cell[kind][i];
+    if (now == was) return;
+    indexed_cell[kind][i] = now;
+    mark_dirty(was);
+    mark_dirty(now);
+    kind_stale[kind] = true;
+    index_moves++;
+}
+
+/* Debug: every recorded cell must match where its body is now. The runs are derived from
+   the recorded cells alone, so a body out of place here is a spawn or death nobody touched. */
+static void spatial_index_check(void) {
+    index_checks++;
+    int drift = 0;
+    for (int kind = 0; kind < SI_KINDS; kind++) {
+        for (int i = 0; i < kind_cap[kind]; i++) {
+            int now = entity_cell(kind, i), was = indexed_cell[kind][i];
+            if (now == was) continue;
+            if (drift++ < 8) LOG_DEBUG("Spatial index drift: %s %d indexed in cell %d, belongs in %d\n",
+                                       kind_name[kind], i, was, now);
+        }
+    }
+    if (drift > 0) {
+        index_drifts += drift;
+        rebuild_spatial_index();
+    }
+}
+
+/* Per tick: only moving bodies and the ones reported through spatial_index_touch() are
+   looked at, a kind is re-sorted only if one of its bodies changed cell, and only the
+   cells they left or entered get a new BPNBS code. */
+void update_spatial_index() {
+    if (!index_ready) { init_static_spatial_index(); return; }
+    if (touched_overflow) { rebuild_spatial_index(); return; }
+    for (int kind = 0; kind < SI_KINDS; kind++) fit_kind(kind);
+
+    for (size_t m = 0; m < sizeof(moving_kinds) / sizeof(moving_kinds[0]); m++) {
+        const uint16_t *slots;
+        int live = kind_slots(moving_kinds[m], &slots);
+        for (int k = 0; k < live; k++) reindex_entity(moving_kinds[m], slots[k]);
+    }
+    for (int t = 0; t < touched_count; t++) reindex_entity(touched[t].kind, touched[t].idx);
+    touched_count = 0;
+    for (int kind = 0; kind < SI_KINDS; kind++) if (kind_stale[kind]) build_kind(kind);
+    /* Moving bodies change grid cell without changing quadrant */
+    for (size_t m = 0; m < sizeof(moving_kinds) / sizeof(moving_kinds[0]); m++) {
+        if (grid_built_tick[moving_kinds[m]] != global_tick) build_grid(moving_kinds[m]);
+    }
+
+    for (int c = 0; c < dirty_count; c++) {
+        int key = dirty_cells[c];
+        cell_dirty[key] = false;
+        int i = key / (GALAXY_SIDE * GALAXY_SIDE), j = (key / GALAXY_SIDE) % GALAXY_SIDE, l = key % GALAXY_SIDE;
+        if (i >= 1 && j >= 1 && l >= 1) refresh_cell_code(i, j, l);
+    }
+    dirty_count = 0;
+
+    if (g_debug && global_tick % SPATIAL_CHECK_TICKS == 0) spatial_index_check();
+}
+
+void log_spatial_stats(void) {
+    uint64_t builds = 0;
+    for (int kind = 0; kind < SI_KINDS; kind++) builds += kind_builds[kind];
+    LOG_DEBUG("Spatial index: %zu bytes, %llu moves, %llu run sorts (%llu npc), %llu checks, %llu drifted bodies\n",
+              spatial_index_bytes(), (unsigned long long)index_moves, (unsigned long long)builds,
+              (unsigned long long)kind_builds[SI_NPC], (unsigned long long)index_checks, (unsigned long long)index_drifts);
+    LOG_DEBUG("Proximity grid: %llu queries, %llu bodies tested, %llu hits, %llu linear scans, %llu result buffer growths (%d hits)\n",
+              (unsigned long long)grid_queries, (unsigned long long)grid_tested,
+              (unsigned long long)grid_hits, (unsigned long long)grid_linear, (unsigned long long)grid_grown, query_cap);
+}
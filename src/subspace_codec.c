@@ -0,0 +1,190 @@
+/*
+ * STARTREK ULTRA - 3D LOGIC ENGINE
+ * Authors: Nicola Taibi, Supported by Google Gemini
+ * Copyright (C) 2026 Nicola Taibi
+ * License: GNU General Public License v3.0
+ */
+
+#include <string.h>
+#include "subspace_codec.h"
+
+/* --- Shared Dictionary --- */
+
+/* Skeletons of the text reports a bridge requests most, taken from a live session.
+   Deflate favours the end of the dictionary, so the most frequent reports come last.
+   Client and server must carry the exact same bytes: changing this breaks the link
+   with older builds that negotiated LINK_CAP_COMPRESS. */
+static const char dict_text[] =
+    /* help */
+    "\033[36m\n"
+    "--- LCARS COMMAND DIRECTORY ---\033[0m\033[37mnav     \033[0m : Warp Navigation <H> <M> <W> [Factor]\n"
+    "\033[37mimp     \033[0m : Impulse Drive <H> <M> <S>\n"
+    "\033[37mjum     \033[0m : Wormhole Jump <Q1> <Q2> <Q3>\n"
+    "\033[37mapr     \033[0m : Approach target <ID> <DIST>\n"
+    "\033[37mcha     \033[0m : Chase locked target\n"
+    "\033[37msrs     \033[0m : Short Range Sensors\n"
+    "\033[37mlrs     \033[0m : Long Range Sensors\n"
+    "\033[37mpha     \033[0m : Fire Phasers <ID> <E> or <E> (Lock)\n"
+    "\033[37mtor     \033[0m : Fire Torpedo <H> <M> or auto (Lock)\n"
+    "\033[37mshe     \033[0m : Shield Configuration <F> <R> <T> <B> <L> <RI>\n"
+    "\033[37mlock    \033[0m : Target Lock-on <ID>\n"
+    "\033[37menc     \033[0m : Encryption Toggle <algo>\n"
+    "\033[37mpow     \033[0m : Power Allocation <E> <S> <W>\n"
+    "\033[37mpsy     \033[0m : Psychological Warfare (Bluff)\n"
+    "\033[37mscan    \033[0m : Detailed Scan <ID>\n"
+    "\033[37mclo     \033[0m : Cloaking Device\n"
+    "\033[37mbor     \033[0m : Boarding Party\n"
+    "\033[37mdis     \033[0m : Dismantle Wreck\n"
+    "\033[37mmin     \033[0m : Planetary Mining\n"
+    "\033[37mmac     \033[0m : Command Macros <def|del|list|NAME>\n"
+    "\033[37msco     \033[0m : Solar Scooping\n"
+    "\033[37mhar     \033[0m : Antimatter Harvest\n"
+    "\033[37mdoc     \033[0m : Dock at Starbase\n"
+    "\033[37mcon     \033[0m : Resource Converter\n"
+    "\033[37mload    \033[0m : Load Cargo\n"
+    "\033[37mrep     \033[0m : Repair Systems\n"
+    "\033[37msta     \033[0m : Status Report\n"
+    "\033[37minv     \033[0m : Inventory Report\n"
+    "\033[37mdam     \033[0m : Damage Report\n"
+    "\033[37mcal     \033[0m : Warp Calculator <QX><QY><QZ> [SX][SY][SZ]\n"
+    "\033[37mical    \033[0m : Impulse Calculator (ETA)\n"
+    "\033[37mwho     \033[0m : Active Captains List\n"
+    "\033[37mhelp    \033[0m : Display this directory\n"
+    "\033[37maux     \033[0m : Auxiliary (probe/report/recover)\n"
+    "\033[37mxxx     \033[0m : Self-Destruct\n"
+    "\033[37mhull    \033[0m : Reinforce Hull (100 Duranium)\n"
+    "\033[37msupernova\033[0m : Admin: Trigger Supernova\n"
+    /* aux */
+    "\n"
+    "\033[36m.--- COMMAND ASSISTANCE: aux -------------------.\033[0m\n"
+    "\033[37m USAGE:  \033[32maux <probe|report|recover>\033[0m\n"
+    " INFO:   Subspace probe management and mission reconnaissance.\n"
+    "\033[36m---------------------------------------------------\033[0m"
+    /* ical */
+    "\n"
+    "\033[36m.--- IMPULSE NAVIGATION COMPUTATION -------------.\033[0m\n"
+    " DESTINATION:  \033[37mSector [1.0, 1.0, 1.0]\033[0m\n"
+    " BEARING:      \033[32mHeading 315.0, Mark -35.3\033[0m\n"
+    " DISTANCE:     \033[33m6.93 Sector Units\033[0m\n"
+    " EST. TIME:    \033[35m0.06 seconds (at 100% Impulse)\033[0m\n"
+    "-------------------------------------------------"
+    /* cal */
+    "\n"
+    "\033[36m.--- NAVIGATIONAL COMPUTATION: PINPOINT PRECISION --.\033[0m\n"
+    " DESTINATION:  \033[37mQ[5,5,5] Sector [5.0,5.0,5.0]\033[0m\n"
+    " BEARING:      \033[32mHeading 236.3, Mark -29.0\033[0m\n"
+    " DISTANCE:     \033[33m4.12 Quadrants\033[0m\n"
+    "\n"
+    "\033[37m WARP FACTOR   EST. TIME      NOTES\033[0m\n"
+    " -----------   ---------      -----------------\n"
+    " Warp 1.0        41.2s      Minimum Warp\n"
+    " Warp 3.0        17.1s      Economic\n"
+    " Warp 6.0         9.8s      Standard Cruise\n"
+    " Warp 8.0         7.8s      High Pursuit\n"
+    " Warp 9.0         7.1s      Maximum Warp\n"
+    "-------------------------------------------------\n"
+    " Use 'nav 236.3 -29.0 4.12 [Factor]'"
+    /* who */
+    "\033[37m\n"
+    "--- ACTIVE CAPTAINS LOG ---\n"
+    "\033[0m [ 1] Sampler            (Q:8,3,7)\n"
+    /* inv */
+    "\033[33m\n"
+    "--- CARGO MANIFEST ---\n"
+    "\033[0m Dilithium       : 10  \n"
+    " Tritanium       : 0   \n"
+    " Verterium (Torp): 0   \n"
+    " Monotanium      : 0   \n"
+    " Isolinear       : 0   \n"
+    " Gases           : 0   \n"
+    " Duranium        : 0   \n"
+    " Prisoners       : 0   \n"
+    "\033[34m CARGO Antimatter: 0\n"
+    " CARGO Torpedoes:  0\n"
+    "\033[0m"
+    /* dam */
+    "\033[31m\n"
+    "--- DAMAGE REPORT ---\033[0m Warp      : 100.0%\n"
+    " Impulse   : 100.0%\n"
+    " Sensors   : 100.0%\n"
+    " Transp    : 100.0%\n"
+    " Phasers   : 100.0%\n"
+    " Torps     : 100.0%\n"
+    " Computer  : 100.0%\n"
+    " Life      : 100.0%\n"
+    /* sta */
+    "\033[36m\n"
+    ".--- LCARS MAIN COMPUTER: SHIP DIAGNOSTICS -----------------------.\n"
+    "\033[0m\033[37m COMMANDER: Sampler            CLASS: Constitution   \n"
+    " FACTION:   Federation         STATUS: \033[32m[ ACTIVE ]\033[0m\n"
+    " CREW COMPLEMENT: 430\n"
+    "\033[0m\033[34m\n"
+    "[ POSITION AND TELEMETRY ]\n"
+    "\033[0m QUADRANT: [8,3,7]  SECTOR: [5.00, 5.00, 5.00]\n"
+    " HEADING:  000\xc2\xb0        MARK:   +00\xc2\xb0\n"
+    " NAV MODE: [ NORMAL ]\n"
+    "\033[34m\n"
+    "[ POWER AND REACTOR STATUS ]\n"
+    "\033[0m MAIN REACTOR: [||||||||||||||||||||] 9999994 / 1000000 (1000.0%)\n"
+    " ALLOCATION:   ENGINES: 0%  SHIELDS: 0%  WEAPONS: 0%\n"
+    "\033[33m[ CARGO BAY - LOGISTICS ]\n"
+    "\033[0m CARGO ANTIMATTER: 0        CARGO TORPEDOES: 0  \n"
+    "\033[33m[ STORED MINERALS & RESOURCES ]\n"
+    "\033[0m DILITHIUM:  10     TRITANIUM:  0      VERTERIUM: 0     [WARHEADS]\n"
+    " MONOTANIUM: 0      ISOLINEAR:  0      GASES:     0    \n"
+    " DURANIUM:   0      PRISON UNIT: 0      PLATING:   0    \n"
+    "\033[34m\n"
+    "[ DEFENSIVE GRID AND ARMAMENTS ]\n"
+    "\033[0m SHIELDS: F:0    R:0    T:0    B:0    L:0    RI:0   \n"
+    " PHOTON TORPEDOES: 1000  LOCK: [ NONE ]\n"
+    "\033[34m\n"
+    "[ SYSTEMS INTEGRITY ]\n"
+    "\033[0m Warp    : \033[32m100.0%\033[0m  Imp     : \033[32m100.0%\033[0m  Sens    : \033[32m100.0%\033[0m  Tran    : \033[32m100.0%\033[0m \n"
+    " Phas    : \033[32m100.0%\033[0m  Torp    : \033[32m100.0%\033[0m  Comp    : \033[32m100.0%\033[0m  Life    : \033[32m100.0%\033[0m \033[36m\n"
+    "'-----------------------------------------------------------------'\n"
+    "\033[0m"
+;
+
+const int SUBSPACE_DICT_LEN = sizeof(dict_text) - 1;
+
+/* --- Codec --- */
+
+int subspace_compress(SubspaceCodec *sc, const uint8_t *in, int len, uint8_t *out, int cap) {
+    if (len < SUBSPACE_COMPRESS_MIN) return -1;
+    if (!sc->def_ready) {
+        memset(&sc->def, 0, sizeof(z_stream));
+        if (deflateInit2(&sc->def, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) return -1;
+        sc->def_ready = true;
+    } else if (deflateReset(&sc->def) != Z_OK) return -1;
+    if (deflateSetDictionary(&sc->def, (const Bytef *)dict_text, SUBSPACE_DICT_LEN) != Z_OK) return -1;
+
+    sc->def.next_in = (Bytef *)in;
+    sc->def.avail_in = len;
+    sc->def.next_out = out;
+    sc->def.avail_out = (cap < len) ? cap : len - 1; /* Give up as soon as it stops paying off */
+    if (deflate(&sc->def, Z_FINISH) != Z_STREAM_END) return -1;
+    return (int)sc->def.total_out;
+}
+
+int subspace_decompress(SubspaceCodec *sc, const uint8_t *in, int len, uint8_t *out, int cap) {
+    if (!sc->inf_ready) {
+        memset(&sc->inf, 0, sizeof(z_stream));
+        if (inflateInit2(&sc->inf, -15) != Z_OK) return -1;
+        sc->inf_ready = true;
+    } else if (inflateReset(&sc->inf) != Z_OK) return -1;
+    /* Raw streams carry no dictionary id: it is installed up front */
+    if (inflateSetDictionary(&sc->inf, (const Bytef *)dict_text, SUBSPACE_DICT_LEN) != Z_OK) return -1;
+
+    sc->inf.next_in = (Bytef *)in;
+    sc->inf.avail_in = len;
+    sc->inf.next_out = out;
+    sc->inf.avail_out = cap;
+    if (inflate(&sc->inf, Z_FINISH) != Z_STREAM_END) return -1;
+    return (int)sc->inf.total_out;
+}
+
+void subspace_codec_free(SubspaceCodec *sc) {
+    if (sc->def_ready) deflateEnd(&sc->def);
+    if (sc->inf_ready) inflateEnd(&sc->inf);
+    sc->def_ready = sc->inf_ready = false;
+}
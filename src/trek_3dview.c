@@ -22,7 +22,7 @@
 #include <pthread.h>
 #include "shared_state.h"
 
-#define IS_Q_VALID(q1,q2,q3) ((q1)>=1 && (q1)<=10 && (q2)>=1 && (q2)<=10 && (q3)>=1 && (q3)<=10)
+#define IS_Q_VALID(q1,q2,q3) ((q1)>=1 && (q1)<=g_galaxy_q && (q2)>=1 && (q2)<=g_galaxy_q && (q3)>=1 && (q3)<=g_galaxy_q)
 
 #include "network.h"
 
@@ -463,7 +463,14 @@ int g_show_axes = 0;
 int g_show_grid = 0;
 int g_show_map = 0;
 int g_my_q[3] = {1,1,1};
-int64_t g_galaxy[11][11][11];
+int g_galaxy_q = CHART_Q;
+int64_t g_galaxy[CHART_SIDE_MAX * CHART_SIDE_MAX * CHART_SIDE_MAX]; /* CHART_CELL(g_galaxy_q, ...) */
+
+/* Charted code of a quadrant, 0 outside the galaxy */
+static int64_t chart_value(int q1, int q2, int q3) {
+    if (!IS_Q_VALID(q1, q2, q3)) return 0;
+    return g_galaxy[CHART_CELL(g_galaxy_q, q1, q2, q3)];
+}
 int g_show_hud = 1; /* Default HUD ON */
 char g_quadrant[128] = "Scanning...";
 char g_last_quadrant[128] = "";
@@ -705,7 +712,9 @@ void loadGameState() {
         enterpriseZ = 5.0f - s1; /* Z in Trek is -Y in Viewer */
     }
 
-    memcpy(g_galaxy, g_shared_state->shm_galaxy, sizeof(g_galaxy));
+    g_galaxy_q = g_shared_state->shm_galaxy_q;
+    if (g_galaxy_q < 1 || g_galaxy_q > GALAXY_Q_MAX) g_galaxy_q = CHART_Q;
+    memcpy(g_galaxy, g_shared_state->shm_galaxy, (size_t)(g_galaxy_q + 1) * (g_galaxy_q + 1) * (g_galaxy_q + 1) * sizeof(int64_t));
 
     for(int p=0; p<3; p++) {
         g_local_probes[p].active = g_shared_state->probes[p].active;
@@ -2094,44 +2103,46 @@ void drawMonster(int type, float x, float y, float z) {
 
 void drawGalaxyMap() {
     glDisable(GL_LIGHTING);
-    float gap = 1.2f;
-    float offset = - (10.0f * gap) / 2.0f;
+    /* The map keeps the size of a 10x10x10 galaxy; larger ones shrink their cells to fit */
+    float gap = 12.0f / g_galaxy_q;
+    float cell = gap / 1.2f;
+    float offset = - (g_galaxy_q * gap) / 2.0f;
 
     /* Draw full grid frame */
     glColor4f(0.2f, 0.2f, 0.5f, 0.3f);
     glPushMatrix();
     glTranslatef(0, 0, 0);
-    glScalef(10.0f * gap, 10.0f * gap, 10.0f * gap);
+    glScalef(g_galaxy_q * gap, g_galaxy_q * gap, g_galaxy_q * gap);
     glutWireCube(1.0);
     glPopMatrix();
 
     /* Draw Vertex Coordinates for orientation */
     glColor3f(0.5f, 0.5f, 0.5f);
     char vbuf[32];
-    int v_coords[] = {1, 10};
+    int v_coords[] = {1, g_galaxy_q};
     for(int vz=0; vz<2; vz++) {
         for(int vy=0; vy<2; vy++) {
             for(int vx=0; vx<2; vx++) {
                 int cx = v_coords[vx], cy = v_coords[vy], cz = v_coords[vz];
                 float px = offset + cx * gap;
                 float py = offset + cz * gap;
-                float pz = offset + (11 - cy) * gap; /* Inverted Y for map display consistency */
+                float pz = offset + (g_galaxy_q + 1 - cy) * gap; /* Inverted Y for map display consistency */
                 sprintf(vbuf, "[%d,%d,%d]", cx, cy, cz);
                 drawText3D(px, py + 0.3f, pz, vbuf);
             }
         }
     }
 
-    for(int z=1; z<=10; z++) {
-        for(int y=1; y<=10; y++) {
-            for(int x=1; x<=10; x++) {
-                int64_t val = g_galaxy[x][y][z];
+    for(int z=1; z<=g_galaxy_q; z++) {
+        for(int y=1; y<=g_galaxy_q; y++) {
+            for(int x=1; x<=g_galaxy_q; x++) {
+                int64_t val = g_galaxy[CHART_CELL(g_galaxy_q, x, y, z)];
                 bool is_my_q = (x == g_my_q[0] && y == g_my_q[1] && z == g_my_q[2]);
                 if (val == 0 && !is_my_q) continue;
 
                 float px = offset + x * gap;
                 float py = offset + z * gap;
-                float pz = offset + (11 - y) * gap;
+                float pz = offset + (g_galaxy_q + 1 - y) * gap;
 
                 /* Color coding based on M|Su|R|T|B|M|D|A|C|S|Pu|N|BH|P|K|B|S (17 digits) */
                 int monster  = (val / 10000000000000000LL) % 10;
@@ -2153,6 +2164,7 @@ void drawGalaxyMap() {
 
                 glPushMatrix();
                 glTranslatef(px, py, pz);
+                glScalef(cell, cell, cell);
                 
                 if (is_my_q) {
                     /* Highlight current quadrant: Pulsing White + Label */
@@ -2167,7 +2179,7 @@ void drawGalaxyMap() {
                     /* Supernova Warning - Red Pulsing (Global Broadcast) */
                     float blink = (sin(pulse * 10.0f) + 1.0f) * 0.5f;
                     glColor4f(1.0f, 0.0f, 0.0f, 0.3f + blink * 0.5f);
-                    glutSolidCube(gap * 0.8f);
+                    glutSolidCube(1.2f * 0.8f); /* Drawn in cell scale */
                 }
 
                 if (storm > 0) {
@@ -2696,8 +2708,9 @@ void display() {
 
     /* Sky color pulse */
     float sn_intensity = 0.0f;
-    if (g_shared_state->shm_galaxy[g_shared_state->shm_q[0]][g_shared_state->shm_q[1]][g_shared_state->shm_q[2]] < 0) {
-        int timer = -g_shared_state->shm_galaxy[g_shared_state->shm_q[0]][g_shared_state->shm_q[1]][g_shared_state->shm_q[2]];
+    int64_t here = chart_value(g_shared_state->shm_q[0], g_shared_state->shm_q[1], g_shared_state->shm_q[2]);
+    if (here < 0) {
+        int timer = -here;
         sn_intensity = 0.3f + sin(pulse*10.0f) * 0.2f;
         if (timer < 300) sn_intensity += 0.3f; 
     }
@@ -3312,7 +3325,7 @@ void display() {
         ty -= 15;
     }
 
-    long long sn_val = g_shared_state->shm_galaxy[g_my_q[0]][g_my_q[1]][g_my_q[2]];
+    long long sn_val = chart_value(g_my_q[0], g_my_q[1], g_my_q[2]);
     if (g_show_hud && (g_sn_pos.active || sn_val < 0)) {
         /* Supernova Overlay - Centered and prominently Red */
         glMatrixMode(GL_PROJECTION); glPushMatrix(); glLoadIdentity(); gluOrtho2D(0, 1000, 0, 1000); 
@@ -9,6 +9,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <sys/socket.h>
@@ -24,9 +25,13 @@
 #include <openssl/evp.h>
 #include <openssl/pem.h>
 #include "network.h"
+#include "crypto_session.h"
+#include "subspace_codec.h"
 
 /* Pre-Shared Subspace Encryption Key (Loaded from ENV) */
 uint8_t SUBSPACE_KEY[32];
+CryptoSession g_crypto; /* Receive-side cipher contexts, rebound when SUBSPACE_KEY changes */
+SubspaceCodec g_codec;  /* Inflates PacketMessage text on links with LINK_CAP_COMPRESS */
 #include "shared_state.h"
 #include "ui.h"
 
@@ -90,6 +95,22 @@ char captain_name[64];
 int my_faction = 0;
 int g_debug = 0;
 
+/* Session Resume State */
+uint8_t MASTER_KEY[32];
+struct sockaddr_in g_server_addr;
+int g_ship_class = 0;
+uint64_t g_resume_token = 0;
+int64_t g_last_frame = 0;
+
+/* Capabilities the server granted at the last handshake. Once sealed updates are granted,
+   a plain PKT_UPDATE can only have been injected on the path. */
+uint32_t g_link_caps = 0;
+int64_t g_sealed_frame = 0;  /* Newest sealed update accepted on this link: replays are older */
+
+/* Spectator Mode: read-only feed, no player slot */
+int g_spectator = 0;
+PacketSpectate g_spectate_req;
+
 #define LOG_DEBUG(...) do { if (g_debug) { printf("DEBUG: " __VA_ARGS__); fflush(stdout); } } while (0)
 
 pid_t visualizer_pid = 0;
@@ -212,10 +233,482 @@ int write_all(int fd, const void *buf, size_t len) {
     return (int)total;
 }
 
+/* Inflates a message deflated by the server. Runs after decryption, on the exact bytes
+   the server compressed. */
+static void expand_message(PacketMessage *msg) {
+    if (!msg->is_compressed) return;
+    static char expanded[65536];
+    int len = subspace_decompress(&g_codec, (const uint8_t*)msg->text, msg->length, (uint8_t*)expanded, 65535);
+    if (len < 0) {
+        strcpy(msg->text, B_RED "<< ERROR: SUBSPACE DECOMPRESSION FAILED - CORRUPT FRAME >>" RESET);
+        msg->length = strlen(msg->text);
+        return;
+    }
+    memcpy(msg->text, expanded, len);
+    msg->text[len] = '\0';
+    msg->length = len;
+}
+
+/* Negotiates a fresh session key over fd using the Master Key. Returns 1 on success. */
+int establish_subspace_link(int fd) {
+    PacketHandshake h_pkt;
+    memset(&h_pkt, 0, sizeof(PacketHandshake));
+    h_pkt.type = PKT_HANDSHAKE;
+    h_pkt.pubkey_len = 32 + 32; /* 32 bytes Key + 32 bytes Signature */
+    
+    /* Generate Random Session Key */
+    FILE *f_rand = fopen("/dev/urandom", "rb");
+    if (f_rand) {
+        if (fread(h_pkt.pubkey, 1, 32, f_rand) != 32) { /* dummy read */ }
+        fclose(f_rand);
+    } else {
+        for(int k=0; k<32; k++) h_pkt.pubkey[k] = rand() % 255;
+    }
+    
+    /* Add Magic Signature for Server-side verification */
+    memcpy(h_pkt.pubkey + 32, HANDSHAKE_MAGIC_STRING, 32);
+
+    /* Store it locally as our new key */
+    uint8_t MY_SESSION_KEY[32];
+    memcpy(MY_SESSION_KEY, h_pkt.pubkey, 32);
+    
+    /* Obfuscate EVERYTHING (Key + Signature) using the Master Key (XOR) */
+    for(int k=0; k<64; k++) h_pkt.pubkey[k] ^= MASTER_KEY[k % 32];
+    h_pkt.caps = LINK_CAP_COMPRESS | LINK_CAP_SEALED_UPDATES;
+    
+    if (write_all(fd, &h_pkt, sizeof(PacketHandshake)) <= 0) return 0;
+    
+    /* Wait for server ACK to verify Master Key. Compressed frames are flagged per message;
+       sealed updates are enforced by the listener from the granted caps. */
+    PacketHandshakeAck ack;
+    if (read_all(fd, &ack, sizeof(PacketHandshakeAck)) <= 0 || ack.type != PKT_HANDSHAKE) return 0;
+    
+    /* Switch to the new Session Key */
+    memcpy(SUBSPACE_KEY, MY_SESSION_KEY, 32);
+    g_link_caps = ack.caps;
+    g_sealed_frame = 0;
+    return 1;
+}
+
+/* --- Galaxy Chart --- */
+
+int g_galaxy_q = CHART_Q;  /* Quadrants per axis, from the last PacketChart */
+
+/* Reads the PacketChart that follows every Galaxy Master. Returns it malloc'd, or NULL if
+   the link failed or the chart does not fit the galaxy it announces. */
+static PacketChart *read_chart(int fd) {
+    PacketChart head;
+    if (read_all(fd, &head, sizeof(PacketChart)) <= 0 || head.type != PKT_CHART) return NULL;
+    if (head.galaxy_q < 1 || head.galaxy_q > GALAXY_Q_MAX || head.count < 0 ||
+        head.count > head.galaxy_q * head.galaxy_q * head.galaxy_q) return NULL;
+    PacketChart *chart = malloc(sizeof(PacketChart) + head.count * sizeof(NetGalaxyCell));
+    if (!chart) return NULL;
+    *chart = head;
+    if (head.count > 0 && read_all(fd, chart->cells, head.count * sizeof(NetGalaxyCell)) <= 0) { free(chart); return NULL; }
+    return chart;
+}
+
+/* Charts one quadrant; coordinates outside the galaxy are ignored. Caller holds the shared state mutex. */
+static void chart_set(int q1, int q2, int q3, int64_t val) {
+    int q = g_shared_state->shm_galaxy_q;
+    if (q1 < 1 || q1 > q || q2 < 1 || q2 > q || q3 < 1 || q3 > q) return;
+    g_shared_state->shm_galaxy[CHART_CELL(q, q1, q2, q3)] = val;
+}
+
+/* Replaces the chart with a Galaxy Master and its PacketChart; without a chart only the
+   Master's corner is known. Caller holds the shared state mutex. */
+static void chart_load(const StarTrekGame *master, const PacketChart *chart) {
+    int q = chart ? chart->galaxy_q : CHART_Q;
+    int side = q < CHART_Q ? q : CHART_Q;
+    memset(g_shared_state->shm_galaxy, 0, (size_t)(q + 1) * (q + 1) * (q + 1) * sizeof(int64_t));
+    g_shared_state->shm_galaxy_q = q;
+    g_galaxy_q = q;
+    for(int i=1; i<=side; i++) for(int j=1; j<=side; j++) for(int l=1; l<=side; l++) chart_set(i, j, l, master->g[i][j][l]);
+    for (int c = 0; chart && c < chart->count; c++) chart_set(chart->cells[c].q1, chart->cells[c].q2, chart->cells[c].q3, chart->cells[c].val);
+}
+
+/* Reconnects after a dropped link. The server answers with the map cells changed since
+   g_last_frame, a full Galaxy Master if the gap is too large, or a rejection (e.g. after a
+   server restart) in which case we fall back to a regular login. Returns 1 on success. */
+int resume_session() {
+    for (int attempt = 1; attempt <= 5 && g_running; attempt++) {
+        sleep(1);
+        printf("\r\033[K" B_YELLOW "[NET] Re-establishing subspace link (attempt %d/5)...\n" RESET, attempt);
+
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) continue;
+        if (connect(fd, (struct sockaddr *)&g_server_addr, sizeof(g_server_addr)) < 0 || !establish_subspace_link(fd)) {
+            close(fd);
+            continue;
+        }
+
+        PacketResume rpkt;
+        memset(&rpkt, 0, sizeof(PacketResume));
+        rpkt.type = PKT_RESUME;
+        memcpy(rpkt.name, captain_name, sizeof(rpkt.name));
+        rpkt.token = g_resume_token;
+        rpkt.last_frame = g_last_frame;
+        write_all(fd, &rpkt, sizeof(PacketResume));
+
+        PacketResumeAck ack;
+        if (read_all(fd, &ack, sizeof(PacketResumeAck)) <= 0 || ack.type != PKT_RESUME) { close(fd); continue; }
+
+        static StarTrekGame full_sync;
+        static NetGalaxyCell cells[RESUME_MAX_DELTA_CELLS];
+        PacketChart *chart = NULL;
+        int ok = 1;
+        if (ack.status == RESUME_REJECTED) {
+            PacketLogin lpkt;
+            memset(&lpkt, 0, sizeof(PacketLogin));
+            lpkt.type = PKT_LOGIN;
+            memcpy(lpkt.name, captain_name, sizeof(lpkt.name));
+            lpkt.faction = my_faction;
+            lpkt.ship_class = g_ship_class;
+            write_all(fd, &lpkt, sizeof(PacketLogin));
+            ok = (read_all(fd, &full_sync, sizeof(StarTrekGame)) == sizeof(StarTrekGame)) && (chart = read_chart(fd)) &&
+                 (read_all(fd, &ack, sizeof(PacketResumeAck)) > 0 && ack.type == PKT_RESUME);
+        } else if (ack.status == RESUME_FULL) {
+            ok = (read_all(fd, &full_sync, sizeof(StarTrekGame)) == sizeof(StarTrekGame)) && (chart = read_chart(fd));
+        } else if (ack.cell_count < 0 || ack.cell_count > RESUME_MAX_DELTA_CELLS) {
+            ok = 0;
+        } else if (ack.cell_count > 0) {
+            ok = (read_all(fd, cells, ack.cell_count * sizeof(NetGalaxyCell)) > 0);
+        }
+        if (!ok) { free(chart); close(fd); continue; }
+
+        if (g_shared_state) {
+            pthread_mutex_lock(&g_shared_state->mutex);
+            if (ack.status == RESUME_DELTA) {
+                for (int c = 0; c < ack.cell_count; c++) chart_set(cells[c].q1, cells[c].q2, cells[c].q3, cells[c].val);
+            } else {
+                chart_load(&full_sync, chart);
+            }
+            /* A fresh login resets the server-side frequency to open channel */
+            if (ack.status == RESUME_REJECTED) g_shared_state->shm_crypto_algo = CRYPTO_NONE;
+            pthread_mutex_unlock(&g_shared_state->mutex);
+        }
+
+        free(chart);
+        g_resume_token = ack.token;
+        g_last_frame = ack.frame_id;
+        int old_sock = sock;
+        sock = fd;
+        close(old_sock);
+        LOG_DEBUG("Session resumed: %s, %d cells, frame %lld\n",
+                  ack.status == RESUME_DELTA ? "delta" : (ack.status == RESUME_FULL ? "full" : "relogin"),
+                  ack.cell_count, (long long)ack.frame_id);
+        return 1;
+    }
+    return 0;
+}
+
+/* --- Sensor Report Rendering --- */
+
+static char g_srs_filter[32] = ""; /* Contact type filter set by 'srs TYPE', empty shows all */
+
+static const char *species_name(int f) {
+    switch (f) {
+        case FACTION_FEDERATION: return "Federation";
+        case FACTION_KLINGON:    return "Klingon";
+        case FACTION_ROMULAN:    return "Romulan";
+        case FACTION_BORG:       return "Borg";
+        case FACTION_CARDASSIAN: return "Cardassian";
+        case FACTION_JEM_HADAR:  return "Jem'Hadar";
+        case FACTION_THOLIAN:    return "Tholian";
+        case FACTION_GORN:       return "Gorn";
+        case FACTION_FERENGI:    return "Ferengi";
+        case FACTION_SPECIES_8472: return "Species 8472";
+        case FACTION_BREEN:      return "Breen";
+        case FACTION_HIROGEN:    return "Hirogen";
+        default: return "Unknown";
+    }
+}
+
+static const char *contact_label(int kind) {
+    static const char *labels[] = {"?", "Vessel", "Vessel", "Starbase", "Planet", "Star", "B-Hole", "Nebula", "Pulsar",
+                                   "Comet", "Asteroid", "Monster", "Probe", "Derelict", "Platform", "Rift", "Buoy", "Mine"};
+    return (kind > 0 && kind <= CONTACT_MINE) ? labels[kind] : labels[0];
+}
+
+static const char *sensor_name(const NetSensorName *names, int count, int slot) {
+    for (int n = 0; n < count; n++) if (names[n].slot == slot) return names[n].name;
+    return "Unknown";
+}
+
+static void render_srs(const PacketSensor *pkt) {
+    const NetSensorName *names = (const NetSensorName *)pkt->data;
+    const NetSensorContact *cts = (const NetSensorContact *)(pkt->data + pkt->name_count * sizeof(NetSensorName));
+
+    printf(CYAN "\n--- SHORT RANGE SENSOR ANALYSIS ---" RESET "\nQUADRANT: [%d,%d,%d] | SECTOR: [%.1f,%.1f,%.1f]\n", pkt->q1, pkt->q2, pkt->q3, pkt->s1, pkt->s2, pkt->s3);
+    printf("ENERGY: %d | TORPEDOES: %d | STATUS: %s\n", pkt->energy, pkt->torpedoes, pkt->cloaked ? MAGENTA "CLOAKED" RESET : GREEN "NORMAL" RESET);
+    if (g_srs_filter[0]) printf("FILTER: %s\n", g_srs_filter);
+    printf("\nTYPE       ID    POSITION      DIST   H / M         DETAILS\n");
+
+    bool neighbor_header = false;
+    for (int k = 0; k < pkt->count; k++) {
+        const NetSensorContact *c = &cts[k];
+        const char *label = contact_label(c->kind);
+        if (g_srs_filter[0] && strncasecmp(label, g_srs_filter, strlen(g_srs_filter)) != 0) continue;
+
+        char detail[160];
+        switch (c->kind) {
+            case CONTACT_PLAYER:
+                snprintf(detail, sizeof(detail), "%s (Player) [E:%d]", sensor_name(names, pkt->name_count, c->owner), c->energy); break;
+            case CONTACT_NPC:
+                if (c->flags & CONTACT_F_NEIGHBOR) snprintf(detail, sizeof(detail), "%s (NPC)", species_name(c->faction));
+                else snprintf(detail, sizeof(detail), "%s [E:%d] [Engines:%d%%]", species_name(c->faction), c->energy, c->detail);
+                break;
+            case CONTACT_BASE:      snprintf(detail, sizeof(detail), "Federation Starbase"); break;
+            case CONTACT_PLANET:    snprintf(detail, sizeof(detail), "Class-M Planet"); break;
+            case CONTACT_STAR:      snprintf(detail, sizeof(detail), "Star"); break;
+            case CONTACT_BLACKHOLE: snprintf(detail, sizeof(detail), "Black Hole (Grav Pull)"); break;
+            case CONTACT_NEBULA:    snprintf(detail, sizeof(detail), "Mutara Nebula"); break;
+            case CONTACT_PULSAR:    snprintf(detail, sizeof(detail), "Pulsar (Radiation)"); break;
+            case CONTACT_COMET:     snprintf(detail, sizeof(detail), (c->flags & CONTACT_F_NEIGHBOR) ? "Comet" : "Comet (Energy Source)"); break;
+            case CONTACT_ASTEROID:  snprintf(detail, sizeof(detail), "Asteroid (Hazard)"); break;
+            case CONTACT_MONSTER:   snprintf(detail, sizeof(detail), "%s", (c->detail == 30) ? "Crystalline Entity" : "Space Amoeba"); break;
+            case CONTACT_PROBE:
+                snprintf(detail, sizeof(detail), "Subspace Probe (%s) %s", sensor_name(names, pkt->name_count, c->owner),
+                         (c->flags & CONTACT_F_DERELICT) ? RED "DERELICT" RESET : CYAN "ACTIVE" RESET);
+                break;
+            case CONTACT_DERELICT:  snprintf(detail, sizeof(detail), "Derelict Ship"); break;
+            case CONTACT_PLATFORM:  snprintf(detail, sizeof(detail), "Defense Platform"); break;
+            case CONTACT_RIFT:      snprintf(detail, sizeof(detail), "Spatial Rift"); break;
+            case CONTACT_BUOY:      snprintf(detail, sizeof(detail), "Comm Buoy"); break;
+            case CONTACT_MINE:      snprintf(detail, sizeof(detail), "Cloaked Mine"); break;
+            default:                snprintf(detail, sizeof(detail), "Unidentified Contact"); break;
+        }
+
+        if (c->flags & CONTACT_F_NEIGHBOR) {
+            if (!neighbor_header) {
+                printf(YELLOW "\n--- NEIGHBORHOOD SENSOR SCAN (Adjacent Quadrants) ---" RESET "\nTYPE       ID    QUADRANT      DIST   H / M         DETAILS\n");
+                neighbor_header = true;
+            }
+            printf("%-10s %-5d [%d,%d,%d] %-5.1f %03.0f / %+03.0f     %s\n", label, c->id, c->q1, c->q2, c->q3, c->dist, c->heading, c->mark, detail);
+        } else {
+            printf("%-10s %-5d [%.1f,%.1f,%.1f] %-5.1f %03.0f / %+03.0f     %s %s%s\n", label, c->id, c->x, c->y, c->z, c->dist, c->heading, c->mark, detail,
+                   (c->flags & CONTACT_F_LOCKED) ? RED "[LOCKED]" RESET : "", (c->flags & CONTACT_F_CHASE) ? B_RED "[CHASE]" RESET : "");
+        }
+    }
+    if (pkt->omitted > 0) printf(YELLOW "\nSENSOR BUFFER SATURATED: %d further contacts not shown.\n" RESET, pkt->omitted);
+}
+
+static void render_lrs(const PacketSensor *pkt) {
+    const NetLrsCell *cells = (const NetLrsCell *)pkt->data;
+    const char* section_names[] = {"[ GREEN TACTICAL ZONE ]", "[ YELLOW TACTICAL ZONE ]", "[ RED TACTICAL ZONE ]"};
+    const char* section_colors[] = {B_GREEN, B_YELLOW, B_RED};
+
+    printf(B_CYAN "\n.--- LCARS LONG RANGE TACTICAL SENSORS --------------------------------------.\n" RESET);
+    printf(WHITE " POS: [%d,%d,%d] SECTOR: [%.1f,%.1f,%.1f] | HDG: %03.0f MRK: %+03.0f\n" RESET,
+           pkt->q1, pkt->q2, pkt->q3, pkt->s1, pkt->s2, pkt->s3, pkt->heading, pkt->mark);
+    printf(B_CYAN "'------------------------------------------------------------------------------'\n" RESET);
+    printf(" DATA: [ H:B-Hole P:Planet N:NPC B:Base S:Star ]\n");
+    printf(" Symbols: ~:Nebula *:Pulsar +:Comet #:Asteroid M:Monster >:Rift\n\n");
+
+    /* Cells arrive as three 3x3 levels, top level first */
+    for (int section = 0; section < 3 && (section + 1) * 9 <= pkt->count; section++) {
+        const NetLrsCell *level = &cells[section * 9];
+        int nq3 = level[0].q3;
+        if (nq3 < 1 || nq3 > g_galaxy_q) continue;
+        printf("%s%s (Level Z:%d)" RESET "\n", section_colors[section], section_names[section], nq3);
+
+        for (int row = 0; row < 3; row++) {
+            char line1[1024] = "  ", line2[1024] = "  ";
+            for (int col = 0; col < 3; col++) {
+                const NetLrsCell *cell = &level[row * 3 + col];
+                char cell1[256], cell2[256];
+                if (!(cell->flags & LRS_F_VALID)) {
+                    strcpy(cell1, "  [ -,-,- ]  -------------   ");
+                    strcpy(cell2, "  [ . . . . . ]              ");
+                } else {
+                    long long v = cell->val;
+                    int s=v%10, b_cnt=(v/10)%10, k=(v/100)%10, p=(v/1000)%10, bh=(v/10000)%10;
+                    int neb=(v/100000)%10, pul=(v/1000000)%10, com=(v/100000000)%10, ast=(v/1000000000)%10;
+                    int mon=(v/10000000000000000LL)%10;
+                    int rift=(v/100000000000000LL)%10;
+
+                    /* LINE 1: COORDS & NAV */
+                    if (cell->flags & LRS_F_CURRENT)
+                        sprintf(cell1, B_BLUE "[ %d,%d,%d ]" RESET "  *- CURRENT -*   ", cell->q1, cell->q2, cell->q3);
+                    else if (cell->flags & LRS_F_NAV_LOST)
+                        sprintf(cell1, WHITE "[ \?,\?,\? ]" RESET "  \?\?\?/\?\?\?/W\?.\?  ");
+                    else
+                        sprintf(cell1, WHITE "[ %d,%d,%d ]" RESET "  %03.0f/%+03.0f/W%.1f  ", cell->q1, cell->q2, cell->q3, cell->heading, cell->mark, cell->dist/10.0);
+
+                    /* LINE 2: OBJECTS [ H P N B S ] */
+                    char h_s[32], p_s[32], n_s[32], b_s[32], s_s[32];
+                    if (cell->flags & LRS_F_ICONS_LOST) {
+                        strcpy(h_s, "?"); strcpy(p_s, "?"); strcpy(n_s, "?"); strcpy(b_s, "?"); strcpy(s_s, "?");
+                    } else {
+                        if(bh>0) sprintf(h_s, "%s%d" RESET, MAGENTA, bh); else strcpy(h_s, ".");
+                        if(p>0) sprintf(p_s, "%s%d" RESET, CYAN, p); else strcpy(p_s, ".");
+                        if(k>0) sprintf(n_s, "%s%d" RESET, RED, k); else strcpy(n_s, ".");
+                        if(b_cnt>0) sprintf(b_s, "%s%d" RESET, GREEN, b_cnt); else strcpy(b_s, ".");
+                        if(s>0) sprintf(s_s, "%s%d" RESET, YELLOW, s); else strcpy(s_s, ".");
+                    }
+
+                    char an[16] = "";
+                    if(neb>0) { strcat(an, "~"); } if(pul>0) { strcat(an, "*"); } if(com>0) { strcat(an, "+"); }
+                    if(ast>0) { strcat(an, "#"); } if(mon>0) { strcat(an, "M"); } if(rift>0) { strcat(an, ">"); }
+
+                    sprintf(cell2, "  [%s %s %s %s %s" RESET "] %-5s      ", h_s, p_s, n_s, b_s, s_s, an);
+                }
+                strcat(line1, cell1); strcat(line2, cell2);
+            }
+            printf("%s\n%s\n\n", line1, line2);
+        }
+    }
+    printf(B_CYAN "'------------------------------------------------------------------------------'\n" RESET);
+}
+
+static void render_scan(const PacketSensor *pkt) {
+    const NetScanReport *r = (const NetScanReport *)pkt->data;
+    switch (r->kind) {
+        case CONTACT_PLAYER: {
+            const char* sys[] = {"Warp", "Impulse", "Sensors", "Transp", "Phasers", "Torps", "Computer", "Life", "Shields", "Aux"};
+            printf(CYAN "\n--- SENSOR SCAN ANALYSIS: TARGET ID %d ---" RESET, r->target_id);
+            printf("COMMANDER: %.63s\n", r->name);
+            printf("ENERGY: %d | CREW: %d | TORPS: %d\n", r->energy, r->crew, r->torpedoes);
+            printf(BLUE "SYSTEMS STATUS:\n" RESET);
+            for (int s = 0; s < 10; s++) {
+                char bar[11]; int fills = (int)(r->system_health[s]/10.0f); for(int k=0; k<10; k++) bar[k]=(k<fills)?'|':'.'; bar[10]=0;
+                printf(" %-8s [%s] %.1f%%\n", sys[s], bar, r->system_health[s]);
+            }
+            break;
+        }
+        case CONTACT_NPC:
+            printf(CYAN "\n--- TACTICAL SCAN ANALYSIS: TARGET ID %d ---" RESET, r->target_id);
+            printf("SPECIES: %s\n", species_name(r->faction));
+            printf("ENERGY CORE: %d\n", r->energy);
+            printf("PROPULSION: %.1f%%\n", r->engine);
+            printf("BEHAVIOR: %s\n", (r->detail == 2) ? "RETREATING" : (r->detail == 1) ? "AGGRESSIVE" : "PATROLLING");
+            break;
+        case CONTACT_BASE:
+            printf(WHITE "\n--- FEDERATION STARBASE ANALYSIS ---" RESET "\nTYPE: Supply and Repair Outpost\nSTATUS: Active\nSERVICES: Full Repair, Torpedo Reload, Energy Recharge.\n");
+            break;
+        case CONTACT_PLANET: {
+            const char* res[] = {"-","Dilithium","Tritanium","Verterium","Monotanium","Isolinear","Gases","Duranium"};
+            printf(GREEN "\n--- PLANETARY SURVEY ---" RESET "\nTYPE: Class-M Habitable\nRESOURCE: %s\nRESERVES: %d units\n", (r->detail >= 0 && r->detail < 8) ? res[r->detail] : "-", r->amount);
+            break;
+        }
+        case CONTACT_STAR:
+            printf(YELLOW "\n--- STELLAR ANALYSIS ---" RESET "\nTYPE: Main Sequence G-Class Star\nLUMINOSITY: Standard\nADVISORY: Proximity scooping active (sco).\n");
+            break;
+        case CONTACT_BLACKHOLE:
+            printf(MAGENTA "\n--- SINGULARITY ANALYSIS ---" RESET "\nTYPE: Schwarzschild Black Hole\nEFFECT: Extreme Time-Dilation and Space Curvature.\nADVISORY: Significant gravitational pull detected within 3.0 units. Escape velocity required.\n");
+            break;
+        case CONTACT_NEBULA:
+            printf(BLUE "\n--- STELLAR PHENOMENON ANALYSIS ---" RESET "\nTYPE: Class-Mutara Nebula\nCOMPOSITION: Ionized Gases, Sensor-dampening particulates.\nEFFECT: Reduced sensor range, Shield regeneration inhibition.\n");
+            break;
+        case CONTACT_PULSAR:
+            printf(RED "\n--- WARNING: PULSAR DETECTED ---" RESET "\nTYPE: Rotating Neutron Star\nRADIATION: Extreme (Gamma/X-Ray)\nADVISORY: Maintain minimum safe distance 2.0. Shield failure imminent in proximity.\n");
+            break;
+        case CONTACT_COMET:
+            printf(CYAN "\n--- COMET TRACKING DATA ---" RESET "\nTYPE: Icy Nucleus / Ion Tail\nSPEED: Orbital Intercept possible.\nCOMPOSITION: Rare gases, frozen verterium.\n");
+            break;
+        case CONTACT_DERELICT:
+            printf(WHITE "\n--- DERELICT SENSOR LOG ---" RESET "\nTYPE: Abandoned Vessel\nINTEGRITY: Critical (Adrift)\nADVISORY: Boarding (bor) may recover valuable resources or tech.\n");
+            break;
+        case CONTACT_ASTEROID:
+            printf(WHITE "\n--- ASTEROID ANALYSIS ---" RESET "\nTYPE: Carbonaceous / Metallic\nEFFECT: Navigation hazard at high impulse/warp.\n");
+            break;
+        case CONTACT_PLATFORM:
+            printf(RED "\n--- DEFENSE PLATFORM TACTICAL ---" RESET "\nTYPE: Automated Weapon Sentry\nSTATUS: ACTIVE / HOSTILE\nENERGY CORE: %d\nCOOLDOWN: %d ticks\n", r->energy, r->amount);
+            break;
+        case CONTACT_MONSTER:
+            printf(MAGENTA "\n--- XENO-BIOLOGICAL ANALYSIS ---" RESET "\nTYPE: %s\nTHREAT LEVEL: EXTREME\nADVISORY: Conventional weapons effective but risky in close proximity.\n", (r->detail == 30) ? "Crystalline Entity" : "Space Amoeba");
+            break;
+        default:
+            printf("Unable to interpret sensor scan of ID %d.\n", r->target_id);
+            break;
+    }
+}
+
+/* Renders a binary alert code back into the bridge text the crew expects */
+static void format_alert(const NetAlert *a, char *out, size_t len) {
+    static const char *sys_names[] = {"WARP", "IMPULSE", "SENSORS", "TRANSPORTERS", "PHASERS", "TORPEDOES", "COMPUTER", "LIFE SUPPORT", "SHIELDS", "AUXILIARY"};
+    const char *sys = (a->p1 >= 0 && a->p1 < 10) ? sys_names[a->p1] : "UNKNOWN";
+    switch (a->code) {
+        case ALERT_GRAVITY_SHEAR: snprintf(out, len, "Extreme gravitational shear detected! Hull integrity at risk."); break;
+        case ALERT_NEBULA_DRAIN: snprintf(out, len, "Alert: Nebular interference draining shields."); break;
+        case ALERT_PULSAR_RADIATION: snprintf(out, len, "Radiation Critical! Shield Integrity Failing. (Dmg: %d)", a->p1); break;
+        case ALERT_SICKBAY_RADIATION: snprintf(out, len, "RADIATION ALERT! EQUIPMENT FAILURE IN SICKBAY!"); break;
+        case ALERT_ASTEROID_COLLISION: snprintf(out, len, "Colliding with asteroids! Reduce speed!"); break;
+        case ALERT_COMET_GAS: snprintf(out, len, "Collecting rare gases from comet tail."); break;
+        case ALERT_AMOEBA_DRAIN: snprintf(out, len, "SPACE AMOEBA ADHERING TO HULL! ENERGY DRAIN CRITICAL!"); break;
+        case ALERT_CRYSTALLINE_RESONANCE: snprintf(out, len, "CRYSTALLINE RESONANCE DETECTED! SHIELDS BUCKLING!"); break;
+        case ALERT_LIFE_SUPPORT_CASUALTIES: snprintf(out, len, "Warning: Casualties reported due to life support instability."); break;
+        case ALERT_HULL_SYSTEM_HIT: snprintf(out, len, "CRITICAL: Impact on bare hull! %s system damaged!", sys); break;
+        case ALERT_PLATFORM_ATTACK: snprintf(out, len, "UNDER ATTACK BY DEFENSE PLATFORM!"); break;
+        case ALERT_PLATFORM_SYSTEM_HIT: snprintf(out, len, "Platform hit bypassed shields! System damage detected!"); break;
+        case ALERT_TORPEDO_HIT: snprintf(out, len, "HIT BY PHOTON TORPEDO!"); break;
+        case ALERT_TORPEDO_SYSTEM_HIT: snprintf(out, len, "SYSTEM ALERT: Torpedo impact caused critical failure in %s!", sys); break;
+        case ALERT_WARP_ENGAGED: snprintf(out, len, "Warp drive engaged. Velocity: Warp %.1f. ETA: %.1f seconds.", a->p1 / 10.0, a->p2 / 30.0); break;
+        case ALERT_IMPULSE_ENGAGED: snprintf(out, len, "Impulse engaged at %d%%.", a->p1); break;
+        case ALERT_SHIP_ALIGNED: snprintf(out, len, "Stabilization complete. Ship aligned."); break;
+        case ALERT_WORMHOLE_EXOTIC_MATTER: snprintf(out, len, "Injecting exotic matter into local Schwarzschild metric..."); break;
+        case ALERT_WORMHOLE_BRIDGE: snprintf(out, len, "Einstein-Rosen Bridge detected. Stabilizing singularity..."); break;
+        case ALERT_WORMHOLE_ENTRY: snprintf(out, len, "Wormhole mouth stable. Entering event horizon."); break;
+        case ALERT_WORMHOLE_STABILIZED: snprintf(out, len, "Wormhole stabilized in target sector. Maintaining hull integrity."); break;
+        case ALERT_WORMHOLE_ARRIVAL: snprintf(out, len, "Wormhole traversal successful. Welcome to destination."); break;
+        default: snprintf(out, len, "Unknown alert code %u.", a->code); break;
+    }
+}
+
+/* Sealed updates are opened into this buffer and then parsed exactly like the plain stream */
+static uint8_t *g_open_buf = NULL;
+static size_t g_open_len = 0, g_open_pos = 0;
+
+static int update_read(void *dst, size_t n, bool sealed) {
+    if (!sealed) return read_all(sock, dst, n);
+    if (g_open_pos + n > g_open_len) return -1;
+    memcpy(dst, g_open_buf + g_open_pos, n);
+    g_open_pos += n;
+    return (int)n;
+}
+
+/* Reads and authenticates a PKT_UPDATE_SEALED frame. Returns 1 when the plaintext update is
+   ready for update_read(), 0 when the frame was rejected, -1 when the link failed. */
+static int open_sealed_update(void) {
+    const size_t max_frame = sizeof(PacketUpdate) + MAX_FX_EVENTS * sizeof(NetFxEvent);
+    static PacketSealedUpdate hdr;
+    if (!g_open_buf && !(g_open_buf = malloc(2 * max_frame))) { perror("malloc failed"); exit(1); }
+    uint8_t *cipher = g_open_buf + max_frame;
+    if (read_all(sock, ((char*)&hdr) + sizeof(int32_t), sizeof(PacketSealedUpdate) - sizeof(int32_t)) <= 0) return -1;
+    if (hdr.length <= 0 || (size_t)hdr.length > max_frame) {
+        LOG_DEBUG("Invalid sealed update length: %d\n", hdr.length);
+        return -1;
+    }
+    if (read_all(sock, cipher, hdr.length) <= 0) return -1;
+
+    crypto_session_bind(&g_crypto, SUBSPACE_KEY);
+    int len = crypto_session_decrypt(&g_crypto, CRYPTO_AES, hdr.iv, hdr.tag, cipher, hdr.length, g_open_buf);
+    int32_t inner = 0;
+    if (len >= (int)offsetof(PacketUpdate, objects)) memcpy(&inner, g_open_buf, sizeof(inner));
+    if (inner != PKT_UPDATE) {
+        LOG_DEBUG("Sealed update failed authentication, frame dropped\n");
+        return 0;
+    }
+    int64_t frame_id;
+    memcpy(&frame_id, g_open_buf + offsetof(PacketUpdate, frame_id), sizeof(frame_id));
+    if (frame_id <= g_sealed_frame) {
+        LOG_DEBUG("Sealed update for frame %lld replayed, frame dropped\n", (long long)frame_id);
+        return 0;
+    }
+    g_sealed_frame = frame_id;
+    g_open_len = len;
+    g_open_pos = sizeof(int32_t);
+    return 1;
+}
+
 void *network_listener(void *arg) {
     while (g_running) {
         int type;
         int r = read_all(sock, &type, sizeof(int));
+        if (r <= 0 && g_resume_token != 0 && resume_session()) {
+            reprint_prompt();
+            continue;
+        }
         if (r <= 0) {
             g_running = 0;
             disable_raw_mode();
@@ -225,17 +718,18 @@ void *network_listener(void *arg) {
         }
         
         if (type == PKT_MESSAGE) {
-            PacketMessage *msg = malloc(sizeof(PacketMessage));
-            if (!msg) { perror("malloc failed"); exit(1); }
+            /* One receive buffer for the listener's lifetime, not 65KB per message */
+            static PacketMessage *msg = NULL;
+            if (!msg && !(msg = malloc(sizeof(PacketMessage)))) { perror("malloc failed"); exit(1); }
             msg->type = type;
             size_t fixed_size = offsetof(PacketMessage, text);
             if (read_all(sock, ((char*)msg) + sizeof(int), fixed_size - sizeof(int)) <= 0) {
-                free(msg); g_running = 0; break;
+                g_running = 0; break;
             }
             
             if (msg->length > 0) {
                 if (read_all(sock, msg->text, msg->length) <= 0) {
-                    free(msg); g_running = 0; break;
+                    g_running = 0; break;
                 }
                 
                 if (msg->is_encrypted) {
@@ -243,47 +737,20 @@ void *network_listener(void *arg) {
                         /* 1. Reverse Rotating Frequency offuscation on IV using packet's embedded frame */
                         for(int i=0; i<8; i++) msg->iv[i] ^= ((msg->origin_frame >> (i*8)) & 0xFF);
 
-                        /* 2. Decrypt the payload */
+                        /* 2. Decrypt the payload with the cached context for this algorithm */
                         char decrypted[65536];
-                        EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
-                        
-                        const EVP_CIPHER *cipher;
-                        int is_gcm = 0;
-                        if (msg->crypto_algo == CRYPTO_CHACHA) { cipher = EVP_chacha20_poly1305(); is_gcm = 1; }
-                        else if (msg->crypto_algo == CRYPTO_ARIA) { cipher = EVP_aria_256_gcm(); is_gcm = 1; }
-                        else if (msg->crypto_algo == CRYPTO_CAMELLIA) { cipher = EVP_camellia_256_ctr(); is_gcm = 0; }
-                        else if (msg->crypto_algo == CRYPTO_SEED) { cipher = EVP_seed_cbc(); is_gcm = 0; }
-                        else if (msg->crypto_algo == CRYPTO_CAST5) { cipher = EVP_cast5_cbc(); is_gcm = 0; }
-                        else if (msg->crypto_algo == CRYPTO_IDEA) { cipher = EVP_idea_cbc(); is_gcm = 0; }
-                        else if (msg->crypto_algo == CRYPTO_3DES) { cipher = EVP_des_ede3_cbc(); is_gcm = 0; }
-                        else if (msg->crypto_algo == CRYPTO_BLOWFISH) { cipher = EVP_bf_cbc(); is_gcm = 0; }
-                        else if (msg->crypto_algo == CRYPTO_RC4) { cipher = EVP_rc4(); is_gcm = 0; }
-                        else if (msg->crypto_algo == CRYPTO_DES) { cipher = EVP_des_cbc(); is_gcm = 0; }
-                        else if (msg->crypto_algo == CRYPTO_PQC) { cipher = EVP_aes_256_gcm(); is_gcm = 1; }
-                        else { cipher = EVP_aes_256_gcm(); is_gcm = 1; }
-                        
-                        const uint8_t *k = SUBSPACE_KEY; /* Client currently uses Master Key */
-                        
-                        EVP_DecryptInit_ex(ctx, cipher, NULL, k, msg->iv);
-                        
-                        int outlen;
-                        EVP_DecryptUpdate(ctx, (uint8_t*)decrypted, &outlen, (const uint8_t*)msg->text, msg->length);
-                        
-                        if (is_gcm) {
-                            EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, 16, msg->tag);
-                        }
-                        
-                        int final_len;
-                        if (EVP_DecryptFinal_ex(ctx, (uint8_t*)decrypted + outlen, &final_len) > 0) {
-                            int total_len = outlen + final_len;
+                        crypto_session_bind(&g_crypto, SUBSPACE_KEY);
+                        int total_len = crypto_session_decrypt(&g_crypto, msg->crypto_algo, msg->iv, msg->tag,
+                                                               (const uint8_t*)msg->text, msg->length, (uint8_t*)decrypted);
+                        if (total_len >= 0) {
                             if (total_len > 65535) total_len = 65535;
                             memcpy(msg->text, decrypted, total_len);
                             msg->text[total_len] = '\0';
                             msg->length = total_len;
+                            expand_message(msg);
                         } else {
                             strcpy(msg->text, B_RED "<< ERROR: SUBSPACE DECRYPTION FAILED - FREQUENCY MISMATCH OR INVALID KEY >>" RESET);
                         }
-                        EVP_CIPHER_CTX_free(ctx);
                     } else if (g_shared_state && g_shared_state->shm_crypto_algo != CRYPTO_NONE) {
                         /* Encryption protocol mismatch (e.g. Captain listening on AES but incoming is ChaCha) */
                         char noise[128];
@@ -308,6 +775,7 @@ void *network_listener(void *arg) {
                 } else {
                     /* Plaintext message, just null terminate */
                     if (msg->length < 65536) msg->text[msg->length] = '\0';
+                    expand_message(msg);
                 }
             } else msg->text[0] = '\0';
             
@@ -339,16 +807,67 @@ void *network_listener(void *arg) {
                        msg->from, 
                        (msg->faction == FACTION_FEDERATION) ? "Starfleet" : "Alien", msg->text);
             }
-            free(msg);
             reprint_prompt();
-        } else if (type == PKT_UPDATE) {
+        } else if (type == PKT_ALERT) {
+            int32_t count;
+            if (read_all(sock, &count, sizeof(count)) <= 0) break;
+            if (count < 0 || count > ALERT_COUNT) {
+                LOG_DEBUG("Invalid alert count received: %d\n", count);
+                break;
+            }
+            NetAlert alerts[ALERT_COUNT];
+            if (count > 0 && read_all(sock, alerts, count * sizeof(NetAlert)) <= 0) break;
+
+            printf("\r\033[K");
+            for (int a = 0; a < count; a++) {
+                char line[160];
+                format_alert(&alerts[a], line, sizeof(line));
+                if (alerts[a].repeat > 1) printf("%s (x%u)\n", line, alerts[a].repeat);
+                else printf("%s\n", line);
+            }
+            reprint_prompt();
+        } else if (type == PKT_SENSOR) {
+            static PacketSensor spkt;
+            spkt.type = type;
+            size_t hdr = offsetof(PacketSensor, data);
+            if (read_all(sock, ((char*)&spkt) + sizeof(int32_t), hdr - sizeof(int32_t)) <= 0) break;
+
+            size_t rec = (spkt.report == SENSOR_SRS) ? sizeof(NetSensorContact) :
+                         (spkt.report == SENSOR_LRS) ? sizeof(NetLrsCell) :
+                         (spkt.report == SENSOR_SCAN) ? sizeof(NetScanReport) : 0;
+            int max_count = (spkt.report == SENSOR_SRS) ? MAX_SENSOR_CONTACTS : (spkt.report == SENSOR_LRS) ? LRS_CELLS : 1;
+            if (rec == 0 || spkt.count < 0 || spkt.count > max_count || spkt.name_count < 0 || spkt.name_count > MAX_CLIENTS) {
+                LOG_DEBUG("Invalid sensor report: kind %d, %d records, %d names\n", spkt.report, spkt.count, spkt.name_count);
+                break;
+            }
+            size_t payload = spkt.name_count * sizeof(NetSensorName) + spkt.count * rec;
+            if (payload > 0 && read_all(sock, spkt.data, payload) <= 0) break;
+
+            printf("\r\033[K");
+            if (spkt.report == SENSOR_SRS) render_srs(&spkt);
+            else if (spkt.report == SENSOR_LRS) render_lrs(&spkt);
+            else if (spkt.count == 1) render_scan(&spkt);
+            reprint_prompt();
+        } else if (type == PKT_UPDATE || type == PKT_UPDATE_SEALED) {
+            bool sealed = (type == PKT_UPDATE_SEALED);
+            /* Spectator feeds are never sealed, whatever the handshake granted */
+            if (!sealed && !g_spectator && (g_link_caps & LINK_CAP_SEALED_UPDATES)) {
+                printf("\r\033[K" B_RED "[SECURITY] Unsealed update on a sealed link. Dropping the link.\n" RESET);
+                shutdown(sock, SHUT_RDWR);
+                continue;
+            }
+            if (sealed) {
+                int o = open_sealed_update();
+                if (o < 0) break;
+                if (o == 0) continue;
+            }
             PacketUpdate upd;
             memset(&upd, 0, sizeof(PacketUpdate));
-            upd.type = type;
+            upd.type = PKT_UPDATE;
             
             /* Read fixed part up to object_count field */
             size_t fixed_size = offsetof(PacketUpdate, objects);
-            int r_fixed = read_all(sock, ((char*)&upd) + sizeof(int32_t), fixed_size - sizeof(int32_t));
+            int r_fixed = update_read(((char*)&upd) + sizeof(int32_t), fixed_size - sizeof(int32_t), sealed);
             
             if (r_fixed <= 0) {
                 LOG_DEBUG("Failed to read PacketUpdate header. Read: %d, Expected: %zu\n", r_fixed, fixed_size - sizeof(int32_t));
@@ -365,13 +884,27 @@ void *network_listener(void *arg) {
                 break;
             }
 
+            g_last_frame = upd.frame_id;
+
             /* Read active objects only */
             int r_objs = 0;
             if (upd.object_count > 0) {
-                r_objs = read_all(sock, upd.objects, upd.object_count * sizeof(NetObject));
+                r_objs = update_read(upd.objects, upd.object_count * sizeof(NetObject), sealed);
                 if (r_objs <= 0) break;
             }
 
+            /* Quadrant combat effects follow the objects */
+            static NetFxEvent fx[MAX_FX_EVENTS];
+            if (upd.fx_count < 0 || upd.fx_count > MAX_FX_EVENTS) {
+                LOG_DEBUG("Invalid fx_count received: %d\n", upd.fx_count);
+                break;
+            }
+            int r_fx = 0;
+            if (upd.fx_count > 0) {
+                r_fx = update_read(fx, upd.fx_count * sizeof(NetFxEvent), sealed);
+                if (r_fx <= 0) break;
+            }
+
             /* --- Telemetry Calculation --- */
             static long long bytes_this_sec = 0;
             static struct timespec last_ts = {0, 0};
@@ -392,7 +925,7 @@ void *network_listener(void *arg) {
             }
             last_packet_arrival = now_secs;
 
-            int current_pkt_size = r_fixed + r_objs + sizeof(int);
+            int current_pkt_size = r_fixed + r_objs + r_fx + sizeof(int);
             bytes_this_sec += current_pkt_size;
             packets_this_sec++;
 
@@ -470,9 +1003,7 @@ void *network_listener(void *arg) {
 
                 /* Update dynamic galaxy data (e.g. Ion Storms, Supernovas) */
                 int mq1 = upd.map_update_q[0], mq2 = upd.map_update_q[1], mq3 = upd.map_update_q[2];
-                if (mq1 >= 1 && mq1 <= 10 && mq2 >= 1 && mq2 <= 10 && mq3 >= 1 && mq3 <= 10) {
-                    g_shared_state->shm_galaxy[mq1][mq2][mq3] = upd.map_update_val;
-                }
+                chart_set(mq1, mq2, mq3, upd.map_update_val);
 
                 g_shared_state->object_count = upd.object_count;
                 for (int o=0; o < upd.object_count; o++) {
@@ -494,45 +1025,45 @@ void *network_listener(void *arg) {
                     g_shared_state->objects[o].active = 1;
                 }
                 
-                /* Append beams to shared state (Queue logic) */
-                if (upd.beam_count > 0) {
-                    for (int b=0; b < upd.beam_count; b++) {
+                /* Combat effects: beams queue up, explosions and wrecks latch until the viewer consumes them.
+                   Our own torpedo takes the single projectile slot when several are in flight. */
+                int my_id = (upd.object_count > 0) ? upd.objects[0].id : 0;
+                g_shared_state->torp.active = 0;
+                for (int f = 0; f < upd.fx_count; f++) {
+                    const NetFxEvent *ev = &fx[f];
+                    if (ev->kind == FX_BEAM) {
                         if (g_shared_state->beam_count < MAX_BEAMS) {
                             int idx = g_shared_state->beam_count;
-                            g_shared_state->beams[idx].shm_sx = upd.beams[b].net_sx;
-                            g_shared_state->beams[idx].shm_sy = upd.beams[b].net_sy;
-                            g_shared_state->beams[idx].shm_sz = upd.beams[b].net_sz;
-                            g_shared_state->beams[idx].shm_tx = upd.beams[b].net_tx;
-                            g_shared_state->beams[idx].shm_ty = upd.beams[b].net_ty;
-                            g_shared_state->beams[idx].shm_tz = upd.beams[b].net_tz;
-                            g_shared_state->beams[idx].active = upd.beams[b].active;
+                            g_shared_state->beams[idx].shm_sx = ev->x;
+                            g_shared_state->beams[idx].shm_sy = ev->y;
+                            g_shared_state->beams[idx].shm_sz = ev->z;
+                            g_shared_state->beams[idx].shm_tx = ev->tx;
+                            g_shared_state->beams[idx].shm_ty = ev->ty;
+                            g_shared_state->beams[idx].shm_tz = ev->tz;
+                            g_shared_state->beams[idx].active = 1;
                             g_shared_state->beam_count++;
                         }
+                    } else if (ev->kind == FX_TORPEDO) {
+                        if (!g_shared_state->torp.active || ev->source == my_id) {
+                            g_shared_state->torp.shm_x = ev->x;
+                            g_shared_state->torp.shm_y = ev->y;
+                            g_shared_state->torp.shm_z = ev->z;
+                            g_shared_state->torp.active = 1;
+                        }
+                    } else if (ev->kind == FX_BOOM) {
+                        g_shared_state->boom.shm_x = ev->x;
+                        g_shared_state->boom.shm_y = ev->y;
+                        g_shared_state->boom.shm_z = ev->z;
+                        g_shared_state->boom.active = 1;
+                    } else if (ev->kind == FX_DISMANTLE) {
+                        g_shared_state->dismantle.shm_x = ev->x;
+                        g_shared_state->dismantle.shm_y = ev->y;
+                        g_shared_state->dismantle.shm_z = ev->z;
+                        g_shared_state->dismantle.species = ev->detail;
+                        g_shared_state->dismantle.active = 1;
                     }
                 }
                 
-                /* Projectile position */
-                g_shared_state->torp.shm_x = upd.torp.net_x;
-                g_shared_state->torp.shm_y = upd.torp.net_y;
-                g_shared_state->torp.shm_z = upd.torp.net_z;
-                g_shared_state->torp.active = upd.torp.active;
-                
-                /* Event Latching */
-                if (upd.boom.active) {
-                    g_shared_state->boom.shm_x = upd.boom.net_x;
-                    g_shared_state->boom.shm_y = upd.boom.net_y;
-                    g_shared_state->boom.shm_z = upd.boom.net_z;
-                    g_shared_state->boom.active = 1;
-                }
-                
-                if (upd.dismantle.active) {
-                    g_shared_state->dismantle.shm_x = upd.dismantle.net_x;
-                    g_shared_state->dismantle.shm_y = upd.dismantle.net_y;
-                    g_shared_state->dismantle.shm_z = upd.dismantle.net_z;
-                    g_shared_state->dismantle.species = upd.dismantle.species;
-                    g_shared_state->dismantle.active = 1;
-                }
-                
                 /* Wormhole Event */
                 g_shared_state->wormhole.shm_x = upd.wormhole.net_x;
                 g_shared_state->wormhole.shm_y = upd.wormhole.net_y;
@@ -577,10 +1108,74 @@ void handle_sigint(int sig) {
     exit(0);
 }
 
+/* Asks for the captain's name, and for faction and class when the server does not know it, then logs in */
+void identify_captain() {
+    int my_ship_class = SHIP_CLASS_GENERIC_ALIEN;
+
+    /* Identification happens ONLY after secure link is established */
+    printf("Commander Name: "); 
+    if (scanf("%63s", captain_name) != 1) { strcpy(captain_name, "Captain"); }
+    clear_stdin();
+
+    /* Identity Check */
+    PacketLogin qpkt;
+    memset(&qpkt, 0, sizeof(PacketLogin));
+    qpkt.type = PKT_QUERY;
+    strcpy(qpkt.name, captain_name);
+    write_all(sock, &qpkt, sizeof(PacketLogin));
+    
+    int is_known = 0;
+    read_all(sock, &is_known, sizeof(int));
+
+    if (!is_known) {
+        printf("\n" B_WHITE "--- NEW RECRUIT IDENTIFIED ---" RESET "\n");
+        printf("--- SELECT YOUR FACTION ---\n");
+        printf(" 0: Federation\n 1: Klingon\n 2: Romulan\n 3: Borg\n 4: Cardassian\n 5: Jem'Hadar\n 6: Tholian\n 7: Gorn\n 8: Ferengi\n 9: Species 8472\n 10: Breen\n 11: Hirogen\nSelection: ");
+        int selection;
+        if (scanf("%d", &selection) != 1) { selection = 0; }
+        switch(selection) {
+            case 0: my_faction = FACTION_FEDERATION; break;
+            case 1: my_faction = FACTION_KLINGON; break;
+            case 2: my_faction = FACTION_ROMULAN; break;
+            case 3: my_faction = FACTION_BORG; break;
+            case 4: my_faction = FACTION_CARDASSIAN; break;
+            case 5: my_faction = FACTION_JEM_HADAR; break;
+            case 6: my_faction = FACTION_THOLIAN; break;
+            case 7: my_faction = FACTION_GORN; break;
+            case 8: my_faction = FACTION_FERENGI; break;
+            case 9: my_faction = FACTION_SPECIES_8472; break;
+            case 10: my_faction = FACTION_BREEN; break;
+            case 11: my_faction = FACTION_HIROGEN; break;
+            default: my_faction = FACTION_FEDERATION; break;
+        }
+        
+        if (my_faction == FACTION_FEDERATION) {
+            printf("\n" B_WHITE "--- SELECT YOUR CLASS ---" RESET "\n");
+            printf(" 0: Constitution\n 1: Miranda\n 2: Excelsior\n 3: Constellation\n 4: Defiant\n 5: Galaxy\n 6: Sovereign\n 7: Intrepid\n 8: Akira\n 9: Nebula\n 10: Ambassador\n 11: Oberth\n 12: Steamrunner\nSelection: ");
+            if (scanf("%d", &my_ship_class) != 1) { my_ship_class = 0; }
+        } else {
+            my_ship_class = SHIP_CLASS_GENERIC_ALIEN;
+        }
+        clear_stdin();
+    } else {
+        printf(B_CYAN "\n--- RETURNING CAPTAIN RECOGNIZED ---\n" RESET);
+    }
+
+    /* Final Login */
+    PacketLogin lpkt;
+    memset(&lpkt, 0, sizeof(PacketLogin));
+    lpkt.type = PKT_LOGIN;
+    strcpy(lpkt.name, captain_name);
+    lpkt.faction = my_faction;
+    lpkt.ship_class = my_ship_class;
+    
+    LOG_DEBUG("Sending login packet (%zu bytes)...\n", sizeof(PacketLogin));
+    write_all(sock, &lpkt, sizeof(PacketLogin));
+}
+
 int main(int argc, char *argv[]) {
     struct sockaddr_in serv_addr;
     char server_ip[64];
-    int my_ship_class = SHIP_CLASS_GENERIC_ALIEN;
     
     /* Security Initialization */
     char *env_key = getenv("TREK_SUB_KEY");
@@ -599,7 +1194,18 @@ int main(int argc, char *argv[]) {
 
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-d") == 0) g_debug = 1;
+        else if (strcmp(argv[i], "-s") == 0 && i + 3 < argc) {
+            g_spectator = 1;
+            g_spectate_req.mode = SPECTATE_QUADRANT;
+            g_spectate_req.q1 = atoi(argv[i+1]); g_spectate_req.q2 = atoi(argv[i+2]); g_spectate_req.q3 = atoi(argv[i+3]);
+            i += 3;
+        } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            g_spectator = 1;
+            g_spectate_req.mode = SPECTATE_CAPTAIN;
+            g_spectate_req.target_id = atoi(argv[++i]);
+        }
     }
+    g_spectate_req.type = PKT_SPECTATE;
 
     struct sigaction sa;
     sa.sa_handler = handle_ack;
@@ -669,106 +1275,25 @@ int main(int argc, char *argv[]) {
         printf("\nConnection Failed \n");
         return -1;
     }
+    g_server_addr = serv_addr;
 
     /* Handshake: Negotiate Unique Session Key */
-    PacketHandshake h_pkt;
-    memset(&h_pkt, 0, sizeof(PacketHandshake));
-    h_pkt.type = PKT_HANDSHAKE;
-    h_pkt.pubkey_len = 32 + 32; /* 32 bytes Key + 32 bytes Signature */
-    
-    /* Generate Random Session Key */
-    FILE *f_rand = fopen("/dev/urandom", "rb");
-    if (f_rand) {
-        if (fread(h_pkt.pubkey, 1, 32, f_rand) != 32) { /* dummy read */ }
-        fclose(f_rand);
-    } else {
-        for(int k=0; k<32; k++) h_pkt.pubkey[k] = rand() % 255;
-    }
-    
-    /* Add Magic Signature for Server-side verification */
-    memcpy(h_pkt.pubkey + 32, HANDSHAKE_MAGIC_STRING, 32);
-
-    /* Store it locally as our new key */
-    uint8_t MY_SESSION_KEY[32];
-    memcpy(MY_SESSION_KEY, h_pkt.pubkey, 32);
-    
-    /* Obfuscate EVERYTHING (Key + Signature) using the Master Key (XOR) */
-    for(int k=0; k<64; k++) h_pkt.pubkey[k] ^= SUBSPACE_KEY[k % 32];
-    
-    write_all(sock, &h_pkt, sizeof(PacketHandshake));
-    
-    /* Wait for server ACK to verify Master Key */
-    int ack_type = 0;
-    if (read_all(sock, &ack_type, sizeof(int)) <= 0 || ack_type != PKT_HANDSHAKE) {
+    memcpy(MASTER_KEY, SUBSPACE_KEY, 32);
+    if (!establish_subspace_link(sock)) {
         fprintf(stderr, B_RED "SECURITY ERROR: Master Key mismatch or Handshake rejected by server.\n" RESET);
         close(sock);
         exit(1);
     }
-    
-    /* Switch to the new Session Key */
-    memcpy(SUBSPACE_KEY, MY_SESSION_KEY, 32);
     printf(B_BLUE "Subspace Link Secured. Unique Frequency active.\n" RESET);
 
-    /* Identification happens ONLY after secure link is established */
-    printf("Commander Name: "); 
-    if (scanf("%63s", captain_name) != 1) { strcpy(captain_name, "Captain"); }
-    clear_stdin();
-
-    /* Identity Check */
-    PacketLogin qpkt;
-    memset(&qpkt, 0, sizeof(PacketLogin));
-    qpkt.type = PKT_QUERY;
-    strcpy(qpkt.name, captain_name);
-    write_all(sock, &qpkt, sizeof(PacketLogin));
-    
-    int is_known = 0;
-    read_all(sock, &is_known, sizeof(int));
-
-    if (!is_known) {
-        printf("\n" B_WHITE "--- NEW RECRUIT IDENTIFIED ---" RESET "\n");
-        printf("--- SELECT YOUR FACTION ---\n");
-        printf(" 0: Federation\n 1: Klingon\n 2: Romulan\n 3: Borg\n 4: Cardassian\n 5: Jem'Hadar\n 6: Tholian\n 7: Gorn\n 8: Ferengi\n 9: Species 8472\n 10: Breen\n 11: Hirogen\nSelection: ");
-        int selection;
-        if (scanf("%d", &selection) != 1) { selection = 0; }
-        switch(selection) {
-            case 0: my_faction = FACTION_FEDERATION; break;
-            case 1: my_faction = FACTION_KLINGON; break;
-            case 2: my_faction = FACTION_ROMULAN; break;
-            case 3: my_faction = FACTION_BORG; break;
-            case 4: my_faction = FACTION_CARDASSIAN; break;
-            case 5: my_faction = FACTION_JEM_HADAR; break;
-            case 6: my_faction = FACTION_THOLIAN; break;
-            case 7: my_faction = FACTION_GORN; break;
-            case 8: my_faction = FACTION_FERENGI; break;
-            case 9: my_faction = FACTION_SPECIES_8472; break;
-            case 10: my_faction = FACTION_BREEN; break;
-            case 11: my_faction = FACTION_HIROGEN; break;
-            default: my_faction = FACTION_FEDERATION; break;
-        }
-        
-        if (my_faction == FACTION_FEDERATION) {
-            printf("\n" B_WHITE "--- SELECT YOUR CLASS ---" RESET "\n");
-            printf(" 0: Constitution\n 1: Miranda\n 2: Excelsior\n 3: Constellation\n 4: Defiant\n 5: Galaxy\n 6: Sovereign\n 7: Intrepid\n 8: Akira\n 9: Nebula\n 10: Ambassador\n 11: Oberth\n 12: Steamrunner\nSelection: ");
-            if (scanf("%d", &my_ship_class) != 1) { my_ship_class = 0; }
-        } else {
-            my_ship_class = SHIP_CLASS_GENERIC_ALIEN;
-        }
-        clear_stdin();
+    if (g_spectator) {
+        /* Spectators skip identification: subscribe and receive the Galaxy Master directly */
+        strcpy(captain_name, "SPECTATOR");
+        write_all(sock, &g_spectate_req, sizeof(PacketSpectate));
     } else {
-        printf(B_CYAN "\n--- RETURNING CAPTAIN RECOGNIZED ---\n" RESET);
+        identify_captain();
     }
 
-    /* Final Login */
-    PacketLogin lpkt;
-    memset(&lpkt, 0, sizeof(PacketLogin));
-    lpkt.type = PKT_LOGIN;
-    strcpy(lpkt.name, captain_name);
-    lpkt.faction = my_faction;
-    lpkt.ship_class = my_ship_class;
-    
-    LOG_DEBUG("Sending login packet (%zu bytes)...\n", sizeof(PacketLogin));
-    write_all(sock, &lpkt, sizeof(PacketLogin));
-
     /* Ricezione Galassia Master (Sincronizzazione iniziale) */
     StarTrekGame master_sync;
     memset(&master_sync, 0, sizeof(StarTrekGame));
@@ -776,8 +1301,9 @@ int main(int argc, char *argv[]) {
     LOG_DEBUG("Client StarTrekGame size: %zu bytes\n", sizeof(StarTrekGame));
     LOG_DEBUG("Client PacketUpdate size: %zu bytes\n", sizeof(PacketUpdate));
     LOG_DEBUG("Waiting for Galaxy Master...\n");
-    if (read_all(sock, &master_sync, sizeof(StarTrekGame)) == sizeof(StarTrekGame)) {
-        printf(B_GREEN "Galaxy Map synchronized.\n" RESET);
+    PacketChart *chart = NULL;
+    if (read_all(sock, &master_sync, sizeof(StarTrekGame)) == sizeof(StarTrekGame) && (chart = read_chart(sock))) {
+        printf(B_GREEN "Galaxy Map synchronized (%dx%dx%d quadrants).\n" RESET, chart->galaxy_q, chart->galaxy_q, chart->galaxy_q);
         LOG_DEBUG("Received Encryption Flags: 0x%08X\n", master_sync.encryption_flags);
         if (master_sync.encryption_flags & 0x01) {
             printf(B_CYAN "[SECURE] Subspace Signature: " B_GREEN "VERIFIED (HMAC-SHA256)\n" RESET);
@@ -786,6 +1312,12 @@ int main(int argc, char *argv[]) {
             printf("... [ACTIVE]\n" RESET);
             printf(B_CYAN "[SECURE] Encryption Layer:   " B_GREEN "AES-GCM + PQC (Quantum Ready)\n" RESET);
         }
+        /* Session token for resuming after a dropped link */
+        PacketResumeAck sess;
+        if (!g_spectator && read_all(sock, &sess, sizeof(PacketResumeAck)) > 0 && sess.type == PKT_RESUME) {
+            g_resume_token = sess.token;
+            g_last_frame = sess.frame_id;
+        }
     } else {
         printf(B_RED "ERROR: Failed to synchronize Galaxy Map.\n" RESET);
     }
@@ -795,13 +1327,14 @@ int main(int argc, char *argv[]) {
     /* Copy Galaxy Master to SHM for 3D Map View */
     if (g_shared_state) {
         pthread_mutex_lock(&g_shared_state->mutex);
-        memcpy(g_shared_state->shm_galaxy, master_sync.g, sizeof(master_sync.g));
+        chart_load(&master_sync, chart);
         g_shared_state->shm_crypto_algo = CRYPTO_NONE;
         g_shared_state->shm_encryption_flags = master_sync.encryption_flags;
         memcpy(g_shared_state->shm_server_signature, master_sync.server_signature, 64);
         memcpy(g_shared_state->shm_server_pubkey, master_sync.server_pubkey, 32);
         pthread_mutex_unlock(&g_shared_state->mutex);
     }
+    free(chart);
     
     if (getenv("DISPLAY") == NULL) {
         printf(B_RED "WARNING: No DISPLAY detected. 3D View might not start.\n" RESET);
@@ -867,7 +1400,7 @@ int main(int argc, char *argv[]) {
                         printf("nav H M W [F]: Warp Navigation (H 0-359, M -90/90, W Dist, F Factor 1-9.9)\n");
                         printf("imp H M S   : Impulse Drive (H, M, Speed 0.0-1.0). imp 0 0 0 to stop.\n");
                         printf("jum Q1 Q2 Q3: Wormhole Jump (Instant travel, costs 5000 En + 1 Dilithium)\n");
-                        printf("srs         : Short Range Sensors (Current Quadrant View)\n");
+                        printf("srs [TYPE]  : Short Range Sensors (Current Quadrant View, optional type filter)\n");
                         printf("lrs         : Long Range Sensors (LCARS Tactical Grid)\n");
                         printf("pha <E>     : Fire Phasers at locked target (uses Energy E)\n");
                         printf("pha <ID> <E>: Fire Phasers at specific target ID\n");
@@ -908,6 +1441,51 @@ int main(int argc, char *argv[]) {
                         printf("axs / grd   : Toggle 3D Visual Guides\n");
                         printf("map         : Toggle Galactic Starmap View\n");
                         printf("xxx         : Self-Destruct\n");
+                        printf("A; B; C     : Command Batch, executed atomically (max %d commands)\n", MAX_BATCH_COMMANDS);
+                        printf("+N A; B; C  : Command Batch with N ticks between steps\n");
+                        printf("mac def NAME [+N] A; B : Store a macro on the server ('mac NAME' runs it)\n");
+                        printf("mac list / mac del NAME: Manage stored macros\n");
+                        if (g_spectator) {
+                            printf(B_WHITE "--- SPECTATOR LINK (read-only) ---" RESET "\n");
+                            printf("spec Q1 Q2 Q3 : Watch a quadrant\n");
+                            printf("follow N      : Follow captain N (player slot 1-32)\n");
+                        }
+                    } else if (g_spectator && strncmp(g_input_buf, "spec ", 5) == 0) {
+                        PacketSpectate spkt = g_spectate_req;
+                        spkt.mode = SPECTATE_QUADRANT;
+                        if (sscanf(g_input_buf + 5, "%d %d %d", &spkt.q1, &spkt.q2, &spkt.q3) == 3) {
+                            g_spectate_req = spkt;
+                            write_all(sock, &spkt, sizeof(PacketSpectate));
+                        } else printf("Usage: spec Q1 Q2 Q3\n");
+                    } else if (g_spectator && strncmp(g_input_buf, "follow ", 7) == 0) {
+                        PacketSpectate spkt = g_spectate_req;
+                        spkt.mode = SPECTATE_CAPTAIN;
+                        if (sscanf(g_input_buf + 7, "%d", &spkt.target_id) == 1) {
+                            g_spectate_req = spkt;
+                            write_all(sock, &spkt, sizeof(PacketSpectate));
+                        } else printf("Usage: follow ID\n");
+                    } else if (!g_spectator && strchr(g_input_buf, ';') && strncmp(g_input_buf, "rad ", 4) != 0 && strncmp(g_input_buf, "mac ", 4) != 0) {
+                        /* Command Batch: "cmd; cmd; ..." runs atomically, "+N cmd; cmd" spaces steps N ticks apart */
+                        PacketBatch bpkt;
+                        memset(&bpkt, 0, sizeof(PacketBatch));
+                        bpkt.type = PKT_BATCH;
+                        char *p_cmd = g_input_buf;
+                        if (p_cmd[0] == '+') {
+                            bpkt.tick_delay = (int)strtol(p_cmd + 1, &p_cmd, 10);
+                            if (bpkt.tick_delay < 0) bpkt.tick_delay = 0;
+                        }
+                        for (char *tok = strtok(p_cmd, ";"); tok && bpkt.count < MAX_BATCH_COMMANDS; tok = strtok(NULL, ";")) {
+                            while (*tok == ' ') tok++;
+                            if (*tok == '\0') continue;
+                            strncpy(bpkt.cmds[bpkt.count++], tok, 255);
+                        }
+                        if (bpkt.count > 0) write_all(sock, &bpkt, offsetof(PacketBatch, cmds) + bpkt.count * sizeof(bpkt.cmds[0]));
+                    } else if (!g_spectator && (strcmp(g_input_buf, "srs") == 0 || strncmp(g_input_buf, "srs ", 4) == 0)) {
+                        /* The filter is applied locally to the binary contact list */
+                        g_srs_filter[0] = '\0';
+                        if (g_input_buf[3] == ' ') sscanf(g_input_buf + 4, "%31s", g_srs_filter);
+                        PacketCommand cpkt = {PKT_COMMAND, "srs"};
+                        send(sock, &cpkt, sizeof(cpkt), 0);
                     } else if (strncmp(g_input_buf, "dis ", 4) == 0 || strcmp(g_input_buf, "dis") == 0) {
                         PacketCommand cpkt = {PKT_COMMAND, ""};
                         size_t clen = strlen(g_input_buf);
@@ -1103,6 +1681,8 @@ int main(int argc, char *argv[]) {
                             if (n <= 0) break;
                             sent_msg += n;
                         }
+                    } else if (g_spectator) {
+                        printf(B_YELLOW "Spectator link is read-only. Use 'spec', 'follow', 'map', 'axs' or 'grd'.\n" RESET);
                     } else {
                         PacketCommand cpkt = {PKT_COMMAND, ""};
                         size_t clen = strlen(g_input_buf);
@@ -20,7 +20,7 @@
 #include <errno.h>
 #include <math.h>
 #include <openssl/evp.h>
-#include <openssl/hmac.h>
+#include <openssl/core_names.h>
 #include <openssl/sha.h>
 #include "server_internal.h"
 
@@ -127,15 +127,39 @@ void display_system_telemetry() {
     printf("%s '-----------------------------------------------------------------------------------------'%s\n\n", B_MAGENTA, RESET);
 }
 
+/* Generates a cryptographic signature of the galaxy state (excluding the signature field
+   itself). The galaxy cube leads StarTrekGame and only changes with galaxy_version, so the
+   HMAC state after absorbing it is kept and each signing hashes only the fields after it.
+   Caller holds game_mutex (or runs before the tick starts): the cube must not move while
+   it is absorbed, or the torn state would stay cached until the next map change. */
 void sign_galaxy_data() {
-    unsigned int len = 32;
-    /* Generate a cryptographic signature of the galaxy state (excluding the signature field itself) */
-    HMAC(EVP_sha256(), MASTER_SESSION_KEY, 32, (uint8_t*)&galaxy_master, 
-         offsetof(StarTrekGame, server_signature), galaxy_master.server_signature, &len);
-    
-    /* In a real scenario, we'd use an actual Ed25519 public key here. 
-       For this implementation, we use a derived key from the Master Session Key. */
-    SHA256(MASTER_SESSION_KEY, 32, SERVER_PUBKEY);
+    static EVP_MAC_CTX *cube_mac = NULL;
+    static uint64_t signed_version = 0;
+    if (!cube_mac || signed_version != galaxy_version) {
+        if (!cube_mac) {
+            EVP_MAC *mac = EVP_MAC_fetch(NULL, "HMAC", NULL);
+            cube_mac = mac ? EVP_MAC_CTX_new(mac) : NULL;
+            EVP_MAC_free(mac);
+            if (!cube_mac) { fprintf(stderr, "HMAC-SHA256 unavailable\n"); exit(1); }
+        }
+        char digest[] = "SHA256";
+        OSSL_PARAM params[] = { OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, digest, 0), OSSL_PARAM_construct_end() };
+        EVP_MAC_init(cube_mac, MASTER_SESSION_KEY, 32, params);
+        EVP_MAC_update(cube_mac, (uint8_t*)galaxy_master.g, sizeof(galaxy_master.g));
+
+        /* In a real scenario, we'd use an actual Ed25519 public key here.
+           For this implementation, we use a derived key from the Master Session Key. */
+        SHA256(MASTER_SESSION_KEY, 32, SERVER_PUBKEY);
+        signed_version = galaxy_version;
+        LOG_DEBUG("Galaxy signature refreshed (version %llu)\n", (unsigned long long)galaxy_version);
+    }
+    EVP_MAC_CTX *ctx = EVP_MAC_CTX_dup(cube_mac);
+    size_t len = 0;
+    const uint8_t *rest = (const uint8_t*)&galaxy_master + sizeof(galaxy_master.g);
+    if (!ctx || !EVP_MAC_update(ctx, rest, offsetof(StarTrekGame, server_signature) - sizeof(galaxy_master.g)) ||
+        !EVP_MAC_final(ctx, galaxy_master.server_signature, &len, 32))
+        LOG_DEBUG("Galaxy signature failed\n");
+    EVP_MAC_CTX_free(ctx);
     memcpy(galaxy_master.server_pubkey, SERVER_PUBKEY, 32);
     
     /* Encryption Details: 
@@ -152,7 +176,27 @@ int main(int argc, char *argv[]) {
     int opt = 1, adlen = sizeof(addr);
     struct epoll_event ev, events[MAX_EVENTS];
 
-    for (int i = 1; i < argc; i++) if (strcmp(argv[i], "-d") == 0) g_debug = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-d") == 0) g_debug = 1;
+        else if (strcmp(argv[i], "-g") == 0 && i + 1 < argc) {
+            /* Quadrants per axis for a newly generated galaxy */
+            galaxy_q = atoi(argv[++i]);
+            if (galaxy_q < 1 || galaxy_q > GALAXY_Q_MAX) {
+                fprintf(stderr, "Galaxy size must be 1-%d quadrants per axis.\n", GALAXY_Q_MAX);
+                exit(1);
+            }
+        }
+        else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+            /* Soft limit of an entity pool, e.g. -l mine=40000 */
+            char name[32];
+            int slots;
+            if (sscanf(argv[++i], "%31[a-z]=%d", name, &slots) != 2 || !entity_set_limit(name, slots)) {
+                fprintf(stderr, "Pool limit must be kind=N with N up to %d (npc, planet, base, star, blackhole, nebula,\n"
+                                "pulsar, comet, asteroid, derelict, mine, buoy, platform, rift, monster).\n", ENT_POOL_MAX);
+                exit(1);
+            }
+        }
+    }
     signal(SIGPIPE, SIG_IGN);
     
     /* Security Initialization */
@@ -189,9 +233,13 @@ int main(int argc, char *argv[]) {
 
     display_system_telemetry();
 
+    entity_init();
     if (!load_galaxy()) { generate_galaxy(); save_galaxy(); }
     sign_galaxy_data();
     init_static_spatial_index();
+    mempool_init();
+    crypto_pool_init();
+    snapshot_publish(); /* Reports have a world to read before the first tick */
     
     pthread_t tid; pthread_create(&tid, NULL, game_loop_thread, NULL);
 
@@ -236,18 +284,18 @@ int main(int argc, char *argv[]) {
                     /* Disconnect */
                     epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
                     pthread_mutex_lock(&game_mutex);
-                    for (int i=0; i<MAX_CLIENTS; i++) if (players[i].socket == fd) { players[i].socket = 0; players[i].active = 0; break; }
+                    for (int i=0; i<MAX_CLIENTS; i++) if (players[i].socket == fd) { crypto_pool_close(i, fd); players[i].socket = 0; players[i].active = 0; reset_alerts(i); break; }
+                    remove_spectator(fd);
                     pthread_mutex_unlock(&game_mutex);
                     close(fd);
                     LOG_DEBUG("Connection closed: FD %d\n", fd);
                     continue;
                 }
 
-                /* Find player index if already logged in */
+                /* Find player index if already logged in. Sockets are only assigned on this thread, so no
+                   lock is needed; a captain lost meanwhile is filtered again when the tick applies the input. */
                 int p_idx = -1;
-                pthread_mutex_lock(&game_mutex);
-                for (int i=0; i<MAX_CLIENTS; i++) if (players[i].socket == fd && players[i].active) { p_idx = i; break; }
-                pthread_mutex_unlock(&game_mutex);
+                for (int i=0; i<MAX_CLIENTS; i++) if (players[i].socket == fd && __atomic_load_n(&players[i].active, __ATOMIC_RELAXED)) { p_idx = i; break; }
 
                 if (type == PKT_HANDSHAKE) {
                     PacketHandshake h_pkt;
@@ -267,29 +315,38 @@ int main(int argc, char *argv[]) {
                             }
                         }
                         
+                        /* Verify Signature Integrity (Full 32 bytes) */
+                        uint8_t sig[32];
+                        for(int k=0; k<32; k++) sig[k] = h_pkt.pubkey[32+k] ^ MASTER_SESSION_KEY[k];
+                        
+                        if (memcmp(sig, HANDSHAKE_MAGIC_STRING, 32) != 0) {
+                            fprintf(stderr, "\033[1;31m[SECURITY ALERT]\033[0m Handshake integrity failure on FD %d. Invalid Master Key.\n", fd);
+                            /* Kick the client */
+                            if (slot != -1) players[slot].socket = 0;
+                            pthread_mutex_unlock(&game_mutex);
+                            epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+                            close(fd);
+                            continue; /* Move to next epoll event */
+                        }
+                        
+                        /* De-obfuscate the Session Key using Master Key. With every slot taken the
+                           link is still valid for spectators, which never occupy a player slot. */
                         if (slot != -1) {
-                            /* De-obfuscate the Session Key and Signature using Master Key */
                             for(int k=0; k<32; k++) {
                                 players[slot].session_key[k] = h_pkt.pubkey[k] ^ MASTER_SESSION_KEY[k];
                             }
-                            
-                            /* Verify Signature Integrity (Full 32 bytes) */
-                            uint8_t sig[32];
-                            for(int k=0; k<32; k++) sig[k] = h_pkt.pubkey[32+k] ^ MASTER_SESSION_KEY[k];
-                            
-                            if (memcmp(sig, HANDSHAKE_MAGIC_STRING, 32) != 0) {
-                                fprintf(stderr, "\033[1;31m[SECURITY ALERT]\033[0m Handshake integrity failure on FD %d. Invalid Master Key.\n", fd);
-                                /* Kick the client */
-                                players[slot].socket = 0;
-                                pthread_mutex_unlock(&game_mutex);
-                                epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
-                                close(fd);
-                                continue; /* Move to next epoll event */
-                            }
-                            
-                            LOG_DEBUG("Secure Session Key negotiated for Client FD %d (Slot %d)\n", fd, slot);
-                            
-                            /* Send ACK back to client to confirm Master Key is correct */
+                            players[slot].link_caps = h_pkt.caps & (LINK_CAP_COMPRESS | LINK_CAP_SEALED_UPDATES);
+                            crypto_pool_prepare(slot);
+                        }
+                        
+                        LOG_DEBUG("Secure Session Key negotiated for Client FD %d (Slot %d), caps 0x%x\n", fd, slot, h_pkt.caps);
+                        
+                        /* Send ACK back to client to confirm Master Key is correct. Only clients that
+                           asked for capabilities get the extended ACK; older ones read a bare int. */
+                        if (h_pkt.caps != 0) {
+                            PacketHandshakeAck ack = { PKT_HANDSHAKE, (slot != -1) ? players[slot].link_caps : 0 };
+                            write_all(fd, &ack, sizeof(PacketHandshakeAck));
+                        } else {
                             int ack_type = PKT_HANDSHAKE;
                             write_all(fd, &ack_type, sizeof(int));
                         }
@@ -306,16 +363,25 @@ int main(int argc, char *argv[]) {
                             write_all(fd, &found, sizeof(int));
                         } else {
                             pthread_mutex_lock(&game_mutex);
+                            if (!link_has_session_key(fd)) {
+                                pthread_mutex_unlock(&game_mutex);
+                                LOG_DEBUG("Login refused for FD %d: no session key on this link\n", fd);
+                                shutdown(fd, SHUT_RDWR); /* Reaped by the epoll loop */
+                                continue;
+                            }
                             int slot = -1;
                             for(int j=0; j<MAX_CLIENTS; j++) { if (players[j].name[0] != '\0' && strcmp(players[j].name, pkt.name) == 0) { slot = j; break; } }
                             if (slot == -1) { for(int j=0; j<MAX_CLIENTS; j++) if (players[j].name[0] == '\0') { slot = j; break; } }
                             
                             if (slot != -1) {
+                                adopt_handshake_link(slot, fd);
+                                reset_alerts(slot);
                                 players[slot].socket = fd;
                                 int is_new = (players[slot].name[0] == '\0');
                                 players[slot].active = 0; /* Block updates during sync */
 
                                 if (is_new) {
+                                    entity_spawned(SI_PLAYER, slot);
                                     strcpy(players[slot].name, pkt.name); players[slot].faction = pkt.faction; players[slot].ship_class = pkt.ship_class;
                                     players[slot].state.energy = 9999999; players[slot].state.torpedoes = 1000;
                                     int crew = 400;
@@ -330,7 +396,7 @@ int main(int argc, char *argv[]) {
                                         default: crew = 200; break;
                                     }
                                     players[slot].state.crew_count = crew;
-                                                                        players[slot].state.q1 = rand()%10 + 1; players[slot].state.q2 = rand()%10 + 1; players[slot].state.q3 = rand()%10 + 1;
+                                                                        players[slot].state.q1 = rand()%galaxy_q + 1; players[slot].state.q2 = rand()%galaxy_q + 1; players[slot].state.q3 = rand()%galaxy_q + 1;
                                                                         players[slot].state.s1 = 5.0; players[slot].state.s2 = 5.0; players[slot].state.s3 = 5.0;
                                                                         
                                                                         /* Initialize Absolute Galactic Coordinates */
@@ -355,10 +421,6 @@ int main(int argc, char *argv[]) {
 
                                 /* SESSION INITIALIZATION: Reset transient event flags */
                                 players[slot].renegade_timer = 0;
-                                players[slot].state.boom.active = 0;
-                                players[slot].state.torp.active = 0;
-                                players[slot].state.dismantle.active = 0;
-                                players[slot].state.beam_count = 0;
                                 players[slot].torp_active = false;
                                 
                                 /* FORCE COORDINATE SYNC: Ensure HUD and Viewer align immediately */
@@ -369,15 +431,17 @@ int main(int argc, char *argv[]) {
                                 players[slot].state.s2 = players[slot].gy - (players[slot].state.q2 - 1) * 10.0;
                                 players[slot].state.s3 = players[slot].gz - (players[slot].state.q3 - 1) * 10.0;
 
+                                const void *sync;
+                                size_t sync_len = signed_galaxy_sync(&sync);
                                 pthread_mutex_unlock(&game_mutex);
 
-                                LOG_DEBUG("Synchronizing Galaxy Master (%zu bytes) to FD %d\n", sizeof(StarTrekGame), fd);
-                                sign_galaxy_data();
+                                LOG_DEBUG("Synchronizing Galaxy Master and chart (%zu bytes) to FD %d\n", sync_len, fd);
                                 pthread_mutex_lock(&players[slot].socket_mutex);
-                                int w_res = write_all(fd, &galaxy_master, sizeof(StarTrekGame));
+                                int w_res = write_all(fd, sync, sync_len);
                                 pthread_mutex_unlock(&players[slot].socket_mutex);
 
-                                if (w_res == sizeof(StarTrekGame)) {
+                                if (w_res == (int)sync_len) {
+                                    send_session_token(slot);
                                     pthread_mutex_lock(&game_mutex);
                                     LOG_DEBUG("Galaxy Master sent successfully to FD %d\n", fd);
                                     bool needs_rescue = false;
@@ -385,13 +449,13 @@ int main(int argc, char *argv[]) {
                                     
                                     int pq1 = players[slot].state.q1, pq2 = players[slot].state.q2, pq3 = players[slot].state.q3;
                                     if (IS_Q_VALID(pq1, pq2, pq3)) {
-                                        QuadrantIndex *qi = &spatial_index[pq1][pq2][pq3];
+                                        QuadrantIndex qi_view = spatial_quadrant(pq1, pq2, pq3), *qi = &qi_view;
                                         for (int s=0; s<qi->star_count; s++) {
-                                            double d = sqrt(pow(players[slot].state.s1 - qi->stars[s]->x, 2) + pow(players[slot].state.s2 - qi->stars[s]->y, 2) + pow(players[slot].state.s3 - qi->stars[s]->z, 2));
+                                            double d = sqrt(pow(players[slot].state.s1 - stars_data[qi->stars[s]].x, 2) + pow(players[slot].state.s2 - stars_data[qi->stars[s]].y, 2) + pow(players[slot].state.s3 - stars_data[qi->stars[s]].z, 2));
                                             if (d < 1.0) needs_rescue = true;
                                         }
                                         for (int p=0; p<qi->planet_count; p++) {
-                                            double d = sqrt(pow(players[slot].state.s1 - qi->planets[p]->x, 2) + pow(players[slot].state.s2 - qi->planets[p]->y, 2) + pow(players[slot].state.s3 - qi->planets[p]->z, 2));
+                                            double d = sqrt(pow(players[slot].state.s1 - planets[qi->planets[p]].x, 2) + pow(players[slot].state.s2 - planets[qi->planets[p]].y, 2) + pow(players[slot].state.s3 - planets[qi->planets[p]].z, 2));
                                             if (d < 1.0) needs_rescue = true;
                                         }
                                     }
@@ -400,7 +464,7 @@ int main(int argc, char *argv[]) {
                                         int rq1, rq2, rq3;
                                         /* Find a quadrant without a supernova */
                                         do {
-                                            rq1 = rand()%10 + 1; rq2 = rand()%10 + 1; rq3 = rand()%10 + 1;
+                                            rq1 = rand()%galaxy_q + 1; rq2 = rand()%galaxy_q + 1; rq3 = rand()%galaxy_q + 1;
                                         } while (supernova_event.supernova_timer > 0 && 
                                                  rq1 == supernova_event.supernova_q1 && 
                                                  rq2 == supernova_event.supernova_q2 && 
@@ -420,13 +484,13 @@ int main(int argc, char *argv[]) {
                                         players[slot].dx = 0; players[slot].dy = 0; players[slot].dz = 0;
                                         players[slot].active = 1;
                                         players[slot].crypto_algo = CRYPTO_NONE; 
-                                        pthread_mutex_unlock(&game_mutex);
                                         send_server_msg(slot, "STARFLEET", "EMERGENCY RESCUE: Your ship was recovered and towed to a safe quadrant.");
+                                        pthread_mutex_unlock(&game_mutex);
                                     } else {
                                         players[slot].active = 1;
                                         players[slot].crypto_algo = CRYPTO_NONE; 
-                                        pthread_mutex_unlock(&game_mutex);
                                         send_server_msg(slot, "SERVER", is_new ? "Welcome aboard, new Captain." : "Commander, welcome back.");
+                                        pthread_mutex_unlock(&game_mutex);
                                     }
                                 }
                             } else {
@@ -434,17 +498,35 @@ int main(int argc, char *argv[]) {
                             }
                         }
                     }
+                } else if (type == PKT_RESUME) {
+                    PacketResume pkt;
+                    if (read_all(fd, ((char*)&pkt) + sizeof(int), sizeof(PacketResume) - sizeof(int)) > 0) {
+                        pkt.name[63] = '\0';
+                        handle_resume(fd, &pkt);
+                    }
+                } else if (type == PKT_SPECTATE) {
+                    PacketSpectate pkt;
+                    if (read_all(fd, ((char*)&pkt) + sizeof(int), sizeof(PacketSpectate) - sizeof(int)) > 0) handle_spectate(fd, &pkt);
                 } else if (p_idx != -1) {
                     if (type == PKT_COMMAND) {
                         PacketCommand pkt;
                         if (read_all(fd, ((char*)&pkt) + sizeof(int), sizeof(PacketCommand) - sizeof(int)) > 0) process_command(p_idx, pkt.cmd);
+                    } else if (type == PKT_BATCH) {
+                        PacketBatch pkt;
+                        size_t hdr = offsetof(PacketBatch, cmds) - sizeof(int);
+                        if (read_all(fd, ((char*)&pkt) + sizeof(int), hdr) > 0) {
+                            if (pkt.count < 1 || pkt.count > MAX_BATCH_COMMANDS) { shutdown(fd, SHUT_RDWR); continue; } /* Stream desync */
+                            if (read_all(fd, pkt.cmds, pkt.count * sizeof(pkt.cmds[0])) > 0) process_batch(p_idx, &pkt);
+                        }
                     } else if (type == PKT_MESSAGE) {
-                        PacketMessage pkt;
-                        if (read_all(fd, ((char*)&pkt) + sizeof(int), offsetof(PacketMessage, text) - sizeof(int)) > 0) {
-                            if (pkt.length > 0 && pkt.length < 4096) read_all(fd, pkt.text, pkt.length + 1);
-                            else pkt.text[0] = '\0';
-                            pkt.type = type; broadcast_message(&pkt);
+                        ArenaMark mark = arena_mark();
+                        PacketMessage *pkt = arena_alloc(sizeof(PacketMessage));
+                        if (pkt && read_all(fd, ((char*)pkt) + sizeof(int), offsetof(PacketMessage, text) - sizeof(int)) > 0) {
+                            if (pkt->length > 0 && pkt->length < 4096) read_all(fd, pkt->text, pkt->length + 1);
+                            else pkt->text[0] = '\0';
+                            pkt->type = type; broadcast_message(pkt);
                         }
+                        arena_release(mark);
                     }
                 }
             }
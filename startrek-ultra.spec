@@ -17,11 +17,13 @@ BuildRequires:  freeglut-devel
 BuildRequires:  mesa-libGLU-devel
 BuildRequires:  mesa-libGL-devel
 BuildRequires:  openssl-devel
+BuildRequires:  zlib-devel
 
 Requires:       freeglut
 Requires:       mesa-libGLU
 Requires:       mesa-libGL
 Requires:       openssl
+Requires:       zlib
 
 %description
 Star Trek Ultra is a high-performance 3D multi-user client-server game engine.